@@ -42,6 +42,7 @@
 #include "llvertexbuffer.h"
 #include "llviewervisualparam.h"
 #include "llfasttimer.h"
+#include "workqueue.h" // <FS/> Async morph masks
 
 //#include "../tools/imdebug/imdebug.h"
 #include "llrendertarget.h"
@@ -944,6 +945,11 @@ LLViewerVisualParam* LLTexLayerInterface::getVisualParamPtr(S32 index) const
 //          * a texture entry index (TE)
 //      * (optional) one or more alpha parameters (weighted alpha textures)
 //-----------------------------------------------------------------------------
+// <FS> Async morph masks
+// static
+bool LLTexLayer::sAsyncMorphMasks = true;
+// </FS>
+
 LLTexLayer::LLTexLayer(LLTexLayerSet* const layer_set) :
     LLTexLayerInterface( layer_set ),
     mLocalTextureObject(NULL)
@@ -1025,6 +1031,7 @@ void LLTexLayer::calculateTexLayerColor(const param_color_list_t &param_list, LL
     {
         param->deleteCaches();
     }
+    mStaticMaskRaw = NULL; // <FS/> Async morph masks
 }
 
 bool LLTexLayer::render(S32 x, S32 y, S32 width, S32 height, LLRenderTarget* bound_target)
@@ -1296,7 +1303,357 @@ bool LLTexLayer::blendAlphaTexture(S32 x, S32 y, S32 width, S32 height)
     addAlphaMask(data, originX, originY, width, height, bound_target);
 }
 
-void LLTexLayer::renderMorphMasks(S32 x, S32 y, S32 width, S32 height, const LLColor4 &layer_color, LLRenderTarget* bound_target, bool force_render)
+// <FS> Async morph masks
+// One blend of the morph mask composite, replaying what renderMorphMasks()
+// draws: the alpha of an image stretched over the mask, or a constant,
+// times the vertex color alpha in effect at that point.
+struct LLMorphMaskStep
+{
+    LLPointer<LLImageRaw>   mImage;     // NULL for a constant alpha
+    S32                     mChannel = 0;
+    F32                     mAlpha = 1.f;
+    bool                    mMultiply = false; // BF_DEST_ALPHA, BF_ZERO rather than BT_ADD
+};
+
+struct LLTexLayer::MorphMaskJob
+{
+    ~MorphMaskJob()
+    {
+        if (mAlphaData)
+        {
+            ll_aligned_free_32(mAlphaData);
+        }
+    }
+
+    void compute();
+
+    std::vector<LLMorphMaskStep> mSteps;
+    S32                     mWidth = 0;
+    S32                     mHeight = 0;
+    U32                     mCacheIndex = 0;
+    U32                     mGeneration = 0;
+    U8*                     mAlphaData = nullptr; // Result, handed over to mAlphaCache
+};
+
+// Bilinear taps of one image axis, clamped to the edge like TAM_CLAMP
+static void get_morph_mask_taps(S32 dst_size, S32 src_size, S32 dst, S32& tap0, S32& tap1, F32& frac)
+{
+    F32 coord = ((F32)dst + 0.5f) * (F32)src_size / (F32)dst_size - 0.5f;
+    if (coord <= 0.f)
+    {
+        tap0 = tap1 = 0;
+        frac = 0.f;
+        return;
+    }
+    tap0 = llmin((S32)coord, src_size - 1);
+    tap1 = llmin(tap0 + 1, src_size - 1);
+    frac = coord - (F32)tap0;
+}
+
+// The render target stores 8 bits of alpha, round each blend the same way
+static inline void quantize_morph_mask_alpha(LLVector4a& alpha)
+{
+    static const LLVector4a zero(0.f);
+    static const LLVector4a one(1.f);
+    alpha.clamp(zero, one);
+    alpha.mul(255.f);
+    alpha = LLVector4a(_mm_cvtepi32_ps(_mm_cvtps_epi32(alpha)));
+    alpha.mul(1.f / 255.f);
+}
+
+// Runs on the General pool, only touches the job and the images it holds
+void LLTexLayer::MorphMaskJob::compute()
+{
+    LL_PROFILE_ZONE_SCOPED;
+
+    // Rows are padded to whole vectors
+    const S32 row_floats = (mWidth + 3) & ~3;
+    const size_t row_bytes = row_floats * sizeof(F32);
+    const size_t num_steps = mSteps.size();
+
+    // Horizontal taps of every image step, they are the same for each row
+    std::vector<S32> taps0(num_steps * mWidth);
+    std::vector<S32> taps1(num_steps * mWidth);
+    std::vector<F32> fracs(num_steps * mWidth);
+    for (size_t step = 0; step < num_steps; ++step)
+    {
+        const LLImageRaw* image = mSteps[step].mImage;
+        if (image)
+        {
+            for (S32 i = 0; i < mWidth; ++i)
+            {
+                const size_t tap = step * mWidth + i;
+                get_morph_mask_taps(mWidth, image->getWidth(), i, taps0[tap], taps1[tap], fracs[tap]);
+            }
+        }
+    }
+
+    F32* alpha_row = (F32*)ll_aligned_malloc_16(row_bytes);
+    F32* top_row = (F32*)ll_aligned_malloc_16(row_bytes);
+    F32* bottom_row = (F32*)ll_aligned_malloc_16(row_bytes);
+    memset(top_row, 0, row_bytes);
+    memset(bottom_row, 0, row_bytes);
+
+    const size_t row_size = (mWidth + 3) & ~0x3; // same size as the readback buffer
+    mAlphaData = (U8*)ll_aligned_malloc_32(row_size * mHeight);
+
+    const F32 to_unit = 1.f / 255.f;
+    static const LLVector4a one(1.f);
+
+    for (S32 row = 0; row < mHeight; ++row)
+    {
+        // Cleared with BT_REPLACE before the first param
+        memset(alpha_row, 0, row_bytes);
+
+        for (size_t step = 0; step < num_steps; ++step)
+        {
+            const LLMorphMaskStep& blend = mSteps[step];
+
+            LLVector4a constant(blend.mAlpha);
+            F32 row_frac = 0.f;
+            if (blend.mImage.notNull())
+            {
+                const LLImageRaw* image = blend.mImage;
+                const S32 components = image->getComponents();
+                const S32 image_width = image->getWidth();
+                const U8* data = image->getData();
+
+                S32 row0, row1;
+                get_morph_mask_taps(mHeight, image->getHeight(), row, row0, row1, row_frac);
+                const U8* texels0 = data + (size_t)row0 * image_width * components + blend.mChannel;
+                const U8* texels1 = data + (size_t)row1 * image_width * components + blend.mChannel;
+
+                const S32* tap0 = &taps0[step * mWidth];
+                const S32* tap1 = &taps1[step * mWidth];
+                const F32* frac = &fracs[step * mWidth];
+                for (S32 i = 0; i < mWidth; ++i)
+                {
+                    const F32 t00 = texels0[tap0[i] * components];
+                    const F32 t01 = texels0[tap1[i] * components];
+                    const F32 t10 = texels1[tap0[i] * components];
+                    const F32 t11 = texels1[tap1[i] * components];
+                    top_row[i] = (t00 + (t01 - t00) * frac[i]) * to_unit;
+                    bottom_row[i] = (t10 + (t11 - t10) * frac[i]) * to_unit;
+                }
+            }
+
+            for (S32 i = 0; i < row_floats; i += 4)
+            {
+                LLVector4a src;
+                if (blend.mImage.notNull())
+                {
+                    LLVector4a top, bottom;
+                    top.load4a(top_row + i);
+                    bottom.load4a(bottom_row + i);
+                    src.setLerp(top, bottom, row_frac);
+                    src.mul(constant);
+                }
+                else
+                {
+                    src = constant;
+                }
+
+                LLVector4a alpha;
+                alpha.load4a(alpha_row + i);
+                if (blend.mMultiply)
+                {
+                    alpha.mul(src);
+                }
+                else
+                {
+                    alpha.add(src);
+                    alpha.setMin(alpha, one);
+                }
+                quantize_morph_mask_alpha(alpha);
+                alpha.store4a(alpha_row + i);
+            }
+        }
+
+        U8* out = mAlphaData + (size_t)row * mWidth;
+        for (S32 i = 0; i < mWidth; ++i)
+        {
+            out[i] = (U8)(alpha_row[i] * 255.f + 0.5f);
+        }
+    }
+
+    ll_aligned_free_16(alpha_row);
+    ll_aligned_free_16(top_row);
+    ll_aligned_free_16(bottom_row);
+}
+
+// Captures the inputs of the morph mask renderMorphMasks() just drew, or
+// returns nullptr if one of them is only available on the GPU. Must run
+// after the params rendered, which keeps their processed images current.
+LLTexLayer::morph_mask_job_t LLTexLayer::createMorphMaskJob(S32 width, S32 height, const LLColor4& layer_color)
+{
+    LLTexLayerParamAlpha* first_param = *mParamAlphaList.begin();
+    if (!first_param || first_param->getMultiplyBlend())
+    {
+        // Multiplies against the alpha earlier layers left in the render target
+        return nullptr;
+    }
+
+    if (getInfo()->mLocalTexture != -1 && mLocalTextureObject)
+    {
+        LLGLTexture* tex = mLocalTextureObject->getImage();
+        if (tex && (tex->getComponents() == 4))
+        {
+            // The alpha of local textures is not kept in system memory
+            return nullptr;
+        }
+    }
+
+    morph_mask_job_t job = std::make_shared<MorphMaskJob>();
+    job->mWidth = width;
+    job->mHeight = height;
+
+    // LLTexLayerParamAlpha::render() leaves its constant alpha as the
+    // current color, later textured draws are modulated by it.
+    F32 color_alpha = 1.f;
+    for (LLTexLayerParamAlpha* param : mParamAlphaList)
+    {
+        if (param->getSkip())
+        {
+            continue;
+        }
+
+        LLMorphMaskStep step;
+        step.mMultiply = param->getMultiplyBlend();
+        if (param->hasStaticImage())
+        {
+            step.mImage = param->getStaticImageRaw();
+            if (step.mImage.isNull() || !step.mImage->getData())
+            {
+                return nullptr;
+            }
+            step.mChannel = step.mImage->getComponents() - 1;
+            step.mAlpha = color_alpha;
+        }
+        else
+        {
+            step.mAlpha = param->getEffectiveWeight();
+            color_alpha = step.mAlpha;
+        }
+        job->mSteps.push_back(step);
+    }
+
+    if (!getInfo()->mStaticImageFileName.empty() && getInfo()->mStaticImageIsMask)
+    {
+        LLGLTexture* tex = LLTexLayerStaticImageList::getInstance()->getTexture(getInfo()->mStaticImageFileName, getInfo()->mStaticImageIsMask);
+        if (tex && ((tex->getComponents() == 4) || (tex->getComponents() == 1)))
+        {
+            if (mStaticMaskRaw.isNull())
+            {
+                // Same decode as the static texture, masks keep their alpha in the last channel
+                LLImageTGA* image_tga = LLTexLayerStaticImageList::getInstance()->getImageTGA(getInfo()->mStaticImageFileName);
+                LLPointer<LLImageRaw> image_raw = new LLImageRaw;
+                if (!image_tga || !image_tga->decode(image_raw) || !image_raw->getData())
+                {
+                    return nullptr;
+                }
+                mStaticMaskRaw = image_raw;
+            }
+
+            LLMorphMaskStep step;
+            step.mMultiply = true;
+            step.mImage = mStaticMaskRaw;
+            step.mChannel = mStaticMaskRaw->getComponents() - 1;
+            step.mAlpha = color_alpha;
+            job->mSteps.push_back(step);
+        }
+    }
+
+    if (!is_approx_equal(layer_color.mV[VALPHA], 1.f))
+    {
+        LLMorphMaskStep step;
+        step.mMultiply = true;
+        step.mAlpha = layer_color.mV[VALPHA];
+        job->mSteps.push_back(step);
+    }
+
+    return job;
+}
+
+void LLTexLayer::computeMorphMask(const morph_mask_job_t& job, bool async)
+{
+    if (!mMorphMaskState)
+    {
+        mMorphMaskState = std::make_shared<MorphMaskState>();
+    }
+
+    MorphMaskState& state = *mMorphMaskState;
+    if (async && (state.mRequested != state.mApplied) && (state.mLastCacheIndex == job->mCacheIndex))
+    {
+        // The job in flight produces the same mask
+        return;
+    }
+    job->mGeneration = ++state.mRequested;
+    state.mLastCacheIndex = job->mCacheIndex;
+
+    if (async)
+    {
+        std::weak_ptr<MorphMaskState> weak_state = mMorphMaskState;
+        LLTexLayer* layer = this;
+
+        LL::WorkQueue::ptr_t main_queue = LL::WorkQueue::getInstance("mainloop");
+        LL::WorkQueue::ptr_t general_queue = LL::WorkQueue::getInstance("General");
+        if (main_queue && general_queue &&
+            main_queue->postTo(general_queue,
+                [job]()
+                {
+                    job->compute();
+                },
+                [job, weak_state, layer]()
+                {
+                    std::shared_ptr<MorphMaskState> state = weak_state.lock();
+                    if (state && (job->mGeneration > state->mApplied))
+                    {
+                        layer->finishMorphMask(*job);
+                    }
+                }))
+        {
+            return;
+        }
+    }
+
+    // No worker available (shutting down), or the caller needs the mask now
+    job->compute();
+    finishMorphMask(*job);
+}
+
+// Same bookkeeping as the end of the readback path, on the main thread
+void LLTexLayer::finishMorphMask(MorphMaskJob& job)
+{
+    mMorphMaskState->mApplied = job.mGeneration;
+
+    alpha_cache_t::iterator iter = mAlphaCache.find(job.mCacheIndex);
+    if (iter != mAlphaCache.end())
+    {
+        ll_aligned_free_32(iter->second);
+        mAlphaCache.erase(iter);
+    }
+
+    S32 max_cache_entries = getTexLayerSet()->getAvatarAppearance()->isSelf() ? 4 : 1;
+    while ((S32)mAlphaCache.size() >= max_cache_entries)
+    {
+        alpha_cache_t::iterator iter2 = mAlphaCache.begin(); // arbitrarily grab the first entry
+        ll_aligned_free_32(iter2->second);
+        mAlphaCache.erase(iter2);
+    }
+
+    U8* alpha_data = job.mAlphaData;
+    job.mAlphaData = nullptr;
+    mAlphaCache[job.mCacheIndex] = alpha_data;
+
+    getTexLayerSet()->getAvatarAppearance()->dirtyMesh();
+    getTexLayerSet()->applyMorphMask(alpha_data, job.mWidth, job.mHeight, 1);
+}
+// </FS>
+
+// <FS> Async morph masks
+//void LLTexLayer::renderMorphMasks(S32 x, S32 y, S32 width, S32 height, const LLColor4 &layer_color, LLRenderTarget* bound_target, bool force_render)
+void LLTexLayer::renderMorphMasks(S32 x, S32 y, S32 width, S32 height, const LLColor4 &layer_color, LLRenderTarget* bound_target, bool force_render, bool allow_async)
+// </FS>
 {
     if (!force_render && !hasMorph())
     {
@@ -1406,6 +1763,21 @@ void LLTexLayer::renderMorphMasks(S32 x, S32 y, S32 width, S32 height, const LLC
         }
 
         U32 cache_index = alpha_mask_crc.getCRC();
+
+        // <FS> Async morph masks
+        // Composite the mask again on the CPU rather than wait for the GPU
+        // on a readback. The render target alpha drawn above is still used
+        // by the bake.
+        morph_mask_job_t job = sAsyncMorphMasks ? createMorphMaskJob(width, height, layer_color) : nullptr;
+        if (job)
+        {
+            job->mCacheIndex = cache_index;
+            mMorphMasksValid = true;
+            computeMorphMask(job, allow_async);
+            return;
+        }
+        // </FS>
+
         U8* alpha_data = NULL;
                 // We believe we need to generate morph masks, do not assume that the cached version is accurate.
                 // We can get bad morph masks during login, on minimize, and occasional gl errors.
@@ -1551,6 +1923,14 @@ void LLTexLayer::renderMorphMasks(S32 x, S32 y, S32 width, S32 height, const LLC
 
         mMorphMasksValid = true;
         getTexLayerSet()->applyMorphMask(alpha_data, width, height, 1);
+
+        // <FS> Async morph masks
+        if (mMorphMaskState)
+        {
+            // Masks still being composited are older than this one
+            mMorphMaskState->mApplied = ++mMorphMaskState->mRequested;
+        }
+        // </FS>
     }
 }
 
@@ -1566,7 +1946,11 @@ void LLTexLayer::addAlphaMask(U8 *data, S32 originX, S32 originY, S32 width, S32
         // TODO: eliminate need for layer morph mask valid flag
         invalidateMorphMasks();
         const bool force_render = false;
-        renderMorphMasks(originX, originY, width, height, net_color, bound_target, force_render);
+        // <FS> Async morph masks
+        //renderMorphMasks(originX, originY, width, height, net_color, bound_target, force_render);
+        const bool allow_async = false; // the mask is needed right below
+        renderMorphMasks(originX, originY, width, height, net_color, bound_target, force_render, allow_async);
+        // </FS>
         alphaData = getAlphaData();
     }
     if (alphaData)
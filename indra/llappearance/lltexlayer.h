@@ -28,6 +28,7 @@
 #define LL_LLTEXLAYER_H
 
 #include <deque>
+#include <memory> // <FS/> Async morph masks
 #include "llglslshader.h"
 #include "llgltexture.h"
 #include "llavatarappearancedefines.h"
@@ -160,7 +161,10 @@ public:
     bool                    findNetColor(LLColor4* color) const;
     /*virtual*/ bool        blendAlphaTexture(S32 x, S32 y, S32 width, S32 height); // Multiplies a single alpha texture against the frame buffer
     /*virtual*/ void        gatherAlphaMasks(U8 *data, S32 originX, S32 originY, S32 width, S32 height, LLRenderTarget* bound_target);
-    void                    renderMorphMasks(S32 x, S32 y, S32 width, S32 height, const LLColor4 &layer_color, LLRenderTarget* bound_target, bool force_render);
+    // <FS> Async morph masks
+    //void                  renderMorphMasks(S32 x, S32 y, S32 width, S32 height, const LLColor4 &layer_color, LLRenderTarget* bound_target, bool force_render);
+    void                    renderMorphMasks(S32 x, S32 y, S32 width, S32 height, const LLColor4 &layer_color, LLRenderTarget* bound_target, bool force_render, bool allow_async = true);
+    // </FS>
     void                    addAlphaMask(U8 *data, S32 originX, S32 originY, S32 width, S32 height, LLRenderTarget* bound_target);
     /*virtual*/ bool        isInvisibleAlphaMask() const;
 
@@ -170,11 +174,38 @@ public:
     /*virtual*/ void        asLLSD(LLSD& sd) const;
 
     static void             calculateTexLayerColor(const param_color_list_t &param_list, LLColor4 &net_color);
+
+    // <FS> Async morph masks
+    // Composite morph masks on the CPU when all their inputs are in system
+    // memory, instead of reading them back from the render target.
+    static bool             sAsyncMorphMasks;
+    // </FS>
 protected:
     LLUUID                  getUUID() const;
     typedef std::map<U32, U8*> alpha_cache_t;
     alpha_cache_t           mAlphaCache;
     LLLocalTextureObject*   mLocalTextureObject;
+
+    // <FS> Async morph masks
+    struct MorphMaskJob;
+    typedef std::shared_ptr<MorphMaskJob> morph_mask_job_t;
+
+    // Shared with the jobs in flight, so results for a deleted layer or
+    // older than the mask already applied are dropped.
+    struct MorphMaskState
+    {
+        U32 mRequested = 0;
+        U32 mApplied = 0;
+        U32 mLastCacheIndex = 0;
+    };
+
+    morph_mask_job_t        createMorphMaskJob(S32 width, S32 height, const LLColor4& layer_color);
+    void                    computeMorphMask(const morph_mask_job_t& job, bool async);
+    void                    finishMorphMask(MorphMaskJob& job);
+
+    std::shared_ptr<MorphMaskState> mMorphMaskState;
+    LLPointer<LLImageRaw>   mStaticMaskRaw;
+    // </FS>
 };
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -181,6 +181,24 @@ bool LLTexLayerParamAlpha::getMultiplyBlend() const
     return ((LLTexLayerParamAlphaInfo *)getInfo())->mMultiplyBlend;
 }
 
+// <FS> Async morph masks
+// Whether render() draws the processed static image rather than a constant alpha
+bool LLTexLayerParamAlpha::hasStaticImage() const
+{
+    return !((LLTexLayerParamAlphaInfo *)getInfo())->mStaticImageFileName.empty() && !mStaticImageInvalid;
+}
+
+// The weight render() applies, the default one if the param does not match the avatar's sex
+F32 LLTexLayerParamAlpha::getEffectiveWeight() const
+{
+    if (!mTexLayer)
+    {
+        return getDefaultWeight();
+    }
+    return (mTexLayer->getTexLayerSet()->getAvatarAppearance()->getSex() & getSex()) ? mCurWeight : getDefaultWeight();
+}
+// </FS>
+
 // <FS:Ansariel> [Legacy Bake]
 //void LLTexLayerParamAlpha::setWeight(F32 weight)
 void LLTexLayerParamAlpha::setWeight(F32 weight, bool upload_bake)
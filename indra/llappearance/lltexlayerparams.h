@@ -105,6 +105,12 @@ public:
     void                    deleteCaches();
     bool                    getMultiplyBlend() const;
 
+    // <FS> Async morph masks
+    bool                    hasStaticImage() const;
+    LLImageRaw*             getStaticImageRaw() const   { return mStaticImageRaw; } // As of the last render()
+    F32                     getEffectiveWeight() const;
+    // </FS>
+
 private:
     LLTexLayerParamAlpha(const LLTexLayerParamAlpha& pOther);
 
@@ -191,6 +191,21 @@ void LLCharacter::updateMotions(e_update_t update_type)
     }
 }
 
+// <FS> Parallel avatar animation
+//-----------------------------------------------------------------------------
+// prepareMotions()
+//-----------------------------------------------------------------------------
+bool LLCharacter::prepareMotions()
+{
+    // unpause if the number of outstanding pause requests has dropped to the initial one
+    if (mMotionController.isPaused() && mPauseRequest->getNumRefs() == 1)
+    {
+        mMotionController.unpauseAllMotions();
+    }
+    return mMotionController.prepareMotions();
+}
+// </FS>
+
 
 //-----------------------------------------------------------------------------
 // deactivateAllMotions()
@@ -157,6 +157,15 @@ public:
     enum e_update_t { NORMAL_UPDATE, HIDDEN_UPDATE, FORCE_UPDATE };
     void updateMotions(e_update_t update_type);
 
+    // <FS> Parallel avatar animation
+    // updateMotions() for visible characters in the steps of
+    // LLMotionController::prepareMotions(), for batching several characters.
+    // Only evaluateMotions() may run on a worker thread.
+    bool prepareMotions();
+    void evaluateMotions(e_update_t update_type) { mMotionController.evaluateMotions(update_type == FORCE_UPDATE, true); }
+    void flushDeferredMotions() { mMotionController.flushDeferredMotions(); }
+    // </FS>
+
     LLAnimPauseRequest requestPause();
     bool areAnimationsPaused() const { return mMotionController.isPaused(); }
     void setAnimTimeFactor(F32 factor) { mMotionController.setTimeFactor(factor); }
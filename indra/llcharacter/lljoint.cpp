@@ -34,8 +34,12 @@
 #include "llmath.h"
 #include <boost/algorithm/string.hpp>
 
-S32 LLJoint::sNumUpdates = 0;
-S32 LLJoint::sNumTouches = 0;
+// <FS> Parallel avatar animation
+//S32 LLJoint::sNumUpdates = 0;
+//S32 LLJoint::sNumTouches = 0;
+thread_local S32 LLJoint::sNumUpdates = 0;
+thread_local S32 LLJoint::sNumTouches = 0;
+// </FS>
 
 template <class T>
 bool attachment_map_iter_compare_key(const T& a, const T& b)
@@ -155,6 +159,11 @@ LLJoint::~LLJoint()
         mParent->removeChild( this );
     }
     removeAllChildren();
+
+    // <FS> Flattened joint hierarchy
+    delete mHierarchy;
+    mHierarchy = nullptr;
+    // </FS>
 }
 
 
@@ -274,6 +283,7 @@ void LLJoint::addChild(LLJoint* joint)
     joint->mXform.setParent(&mXform);
     joint->mParent = this;
     joint->touch();
+    touchHierarchy(); // <FS/> Flattened joint hierarchy
 }
 
 
@@ -290,6 +300,7 @@ void LLJoint::removeChild(LLJoint* joint)
         joint->mXform.setParent(NULL);
         joint->mParent = NULL;
         joint->touch();
+        touchHierarchy(); // <FS/> Flattened joint hierarchy
     }
 }
 
@@ -310,6 +321,7 @@ void LLJoint::removeAllChildren()
         }
     }
     mChildren.clear();
+    touchHierarchy(); // <FS/> Flattened joint hierarchy
 }
 
 
@@ -965,6 +977,14 @@ void LLJoint::updateWorldPRSParent()
 //-----------------------------------------------------------------------------
 void LLJoint::updateWorldMatrixChildren()
 {
+    // <FS> Flattened joint hierarchy
+    if (mHierarchy)
+    {
+        mHierarchy->updateWorldMatrixChildren();
+        return;
+    }
+    // </FS>
+
     if (!this->mUpdateXform) return;
 
     if (mDirtyFlags & MATRIX_DIRTY)
@@ -991,6 +1011,40 @@ void LLJoint::updateWorldMatrix()
     }
 }
 
+// <FS> Flattened joint hierarchy
+//-----------------------------------------------------------------------------
+// setFlatHierarchy()
+//-----------------------------------------------------------------------------
+void LLJoint::setFlatHierarchy(bool enable)
+{
+    if (enable && !mHierarchy)
+    {
+        mHierarchy = new LLJointHierarchy(this);
+    }
+    else if (!enable && mHierarchy)
+    {
+        delete mHierarchy;
+        mHierarchy = nullptr;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// touchHierarchy()
+// Only the flattened copies this joint is part of need to rebuild, so walk
+// up to the root rather than invalidating every skeleton.
+//-----------------------------------------------------------------------------
+void LLJoint::touchHierarchy()
+{
+    for (LLJoint* joint = this; joint; joint = joint->mParent)
+    {
+        if (joint->mHierarchy)
+        {
+            ++joint->mHierarchy->mTreeSerial;
+        }
+    }
+}
+// </FS>
+
 //--------------------------------------------------------------------
 // getSkinOffset()
 //--------------------------------------------------------------------
@@ -1030,3 +1084,162 @@ void LLJoint::clampRotation(LLQuaternion old_rot, LLQuaternion new_rot)
 
 // End
 
+// <FS> Flattened joint hierarchy
+//-----------------------------------------------------------------------------
+// LLJointHierarchy()
+//-----------------------------------------------------------------------------
+LLJointHierarchy::LLJointHierarchy(LLJoint* root)
+:   mRoot(root),
+    mTreeSerial(1),
+    mSerial(0) // built on first use
+{
+}
+
+//-----------------------------------------------------------------------------
+// rebuild()
+// Lays the subtree out again after joints were added to or removed from it.
+//-----------------------------------------------------------------------------
+void LLJointHierarchy::rebuild()
+{
+    mSerial = mTreeSerial;
+
+    mJoints.clear();
+    mParents.clear();
+    mSubtreeEnds.clear();
+    addSubtree(mRoot, -1);
+
+    const U32 count = static_cast<U32>(mJoints.size());
+    mLocalRotations.assign(count, LLQuaternion::DEFAULT);
+    mFresh.assign(count, 0);
+    mLocal.resize(count);
+    mWorld.resize(count);
+    for (U32 i = 0; i < count; i++)
+    {
+        // matches the identity in mLocalRotations
+        mLocal.mArray[i] = LLMatrix4a::identity();
+        mWorld.mArray[i] = LLMatrix4a::identity();
+    }
+}
+
+//-----------------------------------------------------------------------------
+// addSubtree()
+//-----------------------------------------------------------------------------
+void LLJointHierarchy::addSubtree(LLJoint* joint, S32 parent)
+{
+    const U32 index = static_cast<U32>(mJoints.size());
+    mJoints.push_back(joint);
+    // joints whose xform hangs off something other than their parent joint,
+    // like a root parented to the object it sits on, update the usual way
+    if (parent >= 0 && joint->mXform.getParent() == &mJoints[parent]->mXform)
+    {
+        mParents.push_back(parent);
+    }
+    else
+    {
+        mParents.push_back(-1);
+    }
+    mSubtreeEnds.push_back(index + 1);
+
+    for (LLJoint* child : joint->mChildren)
+    {
+        if (child)
+        {
+            addSubtree(child, index);
+        }
+    }
+    mSubtreeEnds[index] = static_cast<U32>(mJoints.size());
+}
+
+//-----------------------------------------------------------------------------
+// updateWorldMatrixChildren()
+//-----------------------------------------------------------------------------
+void LLJointHierarchy::updateWorldMatrixChildren()
+{
+    if (mSerial != mTreeSerial)
+    {
+        rebuild();
+    }
+
+    std::fill(mFresh.begin(), mFresh.end(), 0);
+
+    const U32 count = static_cast<U32>(mJoints.size());
+    U32 i = 0;
+    while (i < count)
+    {
+        LLJoint* joint = mJoints[i];
+        if (!joint->mUpdateXform)
+        {
+            // skip the whole subtree, as the recursive walk does
+            i = mSubtreeEnds[i];
+            continue;
+        }
+
+        if (joint->mDirtyFlags & LLJoint::MATRIX_DIRTY)
+        {
+            if (mParents[i] < 0)
+            {
+                joint->updateWorldMatrix();
+            }
+            else
+            {
+                updateJoint(i, mParents[i]);
+            }
+        }
+        ++i;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// updateJoint()
+// LLXformMatrix::updateMatrix() as a product of unscaled transforms:
+// world = local * parent world, where local holds the joint's rotation and
+// its position scaled by the parent's scale. The joint's own scale is then
+// applied to the rows, as LLMatrix4::initAll() does.
+//-----------------------------------------------------------------------------
+void LLJointHierarchy::updateJoint(U32 index, U32 parent)
+{
+    LLJoint* joint = mJoints[index];
+    LLXformMatrix& xform = joint->mXform;
+    const LLXformMatrix& parent_xform = mJoints[parent]->mXform;
+
+    LLMatrix4a& parent_world = mWorld.mArray[parent];
+    if (!mFresh[parent])
+    {
+        // parent was up to date already or got updated through the lazy
+        // accessors, either way its xform holds its world transform
+        parent_world.loadu(LLMatrix4(parent_xform.getWorldRotation(), LLVector4(parent_xform.getWorldPosition())));
+        mFresh[parent] = 1;
+    }
+
+    LLMatrix4a& local = mLocal.mArray[index];
+    const LLQuaternion& rot = xform.getRotation();
+    if (rot != mLocalRotations[index])
+    {
+        local.loadu(LLMatrix4(rot));
+        mLocalRotations[index] = rot;
+    }
+    LLVector3 offset = xform.getPosition();
+    if (parent_xform.getScaleChildOffset())
+    {
+        offset.scaleVec(parent_xform.getScale());
+    }
+    local.mMatrix[3].set(offset.mV[VX], offset.mV[VY], offset.mV[VZ], 1.f);
+
+    LLMatrix4a& world = mWorld.mArray[index];
+    matMulUnsafe(local, parent_world, world);
+    mFresh[index] = 1;
+
+    const LLVector3& scale = xform.getScale();
+    LLMatrix4a& world_matrix = joint->mWorldMatrix;
+    world_matrix.mMatrix[0].setMul(world.mMatrix[0], scale.mV[VX]);
+    world_matrix.mMatrix[1].setMul(world.mMatrix[1], scale.mV[VY]);
+    world_matrix.mMatrix[2].setMul(world.mMatrix[2], scale.mV[VZ]);
+    world_matrix.mMatrix[3] = world.mMatrix[3];
+
+    xform.setWorldTransform(LLVector3(world.mMatrix[3].getF32ptr()),
+                            rot * parent_xform.getWorldRotation(),
+                            LLMatrix4(world_matrix.getF32ptr()));
+    joint->mDirtyFlags = 0x0;
+    LLJoint::sNumUpdates++;
+}
+// </FS>
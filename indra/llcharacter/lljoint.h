@@ -39,6 +39,7 @@
 #include "llquaternion.h"
 #include "xform.h"
 #include "llmatrix4a.h"
+#include "llalignedarray.h" // <FS/> Flattened joint hierarchy
 
 constexpr S32 LL_CHARACTER_MAX_JOINTS_PER_MESH = 15;
 // Need to set this to count of animate-able joints,
@@ -83,6 +84,8 @@ inline bool operator!=(const LLVector3OverrideMap& a, const LLVector3OverrideMap
     return !(a == b);
 }
 
+class LLJointHierarchy; // <FS/> Flattened joint hierarchy
+
 //-----------------------------------------------------------------------------
 // class LLJoint
 //-----------------------------------------------------------------------------
@@ -90,6 +93,7 @@ LL_ALIGN_PREFIX(16)
 class LLJoint
 {
     LL_ALIGN_NEW
+    friend class LLJointHierarchy; // <FS/> Flattened joint hierarchy
 public:
     // priority levels, from highest to lowest
     enum JointPriority
@@ -149,8 +153,12 @@ public:
     joints_t mChildren;
 
     // debug statics
-    static S32      sNumTouches;
-    static S32      sNumUpdates;
+    // <FS> Parallel avatar animation: per thread, skeletons update on workers
+    //static S32      sNumTouches;
+    //static S32      sNumUpdates;
+    static thread_local S32 sNumTouches;
+    static thread_local S32 sNumUpdates;
+    // </FS>
     typedef std::set<std::string> debug_joint_name_t;
     static debug_joint_name_t s_debugJointNames;
     static void setDebugJointNames(const debug_joint_name_t& names);
@@ -272,6 +280,13 @@ public:
 
     void updateWorldMatrix();
 
+    // <FS> Flattened joint hierarchy
+    // Have updateWorldMatrixChildren() on this joint walk a flattened copy
+    // of its subtree instead of recursing. Meant for skeleton roots.
+    void setFlatHierarchy(bool enable);
+    bool hasFlatHierarchy() const { return mHierarchy != nullptr; }
+    // </FS>
+
     // get/set skin offset
     const LLVector3 &getSkinOffset();
     void setSkinOffset( const LLVector3 &offset);
@@ -302,6 +317,51 @@ public:
     // These are used in checks of whether a pos/scale override is considered significant.
     bool aboveJointPosThreshold(const LLVector3& pos) const;
     bool aboveJointScaleThreshold(const LLVector3& scale) const;
+
+    // <FS> Flattened joint hierarchy
+private:
+    LLJointHierarchy* mHierarchy = nullptr; // owned, see setFlatHierarchy()
+
+    // Called whenever this joint gains or loses a child, so the flattened
+    // copies on this joint and its ancestors know to rebuild
+    void touchHierarchy();
+    // </FS>
 } LL_ALIGN_POSTFIX(16);
+
+// <FS> Flattened joint hierarchy
+//-----------------------------------------------------------------------------
+// class LLJointHierarchy
+// A joint subtree laid out parent before child in contiguous arrays, so that
+// updating its world matrices is one linear pass of LLMatrix4a products
+// instead of a recursion over scattered joints. The joints keep owning their
+// transforms: the pass stores the same world position, rotation and matrices
+// LLJoint::updateWorldMatrix() would have, and the accessors read those.
+//-----------------------------------------------------------------------------
+class LLJointHierarchy
+{
+    friend class LLJoint; // bumps mTreeSerial
+public:
+    LLJointHierarchy(LLJoint* root);
+
+    // Same result as LLJoint::updateWorldMatrixChildren() on the root
+    void updateWorldMatrixChildren();
+
+private:
+    void rebuild();
+    void addSubtree(LLJoint* joint, S32 parent);
+    void updateJoint(U32 index, U32 parent);
+
+    LLJoint*                        mRoot;
+    U32                             mTreeSerial;     // bumped by LLJoint::touchHierarchy()
+    U32                             mSerial;         // mTreeSerial the arrays were built at
+    std::vector<LLJoint*>           mJoints;
+    std::vector<S32>                mParents;        // index in mJoints, -1 if the joint updates itself
+    std::vector<U32>                mSubtreeEnds;    // one past the joint's last descendant
+    std::vector<LLQuaternion>       mLocalRotations; // rotation the rows of mLocal were built from
+    std::vector<U8>                 mFresh;          // mWorld entry computed during this pass
+    LLAlignedArray<LLMatrix4a, 64>  mLocal;          // unscaled local transforms
+    LLAlignedArray<LLMatrix4a, 64>  mWorld;          // unscaled world transforms
+};
+// </FS>
 #endif // LL_LLJOINT_H
 
@@ -123,6 +123,112 @@ U32 LLKeyframeMotion::JointMotionList::dumpDiagInfo()
     return total_size;
 }
 
+// <FS> Flat keyframe sampling
+//-----------------------------------------------------------------------------
+// compile_curve_times()
+// Appends a curve's key times and tells whether they are evenly spaced, which
+// lets the sampler guess the right key without searching.
+//-----------------------------------------------------------------------------
+template <class KEY_MAP>
+static void compile_curve_times(const KEY_MAP& keys, LLKeyframeMotion::InterpolationType interpolation,
+                                LLKeyframeMotion::CompiledCurve& curve, std::vector<F32>& times)
+{
+    curve = LLKeyframeMotion::CompiledCurve();
+    curve.mFirstKey = static_cast<U32>(times.size());
+    curve.mNumKeys = static_cast<U32>(keys.size());
+    curve.mInterpolationType = interpolation;
+    if (keys.empty())
+    {
+        return;
+    }
+
+    for (const auto& key : keys)
+    {
+        times.push_back(key.first);
+    }
+    const F32* key_times = &times[curve.mFirstKey];
+    curve.mStartTime = key_times[0];
+
+    if (curve.mNumKeys < 2)
+    {
+        return;
+    }
+
+    // keys come from U16 quantized times, so allow some slack; the sampler
+    // corrects the guess anyway
+    const F32 step = (key_times[curve.mNumKeys - 1] - curve.mStartTime) / (F32)(curve.mNumKeys - 1);
+    if (step <= 0.f)
+    {
+        return;
+    }
+    for (U32 i = 1; i < curve.mNumKeys - 1; i++)
+    {
+        if (fabsf(key_times[i] - (curve.mStartTime + step * (F32)i)) > step * 0.25f)
+        {
+            return;
+        }
+    }
+    curve.mInvStep = 1.f / step;
+}
+
+//-----------------------------------------------------------------------------
+// compileKeys()
+//-----------------------------------------------------------------------------
+void LLKeyframeMotion::JointMotionList::compileKeys()
+{
+    mCompiledJoints.clear();
+    mScaleTimes.clear();
+    mRotationTimes.clear();
+    mPositionTimes.clear();
+    mScaleValues.resize(0);
+    mRotationValues.resize(0);
+    mPositionValues.resize(0);
+    mRotationSlerp.clear();
+
+    mCompiledJoints.resize(getNumJointMotions());
+    for (U32 i = 0; i < getNumJointMotions(); i++)
+    {
+        const JointMotion* joint_motion = mJointMotionArray[i];
+        CompiledJointMotion& compiled = mCompiledJoints[i];
+
+        compile_curve_times(joint_motion->mScaleCurve.mKeys, joint_motion->mScaleCurve.mInterpolationType,
+                            compiled.mScale, mScaleTimes);
+        for (const auto& key : joint_motion->mScaleCurve.mKeys)
+        {
+            LLVector4a scale;
+            scale.load3(key.second.mScale.mV);
+            mScaleValues.push_back(scale);
+        }
+
+        compile_curve_times(joint_motion->mRotationCurve.mKeys, joint_motion->mRotationCurve.mInterpolationType,
+                            compiled.mRotation, mRotationTimes);
+        const LLQuaternion* prev_rot = nullptr;
+        for (const auto& key : joint_motion->mRotationCurve.mKeys)
+        {
+            if (prev_rot)
+            {
+                // nlerp() falls back to slerp() for these, and so must we
+                mRotationSlerp.back() = dot(*prev_rot, key.second.mRotation) < 0.f ? 1 : 0;
+            }
+            mRotationSlerp.push_back(0);
+            mRotationValues.push_back(LLQuaternion2(key.second.mRotation));
+            prev_rot = &key.second.mRotation;
+        }
+
+        compile_curve_times(joint_motion->mPositionCurve.mKeys, joint_motion->mPositionCurve.mInterpolationType,
+                            compiled.mPosition, mPositionTimes);
+        for (const auto& key : joint_motion->mPositionCurve.mKeys)
+        {
+            LLVector4a position;
+            position.load3(key.second.mPosition.mV);
+            mPositionValues.push_back(position);
+        }
+    }
+
+    mCompiled = true;
+}
+// </FS>
+
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 // ****Curve classes
@@ -738,6 +844,13 @@ bool LLKeyframeMotion::onUpdate(F32 time, U8* joint_mask)
 void LLKeyframeMotion::applyKeyframes(F32 time)
 {
     llassert_always (mJointMotionList->getNumJointMotions() <= mJointStates.size());
+    // <FS> Flat keyframe sampling
+    if (mJointMotionList->isCompiled())
+    {
+        sampleKeyframes(time);
+    }
+    else
+    // </FS>
     for (U32 i=0; i<mJointMotionList->getNumJointMotions(); i++)
     {
         mJointMotionList->getJointMotion(i)->update(mJointStates[i],
@@ -761,6 +874,177 @@ void LLKeyframeMotion::applyKeyframes(F32 time)
     }
 }
 
+// <FS> Flat keyframe sampling
+//-----------------------------------------------------------------------------
+// find_compiled_key()
+// Returns the index of the first key at or after time, i.e. what lower_bound()
+// finds in the curve's key map. Starts from the even spacing estimate, or from
+// the key found last frame, and walks to the answer from there.
+//-----------------------------------------------------------------------------
+static inline U32 find_compiled_key(const LLKeyframeMotion::CompiledCurve& curve, const F32* key_times, F32 time, U32& cursor)
+{
+    U32 right;
+    if (curve.mInvStep > 0.f)
+    {
+        right = (U32)llclamp(ceilf((time - curve.mStartTime) * curve.mInvStep), 0.f, (F32)curve.mNumKeys);
+    }
+    else
+    {
+        right = llmin(cursor, curve.mNumKeys);
+    }
+
+    while (right > 0 && key_times[right - 1] >= time)
+    {
+        --right;
+    }
+    while (right < curve.mNumKeys && key_times[right] < time)
+    {
+        ++right;
+    }
+
+    cursor = right;
+    return right;
+}
+
+//-----------------------------------------------------------------------------
+// sample_compiled_vector()
+// Same result as ScaleCurve::getValue() and PositionCurve::getValue()
+//-----------------------------------------------------------------------------
+static inline void sample_compiled_vector(const LLKeyframeMotion::CompiledCurve& curve, const F32* times,
+                                          const LLVector4a* values, F32 time, U32& cursor, LLVector4a& value)
+{
+    const F32* key_times = times + curve.mFirstKey;
+    const LLVector4a* keys = values + curve.mFirstKey;
+    const U32 right = find_compiled_key(curve, key_times, time, cursor);
+
+    if (right == curve.mNumKeys)
+    {
+        // Past last key
+        value = keys[right - 1];
+    }
+    else if (right == 0 || key_times[right] == time)
+    {
+        // Before first key or exactly on a key
+        value = keys[right];
+    }
+    else if (curve.mInterpolationType == LLKeyframeMotion::IT_STEP)
+    {
+        value = keys[right - 1];
+    }
+    else
+    {
+        const F32 u = (time - key_times[right - 1]) / (key_times[right] - key_times[right - 1]);
+        value.setLerp(keys[right - 1], keys[right], u);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// sample_compiled_rotation()
+// Same result as RotationCurve::getValue()
+//-----------------------------------------------------------------------------
+static inline void sample_compiled_rotation(const LLKeyframeMotion::CompiledCurve& curve, const F32* times,
+                                            const LLQuaternion2* values, const U8* slerp, F32 time, U32& cursor,
+                                            LLQuaternion& value)
+{
+    const F32* key_times = times + curve.mFirstKey;
+    const LLQuaternion2* keys = values + curve.mFirstKey;
+    const U32 right = find_compiled_key(curve, key_times, time, cursor);
+
+    LLQuaternion2 rot;
+    if (right == curve.mNumKeys)
+    {
+        // Past last key
+        rot = keys[right - 1];
+    }
+    else if (right == 0 || key_times[right] == time)
+    {
+        // Before first key or exactly on a key
+        rot = keys[right];
+    }
+    else if (curve.mInterpolationType == LLKeyframeMotion::IT_STEP)
+    {
+        rot = keys[right - 1];
+    }
+    else
+    {
+        const F32 u = (time - key_times[right - 1]) / (key_times[right] - key_times[right - 1]);
+        if (slerp[curve.mFirstKey + right - 1])
+        {
+            value = nlerp(u, LLQuaternion(keys[right - 1].getVector4a().getF32ptr()),
+                             LLQuaternion(keys[right].getVector4a().getF32ptr()));
+            return;
+        }
+        // both keys in the same hemisphere, so the lerp can't come near zero length
+        rot.getVector4aRw().setLerp(keys[right - 1].getVector4a(), keys[right].getVector4a(), u);
+        rot.normalize();
+    }
+
+    const F32* q = rot.getVector4a().getF32ptr();
+    value.mQ[VX] = q[VX];
+    value.mQ[VY] = q[VY];
+    value.mQ[VZ] = q[VZ];
+    value.mQ[VW] = q[VW];
+}
+
+//-----------------------------------------------------------------------------
+// sampleKeyframes()
+// applyKeyframes() over the flat key arrays: one pass over all joints, SIMD
+// interpolation and no key map lookups.
+//-----------------------------------------------------------------------------
+void LLKeyframeMotion::sampleKeyframes(F32 time)
+{
+    const JointMotionList* list = mJointMotionList;
+    const U32 num_joints = list->getNumJointMotions();
+    if (mKeyCursors.size() != num_joints * 3)
+    {
+        mKeyCursors.assign(num_joints * 3, 0);
+    }
+
+    const F32* scale_times = list->mScaleTimes.data();
+    const F32* rotation_times = list->mRotationTimes.data();
+    const F32* position_times = list->mPositionTimes.data();
+    const LLVector4a* scale_values = list->mScaleValues.mArray;
+    const LLQuaternion2* rotation_values = list->mRotationValues.mArray;
+    const LLVector4a* position_values = list->mPositionValues.mArray;
+    const U8* rotation_slerp = list->mRotationSlerp.data();
+
+    LLVector4a vec;
+    LLQuaternion rot;
+    for (U32 i = 0; i < num_joints; i++)
+    {
+        LLJointState* joint_state = mJointStates[i];
+        if (!joint_state)
+        {
+            continue;
+        }
+
+        const CompiledJointMotion& joint_motion = list->mCompiledJoints[i];
+        U32* cursors = &mKeyCursors[i * 3];
+        const U32 usage = joint_state->getUsage();
+
+        if ((usage & LLJointState::SCALE) && joint_motion.mScale.mNumKeys)
+        {
+            sample_compiled_vector(joint_motion.mScale, scale_times, scale_values, time, cursors[0], vec);
+            joint_state->setScale(LLVector3(vec.getF32ptr()));
+        }
+
+        if ((usage & LLJointState::ROT) && joint_motion.mRotation.mNumKeys)
+        {
+            sample_compiled_rotation(joint_motion.mRotation, rotation_times, rotation_values, rotation_slerp,
+                                     time, cursors[1], rot);
+            joint_state->setRotation(rot);
+        }
+
+        if ((usage & LLJointState::POS) && joint_motion.mPosition.mNumKeys)
+        {
+            sample_compiled_vector(joint_motion.mPosition, position_times, position_values, time, cursors[2], vec);
+            llassert(vec.isFinite3());
+            joint_state->setPosition(LLVector3(vec.getF32ptr()));
+        }
+    }
+}
+// </FS>
+
 //-----------------------------------------------------------------------------
 // applyConstraints()
 //-----------------------------------------------------------------------------
@@ -2032,6 +2316,8 @@ bool LLKeyframeMotion::deserialize(LLDataPacker& dp, const LLUUID& asset_id, boo
         }
     }
 
+    joint_motion_list->compileKeys(); // <FS/> Flat keyframe sampling
+
     // *FIX: support cleanup of old keyframe data
     mJointMotionList = joint_motion_list.release(); // release from unique_ptr to member;
     LLKeyframeDataCache::addKeyframeData(getID(),  mJointMotionList);
@@ -42,6 +42,11 @@
 #include "v3dmath.h"
 #include "v3math.h"
 #include "llbvhconsts.h"
+// <FS> Flat keyframe sampling
+#include "llmath.h"
+#include "llsimdmath.h"
+#include "llalignedarray.h"
+// </FS>
 
 class LLKeyframeDataCache;
 class LLDataPacker;
@@ -261,6 +266,8 @@ protected:
 
     void applyKeyframes(F32 time);
 
+    void sampleKeyframes(F32 time); // <FS/> Flat keyframe sampling
+
     void applyConstraints(F32 time, U8* joint_mask);
 
     void activateConstraint(JointConstraint* constraintp);
@@ -390,6 +397,35 @@ public:
         void update(LLJointState* joint_state, F32 time, F32 duration);
     };
 
+    // <FS> Flat keyframe sampling
+    //-------------------------------------------------------------------------
+    // CompiledCurve
+    // Where one curve's keys live in the flat arrays of its JointMotionList
+    //-------------------------------------------------------------------------
+    class CompiledCurve
+    {
+    public:
+        CompiledCurve() : mFirstKey(0), mNumKeys(0), mStartTime(0.f), mInvStep(0.f), mInterpolationType(IT_LINEAR) {}
+
+        U32                 mFirstKey;
+        U32                 mNumKeys;
+        F32                 mStartTime;
+        F32                 mInvStep;   // 1 / key spacing if the keys are evenly spaced, 0 otherwise
+        InterpolationType   mInterpolationType;
+    };
+
+    //-------------------------------------------------------------------------
+    // CompiledJointMotion
+    //-------------------------------------------------------------------------
+    class CompiledJointMotion
+    {
+    public:
+        CompiledCurve   mScale;
+        CompiledCurve   mRotation;
+        CompiledCurve   mPosition;
+    };
+    // </FS>
+
     //-------------------------------------------------------------------------
     // JointMotionList
     //-------------------------------------------------------------------------
@@ -415,12 +451,30 @@ public:
         std::string             mEmoteName;
         LLUUID                  mEmoteID;
 
+        // <FS> Flat keyframe sampling
+        // Copy of every curve's keys made by compileKeys(), one time array and
+        // one value array per channel, so applyKeyframes() never walks the maps.
+        std::vector<CompiledJointMotion>    mCompiledJoints;
+        std::vector<F32>                    mScaleTimes;
+        std::vector<F32>                    mRotationTimes;
+        std::vector<F32>                    mPositionTimes;
+        LLAlignedArray<LLVector4a, 16>      mScaleValues;
+        LLAlignedArray<LLQuaternion2, 16>   mRotationValues;
+        LLAlignedArray<LLVector4a, 16>      mPositionValues;
+        std::vector<U8>                     mRotationSlerp; // key i and i+1 are in opposite hemispheres, see nlerp()
+        bool                                mCompiled = false;
+        // </FS>
+
     public:
         JointMotionList();
         ~JointMotionList();
         U32 dumpDiagInfo();
         JointMotion* getJointMotion(U32 index) const { llassert(index < mJointMotionArray.size()); return mJointMotionArray[index]; }
         U32 getNumJointMotions() const { return static_cast<U32>(mJointMotionArray.size()); }
+        // <FS> Flat keyframe sampling
+        void compileKeys(); // call again whenever the curves' keys change
+        bool isCompiled() const { return mCompiled; }
+        // </FS>
     };
 
 protected:
@@ -434,6 +488,12 @@ protected:
     F32                             mLastUpdateTime;
     F32                             mLastLoopedTime;
     AssetStatus                     mAssetStatus;
+    // <FS> Flat keyframe sampling
+    // Key found for each joint's scale, rotation and position last frame. Kept
+    // here rather than in the shared JointMotionList, which other avatars
+    // sample at the same time.
+    std::vector<U32>                mKeyCursors;
+    // </FS>
 
 public:
     void setCharacter(LLCharacter* character) { mCharacter = character; }
@@ -141,6 +141,7 @@ LLMotionController::LLMotionController()
       mTimeStepCount(0),
       mLastInterp(0.f),
       mIsSelf(false),
+      mDeferSharedUpdates(false), // <FS/> Parallel avatar animation
       mLastCountAfterPurge(0)
 {
 }
@@ -510,7 +511,8 @@ void LLMotionController::updateIdleMotion(LLMotion* motionp)
     LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
     if (motionp->isStopped() && mAnimTime > motionp->getStopTime() + motionp->getEaseOutDuration())
     {
-        deactivateMotionInstance(motionp);
+        //deactivateMotionInstance(motionp);
+        retireMotionInstance(motionp); // <FS/> Parallel avatar animation
     }
     else if (motionp->isStopped() && mAnimTime > motionp->getStopTime())
     {
@@ -527,7 +529,8 @@ void LLMotionController::updateIdleMotion(LLMotion* motionp)
         // this will only be called when an animation stops itself (runs out of time)
         if (mLastTime <= motionp->mSendStopTimestamp)
         {
-            mCharacter->requestStopMotion( motionp );
+            //mCharacter->requestStopMotion( motionp );
+            requestStopMotion(motionp); // <FS/> Parallel avatar animation
             stopMotionInstance(motionp, false);
         }
     }
@@ -629,7 +632,8 @@ void LLMotionController::updateMotionsByType(LLMotion::LLMotionBlendType anim_ty
                 // this will only be called when an animation stops itself (runs out of time)
                 if (mLastTime <= motionp->mSendStopTimestamp)
                 {
-                    mCharacter->requestStopMotion( motionp );
+                    //mCharacter->requestStopMotion( motionp );
+                    requestStopMotion(motionp); // <FS/> Parallel avatar animation
                     stopMotionInstance(motionp, false);
                 }
             }
@@ -639,7 +643,8 @@ void LLMotionController::updateMotionsByType(LLMotion::LLMotionBlendType anim_ty
                 if (motionp->isStopped() && mAnimTime > motionp->getStopTime() + motionp->getEaseOutDuration())
                 {
                     posep->setWeight(0.f);
-                    deactivateMotionInstance(motionp);
+                    //deactivateMotionInstance(motionp);
+                    retireMotionInstance(motionp); // <FS/> Parallel avatar animation
                 }
                 continue;
             }
@@ -666,7 +671,8 @@ void LLMotionController::updateMotionsByType(LLMotion::LLMotionBlendType anim_ty
             else
             {
                 posep->setWeight(0.f);
-                deactivateMotionInstance(motionp);
+                //deactivateMotionInstance(motionp);
+                retireMotionInstance(motionp); // <FS/> Parallel avatar animation
                 continue;
             }
         }
@@ -710,7 +716,8 @@ void LLMotionController::updateMotionsByType(LLMotion::LLMotionBlendType anim_ty
                 // this will only be called when an animation stops itself (runs out of time)
                 if (mLastTime <= motionp->mSendStopTimestamp)
                 {
-                    mCharacter->requestStopMotion( motionp );
+                    //mCharacter->requestStopMotion( motionp );
+                    requestStopMotion(motionp); // <FS/> Parallel avatar animation
                     stopMotionInstance(motionp, false);
                 }
             }
@@ -756,7 +763,8 @@ void LLMotionController::updateMotionsByType(LLMotion::LLMotionBlendType anim_ty
                 // animation has stopped itself due to internal logic
                 // propagate this to the network
                 // as not all viewers are guaranteed to have access to the same logic
-                mCharacter->requestStopMotion( motionp );
+                //mCharacter->requestStopMotion( motionp );
+                requestStopMotion(motionp); // <FS/> Parallel avatar animation
                 stopMotionInstance(motionp, false);
             }
 
@@ -821,6 +829,21 @@ void LLMotionController::updateLoadingMotions()
 void LLMotionController::updateMotions(bool force_update)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
+    // <FS> Parallel avatar animation
+    if (prepareMotions())
+    {
+        evaluateMotions(force_update, false);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// prepareMotions()
+// Advances the animation clock and moves loaded motions to the active list.
+//-----------------------------------------------------------------------------
+bool LLMotionController::prepareMotions()
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
+    // </FS>
     // SL-763: "Distant animated objects run at super fast speed"
     // The use_quantum optimization or possibly the associated code in setTimeStamp()
     // does not work as implemented.
@@ -861,7 +884,8 @@ void LLMotionController::updateMotions(bool force_update)
 
                 updateLoadingMotions();
 
-                return;
+                //return;
+                return false; // <FS/> Parallel avatar animation
             }
 
             // is calculating a new keyframe pose, make sure the last one gets applied
@@ -880,6 +904,21 @@ void LLMotionController::updateMotions(bool force_update)
 
     updateLoadingMotions();
 
+    // <FS> Parallel avatar animation
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// evaluateMotions()
+// Runs the active motions and blends them into the skeleton.
+//-----------------------------------------------------------------------------
+void LLMotionController::evaluateMotions(bool force_update, bool defer_shared)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
+    bool use_quantum = (mTimeStep != 0.f);
+    mDeferSharedUpdates = defer_shared;
+    // </FS>
+
     resetJointSignatures();
 
     if (mPaused && !force_update)
@@ -907,9 +946,66 @@ void LLMotionController::updateMotions(bool force_update)
     }
 
     mHasRunOnce = true;
+    mDeferSharedUpdates = false; // <FS/> Parallel avatar animation
 //  LL_INFOS() << "Motion controller time " << motionTimer.getElapsedTimeF32() << LL_ENDL;
 }
 
+// <FS> Parallel avatar animation
+//-----------------------------------------------------------------------------
+// flushDeferredMotions()
+// Main thread half of evaluateMotions() with defer_shared set.
+//-----------------------------------------------------------------------------
+void LLMotionController::flushDeferredMotions()
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
+    for (const auto& [motionp, deactivate] : mDeferredMotions)
+    {
+        if (!deactivate)
+        {
+            mCharacter->requestStopMotion(motionp);
+        }
+        else if (isMotionActive(motionp))
+        {
+            deactivateMotionInstance(motionp);
+        }
+    }
+    mDeferredMotions.clear();
+}
+
+//-----------------------------------------------------------------------------
+// requestStopMotion()
+// The character may forward the request to the simulator.
+//-----------------------------------------------------------------------------
+void LLMotionController::requestStopMotion(LLMotion* motion)
+{
+    if (mDeferSharedUpdates)
+    {
+        mDeferredMotions.emplace_back(motion, false);
+    }
+    else
+    {
+        mCharacter->requestStopMotion(motion);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// retireMotionInstance()
+// Deactivation runs the motion's callbacks and may delete it, keep both off
+// the worker threads.
+//-----------------------------------------------------------------------------
+void LLMotionController::retireMotionInstance(LLMotion* motion)
+{
+    if (mDeferSharedUpdates)
+    {
+        mDeferredMotions.emplace_back(motion, true);
+    }
+    else
+    {
+        deactivateMotionInstance(motion);
+    }
+}
+// </FS>
+
 //-----------------------------------------------------------------------------
 // updateMotionsMinimal()
 // minimal update (e.g. while hidden)
@@ -33,6 +33,7 @@
 #include <string>
 #include <map>
 #include <deque>
+#include <vector> // <FS/> Parallel avatar animation
 
 #include "llmotion.h"
 #include "llpose.h"
@@ -132,6 +133,19 @@ public:
     // deactivates terminated motions`
     void updateMotions(bool force_update = false);
 
+    // <FS> Parallel avatar animation
+    // updateMotions() in three steps for callers that evaluate several
+    // characters at once. prepareMotions() and flushDeferredMotions() must
+    // run on the main thread. evaluateMotions() only touches this character,
+    // so different controllers may be evaluated concurrently; with
+    // defer_shared set, stop requests and deactivations are queued until
+    // flushDeferredMotions(). prepareMotions() returns false if there is
+    // nothing to evaluate this frame.
+    bool prepareMotions();
+    void evaluateMotions(bool force_update, bool defer_shared);
+    void flushDeferredMotions();
+    // </FS>
+
     // minimal update (e.g. while hidden)
     void updateMotionsMinimal();
 
@@ -194,6 +208,10 @@ protected:
     void updateIdleActiveMotions();
     void purgeExcessMotions();
     void deactivateStoppedMotions();
+    // <FS> Parallel avatar animation
+    void requestStopMotion(LLMotion* motion);
+    void retireMotionInstance(LLMotion* motion);
+    // </FS>
 
 protected:
     F32                 mTimeFactor;            // 1.f for normal speed
@@ -232,6 +250,13 @@ protected:
     F32                 mLastInterp;
 
     U8                  mJointSignature[2][LL_CHARACTER_MAX_ANIMATED_JOINTS];
+
+    // <FS> Parallel avatar animation
+    // Work queued by evaluateMotions(), true for a deactivation and false
+    // for a stop request to the character
+    bool                mDeferSharedUpdates;
+    std::vector<std::pair<LLMotion*, bool> > mDeferredMotions;
+    // </FS>
 private:
     U32                 mLastCountAfterPurge; //for logging and debugging purposes
 };
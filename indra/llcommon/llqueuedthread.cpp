@@ -306,6 +306,29 @@ LLQueuedThread::QueuedRequest* LLQueuedThread::getRequest(handle_t handle)
     return res;
 }
 
+// <FS> Async I/O continuation
+void LLQueuedThread::waitForWake(handle_t handle)
+{
+    QueuedRequest* req = getRequest(handle);
+    if (req)
+    {
+        req->waitForWake();
+    }
+}
+
+void LLQueuedThread::wakeRequest(handle_t handle)
+{
+    lockData();
+    QueuedRequest* req = (QueuedRequest*)mRequestHash.find(handle);
+    if (req && req->mWaitState.exchange(QueuedRequest::WAIT_WOKEN) == QueuedRequest::WAIT_PARKED)
+    {
+        req->mWaitState = QueuedRequest::WAIT_NONE;
+        mRequestQueue.post([this, req]() { processRequest(req); });
+    }
+    unlockData();
+}
+// </FS>
+
 LLQueuedThread::status_t LLQueuedThread::getRequestStatus(handle_t handle)
 {
     status_t res = STATUS_EXPIRED;
@@ -473,6 +496,25 @@ void LLQueuedThread::processRequest(LLQueuedThread::QueuedRequest* req)
                 lockData();
                 req->setStatus(STATUS_QUEUED);
 
+                // <FS> Async I/O continuation
+                U32 wait_state = QueuedRequest::WAIT_ARMED;
+                if (req->mWaitState.compare_exchange_strong(wait_state, QueuedRequest::WAIT_PARKED))
+                {
+                    // wakeRequest() requeues it
+                    unlockData();
+                    mIdleThread = true;
+                    return;
+                }
+                if (wait_state == QueuedRequest::WAIT_WOKEN)
+                {
+                    // Finished before we got here, no need to back off
+                    req->mWaitState = QueuedRequest::WAIT_NONE;
+                    mRequestQueue.post([this, req]() { processRequest(req); });
+                    unlockData();
+                    mIdleThread = true;
+                    return;
+                }
+                // </FS>
                 unlockData();
 
                 llassert(!mDataLock->isSelfLocked());
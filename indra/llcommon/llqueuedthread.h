@@ -101,6 +101,15 @@ public:
         {
             mDeferUntil = time;
         }
+        // <FS> Async I/O continuation
+        // Call from processRequest() before starting an operation that ends
+        // with LLQueuedThread::wakeRequest(), then return false: the request
+        // is parked until woken instead of being retried on a timer.
+        void waitForWake()
+        {
+            mWaitState = WAIT_ARMED;
+        }
+        // </FS>
 
         virtual bool processRequest() = 0; // Return true when request has completed
         virtual void finishRequest(bool completed); // Always called from thread after request has completed or aborted
@@ -110,6 +119,10 @@ public:
         LLAtomicBase<status_t> mStatus;
         U32 mFlags;
         std::chrono::steady_clock::time_point mDeferUntil;
+        // <FS> Async I/O continuation
+        enum wait_state_t { WAIT_NONE, WAIT_ARMED, WAIT_PARKED, WAIT_WOKEN };
+        std::atomic<U32> mWaitState { WAIT_NONE };
+        // </FS>
     };
 
     //------------------------------------------------------------------------
@@ -159,6 +172,13 @@ public:
     // This is public for support classes like LLWorkerThread,
     // but generally the methods above should be used.
     QueuedRequest* getRequest(handle_t handle);
+    // <FS> Async I/O continuation
+    // Thread safe. Arm a request for waking, from inside its processRequest()
+    void waitForWake(handle_t handle);
+    // Thread safe. Requeue a request parked by waitForWake(); a wake that
+    // arrives before the request has parked makes it retry at once.
+    void wakeRequest(handle_t handle);
+    // </FS>
 
     // debug (see source)
     bool check();
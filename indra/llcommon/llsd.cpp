@@ -34,9 +34,11 @@
 #include "llerror.h"
 #include "../llmath/llmath.h"
 #include "llformat.h"
+#include "llmemory.h"
 #include "llsdserialize.h"
 #include "stringize.h"
 
+#include <atomic>
 #include <limits>
 
 // Defend against a caller forcibly passing a negative number into an unsigned
@@ -79,6 +81,94 @@ S32 sLLSDNetObjects = 0;
 #define ALLOC_LLSD_OBJECT           { llsd::sLLSDNetObjects++;  llsd::sLLSDAllocationCount++;   }
 #define FREE_LLSD_OBJECT            { llsd::sLLSDNetObjects--;                                  }
 
+#ifdef NAME_UNNAMED_NAMESPACE
+namespace LLSDUnnamedNamespace
+#else
+namespace
+#endif
+{
+    class ImplArena
+        ///< Monotonic allocator behind LLSD::ArenaScope. Only the thread
+        //   that owns the scope allocates from it, but the Impls it hands
+        //   out may be released anywhere, hence the atomic count. The scope
+        //   itself holds one reference so the arena survives until it is
+        //   closed even if every value made so far is gone.
+    {
+    public:
+        ImplArena() : mRefs(1) { }
+
+        // Every allocation is preceded by a header pointing back here, so
+        // an Impl can find its arena without carrying a pointer of its own.
+        static constexpr size_t HEADER_SIZE = 16;
+
+        void* allocate(size_t size)
+        {
+            const size_t needed = HEADER_SIZE + ((size + 15) & ~size_t(15));
+            if ((size_t)(mEnd - mCur) < needed)
+            {
+                newBlock(needed);
+            }
+            U8* header = mCur;
+            mCur += needed;
+            *reinterpret_cast<ImplArena**>(header) = this;
+            return header + HEADER_SIZE;
+        }
+
+        static ImplArena* owner(const void* ptr)
+        {
+            return *reinterpret_cast<ImplArena* const*>((const U8*)ptr - HEADER_SIZE);
+        }
+
+        void addRef() { mRefs.fetch_add(1, std::memory_order_relaxed); }
+
+        void release()
+        {
+            if (mRefs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                delete this;
+            }
+        }
+
+    private:
+        ~ImplArena()
+        {
+            for (U8* block : mBlocks)
+            {
+                ll_aligned_free_16(block);
+            }
+        }
+
+        void newBlock(size_t needed)
+        {
+            // Grow geometrically so small documents stay small and large ones
+            // do not end up with thousands of blocks.
+            const size_t size = llmax(needed, mNextBlockSize);
+            mNextBlockSize = llmin(mNextBlockSize * 2, MAX_BLOCK_SIZE);
+            U8* block = (U8*)ll_aligned_malloc_16(size);
+            if (!block)
+            {
+                LLError::LLUserWarningMsg::showOutOfMemory();
+                LL_ERRS() << "Unable to allocate " << size << " bytes for LLSD arena" << LL_ENDL;
+            }
+            mBlocks.push_back(block);
+            mCur = block;
+            mEnd = block + size;
+        }
+
+        static constexpr size_t FIRST_BLOCK_SIZE = 64 * 1024;
+        static constexpr size_t MAX_BLOCK_SIZE = 4 * 1024 * 1024;
+
+        std::vector<U8*>    mBlocks;
+        U8*                 mCur { nullptr };
+        U8*                 mEnd { nullptr };
+        size_t              mNextBlockSize { FIRST_BLOCK_SIZE };
+        std::atomic<U32>    mRefs;
+    };
+
+    // Arena of the innermost LLSD::ArenaScope on this thread, if any
+    thread_local ImplArena* sThreadArena = nullptr;
+}
+
 class LLSD::Impl
     /**< This class is the abstract base class of the implementation of LLSD
          It provides the reference counting implementation, and the default
@@ -101,8 +191,16 @@ protected:
     bool shared() const                         { return (mUseCount > 1) && (mUseCount != STATIC_USAGE_COUNT); }
 
     U32 mUseCount;
+    bool mInArena;
 
 public:
+    template<class T, typename... Args>
+    static T* create(Args&&... args);
+        ///< new T(args), from the thread's arena if an ArenaScope is open
+
+    static void destroy(Impl* impl);
+        ///< counterpart of create(), for when the use count reaches 0
+
     static void reset(Impl*& var, Impl* impl);
         ///< safely set var to refer to the new impl (possibly shared)
 
@@ -435,6 +533,8 @@ namespace
 
         DataMap mData;
 
+        friend class LLSD::Impl;
+
     protected:
         ImplMap(const DataMap& data) : mData(data) { }
 
@@ -488,7 +588,7 @@ namespace
         LL_PROFILE_ZONE_SCOPED_CATEGORY_LLSD;
         if (shared())
         {
-            ImplMap* i = new ImplMap(mData);
+            ImplMap* i = create<ImplMap>(mData);
             Impl::assign(var, i);
             return *i;
         }
@@ -528,7 +628,16 @@ namespace
     void ImplMap::insert(std::string_view k, const LLSD& v)
     {
         LL_PROFILE_ZONE_SCOPED_CATEGORY_LLSD;
-        mData.emplace(k, v);
+        // The parsers insert keys in the order the formatters wrote them,
+        // i.e. sorted: appending at the end then costs no tree search.
+        if (mData.empty() || mData.key_comp()(mData.rbegin()->first, k))
+        {
+            mData.emplace_hint(mData.end(), k, v);
+        }
+        else
+        {
+            mData.emplace(k, v);
+        }
     }
 
     void ImplMap::erase(const LLSD::String& k)
@@ -539,6 +648,12 @@ namespace
 
     LLSD& ImplMap::ref(std::string_view k)
     {
+        // Same as insert() above, for the XML parser
+        if (mData.empty() || mData.key_comp()(mData.rbegin()->first, k))
+        {
+            return mData.emplace_hint(mData.end(), k, LLSD())->second;
+        }
+
         DataMap::iterator i = mData.lower_bound(k);
         if (i == mData.end() || mData.key_comp()(k, i->first))
         {
@@ -594,6 +709,8 @@ namespace
 
         DataVector mData;
 
+        friend class LLSD::Impl;
+
     protected:
         ImplArray(const DataVector& data) : mData(data) { }
 
@@ -644,7 +761,7 @@ namespace
     {
         if (shared())
         {
-            ImplArray* i = new ImplArray(mData);
+            ImplArray* i = create<ImplArray>(mData);
             Impl::assign(var, i);
             return *i;
         }
@@ -747,14 +864,16 @@ namespace
 }
 
 LLSD::Impl::Impl()
-    : mUseCount(0)
+    : mUseCount(0),
+      mInArena(false)
 {
     ++sAllocationCount;
     ++sOutstandingCount;
 }
 
 LLSD::Impl::Impl(StaticAllocationMarker)
-    : mUseCount(0)
+    : mUseCount(0),
+      mInArena(false)
 {
 }
 
@@ -763,6 +882,35 @@ LLSD::Impl::~Impl()
     --sOutstandingCount;
 }
 
+template<class T, typename... Args>
+T* LLSD::Impl::create(Args&&... args)
+{
+    ImplArena* arena = sThreadArena;
+    if (!arena)
+    {
+        return new T(std::forward<Args>(args)...);
+    }
+
+    T* impl = new (arena->allocate(sizeof(T))) T(std::forward<Args>(args)...);
+    impl->mInArena = true;
+    arena->addRef();
+    return impl;
+}
+
+void LLSD::Impl::destroy(Impl* impl)
+{
+    if (!impl->mInArena)
+    {
+        delete impl;
+        return;
+    }
+
+    // The memory itself goes back with the rest of the arena
+    ImplArena* arena = ImplArena::owner(impl);
+    impl->~Impl();
+    arena->release();
+}
+
 void LLSD::Impl::reset(Impl*& var, Impl* impl)
 {
     if (impl && impl->mUseCount != STATIC_USAGE_COUNT)
@@ -771,7 +919,7 @@ void LLSD::Impl::reset(Impl*& var, Impl* impl)
     }
     if (var  &&  var->mUseCount != STATIC_USAGE_COUNT && --var->mUseCount == 0)
     {
-        delete var;
+        destroy(var);
     }
     var = impl;
 }
@@ -780,7 +928,7 @@ void LLSD::Impl::move(Impl*& var, Impl*& impl)
 {
     if (var && var->mUseCount != STATIC_USAGE_COUNT && --var->mUseCount == 0)
     {
-        delete var; // destroy var if usage falls to 0 and not static
+        destroy(var); // destroy var if usage falls to 0 and not static
     }
     var = impl; // Steal impl to var without incrementing use since this is a move
     impl = nullptr; // null out old-impl pointer
@@ -801,14 +949,14 @@ const LLSD::Impl& LLSD::Impl::safe(const Impl* impl)
 ImplMap& LLSD::Impl::makeMap(Impl*& var)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_LLSD;
-    ImplMap* im = new ImplMap;
+    ImplMap* im = create<ImplMap>();
     reset(var, im);
     return *im;
 }
 
 ImplArray& LLSD::Impl::makeArray(Impl*& var)
 {
-    ImplArray* ia = new ImplArray;
+    ImplArray* ia = create<ImplArray>();
     reset(var, ia);
     return *ia;
 }
@@ -826,72 +974,72 @@ void LLSD::Impl::assignUndefined(Impl*& var)
 
 void LLSD::Impl::assign(Impl*& var, LLSD::Boolean v)
 {
-    reset(var, new ImplBoolean(v));
+    reset(var, create<ImplBoolean>(v));
 }
 
 void LLSD::Impl::assign(Impl*& var, LLSD::Integer v)
 {
-    reset(var, new ImplInteger(v));
+    reset(var, create<ImplInteger>(v));
 }
 
 void LLSD::Impl::assign(Impl*& var, LLSD::Real v)
 {
-    reset(var, new ImplReal(v));
+    reset(var, create<ImplReal>(v));
 }
 
 void LLSD::Impl::assign(Impl*& var, const char* v)
 {
-    reset(var, new ImplString(v));
+    reset(var, create<ImplString>(v));
 }
 
 void LLSD::Impl::assign(Impl*& var, const LLSD::String& v)
 {
-    reset(var, new ImplString(v));
+    reset(var, create<ImplString>(v));
 }
 
 void LLSD::Impl::assign(Impl*& var, const LLSD::UUID& v)
 {
-    reset(var, new ImplUUID(v));
+    reset(var, create<ImplUUID>(v));
 }
 
 void LLSD::Impl::assign(Impl*& var, const LLSD::Date& v)
 {
-    reset(var, new ImplDate(v));
+    reset(var, create<ImplDate>(v));
 }
 
 void LLSD::Impl::assign(Impl*& var, const LLSD::URI& v)
 {
-    reset(var, new ImplURI(v));
+    reset(var, create<ImplURI>(v));
 }
 
 void LLSD::Impl::assign(Impl*& var, const LLSD::Binary& v)
 {
-    reset(var, new ImplBinary(v));
+    reset(var, create<ImplBinary>(v));
 }
 
 void LLSD::Impl::assign(Impl*& var, LLSD::String&& v)
 {
-    reset(var, new ImplString(std::move(v)));
+    reset(var, create<ImplString>(std::move(v)));
 }
 
 void LLSD::Impl::assign(Impl*& var, LLSD::UUID&& v)
 {
-    reset(var, new ImplUUID(std::move(v)));
+    reset(var, create<ImplUUID>(std::move(v)));
 }
 
 void LLSD::Impl::assign(Impl*& var, LLSD::Date&& v)
 {
-    reset(var, new ImplDate(std::move(v)));
+    reset(var, create<ImplDate>(std::move(v)));
 }
 
 void LLSD::Impl::assign(Impl*& var, LLSD::URI&& v)
 {
-    reset(var, new ImplURI(std::move(v)));
+    reset(var, create<ImplURI>(std::move(v)));
 }
 
 void LLSD::Impl::assign(Impl*& var, LLSD::Binary&& v)
 {
-    reset(var, new ImplBinary(std::move(v)));
+    reset(var, create<ImplBinary>(std::move(v)));
 }
 
 
@@ -960,6 +1108,27 @@ namespace
 }
 
 
+LLSD::ArenaScope::ArenaScope()
+    : mOwner(sThreadArena == nullptr)
+{
+    if (mOwner)
+    {
+        sThreadArena = new ImplArena();
+    }
+}
+
+LLSD::ArenaScope::~ArenaScope()
+{
+    if (mOwner)
+    {
+        ImplArena* arena = sThreadArena;
+        sThreadArena = nullptr;
+        // Freed here, or with the last value allocated from it
+        arena->release();
+    }
+}
+
+
 LLSD::LLSD() : impl(0)                  { ALLOC_LLSD_OBJECT; }
 LLSD::~LLSD()                           { FREE_LLSD_OBJECT; Impl::reset(impl, 0); }
 
@@ -441,6 +441,42 @@ public:
         bool has(Integer) const;        ///< has() only works for Maps
     //@}
 
+    /** @name Bulk Allocation
+        Building a large tree (deserializing an inventory cache or a big
+        AIS response) costs one heap allocation per value, and as many
+        frees when the tree goes away. While an ArenaScope is alive on a
+        thread, every value created on that thread is carved out of one
+        monotonic arena instead, and the arena is handed back to the heap
+        in one go once the last of those values has been released.
+
+            LLSD data;
+            {
+                LLSD::ArenaScope arena;
+                LLSDSerialize::fromBinary(data, istr, size);
+            }
+
+        Values from an arena may be read, copied, modified and released on
+        any thread like any other LLSD. The arena is only ever freed as a
+        whole though: a single value from it that is kept around keeps all
+        of it alive. Only use a scope around code that builds a tree which
+        is converted and dropped, not one that ends up in long lived state.
+        Scopes do not nest; an inner scope just keeps using the outer one.
+    */
+    //@{
+        class LL_COMMON_API ArenaScope
+        {
+        public:
+            ArenaScope();
+            ~ArenaScope();
+
+            ArenaScope(const ArenaScope&) = delete;
+            ArenaScope& operator=(const ArenaScope&) = delete;
+
+        private:
+            bool mOwner;
+        };
+    //@}
+
     /** @name Implementation */
     //@{
 public:
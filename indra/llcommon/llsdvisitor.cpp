@@ -0,0 +1,942 @@
+/**
+ * @file llsdvisitor.cpp
+ * @brief Event driven LLSD parsers that do not build an LLSD tree.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llsdvisitor.h"
+
+#include <iostream>
+#include <iterator>
+#include <locale>
+#include <sstream>
+
+#include "apr_base64.h"
+
+extern "C"
+{
+#ifdef LL_USESYSTEMLIBS
+# include <expat.h>
+#else
+# include "expat/expat.h"
+#endif
+}
+
+#if LL_WINDOWS
+#include "llwin32headers.h" // ntohl
+#else
+#include <netinet/in.h> // ntohl
+#endif
+
+#include "lldate.h"
+#include "llmemorystream.h"
+#include "llsdserialize.h"
+#include "lluri.h"
+
+// Defined in llsdserialize.cpp
+llssize deserialize_string_delim(std::istream& istr, std::string& value, char delim);
+F64 ll_ntohd(F64 netdouble);
+
+/**
+ * LLSDTreeBuilder
+ */
+LLSDTreeBuilder::LLSDTreeBuilder()
+{
+    mStack.reserve(16);
+}
+
+bool LLSDTreeBuilder::add(const LLSD& value)
+{
+    if (mStack.empty())
+    {
+        mResult = value;
+        return true;
+    }
+
+    LLSD& container = *mStack.back();
+    if (container.isMap())
+    {
+        container[mKey] = value;
+    }
+    else
+    {
+        container.append(value);
+    }
+    return true;
+}
+
+bool LLSDTreeBuilder::open(const LLSD& container)
+{
+    // Insert the container first, then keep a pointer to it while it is
+    // being filled. Only the innermost container is ever modified, so the
+    // pointers to its ancestors stay valid.
+    if (mStack.empty())
+    {
+        mResult = container;
+        mStack.push_back(&mResult);
+        return true;
+    }
+
+    LLSD& parent = *mStack.back();
+    if (parent.isMap())
+    {
+        LLSD& slot = parent[mKey];
+        slot = container;
+        mStack.push_back(&slot);
+    }
+    else
+    {
+        parent.append(container);
+        mStack.push_back(&parent[parent.size() - 1]);
+    }
+    return true;
+}
+
+bool LLSDTreeBuilder::close()
+{
+    if (mStack.empty())
+    {
+        return false;
+    }
+    mStack.pop_back();
+    return true;
+}
+
+bool LLSDTreeBuilder::beginMap(S32 size)
+{
+    return open(LLSD::emptyMap());
+}
+
+bool LLSDTreeBuilder::key(std::string_view key)
+{
+    mKey.assign(key.data(), key.size());
+    return true;
+}
+
+bool LLSDTreeBuilder::endMap()
+{
+    return close();
+}
+
+bool LLSDTreeBuilder::beginArray(S32 size)
+{
+    return open(LLSD::emptyArray());
+}
+
+bool LLSDTreeBuilder::endArray()
+{
+    return close();
+}
+
+bool LLSDTreeBuilder::undefined()
+{
+    return add(LLSD());
+}
+
+bool LLSDTreeBuilder::boolean(bool value)
+{
+    return add(LLSD::Boolean(value));
+}
+
+bool LLSDTreeBuilder::integer(S32 value)
+{
+    return add(LLSD::Integer(value));
+}
+
+bool LLSDTreeBuilder::real(F64 value)
+{
+    return add(LLSD::Real(value));
+}
+
+bool LLSDTreeBuilder::string(std::string_view value)
+{
+    return add(LLSD::String(value));
+}
+
+bool LLSDTreeBuilder::uuid(const LLUUID& value)
+{
+    return add(value);
+}
+
+bool LLSDTreeBuilder::date(const LLDate& value)
+{
+    return add(value);
+}
+
+bool LLSDTreeBuilder::uri(std::string_view value)
+{
+    return add(LLURI(std::string(value)));
+}
+
+bool LLSDTreeBuilder::binary(const U8* data, size_t size)
+{
+    return add(LLSD::Binary(data, data + size));
+}
+
+namespace
+{
+    /**
+     * Binary format walker, see LLSDBinaryParser::doParse() for the format.
+     * Works on a memory buffer so that strings and binary blobs can be
+     * handed out without copying them.
+     */
+    class BinaryVisitParser
+    {
+    public:
+        BinaryVisitParser(const U8* data, size_t size, LLSDVisitor& visitor)
+        :   mCur(data),
+            mEnd(data + size),
+            mVisitor(visitor)
+        {
+        }
+
+        S32 parse(S32 max_depth)
+        {
+            return parseValue(max_depth) ? mCount : LLSDParser::PARSE_FAILURE;
+        }
+
+    private:
+        bool parseValue(S32 max_depth);
+        bool parseMap(S32 max_depth);
+        bool parseArray(S32 max_depth);
+
+        bool readBytes(size_t size, const U8*& data)
+        {
+            if ((size_t)(mEnd - mCur) < size)
+            {
+                return false;
+            }
+            data = mCur;
+            mCur += size;
+            return true;
+        }
+
+        bool readU32(U32& value)
+        {
+            const U8* data = nullptr;
+            if (!readBytes(sizeof(U32), data))
+            {
+                return false;
+            }
+            U32 value_nbo;
+            memcpy(&value_nbo, data, sizeof(U32));
+            value = ntohl(value_nbo);
+            return true;
+        }
+
+        bool readF64(F64& value)
+        {
+            const U8* data = nullptr;
+            if (!readBytes(sizeof(F64), data))
+            {
+                return false;
+            }
+            memcpy(&value, data, sizeof(F64));
+            return true;
+        }
+
+        // 4 byte size in network order followed by the data
+        bool readSized(std::string_view& value)
+        {
+            U32 size = 0;
+            const U8* data = nullptr;
+            if (!readU32(size) || (S32)size < 0 || !readBytes(size, data))
+            {
+                return false;
+            }
+            value = std::string_view((const char*)data, size);
+            return true;
+        }
+
+        // Notation style quoted string, may contain escapes
+        bool readDelimited(char delim, std::string_view& value)
+        {
+            const llssize available = llmin((llssize)(mEnd - mCur), (llssize)S32_MAX);
+            LLMemoryStream stream(mCur, (S32)available);
+            const llssize count = deserialize_string_delim(stream, mScratch, delim);
+            if (count == LLSDParser::PARSE_FAILURE || count > available)
+            {
+                return false;
+            }
+            mCur += count;
+            value = mScratch;
+            return true;
+        }
+
+    private:
+        const U8*       mCur;
+        const U8*       mEnd;
+        LLSDVisitor&    mVisitor;
+        std::string     mScratch;
+        S32             mCount { 0 };
+    };
+
+    bool BinaryVisitParser::parseValue(S32 max_depth)
+    {
+        if (mCur >= mEnd || max_depth == 0)
+        {
+            return false;
+        }
+
+        ++mCount;
+        const char c = (char)*mCur++;
+        switch (c)
+        {
+        case '{':
+            return parseMap(max_depth - 1);
+
+        case '[':
+            return parseArray(max_depth - 1);
+
+        case '!':
+            return mVisitor.undefined();
+
+        case '0':
+            return mVisitor.boolean(false);
+
+        case '1':
+            return mVisitor.boolean(true);
+
+        case 'i':
+        {
+            U32 value = 0;
+            return readU32(value) && mVisitor.integer((S32)value);
+        }
+
+        case 'r':
+        {
+            F64 value_nbo = 0.0;
+            return readF64(value_nbo) && mVisitor.real(ll_ntohd(value_nbo));
+        }
+
+        case 'u':
+        {
+            const U8* data = nullptr;
+            if (!readBytes(UUID_BYTES, data))
+            {
+                return false;
+            }
+            LLUUID id;
+            memcpy(id.mData, data, UUID_BYTES);
+            return mVisitor.uuid(id);
+        }
+
+        case '\'':
+        case '"':
+        {
+            std::string_view value;
+            return readDelimited(c, value) && mVisitor.string(value);
+        }
+
+        case 's':
+        {
+            std::string_view value;
+            return readSized(value) && mVisitor.string(value);
+        }
+
+        case 'l':
+        {
+            std::string_view value;
+            return readSized(value) && mVisitor.uri(value);
+        }
+
+        case 'd':
+        {
+            // Dates are written in host order
+            F64 value = 0.0;
+            return readF64(value) && mVisitor.date(LLDate(value));
+        }
+
+        case 'b':
+        {
+            std::string_view value;
+            return readSized(value) && mVisitor.binary((const U8*)value.data(), value.size());
+        }
+
+        default:
+            LL_INFOS() << "Unrecognized character while parsing: int(" << int(c) << ")" << LL_ENDL;
+            return false;
+        }
+    }
+
+    bool BinaryVisitParser::parseMap(S32 max_depth)
+    {
+        U32 size = 0;
+        if (!readU32(size) || (S32)size < 0 || !mVisitor.beginMap((S32)size))
+        {
+            return false;
+        }
+
+        for (U32 count = 0; count < size; ++count)
+        {
+            if (mCur >= mEnd)
+            {
+                return false;
+            }
+
+            std::string_view name;
+            const char c = (char)*mCur++;
+            switch (c)
+            {
+            case 'k':
+                if (!readSized(name))
+                {
+                    return false;
+                }
+                break;
+            case '\'':
+            case '"':
+                if (!readDelimited(c, name))
+                {
+                    return false;
+                }
+                break;
+            default:
+                // Includes a '}' before the announced number of entries
+                return false;
+            }
+
+            if (!mVisitor.key(name) || !parseValue(max_depth))
+            {
+                return false;
+            }
+        }
+
+        if (mCur >= mEnd || *mCur++ != '}')
+        {
+            return false;
+        }
+        return mVisitor.endMap();
+    }
+
+    bool BinaryVisitParser::parseArray(S32 max_depth)
+    {
+        U32 size = 0;
+        if (!readU32(size) || (S32)size < 0 || !mVisitor.beginArray((S32)size))
+        {
+            return false;
+        }
+
+        for (U32 count = 0; count < size; ++count)
+        {
+            if (mCur >= mEnd || *mCur == ']' || !parseValue(max_depth))
+            {
+                return false;
+            }
+        }
+
+        if (mCur >= mEnd || *mCur++ != ']')
+        {
+            return false;
+        }
+        return mVisitor.endArray();
+    }
+
+    /**
+     * XML format walker on top of expat. Follows LLSDXMLParser::Impl: values
+     * outside of <llsd>, keys outside of a map and values in a map without
+     * a key are skipped, unknown elements are reported as undefined.
+     */
+    class XMLVisitParser
+    {
+    public:
+        XMLVisitParser(LLSDVisitor& visitor, S32 max_depth);
+        ~XMLVisitParser();
+
+        S32 parse(const char* data, size_t size);
+
+    private:
+        enum Element {
+            ELEMENT_LLSD,
+            ELEMENT_UNDEF,
+            ELEMENT_BOOL,
+            ELEMENT_INTEGER,
+            ELEMENT_REAL,
+            ELEMENT_STRING,
+            ELEMENT_UUID,
+            ELEMENT_DATE,
+            ELEMENT_URI,
+            ELEMENT_BINARY,
+            ELEMENT_MAP,
+            ELEMENT_ARRAY,
+            ELEMENT_KEY,
+            ELEMENT_UNKNOWN
+        };
+        static Element readElement(const XML_Char* name);
+
+        void startElementHandler(const XML_Char* name, const XML_Char** attributes);
+        void endElementHandler(const XML_Char* name);
+        void characterDataHandler(const XML_Char* data, int length);
+
+        static void sStartElementHandler(void* userData, const XML_Char* name, const XML_Char** attributes);
+        static void sEndElementHandler(void* userData, const XML_Char* name);
+        static void sCharacterDataHandler(void* userData, const XML_Char* data, int length);
+
+        void startSkipping()
+        {
+            mSkipping = true;
+            mSkipThrough = mDepth;
+        }
+
+        void fail()
+        {
+            mFailed = true;
+            XML_StopParser(mParser, XML_FALSE);
+        }
+
+        bool emitValue(Element element);
+
+    private:
+        XML_Parser              mParser;
+        LLSDVisitor&            mVisitor;
+        S32                     mMaxDepth;
+        S32                     mCount { 0 };
+
+        bool                    mInLLSDElement { false };
+        bool                    mGracefullStop { false };
+        bool                    mFailed { false };
+        bool                    mHaveKey { false };
+
+        int                     mDepth { 0 };
+        bool                    mSkipping { false };
+        int                     mSkipThrough { 0 };
+
+        std::vector<Element>    mElements;      // open elements inside <llsd>
+        S32                     mContainerDepth { 0 };
+
+        std::string             mContent;       // text of the current scalar or key
+        std::string             mStripped;      // base64 without whitespace
+        std::vector<U8>         mBinary;
+        std::istringstream      mRealStream;
+    };
+
+    XMLVisitParser::XMLVisitParser(LLSDVisitor& visitor, S32 max_depth)
+    :   mParser(XML_ParserCreate(NULL)),
+        mVisitor(visitor),
+        mMaxDepth(max_depth)
+    {
+        XML_SetUserData(mParser, this);
+        XML_SetElementHandler(mParser, sStartElementHandler, sEndElementHandler);
+        XML_SetCharacterDataHandler(mParser, sCharacterDataHandler);
+        // Reals are always written with a '.', whatever the user's locale
+        mRealStream.imbue(std::locale::classic());
+        mElements.reserve(16);
+    }
+
+    XMLVisitParser::~XMLVisitParser()
+    {
+        XML_ParserFree(mParser);
+    }
+
+    S32 XMLVisitParser::parse(const char* data, size_t size)
+    {
+        // expat takes an int length
+        static const size_t CHUNK_SIZE = 1024 * 1024;
+        XML_Status status = XML_STATUS_OK;
+        do
+        {
+            const size_t chunk = llmin(size, CHUNK_SIZE);
+            status = XML_Parse(mParser, data, (int)chunk, chunk == size);
+            data += chunk;
+            size -= chunk;
+        }
+        while (status == XML_STATUS_OK && size > 0);
+
+        if (mFailed || (status == XML_STATUS_ERROR && !mGracefullStop))
+        {
+            return LLSDParser::PARSE_FAILURE;
+        }
+        return mCount;
+    }
+
+    void XMLVisitParser::startElementHandler(const XML_Char* name, const XML_Char** attributes)
+    {
+        ++mDepth;
+        if (mSkipping)
+        {
+            return;
+        }
+
+        const Element element = readElement(name);
+        if (!mInLLSDElement)
+        {
+            if (element == ELEMENT_LLSD)
+            {
+                mInLLSDElement = true;
+            }
+            else
+            {
+                startSkipping();
+            }
+            return;
+        }
+
+        const Element parent = mElements.empty() ? ELEMENT_LLSD : mElements.back();
+        switch (element)
+        {
+        case ELEMENT_LLSD:
+            return startSkipping();
+
+        case ELEMENT_KEY:
+            if (parent != ELEMENT_MAP)
+            {
+                return startSkipping();
+            }
+            mElements.push_back(element);
+            mContent.clear();
+            return;
+
+        case ELEMENT_BINARY:
+        {
+            const XML_Char* encoding = nullptr;
+            for (const XML_Char** attribute = attributes; *attribute; attribute += 2)
+            {
+                if (strcmp(*attribute, "encoding") == 0)
+                {
+                    encoding = attribute[1];
+                    break;
+                }
+            }
+            if (encoding && strcmp("base64", encoding) != 0)
+            {
+                return startSkipping();
+            }
+            break;
+        }
+
+        default:
+            // all rest are values, fall through
+            ;
+        }
+
+        if (parent == ELEMENT_MAP)
+        {
+            if (!mHaveKey)
+            {
+                return startSkipping();
+            }
+            mHaveKey = false;
+        }
+        else if (parent != ELEMENT_ARRAY && parent != ELEMENT_LLSD)
+        {
+            // improperly nested value in a non-structure
+            return startSkipping();
+        }
+
+        if (mMaxDepth >= 0 && mContainerDepth >= mMaxDepth)
+        {
+            return fail();
+        }
+
+        ++mCount;
+        mElements.push_back(element);
+        mContent.clear();
+        switch (element)
+        {
+        case ELEMENT_MAP:
+            ++mContainerDepth;
+            if (!mVisitor.beginMap(-1))
+            {
+                fail();
+            }
+            break;
+
+        case ELEMENT_ARRAY:
+            ++mContainerDepth;
+            if (!mVisitor.beginArray(-1))
+            {
+                fail();
+            }
+            break;
+
+        default:
+            // all the other values are reported by the end element handler
+            ;
+        }
+    }
+
+    void XMLVisitParser::endElementHandler(const XML_Char* name)
+    {
+        --mDepth;
+        if (mSkipping)
+        {
+            if (mDepth < mSkipThrough)
+            {
+                mSkipping = false;
+            }
+            return;
+        }
+
+        if (mElements.empty())
+        {
+            // </llsd>
+            if (mInLLSDElement)
+            {
+                mInLLSDElement = false;
+                mGracefullStop = true;
+                XML_StopParser(mParser, XML_FALSE);
+            }
+            return;
+        }
+
+        const Element element = mElements.back();
+        mElements.pop_back();
+
+        bool success = true;
+        switch (element)
+        {
+        case ELEMENT_KEY:
+            success = mVisitor.key(mContent);
+            mHaveKey = true;
+            break;
+
+        case ELEMENT_MAP:
+            --mContainerDepth;
+            mHaveKey = false;
+            success = mVisitor.endMap();
+            break;
+
+        case ELEMENT_ARRAY:
+            --mContainerDepth;
+            success = mVisitor.endArray();
+            break;
+
+        default:
+            success = emitValue(element);
+            break;
+        }
+
+        if (!success)
+        {
+            fail();
+        }
+    }
+
+    bool XMLVisitParser::emitValue(Element element)
+    {
+        switch (element)
+        {
+        case ELEMENT_UNDEF:
+        case ELEMENT_UNKNOWN:
+            return mVisitor.undefined();
+
+        case ELEMENT_BOOL:
+            return mVisitor.boolean(mContent == "true" || mContent == "1");
+
+        case ELEMENT_INTEGER:
+        {
+            S32 i;
+            // sscanf okay here with different locales - ints don't change for different locale settings like floats do.
+            if (sscanf(mContent.c_str(), "%d", &i) == 1)
+            {
+                return mVisitor.integer(i);
+            }
+            return mVisitor.integer(LLSD(mContent).asInteger());
+        }
+
+        case ELEMENT_REAL:
+        {
+            F64 r = 0.0;
+            mRealStream.clear();
+            mRealStream.str(mContent);
+            mRealStream >> r;
+            if (mRealStream.fail())
+            {
+                // "nan", "inf" and friends
+                r = LLSD(mContent).asReal();
+            }
+            return mVisitor.real(r);
+        }
+
+        case ELEMENT_STRING:
+            return mVisitor.string(mContent);
+
+        case ELEMENT_UUID:
+        {
+            LLUUID id;
+            id.set(mContent, false);
+            return mVisitor.uuid(id);
+        }
+
+        case ELEMENT_DATE:
+            return mVisitor.date(LLDate(mContent));
+
+        case ELEMENT_URI:
+            return mVisitor.uri(mContent);
+
+        case ELEMENT_BINARY:
+        {
+            // Strip the whitespace python and friends put in their base64
+            mStripped.clear();
+            for (char c : mContent)
+            {
+                if (!isspace((unsigned char)c))
+                {
+                    mStripped.push_back(c);
+                }
+            }
+            mBinary.resize(apr_base64_decode_len(mStripped.c_str()));
+            const S32 len = mBinary.empty() ? 0 : apr_base64_decode_binary(mBinary.data(), mStripped.c_str());
+            return mVisitor.binary(mBinary.data(), len);
+        }
+
+        default:
+            return false;
+        }
+    }
+
+    void XMLVisitParser::characterDataHandler(const XML_Char* data, int length)
+    {
+        // Only scalars and keys have text, skip the indentation between the
+        // children of maps and arrays.
+        if (!mSkipping && !mElements.empty() &&
+            mElements.back() != ELEMENT_MAP && mElements.back() != ELEMENT_ARRAY)
+        {
+            mContent.append(data, length);
+        }
+    }
+
+    void XMLVisitParser::sStartElementHandler(void* userData, const XML_Char* name, const XML_Char** attributes)
+    {
+        ((XMLVisitParser*)userData)->startElementHandler(name, attributes);
+    }
+
+    void XMLVisitParser::sEndElementHandler(void* userData, const XML_Char* name)
+    {
+        ((XMLVisitParser*)userData)->endElementHandler(name);
+    }
+
+    void XMLVisitParser::sCharacterDataHandler(void* userData, const XML_Char* data, int length)
+    {
+        ((XMLVisitParser*)userData)->characterDataHandler(data, length);
+    }
+
+    // Same lookup as LLSDXMLParser::Impl::readElement(), most frequent first
+    XMLVisitParser::Element XMLVisitParser::readElement(const XML_Char* name)
+    {
+        XML_Char c = *name;
+        switch (c)
+        {
+            case 'k':
+                if (strcmp(name, "key") == 0) { return ELEMENT_KEY; }
+                break;
+            case 'r':
+                if (strcmp(name, "real") == 0) { return ELEMENT_REAL; }
+                break;
+            case 'i':
+                if (strcmp(name, "integer") == 0) { return ELEMENT_INTEGER; }
+                break;
+            case 'a':
+                if (strcmp(name, "array") == 0) { return ELEMENT_ARRAY; }
+                break;
+            case 'm':
+                if (strcmp(name, "map") == 0) { return ELEMENT_MAP; }
+                break;
+            case 'u':
+                if (strcmp(name, "uuid") == 0) { return ELEMENT_UUID; }
+                if (strcmp(name, "undef") == 0) { return ELEMENT_UNDEF; }
+                if (strcmp(name, "uri") == 0) { return ELEMENT_URI; }
+                break;
+            case 'b':
+                if (strcmp(name, "binary") == 0) { return ELEMENT_BINARY; }
+                if (strcmp(name, "boolean") == 0) { return ELEMENT_BOOL; }
+                break;
+            case 's':
+                if (strcmp(name, "string") == 0) { return ELEMENT_STRING; }
+                break;
+            case 'l':
+                if (strcmp(name, "llsd") == 0) { return ELEMENT_LLSD; }
+                break;
+            case 'd':
+                if (strcmp(name, "date") == 0) { return ELEMENT_DATE; }
+                break;
+        }
+        return ELEMENT_UNKNOWN;
+    }
+
+    bool read_stream(std::istream& istr, llssize max_bytes, std::string& buffer)
+    {
+        if (max_bytes < 0)
+        {
+            buffer.assign(std::istreambuf_iterator<char>(istr), std::istreambuf_iterator<char>());
+        }
+        else
+        {
+            buffer.resize((size_t)max_bytes);
+            istr.read(buffer.data(), max_bytes);
+            buffer.resize((size_t)istr.gcount());
+        }
+        return !buffer.empty();
+    }
+}
+
+/**
+ * LLSDVisitParser
+ */
+// static
+S32 LLSDVisitParser::parseBinary(const U8* data, size_t size, LLSDVisitor& visitor, S32 max_depth)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_LLSD;
+    if (!data || !size)
+    {
+        return LLSDParser::PARSE_FAILURE;
+    }
+    BinaryVisitParser parser(data, size, visitor);
+    return parser.parse(max_depth);
+}
+
+// static
+S32 LLSDVisitParser::parseXML(const char* data, size_t size, LLSDVisitor& visitor, S32 max_depth)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_LLSD;
+    if (!data || !size)
+    {
+        return LLSDParser::PARSE_FAILURE;
+    }
+    XMLVisitParser parser(visitor, max_depth);
+    return parser.parse(data, size);
+}
+
+// static
+S32 LLSDVisitParser::parseBinary(std::istream& istr, LLSDVisitor& visitor, llssize max_bytes, S32 max_depth)
+{
+    std::string buffer;
+    if (!read_stream(istr, max_bytes, buffer))
+    {
+        return LLSDParser::PARSE_FAILURE;
+    }
+    return parseBinary((const U8*)buffer.data(), buffer.size(), visitor, max_depth);
+}
+
+// static
+S32 LLSDVisitParser::parseXML(std::istream& istr, LLSDVisitor& visitor, llssize max_bytes, S32 max_depth)
+{
+    std::string buffer;
+    if (!read_stream(istr, max_bytes, buffer))
+    {
+        return LLSDParser::PARSE_FAILURE;
+    }
+    return parseXML(buffer.data(), buffer.size(), visitor, max_depth);
+}
@@ -0,0 +1,153 @@
+/**
+ * @file llsdvisitor.h
+ * @brief Event driven LLSD parsers that do not build an LLSD tree.
+ *
+ * @Description:
+ * LLSDSerialize always materializes the whole document: every value is a
+ * separately allocated LLSD node and every map a std::map of them. For
+ * large payloads that are immediately converted into something else (mesh
+ * assets, inventory caches, AIS responses, event queue batches) building
+ * that tree is most of the parse time.
+ * The parsers here walk binary or XML LLSD and report what they find to an
+ * LLSDVisitor instead, in document order:
+ *   beginMap, key, <value>, key, <value>, ..., endMap
+ *   beginArray, <value>, <value>, ..., endArray
+ * where <value> is a scalar callback or a nested map or array. Strings,
+ * keys and binary data are handed out as views into the input or into a
+ * scratch buffer, so they are only valid for the duration of the callback.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLSDVISITOR_H
+#define LL_LLSDVISITOR_H
+
+#include "llsd.h"
+
+#include <iosfwd>
+#include <string_view>
+#include <vector>
+
+/**
+ * @class LLSDVisitor
+ * @brief Receives the parse events. Every callback returns false to abort
+ * the parse, the defaults ignore the event.
+ */
+class LL_COMMON_API LLSDVisitor
+{
+public:
+    virtual ~LLSDVisitor() = default;
+
+    /**
+     * size is the number of entries announced by the document, or -1 when
+     * the format does not say (XML). It is a hint, not a promise.
+     */
+    virtual bool beginMap(S32 size)                 { return true; }
+    virtual bool key(std::string_view key)          { return true; }
+    virtual bool endMap()                           { return true; }
+    virtual bool beginArray(S32 size)               { return true; }
+    virtual bool endArray()                         { return true; }
+
+    virtual bool undefined()                        { return true; }
+    virtual bool boolean(bool value)                { return true; }
+    virtual bool integer(S32 value)                 { return true; }
+    virtual bool real(F64 value)                    { return true; }
+    virtual bool string(std::string_view value)     { return true; }
+    virtual bool uuid(const LLUUID& value)          { return true; }
+    virtual bool date(const LLDate& value)          { return true; }
+    virtual bool uri(std::string_view value)        { return true; }
+    virtual bool binary(const U8* data, size_t size) { return true; }
+};
+
+/**
+ * @class LLSDTreeBuilder
+ * @brief Visitor that builds the same LLSD the tree parsers would.
+ *
+ * Mostly useful to check a visitor based consumer against the tree parsers;
+ * for anything else just use LLSDSerialize.
+ */
+class LL_COMMON_API LLSDTreeBuilder : public LLSDVisitor
+{
+public:
+    LLSDTreeBuilder();
+
+    const LLSD& getResult() const { return mResult; }
+
+    bool beginMap(S32 size) override;
+    bool key(std::string_view key) override;
+    bool endMap() override;
+    bool beginArray(S32 size) override;
+    bool endArray() override;
+
+    bool undefined() override;
+    bool boolean(bool value) override;
+    bool integer(S32 value) override;
+    bool real(F64 value) override;
+    bool string(std::string_view value) override;
+    bool uuid(const LLUUID& value) override;
+    bool date(const LLDate& value) override;
+    bool uri(std::string_view value) override;
+    bool binary(const U8* data, size_t size) override;
+
+private:
+    bool add(const LLSD& value);
+    bool open(const LLSD& container);
+    bool close();
+
+    LLSD                mResult;
+    std::vector<LLSD*>  mStack;
+    std::string         mKey;
+};
+
+/**
+ * @class LLSDVisitParser
+ * @brief Static entry points for the visitor based parsers.
+ *
+ * All of them return the number of values visited, or
+ * LLSDParser::PARSE_FAILURE (-1) if the document is malformed, nests deeper
+ * than max_depth (-1 for no limit) or the visitor aborted.
+ */
+class LL_COMMON_API LLSDVisitParser
+{
+public:
+    /**
+     * Parse one binary LLSD value from memory, without the
+     * "<? LLSD/Binary ?>" header.
+     */
+    static S32 parseBinary(const U8* data, size_t size, LLSDVisitor& visitor, S32 max_depth = -1);
+
+    /**
+     * Parse an XML LLSD document from memory. Anything outside of the first
+     * <llsd> element is ignored.
+     */
+    static S32 parseXML(const char* data, size_t size, LLSDVisitor& visitor, S32 max_depth = -1);
+
+    /**
+     * Same as above, reading up to max_bytes (-1 for everything) from the
+     * stream first.
+     */
+    static S32 parseBinary(std::istream& istr, LLSDVisitor& visitor, llssize max_bytes = -1, S32 max_depth = -1);
+    static S32 parseXML(std::istream& istr, LLSDVisitor& visitor, llssize max_bytes = -1, S32 max_depth = -1);
+};
+
+#endif // LL_LLSDVISITOR_H
@@ -57,6 +57,7 @@ typedef U32 uint32_t;
 #include "../test/namedtempfile.h"
 #include "stringize.h"
 #include "StringVec.h"
+#include <chrono>
 #include <functional>
 
 typedef std::function<void(const LLSD& data, std::ostream& str)> FormatterFunction;
@@ -2194,4 +2195,132 @@ namespace tut
                         { return LLSDSerialize::fromBinary(data, istr, max_bytes) > 0; });
     }
 |*==========================================================================*/
+
+    struct TestLLSDArenaData
+    {
+        // A document shaped like an inventory cache: lots of small maps
+        static LLSD makeDocument(S32 count)
+        {
+            LLSD items = LLSD::emptyArray();
+            for (S32 i = 0; i < count; ++i)
+            {
+                LLSD item;
+                item["name"] = llformat("Inventory item %d", i);
+                item["desc"] = "(No Description)";
+                item["item_id"] = LLUUID::generateNewID();
+                item["parent_id"] = LLUUID::generateNewID();
+                item["asset_id"] = LLUUID::generateNewID();
+                item["type"] = i % 20;
+                item["flags"] = i;
+                item["created_at"] = (LLSD::Integer)(1700000000 + i);
+                item["sale_info"]["sale_price"] = 10;
+                item["sale_info"]["sale_type"] = "not";
+                items.append(item);
+            }
+            return items;
+        }
+
+        static std::string toBinary(const LLSD& sd)
+        {
+            std::ostringstream ostr;
+            LLSDSerialize::toBinary(sd, ostr);
+            return ostr.str();
+        }
+
+        static LLSD fromBinary(const std::string& data)
+        {
+            LLSD sd;
+            std::istringstream istr(data);
+            LLSDSerialize::fromBinary(sd, istr, data.size());
+            return sd;
+        }
+    };
+    typedef tut::test_group<TestLLSDArenaData> TestLLSDArenaGroup;
+    typedef TestLLSDArenaGroup::object TestLLSDArenaObject;
+    TestLLSDArenaGroup llsdArenaGroup("llsd arena allocation");
+
+    template<> template<>
+    void TestLLSDArenaObject::test<1>()
+    {
+        set_test_name("arena parse matches heap parse");
+        const LLSD expected = makeDocument(100);
+        const std::string data = toBinary(expected);
+
+        LLSD parsed;
+        {
+            LLSD::ArenaScope arena;
+            parsed = fromBinary(data);
+        }
+        ensure("same document", llsd_equals(parsed, expected));
+
+        // Arena values behave like any other once the scope is gone
+        parsed[0]["name"] = "renamed";
+        parsed[1]["sale_info"]["sale_price"] = 20;
+        LLSD copy = parsed;
+        copy[2] = LLSD();
+        ensure_equals("modified", parsed[0]["name"].asString(), std::string("renamed"));
+        ensure_equals("nested modified", parsed[1]["sale_info"]["sale_price"].asInteger(), 20);
+        ensure("copy on write", parsed[2].isMap());
+        ensure("copy modified", copy[2].isUndefined());
+    }
+
+    template<> template<>
+    void TestLLSDArenaObject::test<2>()
+    {
+        set_test_name("nested scopes and values outliving them");
+        LLSD kept;
+        {
+            LLSD::ArenaScope outer;
+            kept["outer"] = 1;
+            {
+                LLSD::ArenaScope inner;
+                kept["inner"] = "inner value";
+            }
+            kept["after"] = LLUUID::generateNewID();
+        }
+        kept["heap"] = 2.5;
+        ensure_equals("size", kept.size(), (size_t)4);
+        ensure_equals("inner", kept["inner"].asString(), std::string("inner value"));
+        kept.erase("outer");
+        kept.erase("inner");
+        ensure_equals("erased", kept.size(), (size_t)2);
+    }
+
+    template<> template<>
+    void TestLLSDArenaObject::test<3>()
+    {
+        set_test_name("heap against arena parse and destroy timings");
+        // Only logged, timings are far too machine dependent to check
+        const S32 ITEMS = 50000;
+        const std::string data = toBinary(makeDocument(ITEMS));
+
+        typedef std::chrono::steady_clock clock;
+        auto elapsed = [](clock::time_point start)
+        {
+            return std::chrono::duration<F64>(clock::now() - start).count();
+        };
+
+        auto start = clock::now();
+        LLSD heap = fromBinary(data);
+        const F64 heap_parse = elapsed(start);
+        start = clock::now();
+        heap.clear();
+        const F64 heap_destroy = elapsed(start);
+
+        start = clock::now();
+        LLSD arena;
+        {
+            LLSD::ArenaScope scope;
+            arena = fromBinary(data);
+        }
+        const F64 arena_parse = elapsed(start);
+        ensure_equals("all items", arena.size(), (size_t)ITEMS);
+        start = clock::now();
+        arena.clear();
+        const F64 arena_destroy = elapsed(start);
+
+        LL_INFOS() << ITEMS << " items, " << data.size() << " bytes. Heap: parse "
+                   << heap_parse << "s, destroy " << heap_destroy << "s. Arena: parse "
+                   << arena_parse << "s, destroy " << arena_destroy << "s" << LL_ENDL;
+    }
 }
@@ -0,0 +1,296 @@
+/**
+ * @file llsdvisitor_test.cpp
+ * @brief Tests for the visitor based LLSD parsers
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llsdvisitor.h"
+
+#include "llsd.h"
+#include "llsdserialize.h"
+#include "llsdutil.h"
+#include "llformat.h"
+
+#include "../test/lltut.h"
+
+#include <chrono>
+#include <sstream>
+
+namespace
+{
+    // Only counts, the way a consumer that converts straight into its own
+    // structures would touch the data.
+    struct CountingVisitor : public LLSDVisitor
+    {
+        S32 mMaps { 0 };
+        S32 mArrays { 0 };
+        S32 mScalars { 0 };
+        size_t mBytes { 0 };
+
+        bool beginMap(S32 size) override       { ++mMaps; return true; }
+        bool beginArray(S32 size) override     { ++mArrays; return true; }
+        bool key(std::string_view key) override { mBytes += key.size(); return true; }
+        bool integer(S32 value) override       { ++mScalars; return true; }
+        bool real(F64 value) override          { ++mScalars; return true; }
+        bool string(std::string_view value) override { ++mScalars; mBytes += value.size(); return true; }
+        bool uuid(const LLUUID& value) override { ++mScalars; return true; }
+    };
+
+    // Gives up on the first string
+    struct AbortingVisitor : public LLSDVisitor
+    {
+        bool string(std::string_view value) override { return false; }
+    };
+
+    LLSD sample_llsd()
+    {
+        LLSD sd;
+        sd["undef"] = LLSD();
+        sd["bool"] = true;
+        sd["int"] = -42;
+        sd["real"] = 3.25;
+        sd["string"] = "hello world";
+        sd["empty string"] = "";
+        sd["uuid"] = LLUUID("c96f9b1e-f589-4100-9774-d98643ce0bed");
+        sd["date"] = LLDate("2006-04-24T16:11:33Z");
+        sd["uri"] = LLURI("https://secondlife.com/login");
+        sd["binary"] = LLSD::Binary(37, 0xA5);
+        sd["empty map"] = LLSD::emptyMap();
+        sd["empty array"] = LLSD::emptyArray();
+        sd["nested"]["array"].append(1);
+        sd["nested"]["array"].append("two");
+        sd["nested"]["array"].append(LLSD::emptyMap());
+        sd["nested"]["map"]["deep"]["deeper"] = 7;
+        return sd;
+    }
+
+    LLSD large_llsd(S32 count)
+    {
+        LLSD items = LLSD::emptyArray();
+        for (S32 i = 0; i < count; ++i)
+        {
+            LLSD item;
+            item["name"] = llformat("Item number %d", i);
+            item["desc"] = "A fairly ordinary inventory item description";
+            item["item_id"] = LLUUID::generateNewID();
+            item["parent_id"] = LLUUID::generateNewID();
+            item["type"] = i % 20;
+            item["flags"] = i;
+            item["created_at"] = (F64)i;
+            items.append(item);
+        }
+        return items;
+    }
+
+    std::string to_binary(const LLSD& sd)
+    {
+        std::ostringstream ostr;
+        LLSDSerialize::toBinary(sd, ostr);
+        return ostr.str();
+    }
+
+    std::string to_xml(const LLSD& sd)
+    {
+        std::ostringstream ostr;
+        LLSDSerialize::toXML(sd, ostr);
+        return ostr.str();
+    }
+
+    S32 visit_binary(const std::string& data, LLSDVisitor& visitor, S32 max_depth = -1)
+    {
+        return LLSDVisitParser::parseBinary((const U8*)data.data(), data.size(), visitor, max_depth);
+    }
+
+    S32 visit_xml(const std::string& data, LLSDVisitor& visitor, S32 max_depth = -1)
+    {
+        return LLSDVisitParser::parseXML(data.data(), data.size(), visitor, max_depth);
+    }
+
+    F64 seconds_since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<F64>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+namespace tut
+{
+    struct llsdvisitor_data
+    {
+    };
+    typedef test_group<llsdvisitor_data> llsdvisitor_group;
+    typedef llsdvisitor_group::object object;
+    llsdvisitor_group llsdvisitorgrp("LLSDVisitParser");
+
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("binary tree builder matches LLSDSerialize");
+        const LLSD sd = sample_llsd();
+        const std::string data = to_binary(sd);
+
+        LLSDTreeBuilder builder;
+        ensure("parse succeeded", visit_binary(data, builder) > 0);
+        ensure("same llsd", llsd_equals(builder.getResult(), sd));
+
+        // The stream entry point sees the same thing
+        std::istringstream istr(data);
+        LLSDTreeBuilder stream_builder;
+        ensure("stream parse succeeded",
+               LLSDVisitParser::parseBinary(istr, stream_builder) > 0);
+        ensure("same llsd from stream", llsd_equals(stream_builder.getResult(), sd));
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("xml tree builder matches LLSDSerialize");
+        const LLSD sd = sample_llsd();
+        const std::string data = to_xml(sd);
+
+        LLSDTreeBuilder builder;
+        ensure("parse succeeded", visit_xml(data, builder) > 0);
+        ensure("same llsd", llsd_equals(builder.getResult(), sd));
+
+        std::istringstream istr(data);
+        LLSD parsed;
+        ensure("tree parse succeeded", LLSDSerialize::fromXMLDocument(parsed, istr) > 0);
+        ensure("agrees with tree parser", llsd_equals(builder.getResult(), parsed));
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        set_test_name("xml pretty printing and surrounding junk");
+        const LLSD sd = sample_llsd();
+        std::ostringstream ostr;
+        ostr << "<?xml version=\"1.0\" ?>\n";
+        LLSDSerialize::toPrettyXML(sd, ostr);
+        ostr << "trailing garbage that is never looked at";
+
+        LLSDTreeBuilder builder;
+        ensure("parse succeeded", visit_xml(ostr.str(), builder) > 0);
+        ensure("same llsd", llsd_equals(builder.getResult(), sd));
+    }
+
+    template<> template<>
+    void object::test<4>()
+    {
+        set_test_name("truncated binary input fails");
+        const std::string data = to_binary(sample_llsd());
+        for (size_t size = 0; size < data.size(); ++size)
+        {
+            LLSDTreeBuilder builder;
+            ensure_equals(llformat("truncated at %d", (S32)size),
+                          LLSDVisitParser::parseBinary((const U8*)data.data(), size, builder),
+                          (S32)LLSDParser::PARSE_FAILURE);
+        }
+    }
+
+    template<> template<>
+    void object::test<5>()
+    {
+        set_test_name("truncated xml input fails");
+        const std::string data = to_xml(sample_llsd());
+        LLSDTreeBuilder builder;
+        ensure_equals("half a document",
+                      visit_xml(data.substr(0, data.size() / 2), builder),
+                      (S32)LLSDParser::PARSE_FAILURE);
+    }
+
+    template<> template<>
+    void object::test<6>()
+    {
+        set_test_name("max depth and aborting visitors");
+        const LLSD sd = sample_llsd();
+        const std::string binary = to_binary(sd);
+        const std::string xml = to_xml(sd);
+
+        // Like the tree parsers, scalars count as a level: sample_llsd()
+        // is five values deep.
+        LLSDTreeBuilder shallow;
+        ensure_equals("binary too deep", visit_binary(binary, shallow, 2),
+                      (S32)LLSDParser::PARSE_FAILURE);
+        ensure_equals("xml too deep", visit_xml(xml, shallow, 2),
+                      (S32)LLSDParser::PARSE_FAILURE);
+        ensure_equals("binary one short", visit_binary(binary, shallow, 4),
+                      (S32)LLSDParser::PARSE_FAILURE);
+        LLSDTreeBuilder deep;
+        ensure("binary deep enough", visit_binary(binary, deep, 5) > 0);
+        LLSDTreeBuilder deep_xml;
+        ensure("xml deep enough", visit_xml(xml, deep_xml, 5) > 0);
+
+        AbortingVisitor aborting;
+        ensure_equals("binary abort", visit_binary(binary, aborting),
+                      (S32)LLSDParser::PARSE_FAILURE);
+        ensure_equals("xml abort", visit_xml(xml, aborting),
+                      (S32)LLSDParser::PARSE_FAILURE);
+    }
+
+    template<> template<>
+    void object::test<7>()
+    {
+        set_test_name("visitor against tree parser timings");
+        // Not a pass/fail test, the numbers are only logged. It does check
+        // that both parsers saw the same document.
+        const S32 ITEMS = 20000;
+        const LLSD sd = large_llsd(ITEMS);
+        const std::string binary = to_binary(sd);
+        const std::string xml = to_xml(sd);
+
+        auto start = std::chrono::steady_clock::now();
+        LLSD tree;
+        std::istringstream binary_istr(binary);
+        LLSDSerialize::fromBinary(tree, binary_istr, binary.size());
+        const F64 binary_tree = seconds_since(start);
+        ensure_equals("binary tree size", tree.size(), (size_t)ITEMS);
+
+        start = std::chrono::steady_clock::now();
+        CountingVisitor binary_counter;
+        visit_binary(binary, binary_counter);
+        const F64 binary_visit = seconds_since(start);
+        ensure_equals("binary maps", binary_counter.mMaps, ITEMS);
+        ensure_equals("binary scalars", binary_counter.mScalars, ITEMS * 7);
+
+        start = std::chrono::steady_clock::now();
+        tree.clear();
+        std::istringstream xml_istr(xml);
+        LLSDSerialize::fromXML(tree, xml_istr);
+        const F64 xml_tree = seconds_since(start);
+        ensure_equals("xml tree size", tree.size(), (size_t)ITEMS);
+
+        start = std::chrono::steady_clock::now();
+        CountingVisitor xml_counter;
+        visit_xml(xml, xml_counter);
+        const F64 xml_visit = seconds_since(start);
+        ensure_equals("xml maps", xml_counter.mMaps, ITEMS);
+        ensure_equals("xml scalars", xml_counter.mScalars, ITEMS * 7);
+
+        LL_INFOS() << "Parsed " << ITEMS << " items. Binary (" << binary.size()
+                   << " bytes): tree " << binary_tree << "s, visitor " << binary_visit
+                   << "s. XML (" << xml.size() << " bytes): tree " << xml_tree
+                   << "s, visitor " << xml_visit << "s" << LL_ENDL;
+    }
+}
@@ -17,6 +17,8 @@
 // std headers
 #include <chrono>
 #include <deque>
+#include <stdexcept>
+#include <vector>
 // external library headers
 // other Linden headers
 #include "../test/lltut.h"
@@ -236,4 +238,27 @@ namespace tut
         ensure_equals("didn't run coroutine", stored, "ran");
         ensure("void waitForResult() didn't return", done);
     }
+
+    template<> template<>
+    void object::test<7>()
+    {
+        set_test_name("run_parallel with a throwing job");
+        // No queue by that name: every job runs on this thread
+        std::vector<U32> ran;
+        auto what{ catch_what<std::runtime_error>(
+                [&ran]()
+                {
+                    run_parallel("no such queue", 4,
+                                 [&ran](U32 index)
+                                 {
+                                     ran.push_back(index);
+                                     if (index == 1)
+                                     {
+                                         throw std::runtime_error("job 1 failed");
+                                     }
+                                 });
+                }) };
+        ensure_equals("exception not rethrown", what, "job 1 failed");
+        ensure_equals("jobs after the throw didn't run", ran.size(), size_t(4));
+    }
 } // namespace tut
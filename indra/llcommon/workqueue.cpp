@@ -15,9 +15,12 @@
 #include "workqueue.h"
 // STL headers
 // std headers
+#include <atomic>
+#include <mutex>
 // external library headers
 // other Linden headers
 #include "llapp.h"
+#include "llcond.h"
 #include "llcoros.h"
 #include LLCOROS_MUTEX_HEADER
 #include "llerror.h"
@@ -356,3 +359,71 @@ bool LL::WorkSchedule::tryPop_(Work& work)
 {
     return mQueue.tryPop(work);
 }
+
+/*****************************************************************************
+*   run_parallel()
+*****************************************************************************/
+void LL::run_parallel(const std::string& queue_name, U32 count,
+                      const std::function<void(U32)>& job)
+{
+    struct State
+    {
+        std::function<void(U32)>    mJob;
+        U32                         mCount;
+        std::atomic<U32>            mNext { 0 };
+        LLScalarCond<U32>           mDone { 0 };
+        std::mutex                  mExceptionMutex;
+        std::exception_ptr          mException; // first job that threw
+    };
+    auto state = std::make_shared<State>();
+    state->mJob = job;
+    state->mCount = count;
+
+    // Helpers that only get to run after everything is done find no work
+    // left and never touch mJob.
+    auto work = [state]()
+    {
+        for (U32 i = state->mNext++; i < state->mCount; i = state->mNext++)
+        {
+            // A job that throws still counts as done, or the caller would
+            // wait forever; the exception is rethrown on the calling thread.
+            try
+            {
+                state->mJob(i);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(state->mExceptionMutex);
+                if (!state->mException)
+                {
+                    state->mException = std::current_exception();
+                }
+            }
+            state->mDone.update_all([](U32& done) { ++done; });
+        }
+    };
+
+    WorkQueue::ptr_t queue = WorkQueue::getInstance(queue_name);
+    if (queue)
+    {
+        for (U32 i = 1; i < count; ++i)
+        {
+            if (!queue->post(work))
+            {
+                break;
+            }
+        }
+    }
+    work();
+    state->mDone.wait_equal(count);
+
+    std::exception_ptr exception;
+    {
+        std::lock_guard<std::mutex> lock(state->mExceptionMutex);
+        exception = state->mException;
+    }
+    if (exception)
+    {
+        std::rethrow_exception(exception);
+    }
+}
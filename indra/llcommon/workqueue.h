@@ -631,6 +631,17 @@ namespace LL
             (this, std::forward<CALLABLE>(callable), std::forward<ARGS>(args)...);
     }
 
+    /**
+     * Run job(0) ... job(count - 1) on the WorkQueue named queue_name and
+     * return once every job has completed. The calling thread takes its
+     * share of the jobs, so this never waits on a busy or closed queue; if
+     * there is no such queue, all jobs run on the calling thread. If jobs
+     * throw, the others still run and the first exception is rethrown once
+     * they are all done.
+     */
+    void run_parallel(const std::string& queue_name, U32 count,
+                      const std::function<void(U32)>& job);
+
 } // namespace LL
 
 #endif /* ! defined(LL_WORKQUEUE_H) */
@@ -153,6 +153,18 @@ constexpr int HTTP_CONNECTION_LIMIT_MAX = 256;
 constexpr long HTTP_PIPELINING_DEFAULT = 0L;
 constexpr long HTTP_PIPELINING_MAX = 20L;
 
+// <FS> HTTP/2 multiplexing
+// Concurrent streams per connection, 0 leaves HTTP/2 off.  The
+// upper limit is the usual server-side SETTINGS_MAX_CONCURRENT_STREAMS.
+constexpr long HTTP_HTTP2_STREAMS_DEFAULT = 0L;
+constexpr long HTTP_HTTP2_STREAMS_MAX = 100L;
+
+// Request priorities map onto HTTP/2 stream weights (priority + 1).
+// The default gives libcurl's default weight of 16.
+constexpr unsigned int HTTP_PRIORITY_DEFAULT = 15U;
+constexpr unsigned int HTTP_PRIORITY_MAX = 255U;
+// </FS>
+
 // Miscellaneous defaults
 constexpr bool HTTP_USE_RETRY_AFTER_DEFAULT = true;
 constexpr long HTTP_THROTTLE_RATE_DEFAULT = 0L;
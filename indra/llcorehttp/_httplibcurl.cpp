@@ -283,6 +283,31 @@ bool HttpLibcurl::cancel(HttpHandle handle)
 }
 
 
+// <FS> HTTP/2 multiplexing
+// Stream weight changes on a running transfer go out as a
+// PRIORITY frame the next time libcurl services the connection.
+bool HttpLibcurl::changePriority(HttpHandle handle, HttpRequest::priority_t priority)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
+    HttpOpRequest::ptr_t op = HttpOpRequest::fromHandle<HttpOpRequest>(handle);
+    active_set_t::iterator it(mActiveOps.find(op));
+    if (mActiveOps.end() == it)
+    {
+        return false;
+    }
+
+    op->mReqPriority = priority;
+    const HttpPolicyClass & options(mService->getPolicy().getClassOptions(op->mReqPolicy));
+    if (options.mHttp2Streams > 0 && op->mCurlHandle)
+    {
+        curl_easy_setopt(op->mCurlHandle, CURLOPT_STREAM_WEIGHT, long(priority + 1));
+    }
+
+    return true;
+}
+// </FS>
+
+
 // *NOTE:  cancelRequest logic parallels completeRequest logic.
 // Keep them synchronized as necessary.  Caller is expected to
 // remove the op from the active list and release the op *after*
@@ -542,6 +567,28 @@ void HttpLibcurl::policyUpdated(unsigned int policy_class)
         policy.stallPolicy(policy_class, false);
         mDirtyPolicy[policy_class] = false;
 
+        // <FS> HTTP/2 multiplexing
+        if (options.mHttp2Streams > 0)
+        {
+            // Streams on as few connections as the server allows.
+            // Connections that end up HTTP/1.1 don't pipeline.
+            check_curl_multi_setopt(multi_handle,
+                                     CURLMOPT_PIPELINING,
+                                     long(CURLPIPE_MULTIPLEX));
+#if LIBCURL_VERSION_NUM >= 0x074300
+            check_curl_multi_setopt(multi_handle,
+                                     CURLMOPT_MAX_CONCURRENT_STREAMS,
+                                     long(options.mHttp2Streams));
+#endif
+            check_curl_multi_setopt(multi_handle,
+                                     CURLMOPT_MAX_HOST_CONNECTIONS,
+                                     long(options.mPerHostConnectionLimit));
+            check_curl_multi_setopt(multi_handle,
+                                     CURLMOPT_MAX_TOTAL_CONNECTIONS,
+                                     long(options.mConnectionLimit));
+        }
+        else
+        // </FS>
         if (options.mPipelining > 1)
         {
             // We'll try to do pipelining on this multihandle
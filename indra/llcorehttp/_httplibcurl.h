@@ -118,6 +118,16 @@ public:
     /// Threading:  called by worker thread.
     bool cancel(HttpHandle handle);
 
+    // <FS> HTTP/2 multiplexing
+    /// Change the priority of an active request and, on an HTTP/2
+    /// policy class, the weight of its stream.
+    ///
+    /// @return         True if handle was found among the active requests.
+    ///
+    /// Threading:  called by worker thread.
+    bool changePriority(HttpHandle handle, HttpRequest::priority_t priority);
+    // </FS>
+
     /// Informs transport that a particular policy class has had
     /// options changed and so should effect any transport state
     /// change necessary to effect those changes.  Used mainly for
@@ -137,6 +137,7 @@ HttpOpRequest::HttpOpRequest()
       mReqLength(0),
       mReqHeaders(),
       mReqOptions(),
+      mReqPriority(HTTP_PRIORITY_DEFAULT), // <FS/> HTTP/2 multiplexing
       mCurlActive(false),
       mCurlHandle(NULL),
       mCurlService(NULL),
@@ -321,6 +322,7 @@ HttpStatus HttpOpRequest::setupGet(HttpRequest::policy_t policy_id,
 
 
 HttpStatus HttpOpRequest::setupGetByteRange(HttpRequest::policy_t policy_id,
+                                            HttpRequest::priority_t priority, // <FS/> HTTP/2 multiplexing
                                             const std::string & url,
                                             size_t offset,
                                             size_t len,
@@ -329,6 +331,7 @@ HttpStatus HttpOpRequest::setupGetByteRange(HttpRequest::policy_t policy_id,
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
     setupCommon(policy_id, url, NULL, options, headers);
+    mReqPriority = (std::min)(priority, HTTP_PRIORITY_MAX); // <FS/> HTTP/2 multiplexing
     mReqMethod = HOR_GET;
     mReqOffset = static_cast<off_t>(offset);
     mReqLength = len;
@@ -728,6 +731,19 @@ HttpStatus HttpOpRequest::prepareRequest(HttpService * service)
     {
         xfer_timeout = timeout;
     }
+    // <FS> HTTP/2 multiplexing
+    if (cpolicy.mHttp2Streams > 0L)
+    {
+        // HTTP/2 where TLS negotiates it, HTTP/1.1 otherwise.  Wait for
+        // a stream on an existing connection before opening another one.
+        // Streams don't queue behind each other so the pipelining
+        // timeout adjustment below doesn't apply.
+        check_curl_easy_setopt(mCurlHandle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+        check_curl_easy_setopt(mCurlHandle, CURLOPT_PIPEWAIT, 1L);
+        check_curl_easy_setopt(mCurlHandle, CURLOPT_STREAM_WEIGHT, long(mReqPriority + 1));
+    }
+    else
+    // </FS>
     if (cpolicy.mPipelining > 1L)
     {
         // Pipelining affects both connection and transfer timeout values.
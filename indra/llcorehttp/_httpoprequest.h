@@ -110,6 +110,7 @@ public:
                         const HttpHeaders::ptr_t & headers);
 
     HttpStatus setupGetByteRange(HttpRequest::policy_t policy_id,
+                                 HttpRequest::priority_t priority, // <FS/> HTTP/2 multiplexing
                                  const std::string & url,
                                  size_t offset,
                                  size_t len,
@@ -199,6 +200,7 @@ public:
     size_t              mReqLength;
     HttpHeaders::ptr_t  mReqHeaders;
     HttpOptions::ptr_t  mReqOptions;
+    HttpRequest::priority_t mReqPriority; // <FS/> HTTP/2 multiplexing
 
     // Transport data
     bool                mCurlActive;
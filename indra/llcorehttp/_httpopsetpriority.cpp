@@ -24,7 +24,9 @@
  * $/LicenseInfo$
  */
 
-#if 0 // DEPRECATED
+// <FS> HTTP/2 multiplexing: revived to carry stream weights
+//#if 0 // DEPRECATED
+// </FS>
 #include "_httpopsetpriority.h"
 
 #include "httpresponse.h"
@@ -63,4 +65,4 @@ void HttpOpSetPriority::stageFromRequest(HttpService * service)
 
 }   // end namespace LLCore
 
-#endif
+//#endif // <FS/> HTTP/2 multiplexing
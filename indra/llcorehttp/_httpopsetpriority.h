@@ -27,7 +27,9 @@
 #ifndef _LLCORE_HTTP_SETPRIORITY_H_
 #define _LLCORE_HTTP_SETPRIORITY_H_
 
-#if 0 // DEPRECATED
+// <FS> HTTP/2 multiplexing: revived to carry stream weights
+//#if 0 // DEPRECATED
+// </FS>
 #include "httpcommon.h"
 #include "httprequest.h"
 #include "_httpoperation.h"
@@ -43,13 +45,13 @@ namespace LLCore
 /// request handle and changing it's priority if
 /// found.
 ///
-/// *NOTE:  This will very likely be removed in the near future
-/// when priority is removed from the library.
+/// The ready queues no longer order by priority, the value is
+/// only used as the HTTP/2 stream weight of the request.
 
 class HttpOpSetPriority : public HttpOperation
 {
 public:
-    HttpOpSetPriority(HttpHandle handle);
+    HttpOpSetPriority(HttpHandle handle, HttpRequest::priority_t priority);
 
     virtual ~HttpOpSetPriority();
 
@@ -63,10 +65,11 @@ public:
 protected:
     // Request Data
     HttpHandle                  mHandle;
+    HttpRequest::priority_t     mPriority;
 }; // end class HttpOpSetPriority
 
 }  // end namespace LLCore
-#endif
+//#endif // <FS/> HTTP/2 multiplexing
 
 #endif  // _LLCORE_HTTP_SETPRIORITY_H_
 
@@ -249,10 +249,21 @@ HttpService::ELoopSpeed HttpPolicy::processReadyQueue()
         }
 
         int active(transport.getActiveCountInClass(policy_class));
-        int active_limit(state.mOptions.mPipelining > 1L
-                         ? (state.mOptions.mPerHostConnectionLimit
-                            * state.mOptions.mPipelining)
-                         : state.mOptions.mConnectionLimit);
+        // <FS> HTTP/2 multiplexing
+        //int active_limit(state.mOptions.mPipelining > 1L
+        //                 ? (state.mOptions.mPerHostConnectionLimit
+        //                    * state.mOptions.mPipelining)
+        //                 : state.mOptions.mConnectionLimit);
+        int active_limit(state.mOptions.mConnectionLimit);
+        if (state.mOptions.mHttp2Streams > 0L)
+        {
+            active_limit = state.mOptions.mPerHostConnectionLimit * state.mOptions.mHttp2Streams;
+        }
+        else if (state.mOptions.mPipelining > 1L)
+        {
+            active_limit = state.mOptions.mPerHostConnectionLimit * state.mOptions.mPipelining;
+        }
+        // </FS>
         int needed(active_limit - active);      // Expect negatives here
 
         if (needed > 0)
@@ -372,6 +383,41 @@ bool HttpPolicy::cancel(HttpHandle handle)
 }
 
 
+// <FS> HTTP/2 multiplexing
+bool HttpPolicy::changePriority(HttpHandle handle, HttpRequest::priority_t priority)
+{
+    for (int policy_class(0); policy_class < mClasses.size(); ++policy_class)
+    {
+        ClassState & state(*mClasses[policy_class]);
+
+        // Scan retry queue
+        HttpRetryQueue::container_type & c1(state.mRetryQueue.get_container());
+        for (HttpRetryQueue::container_type::iterator iter(c1.begin()); c1.end() != iter; ++iter)
+        {
+            if ((*iter)->getHandle() == handle)
+            {
+                (*iter)->mReqPriority = priority;
+                return true;
+            }
+        }
+
+        // Scan ready queue
+        HttpReadyQueue::container_type & c2(state.mReadyQueue.get_container());
+        for (HttpReadyQueue::container_type::iterator iter(c2.begin()); c2.end() != iter; ++iter)
+        {
+            if ((*iter)->getHandle() == handle)
+            {
+                (*iter)->mReqPriority = priority;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+// </FS>
+
+
 bool HttpPolicy::stageAfterCompletion(const HttpOpRequest::ptr_t &op)
 {
     // Retry or finalize
@@ -116,6 +116,15 @@ public:
     /// Threading:  called by worker thread
     bool cancel(HttpHandle handle);
 
+    // <FS> HTTP/2 multiplexing
+    /// Set the priority of a request still on the ready or retry
+    /// queues.  The queues keep their order, the priority is only
+    /// applied once the request starts.
+    ///
+    /// Threading:  called by worker thread
+    bool changePriority(HttpHandle handle, HttpRequest::priority_t priority);
+    // </FS>
+
     /// When transport is finished with an op and takes it off the
     /// active queue, it is delivered here for dispatch.  Policy
     /// may send it back to the ready/retry queues if it needs another
@@ -63,7 +63,8 @@ const HttpService::OptionDescriptor HttpService::sOptionDesc[] =
     {   true,       true,       true,       false,      false   },      // PO_TRACE
     {   true,       true,       false,      true,       false   },      // PO_ENABLE_PIPELINING
     {   true,       true,       false,      true,       false   },      // PO_THROTTLE_RATE
-    {   false,      false,      true,       false,      true    }       // PO_SSL_VERIFY_CALLBACK
+    {   false,      false,      true,       false,      true    },      // PO_SSL_VERIFY_CALLBACK
+    {   true,       true,       false,      true,       false   }       // PO_HTTP2_STREAMS // <FS/> HTTP/2 multiplexing
 };
 HttpService * HttpService::sInstance(NULL);
 volatile HttpService::EState HttpService::sState(NOT_INITIALIZED);
@@ -250,6 +251,22 @@ bool HttpService::cancel(HttpHandle handle)
 }
 
 
+// <FS> HTTP/2 multiplexing
+/// Threading:  callable by worker thread.
+bool HttpService::changePriority(HttpHandle handle, HttpRequest::priority_t priority)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
+    if (priority > HTTP_PRIORITY_MAX)
+    {
+        priority = HTTP_PRIORITY_MAX;
+    }
+
+    // Request can't be on request queue so skip that.
+    return mPolicy->changePriority(handle, priority) || mTransport->changePriority(handle, priority);
+}
+// </FS>
+
+
 /// Threading:  callable by worker thread.
 void HttpService::shutdown()
 {
@@ -154,6 +154,16 @@ public:
     /// Threading:  callable by worker thread.
     bool cancel(HttpHandle handle);
 
+    // <FS> HTTP/2 multiplexing
+    /// Try to find the given request handle on the policy queues or
+    /// among the active requests and change its priority.
+    ///
+    /// @return         True if the request was found.
+    ///
+    /// Threading:  callable by worker thread.
+    bool changePriority(HttpHandle handle, HttpRequest::priority_t priority);
+    // </FS>
+
     /// Threading:  callable by worker thread.
     HttpPolicy & getPolicy()
         {
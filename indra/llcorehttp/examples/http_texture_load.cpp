@@ -60,6 +60,7 @@ void usage(std::ostream & out);
 static int concurrency_limit(40);
 static int highwater(100);
 static int pipeline_depth(0);
+static int http2_streams(0); // <FS/> HTTP/2 multiplexing
 static int tracing(0);
 static char url_format[1024] = "http://example.com/some/path?texture_id=%s.texture";
 
@@ -121,6 +122,10 @@ public:
     int                         mRetriesHttp503;
     int                         mSuccesses;
     long                        mByteCount;
+    // <FS> HTTP/2 multiplexing
+    double                      mLatencyTotal;
+    double                      mLatencyMax;
+    // </FS>
     LLCore::HttpHeaders::ptr_t  mHeaders;
 };
 
@@ -167,7 +172,7 @@ int main(int argc, char** argv)
     bool do_verbose(false);
 
     int option(-1);
-    while (-1 != (option = getopt(argc, argv, "u:c:h?RwvH:p:t:")))
+    while (-1 != (option = getopt(argc, argv, "u:c:h?RwvH:p:t:2:")))
     {
         switch (option)
         {
@@ -221,6 +226,23 @@ int main(int argc, char** argv)
             }
             break;
 
+        // <FS> HTTP/2 multiplexing
+        case '2':
+            {
+                unsigned long value;
+                char * end;
+
+                value = strtoul(optarg, &end, 10);
+                if (value > 100 || *end != '\0')
+                {
+                    usage(std::cerr);
+                    return 1;
+                }
+                http2_streams = value;
+            }
+            break;
+        // </FS>
+
         case '5':
             {
                 unsigned long value;
@@ -291,6 +313,15 @@ int main(int argc, char** argv)
                                                    pipeline_depth,
                                                    NULL);
     }
+    // <FS> HTTP/2 multiplexing
+    if (http2_streams)
+    {
+        LLCore::HttpRequest::setStaticPolicyOption(LLCore::HttpRequest::PO_HTTP2_STREAMS,
+                                                   LLCore::HttpRequest::DEFAULT_POLICY_ID,
+                                                   http2_streams,
+                                                   NULL);
+    }
+    // </FS>
     if (tracing)
     {
         LLCore::HttpRequest::setStaticPolicyOption(LLCore::HttpRequest::PO_TRACE,
@@ -353,6 +384,15 @@ int main(int argc, char** argv)
               << std::endl;
     std::cout << "Retries: " << ws.mRetries << "  Retries on 503: " << ws.mRetriesHttp503
               << std::endl;
+    // <FS> HTTP/2 multiplexing
+    // Compare runs with and without -2 against the same server
+    const U64 wall_time(metrics.mEndWallTime - metrics.mStartWallTime);
+    std::cout << "Mean latency: " << (ws.mSuccesses ? 1000.0 * ws.mLatencyTotal / ws.mSuccesses : 0.0)
+              << " mS  Max latency: " << 1000.0 * ws.mLatencyMax
+              << " mS  Throughput: " << (wall_time ? (ws.mByteCount * 1000.0) / wall_time : 0.0)
+              << " KB/S"
+              << std::endl;
+    // </FS>
     std::cout << "User CPU: " << (metrics.mEndUTime - metrics.mStartUTime)
               << " uS  System CPU: " << (metrics.mEndSTime - metrics.mStartSTime)
               << " uS  Wall Time: "  << (metrics.mEndWallTime - metrics.mStartWallTime)
@@ -396,6 +436,9 @@ void usage(std::ostream & out)
         "                       Range:  [1..200]  Default:  " << highwater << "\n"
         " -p <depth>            If <depth> is positive, enables and sets pipelineing\n"
         "                       depth on HTTP requests.  Default:  " << pipeline_depth << "\n"
+        " -2 <streams>          If <streams> is positive, asks for HTTP/2 with up to\n"
+        "                       <streams> requests per connection.  Overrides -p.\n"
+        "                       Default:  " << http2_streams << "\n"
         " -t <level>            If <level> is positive ([1..3]), enables and sets HTTP\n"
         "                       tracing on HTTP requests.  Default:  " << tracing << "\n"
         " -v                    Verbose mode.  Issue some chatter while running\n"
@@ -422,7 +465,9 @@ WorkingSet::WorkingSet()
       mRetries(0),
       mRetriesHttp503(0),
       mSuccesses(0),
-      mByteCount(0L)
+      mByteCount(0L),
+      mLatencyTotal(0.0), // <FS/> HTTP/2 multiplexing
+      mLatencyMax(0.0) // <FS/> HTTP/2 multiplexing
 {
     mAssets.reserve(30000);
 
@@ -521,6 +566,14 @@ void WorkingSet::onCompleted(LLCore::HttpHandle handle, LLCore::HttpResponse * r
             LLCore::BufferArray * data(response->getBody());
             mByteCount += data ? static_cast<long>(data->size()) : 0L;
             ++mSuccesses;
+            // <FS> HTTP/2 multiplexing
+            LLCore::HttpResponse::TransferStats::ptr_t stats(response->getTransferStats());
+            if (stats)
+            {
+                mLatencyTotal += stats->mTotalTime;
+                mLatencyMax = (std::max)(mLatencyMax, stats->mTotalTime);
+            }
+            // </FS>
         }
         else
         {
@@ -33,6 +33,7 @@
 #include "_httpoperation.h"
 #include "_httpoprequest.h"
 #include "_httpopcancel.h"
+#include "_httpopsetpriority.h" // <FS/> HTTP/2 multiplexing
 #include "_httpopsetget.h"
 
 #include "lltimer.h"
@@ -215,12 +216,30 @@ HttpHandle HttpRequest::requestGetByteRange(policy_t policy_id,
                                             const HttpOptions::ptr_t & options,
                                             const HttpHeaders::ptr_t & headers,
                                             HttpHandler::ptr_t user_handler)
+// <FS> HTTP/2 multiplexing
+{
+    return requestGetByteRange(policy_id, HTTP_PRIORITY_DEFAULT, url, offset, len, options, headers, user_handler);
+}
+
+
+HttpHandle HttpRequest::requestGetByteRange(policy_t policy_id,
+                                            priority_t priority,
+                                            const std::string & url,
+                                            size_t offset,
+                                            size_t len,
+                                            const HttpOptions::ptr_t & options,
+                                            const HttpHeaders::ptr_t & headers,
+                                            HttpHandler::ptr_t user_handler)
+// </FS>
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
     HttpStatus status;
 
     HttpOpRequest::ptr_t op(new HttpOpRequest());
-    if (! (status = op->setupGetByteRange(policy_id, url, offset, len, options, headers)))
+    // <FS> HTTP/2 multiplexing
+    //if (! (status = op->setupGetByteRange(policy_id, url, offset, len, options, headers)))
+    if (! (status = op->setupGetByteRange(policy_id, priority, url, offset, len, options, headers)))
+    // </FS>
     {
         mLastReqStatus = status;
         return LLCORE_HTTP_HANDLE_INVALID;
@@ -476,6 +495,25 @@ HttpHandle HttpRequest::requestCancel(HttpHandle request, HttpHandler::ptr_t use
 }
 
 
+// <FS> HTTP/2 multiplexing
+HttpHandle HttpRequest::requestSetPriority(HttpHandle request, priority_t priority, HttpHandler::ptr_t user_handler)
+{
+    HttpStatus status;
+
+    HttpOperation::ptr_t op(new HttpOpSetPriority(request, priority));
+    op->setReplyPath(mReplyQueue, user_handler);
+    if (! (status = mRequestQueue->addOp(op)))          // transfers refcount
+    {
+        mLastReqStatus = status;
+        return LLCORE_HTTP_HANDLE_INVALID;
+    }
+
+    mLastReqStatus = status;
+    return op->getHandle();
+}
+// </FS>
+
+
 // ====================================
 // Utility Methods
 // ====================================
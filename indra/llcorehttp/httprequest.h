@@ -95,6 +95,7 @@ private:
 
 public:
     typedef unsigned int policy_t;
+    typedef unsigned int priority_t; // <FS/> HTTP/2 multiplexing
 
     typedef std::shared_ptr<HttpRequest> ptr_t;
     typedef std::weak_ptr<HttpRequest>   wptr_t;
@@ -232,6 +233,20 @@ public:
         /// Global only
         PO_SSL_VERIFY_CALLBACK,
 
+        // <FS> HTTP/2 multiplexing
+        /// Long value that if positive asks for HTTP/2 on this policy
+        /// class and sets the maximum number of concurrent streams on
+        /// a connection ([0..100]).  Requests wait for a connection
+        /// that can take another stream rather than opening a new one,
+        /// so PO_PER_HOST_CONNECTION_LIMIT then counts connections
+        /// rather than requests.  Servers that don't negotiate HTTP/2
+        /// are served over HTTP/1.1 without pipelining.  Takes
+        /// precedence over PO_PIPELINING_DEPTH.
+        ///
+        /// Per-class only
+        PO_HTTP2_STREAMS,
+        // </FS>
+
         PO_LAST  // Always at end
     };
 
@@ -389,6 +404,31 @@ public:
                                    const HttpHeaders::ptr_t & headers,
                                    HttpHandler::ptr_t handler);
 
+    // <FS> HTTP/2 multiplexing
+    /// As above but with an initial priority for the request.  On
+    /// HTTP/2 policy classes the stream is opened with that weight,
+    /// use requestSetPriority() only when the priority changes later.
+    ///
+    /// @param  policy_id       @see requestGet()
+    /// @param  priority        Initial priority, @see requestSetPriority()
+    /// @param  url             @see requestGetByteRange()
+    /// @param  offset          "
+    /// @param  len             "
+    /// @param  options         "
+    /// @param  headers         "
+    /// @param  handler         "
+    /// @return                 "
+    ///
+    HttpHandle requestGetByteRange(policy_t policy_id,
+                                   priority_t priority,
+                                   const std::string & url,
+                                   size_t offset,
+                                   size_t len,
+                                   const HttpOptions::ptr_t & options,
+                                   const HttpHeaders::ptr_t & headers,
+                                   HttpHandler::ptr_t handler);
+    // </FS>
+
 
     /// Queue a full HTTP POST.  Query arguments and body may
     /// be provided.  Caller is responsible for escaping and
@@ -575,6 +615,22 @@ public:
 
     HttpHandle requestCancel(HttpHandle request, HttpHandler::ptr_t);
 
+    // <FS> HTTP/2 multiplexing
+    /// Change the priority of a previously issued request.  Priorities
+    /// range over [0..255], higher is more urgent, and only matter on
+    /// HTTP/2 policy classes where they become the stream weight of
+    /// the request, including one already in flight.  The ready queues
+    /// stay first-come-first-served.  Completes with HE_HANDLE_NOT_FOUND
+    /// if the request has already finished.
+    ///
+    /// @param  request         Handle of the request to change
+    /// @param  priority        New priority, clamped to 255
+    /// @param  handler         @see requestGet()
+    /// @return                 "
+    ///
+    HttpHandle requestSetPriority(HttpHandle request, priority_t priority, HttpHandler::ptr_t handler);
+    // </FS>
+
     /// @}
 
     /// @name UtilityMethods
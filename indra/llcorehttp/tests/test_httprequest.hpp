@@ -3036,6 +3036,129 @@ void HttpRequestTestObjectType::test<23>()
 }
 
 
+// <FS> HTTP/2 multiplexing
+template <> template <>
+void HttpRequestTestObjectType::test<24>()
+{
+    ScopedCurlInit ready;
+
+    std::string url_base(get_base_url());
+    // std::cerr << "Base:  "  << url_base << std::endl;
+
+    set_test_name("HttpRequest GET and SetPriority on an HTTP/2 policy class");
+
+    // Handler can be stack-allocated *if* there are no dangling
+    // references to it after completion of this method.
+    // Create before memory record as the string copy will bump numbers.
+    TestHandler2 handler(this, "handler");
+    LLCore::HttpHandler::ptr_t handlerp(&handler, NoOpDeletor);
+    mHandlerCalls = 0;
+
+    HttpRequest * req = NULL;
+
+    try
+    {
+        // Get singletons created
+        HttpRequest::createService();
+
+        // Ask for HTTP/2.  The test server only speaks HTTP/1.1 in the
+        // clear so the requests must still work after falling back.
+        long streams(0);
+        HttpStatus status = HttpRequest::setStaticPolicyOption(HttpRequest::PO_HTTP2_STREAMS,
+                                                               HttpRequest::DEFAULT_POLICY_ID,
+                                                               1000L,
+                                                               &streams);
+        ensure("HTTP/2 stream limit accepted", bool(status));
+        ensure("HTTP/2 stream limit clamped", 100L == streams);
+
+        // Start threading early so that thread memory is invariant
+        // over the test.
+        HttpRequest::startThread();
+
+        // create a new ref counted object with an implicit reference
+        req = new HttpRequest();
+
+        // Issue a GET that *can* connect
+        mStatus = HttpStatus(200);
+        HttpHandle handle = req->requestGet(HttpRequest::DEFAULT_POLICY_ID,
+                                            url_base,
+                                            HttpOptions::ptr_t(),
+                                            HttpHeaders::ptr_t(),
+                                            handlerp);
+        ensure("Valid handle returned for get request", handle != LLCORE_HTTP_HANDLE_INVALID);
+
+        // Run the notification pump.
+        int count(0);
+        int limit(LOOP_COUNT_LONG);
+        while (count++ < limit && mHandlerCalls < 1)
+        {
+            req->update(1000000);
+            usleep(LOOP_SLEEP_INTERVAL);
+        }
+        ensure("Request executed in reasonable time", count < limit);
+        ensure("One handler invocation for request", mHandlerCalls == 1);
+
+        // The GET has completed so there is nothing left to reprioritize
+        mStatus = HttpStatus(HttpStatus::LLCORE, HE_HANDLE_NOT_FOUND);
+        HttpHandle handle2 = req->requestSetPriority(handle, 200U, handlerp);
+        ensure("Valid handle returned for priority request", handle2 != LLCORE_HTTP_HANDLE_INVALID);
+
+        // Run the notification pump again
+        count = 0;
+        limit = LOOP_COUNT_SHORT;
+        while (count++ < limit && mHandlerCalls < 2)
+        {
+            req->update(1000000);
+            usleep(LOOP_SLEEP_INTERVAL);
+        }
+        ensure("Priority request executed in reasonable time", count < limit);
+        ensure("Second handler invocation", mHandlerCalls == 2);
+
+        // Okay, request a shutdown of the servicing thread
+        mStatus = HttpStatus();
+        handle = req->requestStopThread(handlerp);
+        ensure("Valid handle returned for third request", handle != LLCORE_HTTP_HANDLE_INVALID);
+
+        // Run the notification pump again
+        count = 0;
+        limit = LOOP_COUNT_LONG;
+        while (count++ < limit && mHandlerCalls < 3)
+        {
+            req->update(1000000);
+            usleep(LOOP_SLEEP_INTERVAL);
+        }
+        ensure("Third request executed in reasonable time", count < limit);
+        ensure("Third handler invocation", mHandlerCalls == 3);
+
+        // See that we actually shutdown the thread
+        count = 0;
+        limit = LOOP_COUNT_SHORT;
+        while (count++ < limit && ! HttpService::isStopped())
+        {
+            usleep(LOOP_SLEEP_INTERVAL);
+        }
+        ensure("Thread actually stopped running", HttpService::isStopped());
+
+        // release the request object
+        delete req;
+        req = NULL;
+
+        // Shut down service
+        HttpRequest::destroyService();
+
+        ensure("Three handler calls on the way out", 3 == mHandlerCalls);
+    }
+    catch (...)
+    {
+        stop_thread(req);
+        delete req;
+        HttpRequest::destroyService();
+        throw;
+    }
+}
+// </FS>
+
+
 }  // end namespace tut
 
 namespace
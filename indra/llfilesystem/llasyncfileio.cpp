@@ -0,0 +1,532 @@
+/**
+ * @file llasyncfileio.cpp
+ * @brief Asynchronous whole-request file reads and writes for the caches.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llasyncfileio.h"
+
+#include "llapr.h"
+#include "lltimer.h"
+#include "threadpool.h"
+
+#if LL_LINUX && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define LL_IO_URING 1
+#endif
+#endif
+
+#if LL_IO_URING
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+constexpr U32 IO_URING_QUEUE_DEPTH = 256;
+constexpr size_t FALLBACK_THREADS = 4;
+
+LLAsyncFileIO* LLAsyncFileIO::sInstance = nullptr;
+
+struct LLAsyncFileIO::Operation
+{
+    std::string     mFileName;
+    U8*             mBuffer { nullptr };
+    S32             mOffset { 0 };
+    S32             mBytes { 0 };
+    S32             mTransferred { 0 };
+    bool            mWrite { false };
+    completion_t    mCompletion;
+#if LL_IO_URING
+    int             mFD { -1 };
+    struct iovec    mIov {};
+#endif
+};
+
+class LLAsyncFileIO::Backend
+{
+public:
+    explicit Backend(LLAsyncFileIO& owner) : mOwner(owner) {}
+    virtual ~Backend() = default;
+
+    virtual const char* getName() const = 0;
+    // Takes the operation; it must reach finish() exactly once
+    virtual void submit(Operation* op) = 0;
+    // Called once nothing is in flight any more
+    virtual void shutdown() = 0;
+
+protected:
+    void finish(Operation* op, S32 bytes) { mOwner.complete(op, bytes); }
+
+    // The same calls the cache threads used to make themselves
+    static S32 runBlocking(Operation* op)
+    {
+        if (op->mWrite)
+        {
+            return LLAPRFile::writeEx(op->mFileName, op->mBuffer, op->mOffset, op->mBytes);
+        }
+        return LLAPRFile::readEx(op->mFileName, op->mBuffer, op->mOffset, op->mBytes);
+    }
+
+private:
+    LLAsyncFileIO& mOwner;
+};
+
+//============================================================================
+// Blocking calls on a thread pool
+
+class LLAsyncFileIOThreadPool : public LLAsyncFileIO::Backend
+{
+public:
+    explicit LLAsyncFileIOThreadPool(LLAsyncFileIO& owner)
+    :   Backend(owner),
+        // Shut down by cleanupClass() once drained, not by the app shutdown event
+        mPool(new LL::ThreadPool("AsyncFileIO", FALLBACK_THREADS, 1024 * 1024, false))
+    {
+        mPool->start();
+    }
+
+    const char* getName() const override { return "thread pool"; }
+
+    void submit(LLAsyncFileIO::Operation* op) override
+    {
+        if (!mPool->getQueue().post([this, op]() { finish(op, runBlocking(op)); }))
+        {
+            finish(op, runBlocking(op)); // pool closed under us
+        }
+    }
+
+    void shutdown() override
+    {
+        mPool->close();
+    }
+
+private:
+    std::unique_ptr<LL::ThreadPool> mPool;
+};
+
+//============================================================================
+// io_uring, talked to directly: liburing is not part of our dependencies and
+// the subset needed here is small.
+
+#if LL_IO_URING
+class LLAsyncFileIOUring : public LLAsyncFileIO::Backend
+{
+public:
+    static LLAsyncFileIOUring* create(LLAsyncFileIO& owner, U32 depth)
+    {
+        std::unique_ptr<LLAsyncFileIOUring> ring(new LLAsyncFileIOUring(owner));
+        if (!ring->setup(depth))
+        {
+            return nullptr;
+        }
+        ring->mReaper = std::thread([ptr = ring.get()]() { ptr->reap(); });
+        return ring.release();
+    }
+
+    ~LLAsyncFileIOUring() override
+    {
+        if (mSQEs)
+        {
+            munmap(mSQEs, mSQEsSize);
+        }
+        if (mCQRing && mCQRing != mSQRing)
+        {
+            munmap(mCQRing, mCQRingSize);
+        }
+        if (mSQRing)
+        {
+            munmap(mSQRing, mSQRingSize);
+        }
+        if (mRingFD >= 0)
+        {
+            close(mRingFD);
+        }
+    }
+
+    const char* getName() const override { return "io_uring"; }
+
+    void submit(LLAsyncFileIO::Operation* op) override
+    {
+        int flags = O_CLOEXEC;
+        if (op->mWrite)
+        {
+            flags |= O_WRONLY | O_CREAT | (op->mOffset < 0 ? O_APPEND : 0);
+        }
+        else
+        {
+            flags |= O_RDONLY;
+        }
+        // Opening is a metadata lookup, cheap next to the transfer, and
+        // keeps this working on kernels without IORING_OP_OPENAT
+        op->mFD = open(op->mFileName.c_str(), flags, 0666);
+        if (op->mFD < 0)
+        {
+            finish(op, 0);
+            return;
+        }
+        op->mIov.iov_base = op->mBuffer;
+        op->mIov.iov_len = op->mBytes;
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        mSlotFree.wait(lock, [this]() { return mInFlight < mSQEntries; });
+        ++mInFlight;
+        queue(op);
+        enter(lock);
+    }
+
+    void shutdown() override
+    {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mQuitting = true;
+            queue(nullptr); // wakes the reaper
+            enter(lock);
+        }
+        mReaper.join();
+    }
+
+private:
+    explicit LLAsyncFileIOUring(LLAsyncFileIO& owner) : Backend(owner) {}
+
+    bool setup(U32 depth)
+    {
+        struct io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        mRingFD = (int)syscall(__NR_io_uring_setup, depth, &params);
+        if (mRingFD < 0)
+        {
+            LL_INFOS("AsyncFileIO") << "io_uring unavailable, errno " << errno << LL_ENDL;
+            return false;
+        }
+
+        mSQRingSize = params.sq_off.array + params.sq_entries * sizeof(U32);
+        mCQRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+#ifdef IORING_FEAT_SINGLE_MMAP
+        bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+#else
+        bool single_mmap = false;
+#endif
+        if (single_mmap)
+        {
+            mSQRingSize = mCQRingSize = llmax(mSQRingSize, mCQRingSize);
+        }
+
+        mSQRing = mmap(nullptr, mSQRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       mRingFD, IORING_OFF_SQ_RING);
+        if (mSQRing == MAP_FAILED)
+        {
+            mSQRing = nullptr;
+            return false;
+        }
+        if (single_mmap)
+        {
+            mCQRing = mSQRing;
+        }
+        else
+        {
+            mCQRing = mmap(nullptr, mCQRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                           mRingFD, IORING_OFF_CQ_RING);
+            if (mCQRing == MAP_FAILED)
+            {
+                mCQRing = nullptr;
+                return false;
+            }
+        }
+        mSQEsSize = params.sq_entries * sizeof(struct io_uring_sqe);
+        void* sqes = mmap(nullptr, mSQEsSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          mRingFD, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED)
+        {
+            return false;
+        }
+        mSQEs = (struct io_uring_sqe*)sqes;
+
+        U8* sq = (U8*)mSQRing;
+        mSQHead = (U32*)(sq + params.sq_off.head);
+        mSQTail = (U32*)(sq + params.sq_off.tail);
+        mSQMask = *(U32*)(sq + params.sq_off.ring_mask);
+        mSQArray = (U32*)(sq + params.sq_off.array);
+        mSQEntries = params.sq_entries;
+
+        U8* cq = (U8*)mCQRing;
+        mCQHead = (U32*)(cq + params.cq_off.head);
+        mCQTail = (U32*)(cq + params.cq_off.tail);
+        mCQMask = *(U32*)(cq + params.cq_off.ring_mask);
+        mCQEs = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+
+        return true;
+    }
+
+    // mMutex is held. A null op queues the shutdown wakeup.
+    void queue(LLAsyncFileIO::Operation* op)
+    {
+        U32 tail = *mSQTail; // only ever written by us
+        U32 index = tail & mSQMask;
+        struct io_uring_sqe* sqe = &mSQEs[index];
+        memset(sqe, 0, sizeof(*sqe));
+        if (op)
+        {
+            sqe->opcode = op->mWrite ? IORING_OP_WRITEV : IORING_OP_READV;
+            sqe->fd = op->mFD;
+            // With O_APPEND the kernel ignores the offset
+            sqe->off = llmax(0, op->mOffset) + op->mTransferred;
+            sqe->addr = (U64)(uintptr_t)&op->mIov;
+            sqe->len = 1;
+        }
+        else
+        {
+            sqe->opcode = IORING_OP_NOP;
+        }
+        sqe->user_data = (U64)(uintptr_t)op;
+        mSQArray[index] = index;
+        __atomic_store_n(mSQTail, tail + 1, __ATOMIC_RELEASE);
+    }
+
+    // mMutex is held. Hands everything queued so far to the kernel.
+    void enter(std::unique_lock<std::mutex>& lock)
+    {
+        while (true)
+        {
+            U32 to_submit = *mSQTail - __atomic_load_n(mSQHead, __ATOMIC_ACQUIRE);
+            if (!to_submit)
+            {
+                return;
+            }
+            int ret = (int)syscall(__NR_io_uring_enter, mRingFD, to_submit, 0, 0, nullptr, 0);
+            if (ret >= 0 || errno == EINTR)
+            {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EBUSY)
+            {
+                // Completion queue backed up; the reaper submits the rest
+                return;
+            }
+            LL_WARNS("AsyncFileIO") << "io_uring_enter failed, errno " << errno << LL_ENDL;
+            return;
+        }
+    }
+
+    void reap()
+    {
+        LL_PROFILER_SET_THREAD_NAME("AsyncFileIO");
+        while (true)
+        {
+            U32 head = *mCQHead; // only ever written by us
+            if (head == __atomic_load_n(mCQTail, __ATOMIC_ACQUIRE))
+            {
+                {
+                    std::unique_lock<std::mutex> lock(mMutex);
+                    if (mQuitting && !mInFlight)
+                    {
+                        return;
+                    }
+                    enter(lock); // anything left over by a busy ring
+                }
+                syscall(__NR_io_uring_enter, mRingFD, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+                continue;
+            }
+
+            struct io_uring_cqe cqe = mCQEs[head & mCQMask];
+            __atomic_store_n(mCQHead, head + 1, __ATOMIC_RELEASE);
+
+            LLAsyncFileIO::Operation* op = (LLAsyncFileIO::Operation*)(uintptr_t)cqe.user_data;
+            if (!op)
+            {
+                continue;
+            }
+
+            if (cqe.res > 0)
+            {
+                op->mTransferred += cqe.res;
+                if (op->mWrite && op->mTransferred < op->mBytes)
+                {
+                    // Short write, queue the remainder
+                    op->mIov.iov_base = op->mBuffer + op->mTransferred;
+                    op->mIov.iov_len = op->mBytes - op->mTransferred;
+                    std::unique_lock<std::mutex> lock(mMutex);
+                    queue(op);
+                    enter(lock);
+                    continue;
+                }
+            }
+            else if (cqe.res < 0)
+            {
+                LL_WARNS("AsyncFileIO") << "Unable to " << (op->mWrite ? "write" : "read") << " file: "
+                                        << op->mFileName << " errno " << -cqe.res << LL_ENDL;
+                op->mTransferred = 0;
+            }
+
+            close(op->mFD);
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                --mInFlight;
+            }
+            mSlotFree.notify_one();
+            finish(op, op->mTransferred);
+        }
+    }
+
+private:
+    int mRingFD { -1 };
+    void* mSQRing { nullptr };
+    size_t mSQRingSize { 0 };
+    void* mCQRing { nullptr };
+    size_t mCQRingSize { 0 };
+    struct io_uring_sqe* mSQEs { nullptr };
+    size_t mSQEsSize { 0 };
+
+    U32* mSQHead { nullptr };
+    U32* mSQTail { nullptr };
+    U32* mSQArray { nullptr };
+    U32 mSQMask { 0 };
+    U32 mSQEntries { 0 };
+    U32* mCQHead { nullptr };
+    U32* mCQTail { nullptr };
+    U32 mCQMask { 0 };
+    struct io_uring_cqe* mCQEs { nullptr };
+
+    std::mutex mMutex; // guards the submission queue and the counters below
+    std::condition_variable mSlotFree;
+    U32 mInFlight { 0 };
+    bool mQuitting { false };
+    std::thread mReaper;
+};
+#endif // LL_IO_URING
+
+//============================================================================
+
+// static
+void LLAsyncFileIO::initClass(bool allow_io_uring)
+{
+    llassert(sInstance == nullptr);
+    sInstance = new LLAsyncFileIO();
+#if LL_IO_URING
+    if (allow_io_uring)
+    {
+        sInstance->mBackend.reset(LLAsyncFileIOUring::create(*sInstance, IO_URING_QUEUE_DEPTH));
+    }
+#endif
+    if (!sInstance->mBackend)
+    {
+        sInstance->mBackend.reset(new LLAsyncFileIOThreadPool(*sInstance));
+    }
+    LL_INFOS("AsyncFileIO") << "Using " << sInstance->getBackendName() << LL_ENDL;
+}
+
+// static
+void LLAsyncFileIO::cleanupClass()
+{
+    if (!sInstance)
+    {
+        return;
+    }
+    sInstance->mClosed = true;
+    while (sInstance->mPending)
+    {
+        ms_sleep(1);
+    }
+    sInstance->mBackend->shutdown();
+    delete sInstance;
+    sInstance = nullptr;
+}
+
+LLAsyncFileIO::LLAsyncFileIO()
+{
+}
+
+LLAsyncFileIO::~LLAsyncFileIO()
+{
+}
+
+const char* LLAsyncFileIO::getBackendName() const
+{
+    return mBackend ? mBackend->getName() : "none";
+}
+
+bool LLAsyncFileIO::read(const std::string& filename, U8* buffer, S32 offset, S32 numbytes,
+                         completion_t completion)
+{
+    llassert(offset >= 0);
+    Operation* op = new Operation;
+    op->mFileName = filename;
+    op->mBuffer = buffer;
+    op->mOffset = llmax(0, offset);
+    op->mBytes = numbytes;
+    op->mCompletion = std::move(completion);
+    return submit(op);
+}
+
+bool LLAsyncFileIO::write(const std::string& filename, const U8* buffer, S32 offset, S32 numbytes,
+                          completion_t completion)
+{
+    Operation* op = new Operation;
+    op->mFileName = filename;
+    op->mBuffer = const_cast<U8*>(buffer); // never written to
+    op->mOffset = offset;
+    op->mBytes = numbytes;
+    op->mWrite = true;
+    op->mCompletion = std::move(completion);
+    return submit(op);
+}
+
+bool LLAsyncFileIO::submit(Operation* op)
+{
+    LL_PROFILE_ZONE_SCOPED;
+    // Counted before the check so cleanupClass() cannot miss it
+    ++mPending;
+    if (mClosed || !mBackend)
+    {
+        --mPending;
+        delete op;
+        return false;
+    }
+    if (!op->mBuffer || op->mBytes <= 0)
+    {
+        complete(op, 0);
+        return true;
+    }
+    mBackend->submit(op);
+    return true;
+}
+
+void LLAsyncFileIO::complete(Operation* op, S32 bytes)
+{
+    if (op->mCompletion)
+    {
+        op->mCompletion(bytes);
+    }
+    delete op;
+    --mPending;
+}
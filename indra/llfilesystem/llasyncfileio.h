@@ -0,0 +1,103 @@
+/**
+ * @file llasyncfileio.h
+ * @brief Asynchronous whole-request file reads and writes for the caches.
+ *
+ * @Description:
+ * The cache threads used to open, seek, read and close every file on the
+ * thread that wanted the data, so each read in flight tied up a thread.
+ * Operations submitted here complete on an I/O thread instead and the
+ * submitter is told through a callback.
+ * 1/ On Linux the operations go through io_uring: one thread keeps up to
+ *    queue depth requests in flight and reaps their completions.
+ * 2/ Everywhere else, or if the kernel refuses io_uring, a small thread
+ *    pool performs the same operations with blocking calls.
+ * 3/ Semantics match LLAPRFile::readEx()/writeEx(): a read may come back
+ *    short at the end of the file, a write never truncates and a negative
+ *    write offset appends.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLASYNCFILEIO_H
+#define LL_LLASYNCFILEIO_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+
+class LLAsyncFileIO
+{
+public:
+    /**
+     * Called on an I/O thread with the number of bytes transferred, 0 if
+     * the file could not be opened or the operation failed. It may also be
+     * called from the submitting thread before read()/write() returns.
+     * Keep it short, it holds up other completions.
+     */
+    typedef std::function<void(S32 bytes)> completion_t;
+
+    static void initClass(bool allow_io_uring = true);
+    static void cleanupClass(); // waits for the operations in flight
+    static LLAsyncFileIO* instance() { return sInstance; }
+
+    /**
+     * Read up to numbytes at offset into buffer, which must stay valid
+     * until the completion runs. Returns false if the operation was not
+     * queued, in which case the completion is never called.
+     */
+    bool read(const std::string& filename, U8* buffer, S32 offset, S32 numbytes,
+              completion_t completion);
+
+    /**
+     * Write numbytes from buffer at offset, or append if offset < 0.
+     * Same contract as read().
+     */
+    bool write(const std::string& filename, const U8* buffer, S32 offset, S32 numbytes,
+               completion_t completion);
+
+    size_t getPending() const { return mPending; }
+    const char* getBackendName() const;
+
+    struct Operation;
+    class Backend;
+
+private:
+    LLAsyncFileIO();
+    ~LLAsyncFileIO();
+
+    bool submit(Operation* op);
+    void complete(Operation* op, S32 bytes);
+
+    LLAsyncFileIO(const LLAsyncFileIO&) = delete;
+    LLAsyncFileIO& operator=(const LLAsyncFileIO&) = delete;
+
+private:
+    std::unique_ptr<Backend> mBackend;
+    std::atomic<size_t> mPending { 0 };
+    std::atomic<bool> mClosed { false };
+
+    static LLAsyncFileIO* sInstance;
+};
+
+#endif // LL_LLASYNCFILEIO_H
@@ -50,6 +50,8 @@
 static const std::string CACHE_FILENAME_PREFIX("sl_cache");
 
 std::string LLDiskCache::sCacheDir;
+LLDiskCacheIndex LLDiskCache::sIndex; // <FS/> Persistent cache index
+LLPackFileStore LLDiskCache::sPackStore; // <FS/> Small asset pack files
 
 // <FS:Ansariel> Optimize asset simple disk cache
 static const char* subdirs = "0123456789abcdef";
@@ -61,6 +63,7 @@ LLDiskCache::LLDiskCache(const std::string& cache_dir,
                          ,const F32 highwater_mark_percent
                          ,const F32 lowwater_mark_percent
 // </FS:Beq>
+                         ,const bool pack_small_assets // <FS/> Small asset pack files
                          ) :
     mMaxSizeBytes(max_size_bytes),
     mEnableCacheDebugInfo(enable_cache_debug_info)
@@ -75,6 +78,18 @@ LLDiskCache::LLDiskCache(const std::string& cache_dir,
         LLFile::mkdir(dirname);
     }
     // </FS:Ansariel>
+    // <FS> Persistent cache index. Load it before anything is added below.
+    sIndex.open(cache_dir);
+    // </FS>
+    // <FS> Small asset pack files. Packed assets stay readable if packing
+    // gets switched off, they are simply not added to any more.
+    const std::string pack_dir = cache_dir + gDirUtilp->getDirDelimiter() + "packs";
+    if (pack_small_assets || LLFile::isdir(pack_dir))
+    {
+        sPackStore.open(pack_dir);
+    }
+    sPackStore.setAcceptsWrites(pack_small_assets);
+    // </FS>
     // <FS:Beq> add static assets into the new cache after clear.
     // Only missing entries are copied on init, skiplist is setup
     // For everything we populate FS specific assets to allow future updates
@@ -112,219 +127,197 @@ LLDiskCache::LLDiskCache(const std::string& cache_dir,
 // asset will have to be re-requested.
 void LLDiskCache::purge()
 {
+    // <FS> Purge from the persistent cache index rather than walking, stat-ing
+    // and sorting every file in the cache directory each time.
+    LL_PROFILE_ZONE_SCOPED;
+    if (!sIndex.isValid())
+    {
+        // The purge thread builds the index first thing, try again next time
+        LL_INFOS("LLDiskCache") << "Cache index is not built yet, skipping purge" << LL_ENDL;
+        return;
+    }
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    sIndex.maintain();
+
+    const uintmax_t file_size_total = sIndex.getTotalSize();
+
+    // <FS:Beq> add high water/low water thresholds to reduce the churn in the cache.
+    LL_DEBUGS("LLDiskCache") << "Cache is " << (int)(((F32)file_size_total)/mMaxSizeBytes*100.0) << "% full" << LL_ENDL;
+    if( file_size_total < mMaxSizeBytes * (mHighPercent/100) )
+    {
+        // Nothing to do here
+        LL_DEBUGS("LLDiskCache") << "Not exceded high water - do nothing" << LL_ENDL;
+        updateCacheSize(file_size_total);
+        return;
+    }
+    // If we reach here we are above the trigger level so we must purge until we've removed enough to take us down to the low water mark.
+    auto target_size = (uintmax_t)(mMaxSizeBytes * (mLowPercent/100));
+    LL_INFOS() << "Purging cache to a maximum of " << target_size << " bytes" << LL_ENDL;
+    // </FS:Beq>
+
+    // <FS> Make sure static assets are not eliminated
+    auto is_static = [this](const LLUUID& id)
+    {
+        return std::find(mSkipList.begin(), mSkipList.end(), id.asString()) != mSkipList.end();
+    };
+
+    LLDiskCacheIndex::entry_list_t evicted;
+    U32 skip{ 0 };
+    sIndex.evict(target_size, is_static, evicted, skip);
+
+    uintmax_t deleted_size_total = 0;
+    for (const LLDiskCacheIndex::Entry& entry : evicted)
+    {
+        deleted_size_total += entry.mSize;
+        if (!sPackStore.remove(entry.mID)) // <FS/> Small asset pack files
+        {
+            LLFile::remove(metaDataToFilepath(entry.mID, entry.mType), ENOENT);
+        }
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto execute_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+
     if (mEnableCacheDebugInfo)
     {
-        LL_INFOS() << "Total dir size before purge is " << dirFileSize(sCacheDir) << LL_ENDL;
+        // Log afterward so it doesn't affect the time measurement
+        // Logging thousands of file results can take hundreds of milliseconds
+        uintmax_t deleted_so_far{ 0 };
+        for (const LLDiskCacheIndex::Entry& entry : evicted)
+        {
+            deleted_so_far += entry.mSize;
+
+            // have to do this because of LL_INFO/LL_END weirdness
+            std::ostringstream line;
+
+            line << "DELETE  ";
+            line << entry.mLastAccess << "  ";
+            line << entry.mSize << "  ";
+            line << entry.mID;
+            line << " (" << file_size_total - deleted_so_far << "/" << mMaxSizeBytes << ")";
+            LL_INFOS() << line.str() << LL_ENDL;
+        }
     }
 
-    boost::system::error_code ec;
+    auto newCacheSize = updateCacheSize(sIndex.getTotalSize());
+    LL_INFOS("LLDiskCache") << "Total dir size after purge is " << newCacheSize << LL_ENDL;
+    LL_INFOS("LLDiskCache") << "Cache purge took " << execute_time << " ms to execute for " << evicted.size() << " files" << LL_ENDL;
+    LL_INFOS("LLDiskCache") << "Deleted: " << evicted.size() << " Skipped: " << skip << " Kept: " << sIndex.getEntryCount() << LL_ENDL;
+    LL_INFOS("LLDiskCache") << "Total of " << deleted_size_total << " bytes removed." << LL_ENDL;
+    // </FS>
+}
+
+// <FS> Persistent cache index
+void LLDiskCache::rebuildIndex()
+{
+    LL_PROFILE_ZONE_SCOPED;
     auto start_time = std::chrono::high_resolution_clock::now();
 
-    typedef std::pair<std::time_t, std::pair<uintmax_t, std::string>> file_info_t;
-    std::vector<file_info_t> file_info;
+    LLDiskCacheIndex::entry_list_t scanned;
 
+    boost::system::error_code ec;
 #if LL_WINDOWS
     std::wstring cache_path(utf8str_to_utf16str(sCacheDir));
 #else
     std::string cache_path(sCacheDir);
 #endif
-    uintmax_t file_size_total = 0; // <FS:Beq/> try to make simple cache less naive.
-    
     if (boost::filesystem::is_directory(cache_path, ec) && !ec.failed())
     {
-        // <FS:Ansariel> Optimize asset simple disk cache
-        //boost::filesystem::directory_iterator iter(cache_path, ec);
-        //while (iter != boost::filesystem::directory_iterator() && !ec.failed())
         boost::filesystem::recursive_directory_iterator iter(cache_path, ec);
         while (iter != boost::filesystem::recursive_directory_iterator() && !ec.failed())
-        // </FS:Ansariel>
         {
             if (boost::filesystem::is_regular_file(*iter, ec) && !ec.failed())
             {
-                if ((*iter).path().string().find(CACHE_FILENAME_PREFIX) != std::string::npos)
+                const std::string file_name = (*iter).path().filename().string();
+                if (file_name.compare(0, CACHE_FILENAME_PREFIX.size(), CACHE_FILENAME_PREFIX) == 0)
                 {
                     uintmax_t file_size = boost::filesystem::file_size(*iter, ec);
-                    if (ec.failed())
+                    std::time_t file_time = 0;
+                    if (!ec.failed())
                     {
-                        continue;
+                        file_time = boost::filesystem::last_write_time(*iter, ec);
                     }
-                    const std::string file_path = (*iter).path().string();
-                    const std::time_t file_time = boost::filesystem::last_write_time(*iter, ec);
-                    if (ec.failed())
+
+                    LLDiskCacheIndex::Entry entry;
+                    // skip "sl_cache_" and trailing "_0.asset"
+                    if (!ec.failed() && entry.mID.set(file_name.substr(CACHE_FILENAME_PREFIX.size() + 1, UUID_STR_LENGTH - 1), false))
                     {
-                        continue;
+                        // The asset type is not part of the file name
+                        entry.mType = LLAssetType::AT_UNKNOWN;
+                        entry.mSize = file_size;
+                        entry.mLastAccess = (S64)file_time;
+                        scanned.push_back(entry);
                     }
-                    file_size_total += file_size; // <FS:Beq/> try to make simple cache less naive.
-
-                    file_info.push_back(file_info_t(file_time, { file_size, file_path }));
                 }
             }
             iter.increment(ec);
         }
     }
 
-    // <FS:Beq> add high water/low water thresholds to reduce the churn in the cache.
-    LL_DEBUGS("LLDiskCache") << "Cache is " << (int)(((F32)file_size_total)/mMaxSizeBytes*100.0) << "% full" << LL_ENDL;
-    if( file_size_total < mMaxSizeBytes * (mHighPercent/100) )
+    // <FS> Small asset pack files
+    LLPackFileStore::info_list_t packed;
+    sPackStore.getInfo(packed);
+    const S64 now = (S64)std::time(nullptr);
+    for (const LLPackFileStore::Info& info : packed)
     {
-        // Nothing to do here 
-        LL_DEBUGS("LLDiskCache") << "Not exceded high water - do nothing" << LL_ENDL;
-        return;
+        LLDiskCacheIndex::Entry entry;
+        entry.mID = info.mID;
+        entry.mType = info.mType;
+        entry.mSize = info.mSize;
+        entry.mLastAccess = now;
+        scanned.push_back(entry);
     }
-    // If we reach here we are above the trigger level so we must purge until we've removed enough to take us down to the low water mark.
-    // </FS:Beq>
-    std::sort(file_info.begin(), file_info.end(), [](file_info_t& x, file_info_t& y)
-    {
-        return x.first < y.first; // <FS:Beq/> sort oldest to newest, to we can remove the oldest files first.
-    });
-
+    // </FS>
 
-    // <FS:Beq> add high water/low water thresholds to reduce the churn in the cache.
-    auto target_size = (uintmax_t)(mMaxSizeBytes * (mLowPercent/100));
-    LL_INFOS() << "Purging cache to a maximum of " << target_size << " bytes" << LL_ENDL;
-    // </FS:Beq>
+    sIndex.rebuild(scanned);
 
-    // <FS:Beq> Extra accounting to track the retention of static assets
-    //std::vector<bool> file_removed;
-    enum class purge_action { delete_file=0, keep_file, skip_file };
-    std::map<std::string,purge_action> file_removed;
-    auto keep{file_info.size()};
-    auto del{0};
-    auto skip{0};
-    // </FS:Beq>
-    // <FS:Beq> revised purge logic to track amount removed not retained to shortern loop
-    // uintmax_t file_size_total = 0;
-    // if (mEnableCacheDebugInfo)
-    // {
-    //     file_removed.reserve(file_info.size());
-    // }
-    // uintmax_t file_size_total = 0;
-    // for (file_info_t& entry : file_info)
-    // {
-    //     file_size_total += entry.second.first;
-
-    //     bool should_remove = file_size_total > mMaxSizeBytes;
-    //     if (mEnableCacheDebugInfo)
-    //     {
-    //         file_removed.push_back(should_remove);
-    //     }
-    uintmax_t deleted_size_total = 0;
-    for (const file_info_t& entry : file_info)
-    {
-        // first check if we still need to delete more files
-        bool should_remove = (file_size_total - deleted_size_total) > target_size;
+    auto execute_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start_time).count();
+    LL_INFOS("LLDiskCache") << "Built cache index from " << scanned.size() << " files in " << execute_time << " ms" << LL_ENDL;
+    updateCacheSize(sIndex.getTotalSize());
+}
 
-        // <FS> Make sure static assets are not eliminated
-        auto action{ should_remove ? purge_action::delete_file : purge_action::keep_file };
-        if (!should_remove)
-        {
-            break;
-        }
+void LLDiskCache::cleanupSingleton()
+{
+    sIndex.close();
+    sPackStore.close(); // <FS/> Small asset pack files
+}
 
-        auto this_file_size = entry.second.first;
-        deleted_size_total += this_file_size;
-        auto uuid_as_string = gDirUtilp->getBaseFileName(entry.second.second, true);
-        uuid_as_string      = uuid_as_string.substr(CACHE_FILENAME_PREFIX.size() + 1, 36);  // skip "sl_cache_" and trailing "_N"
-        // LL_INFOS() << "checking UUID=" <<uuid_as_string<< LL_ENDL;
-        if (std::find(mSkipList.begin(), mSkipList.end(), uuid_as_string) != mSkipList.end())
-        {
-            // this is one of our protected items so no purging
-            should_remove = false;
-            action = purge_action::skip_file;
-            boost::filesystem::last_write_time(entry.second.second, ec);  // force these to the front of the list next time so that purge size works 
-            skip++;
-        }
-        else{
-            del++;
-        }
-        keep--;
-        if (mEnableCacheDebugInfo)
-        {
-            file_removed.emplace(entry.second.second, action);
-        }
-    // </FS>
-        if (should_remove)
-        {
-            boost::filesystem::remove(entry.second.second, ec);
-            if (ec.failed())
-            {
-                LL_WARNS() << "Failed to delete cache file " << entry.second.second << ": " << ec.message() << LL_ENDL;
-            }
-        }
-    }
-// <FS:Beq> update the debug logging to be more useful
-    auto end_time = std::chrono::high_resolution_clock::now();
-    auto execute_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
-// </FS:Beq>
-    if (mEnableCacheDebugInfo)
-    {
-        // <FS:Beq> update the debug logging to be more useful
-        // auto end_time = std::chrono::high_resolution_clock::now();
-        // auto execute_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
-        // </FS:Beq>
+// static
+void LLDiskCache::recordWrite(const LLUUID& id, LLAssetType::EType at, U64 size)
+{
+    sIndex.recordWrite(id, at, size);
+}
 
-        // Log afterward so it doesn't affect the time measurement
-        // Logging thousands of file results can take hundreds of milliseconds
-        uintmax_t deleted_so_far{ 0 }; // <FS:Beq/> update the debug logging to be more useful
-        for (size_t i = 0; i < file_info.size(); ++i)
-        {
-            const file_info_t& entry = file_info[i];
-            // <FS> Static asset stuff
-            deleted_so_far += entry.second.first; // <FS:Beq/> update the debug logging to be more useful
-            //const bool removed = file_removed[i];
-            //const std::string action = removed ? "DELETE:" : "KEEP:";
-            std::string action{};
-
-            // Check if the file exists in the map
-            auto& filename{ entry.second.second };
-            if (file_removed.find(filename) != file_removed.end()) {
-            // File found in the map, retrieve the corresponding enum value
-            switch (file_removed[filename])
-            {
-                case purge_action::delete_file:
-                    action = "DELETE";
-                    del++;
-                break;
-                case purge_action::skip_file:
-                    action = "STATIC";
-                    skip++;
-                break;
-                default:
-                // Handle any unexpected enum value
-                    action = "UNKNOWN";
-                break;
-            }
-            }
-            else 
-            {
-                action = "KEEP";
-            }            
-            // </FS>
+// static
+void LLDiskCache::recordRemove(const LLUUID& id)
+{
+    sIndex.recordRemove(id);
+}
 
-            // have to do this because of LL_INFO/LL_END weirdness
-            std::ostringstream line;
+// static
+void LLDiskCache::recordRename(const LLUUID& old_id, const LLUUID& new_id, LLAssetType::EType new_at)
+{
+    sIndex.recordRename(old_id, new_id, new_at);
+}
 
-            line << action << "  ";
-            line << entry.first << "  ";
-            line << entry.second.first << "  ";
-            line << entry.second.second;
-            line << " (" << file_size_total - deleted_so_far << "/" << mMaxSizeBytes << ")"; // <FS:Beq/> update the debug logging to be more useful
-            LL_INFOS() << line.str() << LL_ENDL;
-        }
-// <FS:Beq> make the summary stats more easily enabled.
-    }
-    // <FS:Beq> update the debug logging to be more useful
-        // LL_INFOS() << "Total dir size after purge is " << dirFileSize(sCacheDir) << LL_ENDL;
-        // LL_INFOS() << "Cache purge took " << execute_time << " ms to execute for " << file_info.size() << " files" << LL_ENDL;
+// static
+bool LLDiskCache::recordAccess(const LLUUID& id)
+{
+    // Same threshold LLFileSystem::updateFileAccessTime() uses for the file
+    // time stamps (see SL-14582); it also keeps the journal small.
+    constexpr std::time_t time_threshold = 1 * 60 * 60;
+    return sIndex.recordAccess(id, time_threshold);
+}
+// </FS>
 
-    auto newCacheSize = updateCacheSize(file_size_total - deleted_size_total); 
-    LL_INFOS("LLDiskCache") << "Total dir size after purge is " << newCacheSize << LL_ENDL; 
-    LL_INFOS("LLDiskCache") << "Cache purge took " << execute_time << " ms to execute for " << file_info.size() << " files" << LL_ENDL;
-// </FS:Beq>
-    LL_INFOS("LLDiskCache") << "Deleted: " << del << " Skipped: " << skip << " Kept: " << keep << LL_ENDL;    // <FS:Beq/> Extra accounting to track the retention of static assets
-    LL_INFOS("LLDiskCache") << "Total of " << deleted_size_total << " bytes removed." << LL_ENDL;    // <FS:Beq/> Extra accounting to track the retention of static assets
-    // } <FS:Beq/> this bracket was moved up a few lines.
+// <FS> Small asset pack files
+void LLDiskCache::compactPackFiles()
+{
+    sPackStore.compact();
 }
+// </FS>
 
 const std::string LLDiskCache::metaDataToFilepath(const LLUUID& id, LLAssetType::EType at)
 {
@@ -390,6 +383,16 @@ void LLDiskCache::prepopulateCacheWithStatic()
                     {
                         LL_WARNS("LLDiskCache") << "Failed to copy " << from_asset_file << " to " << to_asset_file << LL_ENDL;
                     }
+                    // <FS> Persistent cache index
+                    else
+                    {
+                        llstat file_stat;
+                        if (LLFile::stat(to_asset_file, &file_stat) == 0)
+                        {
+                            sIndex.recordWrite(uuid, LLAssetType::AT_UNKNOWN, file_stat.st_size);
+                        }
+                    }
+                    // </FS>
                 }
                 if (std::find(mSkipList.begin(), mSkipList.end(), uuid_as_string) == mSkipList.end())
                 {
@@ -442,6 +445,8 @@ void LLDiskCache::clearCache()
             }
             iter.increment(ec);
         }
+        sIndex.clear(); // <FS/> Persistent cache index
+        sPackStore.clear(); // <FS/> Small asset pack files
         // <FS:Beq> add static assets into the new cache after clear
     LL_INFOS() << "prepopulating new cache " << LL_ENDL;
         prepopulateCacheWithStatic();
@@ -508,6 +513,12 @@ uintmax_t LLDiskCache::dirFileSize(const std::string& dir, bool force)
         LL_DEBUGS("LLDiskCache") << "Using cached result: " << mStoredCacheSize << LL_ENDL;
         return mStoredCacheSize;
     }
+    // <FS> The cache index knows the size without a scan
+    if (dir == sCacheDir && sIndex.isValid())
+    {
+        return updateCacheSize(sIndex.getTotalSize());
+    }
+    // </FS>
 // </FS:Beq>
     uintmax_t total_file_size = 0;
 
@@ -565,8 +576,18 @@ void LLPurgeDiskCacheThread::run()
 {
     constexpr std::chrono::seconds CHECK_INTERVAL{60};
 
+    // <FS> Persistent cache index. Build it here rather than on the main
+    // thread, then purge right away since the startup purge was skipped.
+    if (!LLDiskCache::instance().isIndexValid())
+    {
+        LLDiskCache::instance().rebuildIndex();
+        LLDiskCache::instance().purge();
+    }
+    // </FS>
+
     while (LLApp::instance()->sleep(CHECK_INTERVAL))
     {
         LLDiskCache::instance().purge();
+        LLDiskCache::instance().compactPackFiles(); // <FS/> Small asset pack files
     }
 }
@@ -28,6 +28,11 @@
  *    directory, sorts them by date of last access (write) and then
  *    deletes any files based on age until the total size of all
  *    the files is less than the maximum size specified.
+ *    <FS> The list of files, their sizes and access times is now kept
+ *    in a persistent LLDiskCacheIndex that LLFileSystem updates as
+ *    files are written, read and removed, so purging no longer has to
+ *    walk and stat the whole cache directory. The directory is only
+ *    scanned to (re)build that index. </FS>
  * 4/ An LLSingleton idiom is used since there will only ever be
  *    a single cache and we want to access it from numerous places.
  * 5/ Performance on my modest system seems very acceptable. For
@@ -63,6 +68,8 @@
 #define _LLDISKCACHE
 
 #include "llsingleton.h"
+#include "lldiskcacheindex.h" // <FS/> Persistent cache index
+#include "llpackfilestore.h" // <FS/> Small asset pack files
 #include <chrono>
 using namespace std::chrono;
 
@@ -106,10 +113,20 @@ class LLDiskCache :
                      */
                     const F32 lowwater_mark_percent
                     // </FS:Beq>
+                    // <FS> Small asset pack files
+                    /**
+                     * Store small assets in a few large pack files rather
+                     * than one file each. Based on the setting at
+                     * 'FSDiskCachePackSmallAssets'
+                     */
+                    , const bool pack_small_assets
+                    // </FS>
                     );
 
         virtual ~LLDiskCache() = default;
 
+        void cleanupSingleton() override; // <FS/> Persistent cache index
+
     public:
         /**
          * Construct a filename and path to it based on the file meta data
@@ -152,6 +169,50 @@ class LLDiskCache :
 
         void removeOldVFSFiles();
 
+        // <FS> Persistent cache index
+        /**
+         * Record changes to the cache contents in the cache index. These are
+         * called by LLFileSystem from any thread.
+         */
+        static void recordWrite(const LLUUID& id, LLAssetType::EType at, U64 size);
+        static void recordRemove(const LLUUID& id);
+        static void recordRename(const LLUUID& old_id, const LLUUID& new_id, LLAssetType::EType new_at);
+
+        /**
+         * Update the last access time of a cached file in the index. Returns
+         * false if the index is not usable yet, in which case the caller must
+         * update the access time of the file itself.
+         */
+        static bool recordAccess(const LLUUID& id);
+
+        /**
+         * True once the index describes the cache contents and can be used
+         * for purging.
+         */
+        bool isIndexValid() const { return sIndex.isValid(); }
+
+        /**
+         * Build the index from the files in the cache directory. This is the
+         * one expensive operation left and only happens on first use or after
+         * the viewer did not shut down cleanly. Called by LLPurgeDiskCacheThread.
+         */
+        void rebuildIndex();
+        // </FS>
+
+        // <FS> Small asset pack files
+        /**
+         * The store holding small assets when packing is enabled. LLFileSystem
+         * checks it before falling back to the regular per asset files.
+         */
+        static LLPackFileStore& getPackStore() { return sPackStore; }
+
+        /**
+         * Reclaim the space of removed and replaced packed assets. Called by
+         * LLPurgeDiskCacheThread.
+         */
+        void compactPackFiles();
+        // </FS>
+
         // <FS:Ansariel> Better asset cache size control
         void setMaxSizeBytes(uintmax_t size) { mMaxSizeBytes = size; }
         // <FS:Beq> High/Low water control
@@ -195,6 +256,18 @@ class LLDiskCache :
          */
         static std::string sCacheDir;
 
+        /**
+         * <FS> The persistent index of the cache contents. Static for the
+         * same reason as sCacheDir: LLFileSystem updates it from worker
+         * threads without going through the singleton.
+         */
+        static LLDiskCacheIndex sIndex;
+
+        /**
+         * <FS> Small asset pack files. Static like sIndex.
+         */
+        static LLPackFileStore sPackStore;
+
         /**
          * When enabled, displays additional debugging information in
          * various parts of the code
@@ -0,0 +1,555 @@
+/**
+ * @file lldiskcacheindex.cpp
+ * @brief Persistent index of the asset disk cache contents.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "lldiskcacheindex.h"
+
+#include "lldir.h"
+
+// Note: none of these names may contain the "sl_cache" prefix, otherwise the
+// directory scans in LLDiskCache would treat them as cached assets.
+static const char INDEX_SNAPSHOT_NAME[] = "cache_index.snapshot";
+static const char INDEX_JOURNAL_NAME[] = "cache_index.journal";
+static const char INDEX_ROTATED_JOURNAL_NAME[] = "cache_index.journal.old";
+static const char INDEX_MARKER_NAME[] = "cache_index.open";
+
+static const U32 INDEX_SNAPSHOT_MAGIC = 0x58444943; // "CIDX"
+static const U32 INDEX_VERSION = 1;
+
+// Compact once the journal holds this many records and outnumbers the entries
+static const U32 MIN_JOURNAL_RECORDS_FOR_COMPACTION = 16384;
+
+namespace
+{
+    struct SnapshotHeader
+    {
+        U32 mMagic;
+        U32 mVersion;
+        U32 mRecordSize;
+        U32 mCount;
+    };
+}
+
+LLDiskCacheIndex::LLDiskCacheIndex()
+{
+    static_assert(sizeof(Record) == 40, "LLDiskCacheIndex::Record layout changed, bump INDEX_VERSION");
+}
+
+LLDiskCacheIndex::~LLDiskCacheIndex()
+{
+    if (mJournal)
+    {
+        LLFile::close(mJournal);
+        mJournal = nullptr;
+    }
+}
+
+std::string LLDiskCacheIndex::getSnapshotName() const
+{
+    return mCacheDir + gDirUtilp->getDirDelimiter() + INDEX_SNAPSHOT_NAME;
+}
+
+std::string LLDiskCacheIndex::getJournalName() const
+{
+    return mCacheDir + gDirUtilp->getDirDelimiter() + INDEX_JOURNAL_NAME;
+}
+
+std::string LLDiskCacheIndex::getRotatedJournalName() const
+{
+    return mCacheDir + gDirUtilp->getDirDelimiter() + INDEX_ROTATED_JOURNAL_NAME;
+}
+
+std::string LLDiskCacheIndex::getMarkerName() const
+{
+    return mCacheDir + gDirUtilp->getDirDelimiter() + INDEX_MARKER_NAME;
+}
+
+bool LLDiskCacheIndex::open(const std::string& cache_dir)
+{
+    LL_PROFILE_ZONE_SCOPED;
+    LLMutexLock lock(&mMutex);
+
+    mCacheDir = cache_dir;
+    mEntries.clear();
+    mLRU.clear();
+    mTotalSize = 0;
+    mJournalRecords = 0;
+
+    bool valid = true;
+    const std::string marker = getMarkerName();
+    if (LLFile::isfile(marker))
+    {
+        LL_INFOS("LLDiskCache") << "Disk cache index was not closed cleanly, it will be rebuilt" << LL_ENDL;
+        valid = false;
+    }
+    else if (!LLFile::isfile(getSnapshotName()) && !LLFile::isfile(getJournalName()))
+    {
+        LL_INFOS("LLDiskCache") << "No disk cache index found, it will be built" << LL_ENDL;
+        valid = false;
+    }
+    else
+    {
+        valid = replay(getSnapshotName(), true) &&
+                replay(getRotatedJournalName(), false) &&
+                replay(getJournalName(), false);
+        if (!valid)
+        {
+            LL_WARNS("LLDiskCache") << "Disk cache index is corrupt, it will be rebuilt" << LL_ENDL;
+        }
+    }
+
+    if (!valid)
+    {
+        mEntries.clear();
+        mLRU.clear();
+        mTotalSize = 0;
+    }
+    mValid = valid;
+
+    LLFILE* marker_file = LLFile::fopen(marker, "wb");
+    if (marker_file)
+    {
+        LLFile::close(marker_file);
+    }
+
+    // A stale journal is of no use once the index is going to be rebuilt
+    if (!valid)
+    {
+        LLFile::remove(getRotatedJournalName(), ENOENT);
+    }
+    mJournal = LLFile::fopen(getJournalName(), valid ? "ab" : "wb");
+    if (!mJournal)
+    {
+        LL_WARNS("LLDiskCache") << "Unable to open disk cache journal " << getJournalName() << LL_ENDL;
+    }
+
+    LL_INFOS("LLDiskCache") << "Disk cache index loaded " << mEntries.size() << " entries, "
+                            << mTotalSize << " bytes" << LL_ENDL;
+    return valid;
+}
+
+void LLDiskCacheIndex::close()
+{
+    if (!isOpen())
+    {
+        return;
+    }
+
+    compact();
+
+    LLMutexLock lock(&mMutex);
+    if (mJournal)
+    {
+        LLFile::close(mJournal);
+        mJournal = nullptr;
+    }
+
+    // Only a valid index may be trusted next session, otherwise leave the
+    // marker in place so the rebuild is retried.
+    if (mValid)
+    {
+        LLFile::remove(getMarkerName(), ENOENT);
+    }
+}
+
+bool LLDiskCacheIndex::replay(const std::string& filename, bool snapshot)
+{
+    LLFILE* file = LLFile::fopen(filename, "rb");
+    if (!file)
+    {
+        // A missing rotated journal or snapshot is normal
+        return true;
+    }
+
+    U32 expected = 0;
+    if (snapshot)
+    {
+        SnapshotHeader header;
+        if (fread(&header, sizeof(header), 1, file) != 1 ||
+            header.mMagic != INDEX_SNAPSHOT_MAGIC ||
+            header.mVersion != INDEX_VERSION ||
+            header.mRecordSize != sizeof(Record))
+        {
+            LLFile::close(file);
+            return false;
+        }
+        expected = header.mCount;
+    }
+
+    constexpr size_t RECORDS_PER_READ = 1024;
+    std::vector<Record> records(RECORDS_PER_READ);
+    U32 count = 0;
+    size_t read;
+    while ((read = fread(records.data(), sizeof(Record), RECORDS_PER_READ, file)) > 0)
+    {
+        for (size_t i = 0; i < read; ++i)
+        {
+            applyLocked(records[i]);
+        }
+        count += (U32)read;
+    }
+    LLFile::close(file);
+
+    if (snapshot)
+    {
+        return count == expected;
+    }
+
+    mJournalRecords += count;
+    // A torn record at the end of the journal is simply dropped
+    return true;
+}
+
+void LLDiskCacheIndex::applyLocked(const Record& record)
+{
+    Entry entry;
+    memcpy(entry.mID.mData, record.mID, UUID_BYTES);
+    entry.mType = (LLAssetType::EType)record.mType;
+    entry.mSize = record.mSize;
+    entry.mLastAccess = record.mLastAccess;
+
+    switch (record.mOp)
+    {
+        case OP_WRITE:
+            insertLocked(entry);
+            break;
+        case OP_ACCESS:
+        {
+            auto it = mEntries.find(entry.mID);
+            if (it != mEntries.end())
+            {
+                Entry updated = it->second;
+                updated.mLastAccess = entry.mLastAccess;
+                insertLocked(updated);
+            }
+            break;
+        }
+        case OP_REMOVE:
+            eraseLocked(entry.mID);
+            break;
+        default:
+            break;
+    }
+}
+
+void LLDiskCacheIndex::insertLocked(const Entry& entry)
+{
+    eraseLocked(entry.mID);
+    mEntries[entry.mID] = entry;
+    mLRU.emplace(entry.mLastAccess, entry.mID);
+    mTotalSize += entry.mSize;
+}
+
+void LLDiskCacheIndex::eraseLocked(const LLUUID& id)
+{
+    auto it = mEntries.find(id);
+    if (it != mEntries.end())
+    {
+        mLRU.erase(lru_key_t(it->second.mLastAccess, id));
+        mTotalSize -= it->second.mSize;
+        mEntries.erase(it);
+    }
+}
+
+void LLDiskCacheIndex::appendLocked(EOp op, const Entry& entry)
+{
+    if (!mJournal)
+    {
+        return;
+    }
+
+    Record record{};
+    record.mOp = op;
+    record.mType = (S32)entry.mType;
+    memcpy(record.mID, entry.mID.mData, UUID_BYTES);
+    record.mSize = entry.mSize;
+    record.mLastAccess = entry.mLastAccess;
+
+    if (fwrite(&record, sizeof(record), 1, mJournal) == 1)
+    {
+        ++mJournalRecords;
+    }
+}
+
+void LLDiskCacheIndex::rebuild(const entry_list_t& scanned)
+{
+    LL_PROFILE_ZONE_SCOPED;
+    {
+        LLMutexLock lock(&mMutex);
+        for (const Entry& entry : scanned)
+        {
+            // Anything recorded while the scan was running is more recent
+            if (mEntries.find(entry.mID) == mEntries.end())
+            {
+                insertLocked(entry);
+            }
+        }
+        mValid = true;
+    }
+
+    // Persist the result right away so a crash does not force another scan
+    compact();
+}
+
+void LLDiskCacheIndex::clear()
+{
+    LLMutexLock lock(&mMutex);
+    mEntries.clear();
+    mLRU.clear();
+    mTotalSize = 0;
+    mJournalRecords = 0;
+
+    if (mJournal)
+    {
+        LLFile::close(mJournal);
+        mJournal = LLFile::fopen(getJournalName(), "wb");
+    }
+    LLFile::remove(getRotatedJournalName(), ENOENT);
+    LLFile::remove(getSnapshotName(), ENOENT);
+
+    // An empty cache is trivially described by an empty index
+    mValid = true;
+}
+
+void LLDiskCacheIndex::recordWrite(const LLUUID& id, LLAssetType::EType type, U64 size)
+{
+    Entry entry;
+    entry.mID = id;
+    entry.mType = type;
+    entry.mSize = size;
+    entry.mLastAccess = (S64)std::time(nullptr);
+
+    LLMutexLock lock(&mMutex);
+    insertLocked(entry);
+    appendLocked(OP_WRITE, entry);
+}
+
+void LLDiskCacheIndex::recordRemove(const LLUUID& id)
+{
+    LLMutexLock lock(&mMutex);
+    if (mEntries.find(id) == mEntries.end() && mValid)
+    {
+        return;
+    }
+
+    eraseLocked(id);
+    Entry entry;
+    entry.mID = id;
+    appendLocked(OP_REMOVE, entry);
+}
+
+void LLDiskCacheIndex::recordRename(const LLUUID& old_id, const LLUUID& new_id, LLAssetType::EType new_type)
+{
+    LLMutexLock lock(&mMutex);
+    auto it = mEntries.find(old_id);
+    if (it == mEntries.end())
+    {
+        return;
+    }
+
+    Entry entry = it->second;
+    eraseLocked(old_id);
+    Entry removed;
+    removed.mID = old_id;
+    appendLocked(OP_REMOVE, removed);
+
+    entry.mID = new_id;
+    entry.mType = new_type;
+    entry.mLastAccess = (S64)std::time(nullptr);
+    insertLocked(entry);
+    appendLocked(OP_WRITE, entry);
+}
+
+bool LLDiskCacheIndex::recordAccess(const LLUUID& id, std::time_t access_threshold)
+{
+    if (!mValid)
+    {
+        return false;
+    }
+
+    const S64 now = (S64)std::time(nullptr);
+
+    LLMutexLock lock(&mMutex);
+    auto it = mEntries.find(id);
+    if (it == mEntries.end())
+    {
+        // Not in the cache; nothing to update
+        return true;
+    }
+
+    if (now - it->second.mLastAccess > (S64)access_threshold)
+    {
+        Entry entry = it->second;
+        entry.mLastAccess = now;
+        insertLocked(entry);
+        appendLocked(OP_ACCESS, entry);
+    }
+    return true;
+}
+
+void LLDiskCacheIndex::evict(U64 target_size, const std::function<bool(const LLUUID&)>& is_protected,
+                             entry_list_t& evicted, U32& protected_count)
+{
+    LL_PROFILE_ZONE_SCOPED;
+    LLMutexLock lock(&mMutex);
+
+    const S64 now = (S64)std::time(nullptr);
+    std::vector<Entry> refreshed;
+
+    auto it = mLRU.begin();
+    while (mTotalSize > target_size && it != mLRU.end())
+    {
+        const LLUUID id = it->second;
+        ++it;
+
+        auto entry_it = mEntries.find(id);
+        if (entry_it == mEntries.end())
+        {
+            continue;
+        }
+
+        Entry entry = entry_it->second;
+        if (is_protected && is_protected(id))
+        {
+            // Moving these to the back of the queue now would invalidate
+            // the iterator, so do it once the walk is over.
+            ++protected_count;
+            entry.mLastAccess = now;
+            refreshed.push_back(entry);
+            continue;
+        }
+
+        eraseLocked(id);
+        appendLocked(OP_REMOVE, entry);
+        evicted.push_back(entry);
+    }
+
+    for (const Entry& entry : refreshed)
+    {
+        insertLocked(entry);
+        appendLocked(OP_ACCESS, entry);
+    }
+}
+
+size_t LLDiskCacheIndex::getEntryCount()
+{
+    LLMutexLock lock(&mMutex);
+    return mEntries.size();
+}
+
+void LLDiskCacheIndex::maintain()
+{
+    bool needs_compaction = false;
+    {
+        LLMutexLock lock(&mMutex);
+        if (mJournal)
+        {
+            fflush(mJournal);
+        }
+        needs_compaction = mValid &&
+                           mJournalRecords > MIN_JOURNAL_RECORDS_FOR_COMPACTION &&
+                           mJournalRecords > mEntries.size();
+    }
+
+    if (needs_compaction)
+    {
+        compact();
+    }
+}
+
+void LLDiskCacheIndex::compact()
+{
+    LL_PROFILE_ZONE_SCOPED;
+    std::vector<Record> records;
+    {
+        // Take a copy of the entries and rotate the journal while locked.
+        // Everything recorded from here on lands in the fresh journal.
+        LLMutexLock lock(&mMutex);
+        if (!mJournal || !mValid)
+        {
+            return;
+        }
+
+        records.reserve(mEntries.size());
+        for (const auto& it : mEntries)
+        {
+            const Entry& entry = it.second;
+            Record record{};
+            record.mOp = OP_WRITE;
+            record.mType = (S32)entry.mType;
+            memcpy(record.mID, entry.mID.mData, UUID_BYTES);
+            record.mSize = entry.mSize;
+            record.mLastAccess = entry.mLastAccess;
+            records.push_back(record);
+        }
+
+        LLFile::close(mJournal);
+        LLFile::remove(getRotatedJournalName(), ENOENT);
+        LLFile::rename(getJournalName(), getRotatedJournalName());
+        mJournal = LLFile::fopen(getJournalName(), "ab");
+        mJournalRecords = 0;
+    }
+
+    const std::string snapshot = getSnapshotName();
+    const std::string temp_snapshot = snapshot + ".tmp";
+    LLFILE* file = LLFile::fopen(temp_snapshot, "wb");
+    if (!file)
+    {
+        LL_WARNS("LLDiskCache") << "Unable to write disk cache index snapshot " << temp_snapshot << LL_ENDL;
+        return;
+    }
+
+    SnapshotHeader header;
+    header.mMagic = INDEX_SNAPSHOT_MAGIC;
+    header.mVersion = INDEX_VERSION;
+    header.mRecordSize = sizeof(Record);
+    header.mCount = (U32)records.size();
+
+    bool success = fwrite(&header, sizeof(header), 1, file) == 1;
+    if (success && !records.empty())
+    {
+        success = fwrite(records.data(), sizeof(Record), records.size(), file) == records.size();
+    }
+    LLFile::close(file);
+
+    if (!success)
+    {
+        LL_WARNS("LLDiskCache") << "Failed writing disk cache index snapshot" << LL_ENDL;
+        LLFile::remove(temp_snapshot, ENOENT);
+        return;
+    }
+
+    LLFile::remove(snapshot, ENOENT);
+    if (LLFile::rename(temp_snapshot, snapshot) == 0)
+    {
+        // The rotated journal is now fully contained in the snapshot
+        LLFile::remove(getRotatedJournalName(), ENOENT);
+    }
+
+    LL_DEBUGS("LLDiskCache") << "Compacted disk cache index to " << records.size() << " entries" << LL_ENDL;
+}
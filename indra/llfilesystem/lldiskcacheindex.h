@@ -0,0 +1,179 @@
+/**
+ * @file lldiskcacheindex.h
+ * @brief Persistent index of the asset disk cache contents.
+ *
+ * @Description:
+ * Keeps an in-memory record (id, asset type, size, last access) of every
+ * file in the asset disk cache so that purging and size accounting never
+ * have to walk the cache directory.
+ * 1/ Every change is appended to a small binary journal as a fixed size
+ *    record. Records are absolute (not deltas) so replaying them is
+ *    idempotent.
+ * 2/ The journal is periodically folded into a compacted snapshot. The
+ *    journal is rotated before the snapshot is written, so a crash during
+ *    compaction only means replaying the rotated journal on next load.
+ * 3/ A marker file exists while the index is open. If it is found at
+ *    startup the previous session did not shut down cleanly, the journal
+ *    tail may be missing and the index has to be rebuilt from the
+ *    directory (once, on the purge thread).
+ * 4/ Entries are also kept ordered by last access time so that eviction
+ *    costs O(evicted entries) rather than O(cache size).
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLDISKCACHEINDEX_H
+#define LL_LLDISKCACHEINDEX_H
+
+#include "llassettype.h"
+#include "llfile.h"
+#include "llmutex.h"
+#include "lluuid.h"
+
+#include <atomic>
+#include <ctime>
+#include <functional>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+class LLDiskCacheIndex
+{
+public:
+    struct Entry
+    {
+        LLUUID              mID;
+        LLAssetType::EType  mType { LLAssetType::AT_UNKNOWN };
+        U64                 mSize { 0 };
+        S64                 mLastAccess { 0 };
+    };
+    typedef std::vector<Entry> entry_list_t;
+
+    LLDiskCacheIndex();
+    ~LLDiskCacheIndex();
+
+    /**
+     * Open the index stored in cache_dir. Returns true if the stored index
+     * is trustworthy; false means the caller must rebuild it via
+     * rebuild() before it is used for purging.
+     */
+    bool open(const std::string& cache_dir);
+
+    /**
+     * Compact the journal into the snapshot and mark the index as cleanly
+     * closed. Nothing is recorded after this.
+     */
+    void close();
+
+    bool isOpen() const { return mJournal != nullptr; }
+    bool isValid() const { return mValid; }
+
+    /**
+     * Replace the index contents with the result of a directory scan. Entries
+     * recorded while the scan was running are kept.
+     */
+    void rebuild(const entry_list_t& scanned);
+
+    /**
+     * Drop every entry and truncate the stored index (used when the cache
+     * itself is cleared).
+     */
+    void clear();
+
+    // Called by LLFileSystem whenever the cache contents change
+    void recordWrite(const LLUUID& id, LLAssetType::EType type, U64 size);
+    void recordRemove(const LLUUID& id);
+    void recordRename(const LLUUID& old_id, const LLUUID& new_id, LLAssetType::EType new_type);
+
+    /**
+     * Update the last access time of an entry. Returns false if the index
+     * cannot answer (not valid yet) so the caller can fall back to touching
+     * the file itself. Updates younger than access_threshold seconds are
+     * ignored to keep the journal small.
+     */
+    bool recordAccess(const LLUUID& id, std::time_t access_threshold);
+
+    /**
+     * Pick the least recently used entries whose removal brings the total
+     * size down to target_size. Entries for which is_protected returns true
+     * are never picked; their access time is refreshed instead so they stop
+     * blocking the head of the queue. The picked entries are removed from
+     * the index; deleting the files is up to the caller.
+     */
+    void evict(U64 target_size, const std::function<bool(const LLUUID&)>& is_protected,
+               entry_list_t& evicted, U32& protected_count);
+
+    U64 getTotalSize() const { return mTotalSize; }
+    size_t getEntryCount();
+
+    /**
+     * Flush the journal to disk and, when it has grown large compared to the
+     * number of entries, fold it into a new snapshot.
+     */
+    void maintain();
+
+private:
+    enum EOp : U8
+    {
+        OP_WRITE = 1,
+        OP_ACCESS = 2,
+        OP_REMOVE = 3,
+    };
+
+    // On-disk record used by both the journal and the snapshot
+    struct Record
+    {
+        U8  mOp;
+        U8  mPad[3];
+        S32 mType;
+        U8  mID[UUID_BYTES];
+        U64 mSize;
+        S64 mLastAccess;
+    };
+
+    typedef std::pair<S64, LLUUID> lru_key_t;
+
+    void applyLocked(const Record& record);
+    void insertLocked(const Entry& entry);
+    void eraseLocked(const LLUUID& id);
+    void appendLocked(EOp op, const Entry& entry);
+    bool replay(const std::string& filename, bool snapshot);
+    void compact();
+
+    std::string getSnapshotName() const;
+    std::string getJournalName() const;
+    std::string getRotatedJournalName() const;
+    std::string getMarkerName() const;
+
+private:
+    LLMutex                             mMutex;
+    std::string                         mCacheDir;
+    std::unordered_map<LLUUID, Entry>   mEntries;
+    std::set<lru_key_t>                 mLRU;
+    std::atomic<U64>                    mTotalSize { 0 };
+    std::atomic<bool>                   mValid { false };
+    LLFILE*                             mJournal { nullptr };
+    U32                                 mJournalRecords { 0 };
+};
+
+#endif // LL_LLDISKCACHEINDEX_H
@@ -36,6 +36,13 @@
 
 #include "boost/filesystem.hpp"
 
+// <FS> Zero-copy cache reads
+#include <atomic>
+#if LL_WINDOWS
+#include "llwin32headers.h"
+#endif
+// </FS>
+
 constexpr S32 LLFileSystem::READ        = 0x00000001;
 constexpr S32 LLFileSystem::WRITE       = 0x00000002;
 constexpr S32 LLFileSystem::READ_WRITE  = 0x00000003;  // LLFileSystem::READ & LLFileSystem::WRITE
@@ -56,6 +63,14 @@ LLFileSystem::LLFileSystem(const LLUUID& file_id, const LLAssetType::EType file_
     // we decided to follow Henri's suggestion and move the code to update the last access time here.
     if (mode == LLFileSystem::READ)
     {
+        // <FS> Persistent cache index. The index tracks the last access time
+        // itself, only touch the file while the index is still being built.
+        if (LLDiskCache::recordAccess(mFileID))
+        {
+            return;
+        }
+        // </FS>
+
         // build the filename (TODO: we do this in a few places - perhaps we should factor into a single function)
         const std::string filename = LLDiskCache::metaDataToFilepath(mFileID, mFileType);
 
@@ -75,6 +90,13 @@ LLFileSystem::LLFileSystem(const LLUUID& file_id, const LLAssetType::EType file_
 bool LLFileSystem::getExists(const LLUUID& file_id, const LLAssetType::EType file_type)
 {
     LL_PROFILE_ZONE_SCOPED;
+    // <FS> Small asset pack files
+    if (S32 packed_size = LLDiskCache::getPackStore().getSize(file_id); packed_size >= 0)
+    {
+        return packed_size > 0;
+    }
+    // </FS>
+
     const std::string filename = LLDiskCache::metaDataToFilepath(file_id, file_type);
 
     // <FS:Ansariel> IO-streams replacement
@@ -98,9 +120,18 @@ bool LLFileSystem::getExists(const LLUUID& file_id, const LLAssetType::EType fil
 bool LLFileSystem::removeFile(const LLUUID& file_id, const LLAssetType::EType file_type, int suppress_error /*= 0*/)
 {
     LL_PROFILE_ZONE_COLOR(tracy::Color::Gold); // <FS:Beq> measure cache performance
+    // <FS> Small asset pack files
+    if (LLDiskCache::getPackStore().remove(file_id))
+    {
+        LLDiskCache::recordRemove(file_id);
+        return true;
+    }
+    // </FS>
+
     const std::string filename = LLDiskCache::metaDataToFilepath(file_id, file_type);
 
     LLFile::remove(filename.c_str(), suppress_error);
+    LLDiskCache::recordRemove(file_id); // <FS/> Persistent cache index
 
     return true;
 }
@@ -116,6 +147,14 @@ bool LLFileSystem::renameFile(const LLUUID& old_file_id, const LLAssetType::ETyp
     // Rename needs the new file to not exist.
     LLFileSystem::removeFile(new_file_id, new_file_type, ENOENT);
 
+    // <FS> Small asset pack files
+    if (LLDiskCache::getPackStore().rename(old_file_id, new_file_id, new_file_type))
+    {
+        LLDiskCache::recordRename(old_file_id, new_file_id, new_file_type);
+        return true;
+    }
+    // </FS>
+
     if (LLFile::rename(old_filename, new_filename) != 0)
     {
         // We would like to return false here indicating the operation
@@ -124,6 +163,12 @@ bool LLFileSystem::renameFile(const LLUUID& old_file_id, const LLAssetType::ETyp
         //return false;
         LL_WARNS() << "Failed to rename " << old_file_id << " to " << new_file_id << " reason: " << strerror(errno) << LL_ENDL;
     }
+    // <FS> Persistent cache index
+    else
+    {
+        LLDiskCache::recordRename(old_file_id, new_file_id, new_file_type);
+    }
+    // </FS>
 
     return true;
 }
@@ -134,6 +179,13 @@ S32 LLFileSystem::getFileSize(const LLUUID& file_id, const LLAssetType::EType fi
     LL_PROFILE_ZONE_COLOR(tracy::Color::Gold); // <FS:Beq> measure cache performance
     const std::string filename = LLDiskCache::metaDataToFilepath(file_id, file_type);
 
+    // <FS> Small asset pack files
+    if (S32 packed_size = LLDiskCache::getPackStore().getSize(file_id); packed_size >= 0)
+    {
+        return packed_size;
+    }
+    // </FS>
+
     S32 file_size = 0;
     // <FS:Ansariel> IO-streams replacement
     //llifstream file(filename, std::ios::binary);
@@ -157,6 +209,15 @@ bool LLFileSystem::read(U8* buffer, S32 bytes)
     LL_PROFILE_ZONE_COLOR(tracy::Color::Gold); // <FS:Beq> measure cache performance
     bool success = false;
 
+    // <FS> Small asset pack files
+    if (S32 packed_read = LLDiskCache::getPackStore().read(mFileID, mPosition, buffer, bytes); packed_read >= 0)
+    {
+        mBytesRead = packed_read;
+        mPosition += mBytesRead;
+        return mBytesRead > 0;
+    }
+    // </FS>
+
     const std::string filename = LLDiskCache::metaDataToFilepath(mFileID, mFileType);
 
     // <FS:Ansariel> IO-streams replacement
@@ -206,6 +267,39 @@ bool LLFileSystem::read(U8* buffer, S32 bytes)
     return success;
 }
 
+// <FS> Zero-copy cache reads
+LLFileView::ptr_t LLFileSystem::readView(S32 bytes)
+{
+    LL_PROFILE_ZONE_COLOR(tracy::Color::Gold);
+    mBytesRead = 0;
+
+    LLFileView::ptr_t view;
+    if (S32 packed_size = LLDiskCache::getPackStore().getSize(mFileID); packed_size >= 0)
+    {
+        // Packed assets are small, a copy is as cheap as it gets
+        view = LLFileView::allocate(llmin(bytes, packed_size - mPosition));
+        if (view)
+        {
+            S32 packed_read = LLDiskCache::getPackStore().read(mFileID, mPosition, view->getData(), view->getSize());
+            view->truncate(packed_read);
+        }
+    }
+    else
+    {
+        view = LLFileView::open(LLDiskCache::metaDataToFilepath(mFileID, mFileType), mPosition, bytes);
+    }
+
+    if (!view || view->getSize() <= 0)
+    {
+        return nullptr;
+    }
+
+    mBytesRead = view->getSize();
+    mPosition += mBytesRead;
+    return view;
+}
+// </FS>
+
 S32 LLFileSystem::getLastBytesRead() const
 {
     LL_PROFILE_ZONE_COLOR(tracy::Color::Gold); // <FS:Beq> measure cache performance
@@ -218,9 +312,55 @@ bool LLFileSystem::eof() const
     return mPosition >= getSize();
 }
 
+// <FS> Zero-copy cache reads
+// Truncating a cache file in place would pull the pages out from under an
+// LLFileView still mapping it (SIGBUS on POSIX, and Windows refuses to
+// truncate a mapped file at all). Give the new contents a fresh file
+// instead, the old one lives on until the last view is gone. Returns the
+// number of bytes written, -1 if the file could not be replaced.
+static S32 overwrite_file(const std::string& filename, const U8* buffer, S32 bytes)
+{
+#if LL_WINDOWS
+    // Views open their files with FILE_SHARE_DELETE, so a complete copy can
+    // be renamed over them.
+    static std::atomic<U32> sTempCounter{ 0 };
+    const std::string temp_filename = filename + llformat(".%u.tmp", sTempCounter++);
+    LLFILE* ofs = LLFile::fopen(temp_filename, "wb");
+#else
+    LLFile::remove(filename, ENOENT);
+    LLFILE* ofs = LLFile::fopen(filename, "wb");
+#endif
+    if (!ofs)
+    {
+        return -1;
+    }
+    S32 bytes_written = bytes > 0 ? static_cast<S32>(fwrite(buffer, 1, bytes, ofs)) : 0;
+    fclose(ofs);
+
+#if LL_WINDOWS
+    llutf16string utf16temp = utf8str_to_utf16str(temp_filename);
+    llutf16string utf16filename = utf8str_to_utf16str(filename);
+    if (!MoveFileExW((LPCWSTR)utf16temp.c_str(), (LPCWSTR)utf16filename.c_str(), MOVEFILE_REPLACE_EXISTING))
+    {
+        LL_WARNS("LLFileSystem") << "Could not replace " << filename << ", error " << GetLastError() << LL_ENDL;
+        LLFile::remove(temp_filename, ENOENT);
+        return -1;
+    }
+#endif
+    return bytes_written;
+}
+// </FS>
+
 bool LLFileSystem::write(const U8* buffer, S32 bytes)
 {
     LL_PROFILE_ZONE_COLOR(tracy::Color::Gold); // <FS:Beq> measure cache performance
+    // <FS> Small asset pack files
+    if (writePacked(buffer, bytes))
+    {
+        return true;
+    }
+    // </FS>
+
     const std::string filename = LLDiskCache::metaDataToFilepath(mFileID, mFileType);
 
     bool success = false;
@@ -273,6 +413,7 @@ bool LLFileSystem::write(const U8* buffer, S32 bytes)
     //        success = true;
     //    }
     //}
+    S32 file_size = -1; // <FS/> Persistent cache index
     if (mMode == APPEND)
     {
         LLFILE* ofs = LLFile::fopen(filename, "a+b");
@@ -282,6 +423,7 @@ bool LLFileSystem::write(const U8* buffer, S32 bytes)
             mPosition = ftell(ofs);
             fclose(ofs);
             success = (bytes_written == bytes);
+            file_size = mPosition; // <FS/> Persistent cache index
         }
     }
     else if (mMode == READ_WRITE)
@@ -293,38 +435,116 @@ bool LLFileSystem::write(const U8* buffer, S32 bytes)
             {
                 S32 bytes_written = static_cast<S32>(fwrite(buffer, 1, bytes, ofs));
                 mPosition = ftell(ofs);
+                // <FS> Persistent cache index; the write may not have been at the end
+                if (fseek(ofs, 0, SEEK_END) == 0)
+                {
+                    file_size = ftell(ofs);
+                }
+                // </FS>
                 fclose(ofs);
                 success = (bytes_written == bytes);
             }
         }
         else
         {
-            ofs = LLFile::fopen(filename, "wb");
-            if (ofs)
+            S32 bytes_written = overwrite_file(filename, buffer, bytes);
+            if (bytes_written >= 0)
             {
-                S32 bytes_written = static_cast<S32>(fwrite(buffer, 1, bytes, ofs));
-                mPosition = ftell(ofs);
-                fclose(ofs);
+                mPosition = bytes_written;
                 success = (bytes_written == bytes);
+                file_size = mPosition; // <FS/> Persistent cache index
             }
         }
     }
     else
     {
-        LLFILE* ofs = LLFile::fopen(filename, "wb");
-        if (ofs)
+        S32 bytes_written = overwrite_file(filename, buffer, bytes);
+        if (bytes_written >= 0)
         {
-            S32 bytes_written = static_cast<S32>(fwrite(buffer, 1, bytes, ofs));
-            mPosition = ftell(ofs);
-            fclose(ofs);
+            mPosition = bytes_written;
             success = (bytes_written == bytes);
+            file_size = mPosition; // <FS/> Persistent cache index
         }
     }
     // </FS:Ansariel>
 
+    // <FS> Persistent cache index
+    if (file_size >= 0)
+    {
+        LLDiskCache::recordWrite(mFileID, mFileType, (U64)file_size);
+    }
+    // </FS>
+
     return success;
 }
 
+// <FS> Small asset pack files
+bool LLFileSystem::writePacked(const U8* buffer, S32 bytes)
+{
+    LLPackFileStore& store = LLDiskCache::getPackStore();
+    if (!LLPackFileStore::isPackable(mFileType) || bytes < 0)
+    {
+        return false;
+    }
+
+    const S32 packed_size = store.getSize(mFileID);
+    if (packed_size < 0 && !store.acceptsWrites())
+    {
+        return false;
+    }
+
+    const std::string filename = LLDiskCache::metaDataToFilepath(mFileID, mFileType);
+    if (packed_size < 0 && mMode != WRITE && LLFile::isfile(filename))
+    {
+        // Keep adding to an asset that already has a file of its own
+        return false;
+    }
+
+    // Rebuild the complete asset the way the file based modes below would
+    // have left it: WRITE truncates, APPEND adds at the end and READ_WRITE
+    // overwrites at the current position.
+    std::vector<U8> data;
+    if (mMode != WRITE && packed_size > 0)
+    {
+        store.readAll(mFileID, data);
+    }
+
+    const size_t offset = (mMode == APPEND) ? data.size() : (mMode == READ_WRITE ? (size_t)mPosition : 0);
+    const size_t new_size = llmax(data.size(), offset + (size_t)bytes);
+    if (new_size > (size_t)LLPackFileStore::MAX_PACKED_SIZE || !store.acceptsWrites())
+    {
+        // Too big for the pack (or packing was switched off): move what we
+        // have out to a file of its own and carry on with that.
+        if (packed_size >= 0)
+        {
+            if (overwrite_file(filename, data.data(), (S32)data.size()) != (S32)data.size())
+            {
+                return false;
+            }
+            store.remove(mFileID);
+        }
+        return false;
+    }
+
+    data.resize(new_size);
+    memcpy(data.data() + offset, buffer, bytes);
+    if (!store.write(mFileID, mFileType, data.data(), (S32)new_size))
+    {
+        return false;
+    }
+
+    if (mMode == WRITE && packed_size < 0)
+    {
+        // Don't leave an older copy of the asset behind
+        LLFile::remove(filename, ENOENT);
+    }
+
+    mPosition = (S32)(offset + bytes);
+    LLDiskCache::recordWrite(mFileID, mFileType, (U64)new_size);
+    return true;
+}
+// </FS>
+
 bool LLFileSystem::seek(S32 offset, S32 origin)
 {
     LL_PROFILE_ZONE_COLOR(tracy::Color::Gold); // <FS:Beq> measure cache performance
@@ -33,6 +33,7 @@
 #include "lluuid.h"
 #include "llassettype.h"
 #include "lldiskcache.h"
+#include "llfileview.h" // <FS/> Zero-copy cache reads
 
 class LLFileSystem
 {
@@ -41,6 +42,14 @@ class LLFileSystem
         ~LLFileSystem() = default;
 
         bool read(U8* buffer, S32 bytes);
+        // <FS> Zero-copy cache reads
+        /**
+         * Same as read() but hands back a view of the cached data instead of
+         * copying it into a caller supplied buffer. Large regions are mapped
+         * straight from the cache file. Returns null if nothing could be read.
+         */
+        LLFileView::ptr_t readView(S32 bytes);
+        // </FS>
         S32  getLastBytesRead() const;
         bool eof() const;
 
@@ -72,6 +81,9 @@ class LLFileSystem
         static const S32 READ_WRITE;
         static const S32 APPEND;
 
+    protected:
+        bool writePacked(const U8* buffer, S32 bytes); // <FS/> Small asset pack files
+
     protected:
         LLAssetType::EType mFileType;
         LLUUID  mFileID;
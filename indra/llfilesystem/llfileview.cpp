@@ -0,0 +1,232 @@
+/**
+ * @file llfileview.cpp
+ * @brief Read-only, reference counted view of a cached file region.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llfileview.h"
+
+#include "llmemory.h"
+
+#if LL_WINDOWS
+#include "llwin32headers.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// static
+LLFileView::ptr_t LLFileView::open(const std::string& filename, S32 offset, S32 size)
+{
+    LL_PROFILE_ZONE_SCOPED;
+    if (offset < 0 || size <= 0)
+    {
+        return nullptr;
+    }
+
+    ptr_t view = new LLFileView();
+    if (!view->map(filename, offset, size))
+    {
+        return nullptr;
+    }
+    return view;
+}
+
+// static
+LLFileView::ptr_t LLFileView::allocate(S32 size)
+{
+    if (size <= 0)
+    {
+        return nullptr;
+    }
+
+    ptr_t view = new LLFileView();
+    view->mData = (U8*)ll_aligned_malloc_16(size);
+    if (!view->mData)
+    {
+        return nullptr;
+    }
+    view->mSize = size;
+    return view;
+}
+
+LLFileView::~LLFileView()
+{
+    if (mMapBase)
+    {
+#if LL_WINDOWS
+        UnmapViewOfFile(mMapBase);
+#else
+        munmap(mMapBase, mMapLength);
+#endif
+    }
+    else if (mData)
+    {
+        ll_aligned_free_16(mData);
+    }
+}
+
+void LLFileView::truncate(S32 size)
+{
+    mSize = llclamp(size, 0, mSize);
+}
+
+#if LL_WINDOWS
+
+bool LLFileView::map(const std::string& filename, S32 offset, S32 size)
+{
+    // FILE_SHARE_DELETE so the cache can still purge or replace the file
+    // while it is being viewed.
+    llutf16string utf16filename = utf8str_to_utf16str(filename);
+    HANDLE file = CreateFileW((LPCWSTR)utf16filename.c_str(), GENERIC_READ,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) || (S64)offset >= file_size.QuadPart)
+    {
+        CloseHandle(file);
+        return false;
+    }
+    size = (S32)llmin((S64)size, file_size.QuadPart - offset);
+
+    if (size >= MIN_MAPPED_SIZE)
+    {
+        // Views have to start on an allocation granularity boundary
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        const S32 delta = offset % (S32)info.dwAllocationGranularity;
+        const S32 aligned = offset - delta;
+
+        HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+        if (mapping)
+        {
+            void* base = MapViewOfFile(mapping, FILE_MAP_COPY, 0, (DWORD)aligned, (SIZE_T)size + delta);
+            // The view keeps the mapping object alive
+            CloseHandle(mapping);
+            if (base)
+            {
+                CloseHandle(file);
+                mMapBase = base;
+                mMapLength = (size_t)size + delta;
+                mData = (U8*)base + delta;
+                mSize = size;
+                return true;
+            }
+        }
+        LL_DEBUGS("LLDiskCache") << "Unable to map " << filename << ", reading it instead" << LL_ENDL;
+    }
+
+    mData = (U8*)ll_aligned_malloc_16(size);
+    if (!mData)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    OVERLAPPED overlapped = {};
+    overlapped.Offset = (DWORD)offset;
+    DWORD bytes_read = 0;
+    const bool success = ReadFile(file, mData, (DWORD)size, &bytes_read, &overlapped) && bytes_read > 0;
+    CloseHandle(file);
+    mSize = (S32)bytes_read;
+    return success;
+}
+
+#else // LL_WINDOWS
+
+bool LLFileView::map(const std::string& filename, S32 offset, S32 size)
+{
+    int fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || (S64)offset >= (S64)file_stat.st_size)
+    {
+        ::close(fd);
+        return false;
+    }
+    size = (S32)llmin((S64)size, (S64)file_stat.st_size - offset);
+
+    if (size >= MIN_MAPPED_SIZE)
+    {
+        static const S32 page_size = (S32)sysconf(_SC_PAGESIZE);
+        const S32 delta = offset % page_size;
+        const S32 aligned = offset - delta;
+
+        // Private and writable: pages the consumer touches get copied, the
+        // file itself is never modified.
+        void* base = mmap(nullptr, (size_t)size + delta, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, aligned);
+        if (base != MAP_FAILED)
+        {
+            // The whole region is about to be parsed front to back
+            madvise(base, (size_t)size + delta, MADV_WILLNEED);
+            ::close(fd);
+            mMapBase = base;
+            mMapLength = (size_t)size + delta;
+            mData = (U8*)base + delta;
+            mSize = size;
+            return true;
+        }
+        LL_DEBUGS("LLDiskCache") << "Unable to map " << filename << ", reading it instead" << LL_ENDL;
+    }
+
+    mData = (U8*)ll_aligned_malloc_16(size);
+    if (!mData)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    S32 total = 0;
+    while (total < size)
+    {
+        ssize_t bytes_read = pread(fd, mData + total, size - total, (off_t)offset + total);
+        if (bytes_read < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (bytes_read <= 0)
+        {
+            break;
+        }
+        total += (S32)bytes_read;
+    }
+    ::close(fd);
+    mSize = total;
+    return total > 0;
+}
+
+#endif // LL_WINDOWS
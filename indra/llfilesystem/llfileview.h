@@ -0,0 +1,99 @@
+/**
+ * @file llfileview.h
+ * @brief Read-only, reference counted view of a cached file region.
+ *
+ * @Description:
+ * Reading a cache file the usual way costs a heap allocation for the
+ * destination buffer and a copy out of the page cache. A view maps the
+ * requested region of the file straight into the address space instead and
+ * keeps it mapped for as long as someone holds a reference to it.
+ * 1/ The mapping is private (copy-on-write): the consumer may scribble on
+ *    the data in place without the changes ever reaching the file.
+ * 2/ A view stays valid after the cache file is rewritten, renamed or
+ *    deleted. On POSIX the old pages are kept alive by the mapping, on
+ *    Windows the file is opened with FILE_SHARE_DELETE.
+ * 3/ Small regions, and files that cannot be mapped, are read into a plain
+ *    heap buffer instead; mapping them would cost more than the copy.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLFILEVIEW_H
+#define LL_LLFILEVIEW_H
+
+#include "llpointer.h"
+#include "llrefcount.h"
+
+class LLFileView : public LLThreadSafeRefCount
+{
+public:
+    typedef LLPointer<LLFileView> ptr_t;
+
+    /**
+     * Regions smaller than this are read into a heap buffer rather than
+     * mapped.
+     */
+    static constexpr S32 MIN_MAPPED_SIZE = 16 * 1024;
+
+    /**
+     * View up to size bytes of filename starting at offset. The view is
+     * shorter than requested if the file ends first. Returns null if the
+     * file does not exist or offset is past its end.
+     */
+    static ptr_t open(const std::string& filename, S32 offset, S32 size);
+
+    /**
+     * A heap backed view of size bytes for the caller to fill, used where
+     * the data does not come from a plain file. Returns null when out of
+     * memory.
+     */
+    static ptr_t allocate(S32 size);
+
+    U8* getData() const { return mData; }
+    S32 getSize() const { return mSize; }
+    bool isMapped() const { return mMapBase != nullptr; }
+
+    /**
+     * Shorten the view, e.g. after a read into an allocated view came up
+     * short. The memory itself is only released with the view.
+     */
+    void truncate(S32 size);
+
+protected:
+    LLFileView() = default;
+    ~LLFileView();
+
+private:
+    bool map(const std::string& filename, S32 offset, S32 size);
+
+    LLFileView(const LLFileView&) = delete;
+    LLFileView& operator=(const LLFileView&) = delete;
+
+private:
+    U8*     mData { nullptr };
+    S32     mSize { 0 };
+    void*   mMapBase { nullptr };   // start of the mapping, page aligned
+    size_t  mMapLength { 0 };
+};
+
+#endif // LL_LLFILEVIEW_H
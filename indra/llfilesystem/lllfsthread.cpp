@@ -28,6 +28,7 @@
 #include "lllfsthread.h"
 #include "llstl.h"
 #include "llapr.h"
+#include "llasyncfileio.h" // <FS/> Async cache I/O
 
 //============================================================================
 
@@ -138,6 +139,7 @@ LLLFSThread::Request::Request(LLLFSThread* thread,
     mOffset(offset),
     mBytes(numbytes),
     mBytesRead(0),
+    mSubmitted(false), // <FS/> Async cache I/O
     mResponder(responder)
 {
     if (numbytes <= 0)
@@ -176,10 +178,52 @@ void LLLFSThread::Request::deleteRequest()
     LLQueuedThread::QueuedRequest::deleteRequest();
 }
 
+// <FS> Async cache I/O
+// Hands the operation to LLAsyncFileIO and parks the request until the
+// completion wakes it. LLAsyncFileIO::cleanupClass() drains everything in
+// flight before this thread shuts down, so the request outlives the I/O.
+bool LLLFSThread::Request::submitAsync()
+{
+    LLAsyncFileIO* io = LLAsyncFileIO::instance();
+    if (!io || (mOperation == FILE_READ && mOffset < 0))
+    {
+        return false;
+    }
+
+    LLLFSThread* thread = mThread;
+    handle_t handle = getHashKey();
+    thread->waitForWake(handle);
+    mSubmitted = true;
+    auto completion = [this, thread, handle](S32 bytes)
+    {
+        mBytesRead = bytes;
+        thread->wakeRequest(handle);
+    };
+    bool queued = (mOperation == FILE_READ) ? io->read(mFileName, mBuffer, mOffset, mBytes, completion)
+                                            : io->write(mFileName, mBuffer, mOffset, mBytes, completion);
+    if (!queued)
+    {
+        mSubmitted = false;
+        thread->wakeRequest(handle); // disarm, we carry on synchronously
+    }
+    return queued;
+}
+// </FS>
+
 bool LLLFSThread::Request::processRequest()
 {
     LL_PROFILE_ZONE_SCOPED;
     bool complete = false;
+    // <FS> Async cache I/O
+    if (mSubmitted)
+    {
+        return true; // woken by the completion, mBytesRead is set
+    }
+    if ((mOperation == FILE_READ || mOperation == FILE_WRITE) && submitAsync())
+    {
+        return false;
+    }
+    // </FS>
     if (mOperation ==  FILE_READ)
     {
         llassert(mOffset >= 0);
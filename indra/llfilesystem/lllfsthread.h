@@ -99,6 +99,8 @@ public:
         /*virtual*/ void deleteRequest();
 
     private:
+        bool submitAsync(); // <FS/> Async cache I/O
+
         LLLFSThread* mThread;
         operation_t mOperation;
 
@@ -108,6 +110,7 @@ public:
         S32 mOffset;    // offset into file, -1 = append (WRITE only)
         S32 mBytes;     // bytes to read from file, -1 = all
         S32 mBytesRead; // bytes read from file
+        bool mSubmitted; // <FS/> Async cache I/O: handed to LLAsyncFileIO
 
         LLPointer<Responder> mResponder;
     };
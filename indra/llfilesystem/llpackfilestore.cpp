@@ -0,0 +1,568 @@
+/**
+ * @file llpackfilestore.cpp
+ * @brief Packs small cached assets into a few large segment files.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llpackfilestore.h"
+
+#include "lldir.h"
+
+static const U32 PACK_RECORD_MAGIC = 0x4b435053; // "SPCK"
+static const U32 PACK_FLAG_TOMBSTONE = 0x1;
+
+// Note: must not contain the "sl_cache" prefix, see LLDiskCache
+static const char PACK_SEGMENT_PREFIX[] = "pack_";
+static const char PACK_SEGMENT_SUFFIX[] = ".seg";
+
+// Segments whose live data falls below this fraction get compacted
+static const F32 COMPACTION_LIVE_RATIO = 0.5f;
+
+LLPackFileStore::LLPackFileStore()
+{
+    static_assert(sizeof(RecordHeader) == 32, "LLPackFileStore::RecordHeader layout changed");
+}
+
+LLPackFileStore::~LLPackFileStore()
+{
+    close();
+}
+
+// static
+bool LLPackFileStore::isPackable(LLAssetType::EType type)
+{
+    switch (type)
+    {
+        case LLAssetType::AT_SOUND:
+        case LLAssetType::AT_CALLINGCARD:
+        case LLAssetType::AT_LANDMARK:
+        case LLAssetType::AT_CLOTHING:
+        case LLAssetType::AT_NOTECARD:
+        case LLAssetType::AT_LSL_TEXT:
+        case LLAssetType::AT_LSL_BYTECODE:
+        case LLAssetType::AT_BODYPART:
+        case LLAssetType::AT_ANIMATION:
+        case LLAssetType::AT_GESTURE:
+        case LLAssetType::AT_SETTINGS:
+        case LLAssetType::AT_MATERIAL:
+            return true;
+        default:
+            return false;
+    }
+}
+
+std::string LLPackFileStore::getSegmentName(U32 number) const
+{
+    return mDir + gDirUtilp->getDirDelimiter() + llformat("%s%08u%s", PACK_SEGMENT_PREFIX, number, PACK_SEGMENT_SUFFIX);
+}
+
+bool LLPackFileStore::open(const std::string& dir)
+{
+    LL_PROFILE_ZONE_SCOPED;
+    LLMutexLock lock(&mMutex);
+
+    mDir = dir;
+    LLFile::mkdir(mDir);
+
+    // Segment numbers only ever grow so replaying them in numeric order
+    // replays the records in the order they were written.
+    std::vector<U32> numbers;
+    for (const std::string& name : gDirUtilp->getFilesInDir(mDir))
+    {
+        U32 number = 0;
+        if (name.compare(0, strlen(PACK_SEGMENT_PREFIX), PACK_SEGMENT_PREFIX) == 0 &&
+            sscanf(name.c_str() + strlen(PACK_SEGMENT_PREFIX), "%u", &number) == 1)
+        {
+            numbers.push_back(number);
+        }
+    }
+    std::sort(numbers.begin(), numbers.end());
+
+    for (U32 number : numbers)
+    {
+        Segment& segment = mSegments[number];
+        if (!scanSegment(number, segment))
+        {
+            LL_WARNS("LLDiskCache") << "Pack segment " << getSegmentName(number) << " ends in a torn record" << LL_ENDL;
+            segment.mWritable = false;
+        }
+        mActiveSegment = number;
+    }
+
+    mOpen = true;
+    LL_INFOS("LLDiskCache") << "Pack store opened with " << mTable.size() << " assets in " << mSegments.size() << " segments" << LL_ENDL;
+    return true;
+}
+
+void LLPackFileStore::close()
+{
+    LLMutexLock lock(&mMutex);
+    mOpen = false;
+    for (auto& it : mSegments)
+    {
+        if (it.second.mFile)
+        {
+            LLFile::close(it.second.mFile);
+            it.second.mFile = nullptr;
+        }
+    }
+    mSegments.clear();
+    mTable.clear();
+}
+
+bool LLPackFileStore::scanSegment(U32 number, Segment& segment)
+{
+    segment.mFile = LLFile::fopen(getSegmentName(number), "a+b");
+    if (!segment.mFile)
+    {
+        segment.mWritable = false;
+        return true;
+    }
+
+    fseek(segment.mFile, 0, SEEK_END);
+    const long file_size = ftell(segment.mFile);
+    fseek(segment.mFile, 0, SEEK_SET);
+
+    U32 offset = 0;
+    RecordHeader header;
+    while (offset + sizeof(header) <= (U32)file_size)
+    {
+        if (fread(&header, sizeof(header), 1, segment.mFile) != 1 ||
+            header.mMagic != PACK_RECORD_MAGIC ||
+            header.mSize < 0 || header.mSize > MAX_PACKED_SIZE ||
+            offset + sizeof(header) + header.mSize > (U32)file_size)
+        {
+            segment.mSize = (U32)file_size;
+            return false;
+        }
+
+        LLUUID id;
+        memcpy(id.mData, header.mID, UUID_BYTES);
+        forgetLocked(id);
+        if (!(header.mFlags & PACK_FLAG_TOMBSTONE))
+        {
+            Location& location = mTable[id];
+            location.mSegment = number;
+            location.mOffset = offset;
+            location.mSize = header.mSize;
+            location.mType = (LLAssetType::EType)header.mType;
+            segment.mLiveBytes += sizeof(header) + header.mSize;
+        }
+
+        offset += sizeof(header) + header.mSize;
+        if (header.mSize > 0)
+        {
+            fseek(segment.mFile, header.mSize, SEEK_CUR);
+        }
+    }
+
+    segment.mSize = offset;
+    return offset == (U32)file_size;
+}
+
+void LLPackFileStore::forgetLocked(const LLUUID& id)
+{
+    auto it = mTable.find(id);
+    if (it != mTable.end())
+    {
+        auto seg_it = mSegments.find(it->second.mSegment);
+        if (seg_it != mSegments.end())
+        {
+            seg_it->second.mLiveBytes -= sizeof(RecordHeader) + it->second.mSize;
+        }
+        mTable.erase(it);
+    }
+}
+
+LLPackFileStore::Segment* LLPackFileStore::getActiveSegmentLocked(U32 needed)
+{
+    auto it = mSegments.find(mActiveSegment);
+    if (it != mSegments.end() && it->second.mFile && it->second.mWritable &&
+        it->second.mSize + needed <= MAX_SEGMENT_SIZE)
+    {
+        return &it->second;
+    }
+
+    if (it != mSegments.end())
+    {
+        ++mActiveSegment;
+    }
+
+    Segment& segment = mSegments[mActiveSegment];
+    segment.mFile = LLFile::fopen(getSegmentName(mActiveSegment), "a+b");
+    if (!segment.mFile)
+    {
+        LL_WARNS("LLDiskCache") << "Unable to create pack segment " << getSegmentName(mActiveSegment) << LL_ENDL;
+        mSegments.erase(mActiveSegment);
+        return nullptr;
+    }
+    return &segment;
+}
+
+bool LLPackFileStore::appendLocked(const LLUUID& id, LLAssetType::EType type, U32 flags, const U8* data, S32 size, Location& location)
+{
+    const U32 needed = sizeof(RecordHeader) + size;
+    Segment* segment = getActiveSegmentLocked(needed);
+    if (!segment)
+    {
+        return false;
+    }
+
+    RecordHeader header;
+    header.mMagic = PACK_RECORD_MAGIC;
+    header.mFlags = flags;
+    memcpy(header.mID, id.mData, UUID_BYTES);
+    header.mType = (S32)type;
+    header.mSize = size;
+
+    // The stream is opened for appending, the position only matters to
+    // the reads that share it.
+    fseek(segment->mFile, 0, SEEK_END);
+    bool success = fwrite(&header, sizeof(header), 1, segment->mFile) == 1;
+    if (success && size > 0)
+    {
+        success = fwrite(data, 1, size, segment->mFile) == (size_t)size;
+    }
+    if (!success)
+    {
+        // Whatever made it to the disk is a torn record now
+        segment->mWritable = false;
+        return false;
+    }
+
+    location.mSegment = mActiveSegment;
+    location.mOffset = segment->mSize;
+    location.mSize = size;
+    location.mType = type;
+    segment->mSize += needed;
+    if (!(flags & PACK_FLAG_TOMBSTONE))
+    {
+        segment->mLiveBytes += needed;
+    }
+    return true;
+}
+
+bool LLPackFileStore::readLocked(const Location& location, S32 offset, U8* buffer, S32 bytes)
+{
+    auto it = mSegments.find(location.mSegment);
+    if (it == mSegments.end() || !it->second.mFile)
+    {
+        return false;
+    }
+
+    LLFILE* file = it->second.mFile;
+    return fseek(file, location.mOffset + sizeof(RecordHeader) + offset, SEEK_SET) == 0 &&
+           fread(buffer, 1, bytes, file) == (size_t)bytes;
+}
+
+S32 LLPackFileStore::getSize(const LLUUID& id)
+{
+    if (!mOpen)
+    {
+        return -1;
+    }
+
+    LLMutexLock lock(&mMutex);
+    auto it = mTable.find(id);
+    return it != mTable.end() ? it->second.mSize : -1;
+}
+
+S32 LLPackFileStore::read(const LLUUID& id, S32 offset, U8* buffer, S32 bytes)
+{
+    if (!mOpen)
+    {
+        return -1;
+    }
+
+    LL_PROFILE_ZONE_SCOPED;
+    LLMutexLock lock(&mMutex);
+    auto it = mTable.find(id);
+    if (it == mTable.end())
+    {
+        return -1;
+    }
+
+    const Location& location = it->second;
+    if (offset < 0 || offset >= location.mSize || bytes <= 0)
+    {
+        return 0;
+    }
+
+    bytes = llmin(bytes, location.mSize - offset);
+    return readLocked(location, offset, buffer, bytes) ? bytes : 0;
+}
+
+bool LLPackFileStore::readAll(const LLUUID& id, std::vector<U8>& data)
+{
+    if (!mOpen)
+    {
+        return false;
+    }
+
+    LLMutexLock lock(&mMutex);
+    auto it = mTable.find(id);
+    if (it == mTable.end())
+    {
+        return false;
+    }
+
+    data.resize(it->second.mSize);
+    return data.empty() || readLocked(it->second, 0, data.data(), it->second.mSize);
+}
+
+bool LLPackFileStore::write(const LLUUID& id, LLAssetType::EType type, const U8* data, S32 size)
+{
+    if (!mOpen || size < 0 || size > MAX_PACKED_SIZE)
+    {
+        return false;
+    }
+
+    LL_PROFILE_ZONE_SCOPED;
+    LLMutexLock lock(&mMutex);
+    Location location;
+    if (!appendLocked(id, type, 0, data, size, location))
+    {
+        return false;
+    }
+
+    forgetLocked(id);
+    mTable[id] = location;
+    return true;
+}
+
+bool LLPackFileStore::remove(const LLUUID& id)
+{
+    if (!mOpen)
+    {
+        return false;
+    }
+
+    LLMutexLock lock(&mMutex);
+    auto it = mTable.find(id);
+    if (it == mTable.end())
+    {
+        return false;
+    }
+
+    Location tombstone;
+    appendLocked(id, it->second.mType, PACK_FLAG_TOMBSTONE, nullptr, 0, tombstone);
+    forgetLocked(id);
+    return true;
+}
+
+bool LLPackFileStore::rename(const LLUUID& old_id, const LLUUID& new_id, LLAssetType::EType new_type)
+{
+    if (!mOpen)
+    {
+        return false;
+    }
+
+    LLMutexLock lock(&mMutex);
+    auto it = mTable.find(old_id);
+    if (it == mTable.end())
+    {
+        return false;
+    }
+
+    std::vector<U8> data(it->second.mSize);
+    if (!data.empty() && !readLocked(it->second, 0, data.data(), it->second.mSize))
+    {
+        return false;
+    }
+
+    Location location;
+    if (!appendLocked(new_id, new_type, 0, data.data(), (S32)data.size(), location))
+    {
+        return false;
+    }
+    forgetLocked(new_id);
+    mTable[new_id] = location;
+
+    Location tombstone;
+    appendLocked(old_id, new_type, PACK_FLAG_TOMBSTONE, nullptr, 0, tombstone);
+    forgetLocked(old_id);
+    return true;
+}
+
+void LLPackFileStore::removeSegmentLocked(U32 number)
+{
+    auto it = mSegments.find(number);
+    if (it == mSegments.end())
+    {
+        return;
+    }
+
+    if (it->second.mFile)
+    {
+        LLFile::close(it->second.mFile);
+    }
+    LLFile::remove(getSegmentName(number), ENOENT);
+    mSegments.erase(it);
+}
+
+void LLPackFileStore::clear()
+{
+    LLMutexLock lock(&mMutex);
+    while (!mSegments.empty())
+    {
+        removeSegmentLocked(mSegments.begin()->first);
+    }
+    mTable.clear();
+    // Keep counting up so a stale segment can never be replayed after a newer one
+    ++mActiveSegment;
+}
+
+void LLPackFileStore::compact()
+{
+    if (!mOpen)
+    {
+        return;
+    }
+
+    LL_PROFILE_ZONE_SCOPED;
+
+    // Pick the candidates first; the segments can change as soon as the
+    // lock is released.
+    std::vector<U32> candidates;
+    {
+        LLMutexLock lock(&mMutex);
+        for (const auto& it : mSegments)
+        {
+            if (it.first != mActiveSegment &&
+                (F32)it.second.mLiveBytes < (F32)it.second.mSize * COMPACTION_LIVE_RATIO)
+            {
+                candidates.push_back(it.first);
+            }
+        }
+    }
+
+    for (U32 number : candidates)
+    {
+        std::vector<LLUUID> ids;
+        {
+            LLMutexLock lock(&mMutex);
+            for (const auto& it : mTable)
+            {
+                if (it.second.mSegment == number)
+                {
+                    ids.push_back(it.first);
+                }
+            }
+        }
+
+        // Move the live records one at a time so readers and writers are
+        // never blocked for long.
+        std::vector<U8> data;
+        for (const LLUUID& id : ids)
+        {
+            LLMutexLock lock(&mMutex);
+            auto it = mTable.find(id);
+            if (it == mTable.end() || it->second.mSegment != number)
+            {
+                // Removed or rewritten in the meantime
+                continue;
+            }
+
+            data.resize(it->second.mSize);
+            if (!data.empty() && !readLocked(it->second, 0, data.data(), it->second.mSize))
+            {
+                continue;
+            }
+
+            Location location;
+            if (appendLocked(id, it->second.mType, 0, data.data(), (S32)data.size(), location))
+            {
+                forgetLocked(id);
+                mTable[id] = location;
+            }
+        }
+
+        LLMutexLock lock(&mMutex);
+        auto seg_it = mSegments.find(number);
+        if (seg_it != mSegments.end() && seg_it->second.mLiveBytes == 0)
+        {
+            carryTombstonesLocked(number);
+            LL_DEBUGS("LLDiskCache") << "Compacted pack segment " << getSegmentName(number) << LL_ENDL;
+            removeSegmentLocked(number);
+        }
+    }
+}
+
+void LLPackFileStore::carryTombstonesLocked(U32 number)
+{
+    // A tombstone has to outlive the records it hides, which may sit in an
+    // older segment. Copy them forward unless no older segment is left.
+    auto seg_it = mSegments.find(number);
+    if (seg_it == mSegments.begin() || seg_it == mSegments.end() || !seg_it->second.mFile)
+    {
+        return;
+    }
+
+    LLFILE* file = seg_it->second.mFile;
+    const U32 size = seg_it->second.mSize;
+    std::vector<std::pair<LLUUID, LLAssetType::EType>> tombstones;
+
+    U32 offset = 0;
+    RecordHeader header;
+    while (offset + sizeof(header) <= size)
+    {
+        if (fseek(file, offset, SEEK_SET) != 0 ||
+            fread(&header, sizeof(header), 1, file) != 1 ||
+            header.mMagic != PACK_RECORD_MAGIC)
+        {
+            break;
+        }
+
+        if (header.mFlags & PACK_FLAG_TOMBSTONE)
+        {
+            LLUUID id;
+            memcpy(id.mData, header.mID, UUID_BYTES);
+            // If the asset was written again since, the newer record wins
+            // anyway and a tombstone appended now would wrongly hide it.
+            if (mTable.find(id) == mTable.end())
+            {
+                tombstones.emplace_back(id, (LLAssetType::EType)header.mType);
+            }
+        }
+        offset += sizeof(header) + header.mSize;
+    }
+
+    for (const auto& tombstone : tombstones)
+    {
+        Location location;
+        appendLocked(tombstone.first, tombstone.second, PACK_FLAG_TOMBSTONE, nullptr, 0, location);
+    }
+}
+
+void LLPackFileStore::getInfo(info_list_t& info)
+{
+    LLMutexLock lock(&mMutex);
+    info.reserve(info.size() + mTable.size());
+    for (const auto& it : mTable)
+    {
+        info.push_back({ it.first, it.second.mType, it.second.mSize });
+    }
+}
@@ -0,0 +1,185 @@
+/**
+ * @file llpackfilestore.h
+ * @brief Packs small cached assets into a few large segment files.
+ *
+ * @Description:
+ * Most assets in the asset cache are small (gestures, notecards,
+ * animations, sounds...). Storing each one in its own file costs an inode
+ * and an open/close pair per access. This store appends them to a handful
+ * of segment files instead and keeps an in-memory table of where each one
+ * lives.
+ * 1/ Segments are append-only. Every write appends a record header and
+ *    the asset data; a remove appends a header-only tombstone. The last
+ *    record for an id wins, so the table is rebuilt at startup by walking
+ *    the record headers.
+ * 2/ A torn record at the end of a segment (crash mid-write) ends the walk
+ *    of that segment and the segment is never appended to again.
+ * 3/ compact() copies the live records out of segments that are mostly
+ *    garbage and deletes them. It is meant to run on a background thread.
+ * 4/ Only whole, small assets are stored here. LLFileSystem moves an
+ *    asset out to a regular cache file as soon as it grows too large.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLPACKFILESTORE_H
+#define LL_LLPACKFILESTORE_H
+
+#include "llassettype.h"
+#include "llfile.h"
+#include "llmutex.h"
+#include "lluuid.h"
+
+#include <atomic>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+class LLPackFileStore
+{
+public:
+    /**
+     * Largest asset kept in the store. Anything bigger lives in its own
+     * cache file.
+     */
+    static constexpr S32 MAX_PACKED_SIZE = 64 * 1024;
+
+    /**
+     * Size at which the active segment is closed and a new one started.
+     */
+    static constexpr U32 MAX_SEGMENT_SIZE = 32 * 1024 * 1024;
+
+    struct Info
+    {
+        LLUUID              mID;
+        LLAssetType::EType  mType;
+        S32                 mSize;
+    };
+    typedef std::vector<Info> info_list_t;
+
+    LLPackFileStore();
+    ~LLPackFileStore();
+
+    /**
+     * Open (creating if needed) the store in dir and build the offset
+     * table from the segments found there.
+     */
+    bool open(const std::string& dir);
+    void close();
+    bool isOpen() const { return mOpen; }
+
+    /**
+     * When false, assets already in the store can still be read, renamed
+     * and removed but new ones are not added.
+     */
+    void setAcceptsWrites(bool accepts) { mAcceptsWrites = accepts; }
+    bool acceptsWrites() const { return mOpen && mAcceptsWrites; }
+
+    /**
+     * Asset types that are small enough and written as a whole often
+     * enough to be worth packing. Mesh and textures are not: they are large
+     * and the mesh repository updates parts of its cache files in place.
+     */
+    static bool isPackable(LLAssetType::EType type);
+
+    /**
+     * Size of a packed asset, or -1 if the asset is not in the store.
+     */
+    S32 getSize(const LLUUID& id);
+
+    /**
+     * Read up to bytes from a packed asset starting at offset. Returns the
+     * number of bytes read, or -1 if the asset is not in the store.
+     */
+    S32 read(const LLUUID& id, S32 offset, U8* buffer, S32 bytes);
+    bool readAll(const LLUUID& id, std::vector<U8>& data);
+
+    /**
+     * Store the complete contents of an asset, replacing any previous
+     * version. Fails for assets larger than MAX_PACKED_SIZE.
+     */
+    bool write(const LLUUID& id, LLAssetType::EType type, const U8* data, S32 size);
+
+    // These return false if the asset is not in the store
+    bool remove(const LLUUID& id);
+    bool rename(const LLUUID& old_id, const LLUUID& new_id, LLAssetType::EType new_type);
+
+    /**
+     * Remove every packed asset and segment file.
+     */
+    void clear();
+
+    /**
+     * Rewrite segments that are mostly dead records. Safe to call from a
+     * background thread while the store is in use.
+     */
+    void compact();
+
+    void getInfo(info_list_t& info);
+
+private:
+    struct RecordHeader
+    {
+        U32 mMagic;
+        U32 mFlags;
+        U8  mID[UUID_BYTES];
+        S32 mType;
+        S32 mSize;
+    };
+
+    struct Location
+    {
+        U32                 mSegment;
+        U32                 mOffset;    // of the record header
+        S32                 mSize;
+        LLAssetType::EType  mType;
+    };
+
+    struct Segment
+    {
+        LLFILE* mFile { nullptr };
+        U32     mSize { 0 };
+        U32     mLiveBytes { 0 };
+        bool    mWritable { true };
+    };
+
+    bool scanSegment(U32 number, Segment& segment);
+    bool appendLocked(const LLUUID& id, LLAssetType::EType type, U32 flags, const U8* data, S32 size, Location& location);
+    bool readLocked(const Location& location, S32 offset, U8* buffer, S32 bytes);
+    void forgetLocked(const LLUUID& id);
+    Segment* getActiveSegmentLocked(U32 needed);
+    void removeSegmentLocked(U32 number);
+    void carryTombstonesLocked(U32 number);
+    std::string getSegmentName(U32 number) const;
+
+private:
+    LLMutex                                 mMutex;
+    std::string                             mDir;
+    std::unordered_map<LLUUID, Location>    mTable;
+    std::map<U32, Segment>                  mSegments;
+    U32                                     mActiveSegment { 0 };
+    std::atomic<bool>                       mOpen { false };
+    std::atomic<bool>                       mAcceptsWrites { true };
+};
+
+#endif // LL_LLPACKFILESTORE_H
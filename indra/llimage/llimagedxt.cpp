@@ -424,6 +424,230 @@ bool LLImageDXT::encode(const LLImageRaw* raw_image, F32 time)
     return encodeDXT(raw_image, time, false);
 }
 
+// <FS> Compressed texture cache
+// Software BC1 (DXT1) block encoder. Endpoints come from the inset bounding
+// box of the block, with the box diagonal flipped along channels that run
+// against the dominant one, then each texel picks the nearest of the four
+// palette entries. Not as good as an exhaustive search, but cheap enough to
+// run on every texture the viewer loads.
+
+static U16 bc1_pack_565(const S32* rgb)
+{
+    return (U16)(((rgb[0] >> 3) << 11) | ((rgb[1] >> 2) << 5) | (rgb[2] >> 3));
+}
+
+static void bc1_unpack_565(U16 color, S32* rgb)
+{
+    S32 r = (color >> 11) & 0x1f;
+    S32 g = (color >> 5) & 0x3f;
+    S32 b = color & 0x1f;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+// block: 16 texels, 3 bytes each, row major
+static void bc1_encode_block(const U8* block, U8* out)
+{
+    S32 mins[3] = { 255, 255, 255 };
+    S32 maxs[3] = { 0, 0, 0 };
+    S32 sums[3] = { 0, 0, 0 };
+    for (S32 i = 0; i < 16; ++i)
+    {
+        for (S32 c = 0; c < 3; ++c)
+        {
+            S32 v = block[i * 3 + c];
+            mins[c] = llmin(mins[c], v);
+            maxs[c] = llmax(maxs[c], v);
+            sums[c] += v;
+        }
+    }
+
+    // Flip the diagonal for channels that decrease while the widest one increases
+    S32 axis = 0;
+    for (S32 c = 1; c < 3; ++c)
+    {
+        if (maxs[c] - mins[c] > maxs[axis] - mins[axis])
+        {
+            axis = c;
+        }
+    }
+    for (S32 c = 0; c < 3; ++c)
+    {
+        if (c == axis)
+        {
+            continue;
+        }
+        S32 covariance = 0;
+        for (S32 i = 0; i < 16; ++i)
+        {
+            covariance += (block[i * 3 + axis] * 16 - sums[axis]) * (block[i * 3 + c] * 16 - sums[c]) / 256;
+        }
+        if (covariance < 0)
+        {
+            std::swap(mins[c], maxs[c]);
+        }
+    }
+
+    // Inset the box by 1/16th to reduce the error of the interpolated colors
+    for (S32 c = 0; c < 3; ++c)
+    {
+        S32 inset = (maxs[c] - mins[c]) / 16;
+        maxs[c] -= inset;
+        mins[c] += inset;
+    }
+
+    U16 color0 = bc1_pack_565(maxs);
+    U16 color1 = bc1_pack_565(mins);
+    if (color0 < color1)
+    {
+        std::swap(color0, color1);
+    }
+
+    U32 indices = 0;
+    if (color0 != color1)
+    {
+        // color0 > color1 selects the opaque four color mode
+        S32 palette[4][3];
+        bc1_unpack_565(color0, palette[0]);
+        bc1_unpack_565(color1, palette[1]);
+        for (S32 c = 0; c < 3; ++c)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+
+        for (S32 i = 0; i < 16; ++i)
+        {
+            S32 best = 0;
+            S32 best_dist = S32_MAX;
+            for (S32 p = 0; p < 4; ++p)
+            {
+                S32 dr = block[i * 3] - palette[p][0];
+                S32 dg = block[i * 3 + 1] - palette[p][1];
+                S32 db = block[i * 3 + 2] - palette[p][2];
+                S32 dist = dr * dr + dg * dg + db * db;
+                if (dist < best_dist)
+                {
+                    best_dist = dist;
+                    best = p;
+                }
+            }
+            indices |= (U32)best << (i * 2);
+        }
+    }
+
+    out[0] = (U8)(color0 & 0xff);
+    out[1] = (U8)(color0 >> 8);
+    out[2] = (U8)(color1 & 0xff);
+    out[3] = (U8)(color1 >> 8);
+    out[4] = (U8)(indices & 0xff);
+    out[5] = (U8)((indices >> 8) & 0xff);
+    out[6] = (U8)((indices >> 16) & 0xff);
+    out[7] = (U8)(indices >> 24);
+}
+
+// Encodes one mip; mips smaller than a block repeat their edge texels
+static void bc1_encode_image(const U8* data, S32 width, S32 height, S32 ncomponents, U8* out)
+{
+    U8 block[16 * 3];
+    for (S32 by = 0; by < height || by == 0; by += 4)
+    {
+        for (S32 bx = 0; bx < width || bx == 0; bx += 4)
+        {
+            for (S32 y = 0; y < 4; ++y)
+            {
+                S32 sy = llmin(by + y, height - 1);
+                for (S32 x = 0; x < 4; ++x)
+                {
+                    S32 sx = llmin(bx + x, width - 1);
+                    const U8* texel = data + (sy * width + sx) * ncomponents;
+                    U8* dst = block + (y * 4 + x) * 3;
+                    dst[0] = texel[0];
+                    dst[1] = texel[1];
+                    dst[2] = texel[2];
+                }
+            }
+            bc1_encode_block(block, out);
+            out += 8;
+        }
+    }
+}
+
+bool LLImageDXT::encodeBC1(const LLImageRaw* raw_image)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
+    llassert_always(raw_image);
+
+    if (raw_image->isBufferInvalid())
+    {
+        setLastError("Invalid input, no buffer");
+        return false;
+    }
+
+    S32 ncomponents = raw_image->getComponents();
+    if (ncomponents != 3 && ncomponents != 4)
+    {
+        setLastError("BC1 needs an RGB or RGBA image");
+        return false;
+    }
+
+    LLImageDataSharedLock lockIn(raw_image);
+    LLImageDataLock lock(this);
+
+    S32 width = raw_image->getWidth();
+    S32 height = raw_image->getHeight();
+
+    setSize(width, height, 3);
+    mHeaderSize = sizeof(dxtfile_header_t);
+    mFileFormat = FORMAT_DXR1;
+
+    S32 nmips = calcNumMips(width, height);
+    S32 totbytes = mHeaderSize;
+    for (S32 mip = 0, w = width, h = height; mip < nmips; mip++, w >>= 1, h >>= 1)
+    {
+        totbytes += formatBytes(mFileFormat, w, h);
+    }
+
+    if (!allocateData(totbytes))
+    {
+        setLastError("Out of memory");
+        return false;
+    }
+
+    U8* data = getData();
+    dxtfile_header_t* header = (dxtfile_header_t*)data;
+    memset(header, 0, mHeaderSize);
+    header->fourcc = 0x20534444;
+    header->pixel_fmt.fourcc = getFourCC(mFileFormat);
+    header->num_mips = nmips;
+    header->maxwidth = width;
+    header->maxheight = height;
+
+    // DXR layout: smallest mip first, so getMipOffset(0) is the last one
+    const U8* src = raw_image->getData();
+    std::vector<U8> mip_buffer;
+    std::vector<U8> next_buffer;
+    S32 w = width;
+    S32 h = height;
+    for (S32 mip = 0; mip < nmips; mip++)
+    {
+        bc1_encode_image(src, w, h, ncomponents, data + getMipOffset(mip));
+        if (mip + 1 < nmips)
+        {
+            next_buffer.resize((size_t)(w >> 1) * (h >> 1) * ncomponents);
+            generateMip(src, next_buffer.data(), w >> 1, h >> 1, ncomponents);
+            mip_buffer.swap(next_buffer);
+            src = mip_buffer.data();
+        }
+        w >>= 1;
+        h >>= 1;
+    }
+
+    return true;
+}
+// </FS>
+
 // virtual
 bool LLImageDXT::convertToDXR()
 {
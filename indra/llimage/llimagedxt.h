@@ -117,6 +117,12 @@ public:
 
     bool convertToDXR(); // convert from DXT to DXR
 
+    // <FS> Compressed texture cache
+    // Software encodes raw_image (RGB, or RGBA whose alpha is ignored) to
+    // DXR1 with the full mip chain, ready for LLImageGL::createGLTextureCompressed()
+    bool encodeBC1(const LLImageRaw* raw_image);
+    // </FS>
+
     static void checkMinWidthHeight(EFileFormat format, S32& width, S32& height);
     static S32 formatBits(EFileFormat format);
     static S32 formatBytes(EFileFormat format, S32 width, S32 height);
@@ -40,6 +40,7 @@ LLImageJ2CImpl* fallbackCreateLLImageJ2CImpl();
 
 // Test data gathering handle
 LLImageCompressionTester* LLImageJ2C::sTesterp = NULL ;
+S32 LLImageJ2C::sMaxThreadsPerDecode = 1; // <FS/> Threaded J2C decode
 const std::string sTesterName("ImageCompressionTester");
 
 //static
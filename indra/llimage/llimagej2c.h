@@ -78,6 +78,13 @@ public:
 
     static std::string getEngineInfo();
 
+    // <FS> Threaded J2C decode
+    // Most threads a decoder may spend inside a single large image, 1 keeps
+    // every decode on the thread that asked for it
+    static void setMaxThreadsPerDecode(S32 threads) { sMaxThreadsPerDecode = llmax(threads, 1); }
+    static S32 getMaxThreadsPerDecode() { return sMaxThreadsPerDecode; }
+    // </FS>
+
 protected:
     friend class LLImageJ2CImpl;
     friend class LLImageJ2COJ;
@@ -99,6 +106,8 @@ protected:
 
     // Image compression/decompression tester
     static LLImageCompressionTester* sTesterp;
+
+    static S32 sMaxThreadsPerDecode; // <FS/> Threaded J2C decode
 };
 
 // Derive from this class to implement JPEG2000 decoding
@@ -85,14 +85,19 @@ size_t LLImageDecodeThread::update(F32 max_time_ms)
 
 size_t LLImageDecodeThread::getPending()
 {
-    return mThreadPool->getQueue().size();
+    // <FS> Prioritized image decode
+    //return mThreadPool->getQueue().size();
+    LLMutexLock lock(&mPendingMutex);
+    return mPending.size();
+    // </FS>
 }
 
 LLImageDecodeThread::handle_t LLImageDecodeThread::decodeImage(
     const LLPointer<LLImageFormatted>& image,
     S32 discard,
     bool needs_aux,
-    const LLPointer<LLImageDecodeThread::Responder>& responder)
+    const LLPointer<LLImageDecodeThread::Responder>& responder,
+    F32 priority) // <FS/> Prioritized image decode
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
 
@@ -100,26 +105,107 @@ LLImageDecodeThread::handle_t LLImageDecodeThread::decodeImage(
     if (decode_id == 0)
         decode_id = ++mDecodeCount;
 
+    // <FS> Prioritized image decode
     // Instantiate the ImageRequest right in the lambda, why not?
-    bool posted = mThreadPool->getQueue().post(
-        [req = ImageRequest(image, discard, needs_aux, responder, decode_id)]
-        () mutable
-        {
-            auto done = req.processRequest();
-            req.finishRequest(done);
-        });
+    //bool posted = mThreadPool->getQueue().post(
+    //    [req = ImageRequest(image, discard, needs_aux, responder, decode_id)]
+    //    () mutable
+    //    {
+    //        auto done = req.processRequest();
+    //        req.finishRequest(done);
+    //    });
+    {
+        LLMutexLock lock(&mPendingMutex);
+        mPending[decode_id] = PendingDecode{ std::make_unique<ImageRequest>(image, discard, needs_aux, responder, decode_id), priority };
+        mPendingOrder.emplace(priority, decode_id);
+    }
+
+    // The job does not carry the request: it picks the best pending one
+    // when a worker gets to it, so later reprioritization takes effect.
+    bool posted = mThreadPool->getQueue().post([this]() { decodeHighestPriority(); });
     if (! posted)
     {
         LL_DEBUGS() << "Tried to start decoding on shutdown" << LL_ENDL;
+        cancel(decode_id);
         return 0;
     }
+    // </FS>
 
     return decode_id;
 }
 
+// <FS> Prioritized image decode
+// WORKER THREAD
+void LLImageDecodeThread::decodeHighestPriority()
+{
+    std::unique_ptr<ImageRequest> req;
+    {
+        LLMutexLock lock(&mPendingMutex);
+        if (mPendingOrder.empty())
+        {
+            // The request this job was posted for has been cancelled
+            return;
+        }
+        auto order_it = mPendingOrder.begin();
+        auto pending_it = mPending.find(order_it->second);
+        mPendingOrder.erase(order_it);
+        if (pending_it == mPending.end())
+        {
+            return;
+        }
+        req = std::move(pending_it->second.mRequest);
+        mPending.erase(pending_it);
+    }
+
+    auto done = req->processRequest();
+    req->finishRequest(done);
+}
+
+bool LLImageDecodeThread::setPriority(handle_t handle, F32 priority)
+{
+    LLMutexLock lock(&mPendingMutex);
+    auto it = mPending.find(handle);
+    if (it == mPending.end())
+    {
+        return false;
+    }
+    if (it->second.mPriority != priority)
+    {
+        mPendingOrder.erase(std::make_pair(it->second.mPriority, handle));
+        mPendingOrder.emplace(priority, handle);
+        it->second.mPriority = priority;
+    }
+    return true;
+}
+
+bool LLImageDecodeThread::cancel(handle_t handle)
+{
+    std::unique_ptr<ImageRequest> req;
+    {
+        LLMutexLock lock(&mPendingMutex);
+        auto it = mPending.find(handle);
+        if (it == mPending.end())
+        {
+            return false;
+        }
+        mPendingOrder.erase(std::make_pair(it->second.mPriority, handle));
+        req = std::move(it->second.mRequest);
+        mPending.erase(it);
+    }
+    // req (and the image data it holds) is released outside the lock;
+    // the job posted for it will find nothing to do and return.
+    return true;
+}
+// </FS>
+
 void LLImageDecodeThread::shutdown()
 {
     mThreadPool->close();
+    // <FS> Prioritized image decode
+    LLMutexLock lock(&mPendingMutex);
+    mPendingOrder.clear();
+    mPending.clear();
+    // </FS>
 }
 
 LLImageDecodeThread::Responder::~Responder()
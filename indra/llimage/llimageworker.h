@@ -30,6 +30,13 @@
 #include "llimage.h"
 #include "llpointer.h"
 #include "threadpool_fwd.h"
+// <FS> Prioritized image decode
+#include "llmutex.h"
+#include <set>
+#include <unordered_map>
+
+class ImageRequest;
+// </FS>
 
 class LLImageDecodeThread
 {
@@ -48,15 +55,54 @@ public:
 
     // meant to resemble LLQueuedThread::handle_t
     typedef U32 handle_t;
+    // <FS> Prioritized image decode
+    // Requests with a higher priority are decoded first; equal priorities
+    // are decoded in submission order.
+    //handle_t decodeImage(const LLPointer<LLImageFormatted>& image,
+    //                     S32 discard, bool needs_aux,
+    //                     const LLPointer<Responder>& responder);
     handle_t decodeImage(const LLPointer<LLImageFormatted>& image,
                          S32 discard, bool needs_aux,
-                         const LLPointer<Responder>& responder);
+                         const LLPointer<Responder>& responder,
+                         F32 priority = 0.f);
+    // Change the priority of a request that has not started decoding yet.
+    // Returns false if the request is already running or finished.
+    bool setPriority(handle_t handle, F32 priority);
+    // Drop a request that has not started decoding yet. Its responder will
+    // never be called. Returns false if the request is already running or
+    // finished, in which case the responder still fires.
+    bool cancel(handle_t handle);
+    // </FS>
     size_t getPending();
     size_t update(F32 max_time_ms);
     S32 getTotalDecodeCount() { return mDecodeCount; }
     void shutdown();
 
 private:
+    // <FS> Prioritized image decode
+    // Each queued request posts one job to mThreadPool; the job decodes
+    // whichever pending request has the highest priority at that moment.
+    void decodeHighestPriority();
+
+    struct PendingDecode
+    {
+        std::unique_ptr<ImageRequest> mRequest;
+        F32 mPriority;
+    };
+    // (priority, handle) ordered highest priority first, then oldest handle
+    struct ComparePending
+    {
+        bool operator()(const std::pair<F32, handle_t>& lhs, const std::pair<F32, handle_t>& rhs) const
+        {
+            return lhs.first != rhs.first ? lhs.first > rhs.first : lhs.second < rhs.second;
+        }
+    };
+    // Declared before mThreadPool so they outlive its worker threads
+    LLMutex mPendingMutex;
+    std::unordered_map<handle_t, PendingDecode> mPending;
+    std::set<std::pair<F32, handle_t>, ComparePending> mPendingOrder;
+    // </FS>
+
     // As of SL-17483, LLImageDecodeThread is no longer itself an
     // LLQueuedThread - instead this is the API by which we submit work to the
     // "ImageDecode" ThreadPool.
@@ -35,6 +35,12 @@
 #include "../llcommon/lltrace.h"
 // Tut header
 #include "../test/lltut.h"
+// <FS> Prioritized image decode
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+// </FS>
 
 // -------------------------------------------------------------------------------------------
 // Stubbing: Declarations required to link and run the class being tested
@@ -110,11 +116,71 @@ namespace tut
             bool* done;
     };
 
+    // <FS> Prioritized image decode
+    // Holds decode workers inside completed() until the test lets them go,
+    // so the requests queued meanwhile stay pending.
+    struct decode_gate
+    {
+        std::mutex mMutex;
+        std::condition_variable mCondition;
+        S32 mEntered = 0;
+        S32 mPermits = 0;
+        std::vector<std::string> mCompleted;
+
+        void release(S32 count)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mPermits += count;
+            mCondition.notify_all();
+        }
+
+        template <typename PRED>
+        bool waitFor(PRED pred)
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            return mCondition.wait_for(lock, std::chrono::seconds(10), pred);
+        }
+    };
+
+    class responder_blocker : public LLImageDecodeThread::Responder
+    {
+        public:
+            responder_blocker(decode_gate* gate) : mGate(gate) {}
+            virtual void completed(bool success, const std::string& error_message, LLImageRaw* raw, LLImageRaw* aux, U32 request_id)
+            {
+                std::unique_lock<std::mutex> lock(mGate->mMutex);
+                ++mGate->mEntered;
+                mGate->mCondition.notify_all();
+                mGate->mCondition.wait(lock, [this]() { return mGate->mPermits > 0; });
+                --mGate->mPermits;
+            }
+        private:
+            decode_gate* mGate;
+    };
+
+    // Records the order in which requests complete
+    class responder_recorder : public LLImageDecodeThread::Responder
+    {
+        public:
+            responder_recorder(decode_gate* gate, const std::string& name) : mGate(gate), mName(name) {}
+            virtual void completed(bool success, const std::string& error_message, LLImageRaw* raw, LLImageRaw* aux, U32 request_id)
+            {
+                std::lock_guard<std::mutex> lock(mGate->mMutex);
+                mGate->mCompleted.push_back(mName);
+                mGate->mCondition.notify_all();
+            }
+        private:
+            decode_gate* mGate;
+            std::string mName;
+    };
+    // </FS>
+
     // Test wrapper declaration : decode thread
     struct imagedecodethread_test
     {
         // Instance to be tested
         LLImageDecodeThread* mThread;
+        decode_gate mGate; // <FS/> Prioritized image decode
         // Constructor and destructor of the test wrapper
         imagedecodethread_test()
         {
@@ -122,8 +188,33 @@ namespace tut
         }
         ~imagedecodethread_test()
         {
+            mGate.release(DECODE_WORKERS); // <FS/> Prioritized image decode
             delete mThread;
         }
+
+        // <FS> Prioritized image decode
+        // Width of the "ImageDecode" pool LLImageDecodeThread creates
+        static const S32 DECODE_WORKERS = 8;
+
+        // Starts the thread with every worker but one held by the gate, so
+        // requests queued afterwards run one at a time once released.
+        void startSingleWorker()
+        {
+            mThread = new LLImageDecodeThread(true);
+            for (S32 i = 0; i < DECODE_WORKERS; ++i)
+            {
+                mThread->decodeImage(NULL, 0, false, new responder_blocker(&mGate), 100.f);
+            }
+            ensure("LLImageDecodeThread: workers never picked up the blocking requests",
+                   mGate.waitFor([this]() { return mGate.mEntered == DECODE_WORKERS; }));
+        }
+
+        void waitForCompleted(size_t count)
+        {
+            ensure("LLImageDecodeThread: requests not processed",
+                   mGate.waitFor([this, count]() { return mGate.mCompleted.size() >= count; }));
+        }
+        // </FS>
     };
 
     // Tut templating thingamagic: test group, object and test instance
@@ -166,4 +257,62 @@ namespace tut
         // Verifies that the responder has now been called
         ensure("LLImageDecodeThread: threaded work unit not processed", done == true);
     }
+
+    // <FS> Prioritized image decode
+    template<> template<>
+    void imagedecodethread_object_t::test<2>()
+    {
+        // Pending requests are decoded highest priority first
+        startSingleWorker();
+        mThread->decodeImage(NULL, 0, false, new responder_recorder(&mGate, "low"), 1.f);
+        mThread->decodeImage(NULL, 0, false, new responder_recorder(&mGate, "high"), 3.f);
+        mThread->decodeImage(NULL, 0, false, new responder_recorder(&mGate, "mid"), 2.f);
+        mThread->decodeImage(NULL, 0, false, new responder_recorder(&mGate, "mid2"), 2.f);
+        ensure_equals("LLImageDecodeThread: requests not pending", mThread->getPending(), size_t(4));
+
+        mGate.release(1);
+        waitForCompleted(4);
+        ensure_equals("LLImageDecodeThread: first", mGate.mCompleted[0], "high");
+        ensure_equals("LLImageDecodeThread: second", mGate.mCompleted[1], "mid");
+        ensure_equals("LLImageDecodeThread: equal priorities not in submission order", mGate.mCompleted[2], "mid2");
+        ensure_equals("LLImageDecodeThread: last", mGate.mCompleted[3], "low");
+    }
+
+    template<> template<>
+    void imagedecodethread_object_t::test<3>()
+    {
+        // setPriority() reorders a pending request
+        startSingleWorker();
+        LLImageDecodeThread::handle_t first = mThread->decodeImage(NULL, 0, false, new responder_recorder(&mGate, "first"), 1.f);
+        mThread->decodeImage(NULL, 0, false, new responder_recorder(&mGate, "second"), 2.f);
+        ensure("LLImageDecodeThread: setPriority() on a pending request failed", mThread->setPriority(first, 5.f));
+
+        mGate.release(1);
+        waitForCompleted(2);
+        ensure_equals("LLImageDecodeThread: raised request not decoded first", mGate.mCompleted[0], "first");
+        ensure_equals("LLImageDecodeThread: lowered request not decoded last", mGate.mCompleted[1], "second");
+        ensure("LLImageDecodeThread: setPriority() on a finished request succeeded", !mThread->setPriority(first, 1.f));
+    }
+
+    template<> template<>
+    void imagedecodethread_object_t::test<4>()
+    {
+        // cancel() drops a pending request without calling its responder
+        startSingleWorker();
+        LLImageDecodeThread::handle_t kept = mThread->decodeImage(NULL, 0, false, new responder_recorder(&mGate, "kept"), 1.f);
+        LLImageDecodeThread::handle_t cancelled = mThread->decodeImage(NULL, 0, false, new responder_recorder(&mGate, "cancelled"), 2.f);
+        ensure("LLImageDecodeThread: cancel() on a pending request failed", mThread->cancel(cancelled));
+        ensure_equals("LLImageDecodeThread: cancelled request still pending", mThread->getPending(), size_t(1));
+
+        mGate.release(1);
+        // The single free worker runs the jobs in order, so once this one is
+        // done the job posted for the cancelled request has run as well.
+        mThread->decodeImage(NULL, 0, false, new responder_recorder(&mGate, "after"), 1.f);
+        waitForCompleted(2);
+        ensure_equals("LLImageDecodeThread: completed requests", mGate.mCompleted.size(), size_t(2));
+        ensure_equals("LLImageDecodeThread: kept request", mGate.mCompleted[0], "kept");
+        ensure_equals("LLImageDecodeThread: later request", mGate.mCompleted[1], "after");
+        ensure("LLImageDecodeThread: cancel() on a finished request succeeded", !mThread->cancel(kept));
+    }
+    // </FS>
 }
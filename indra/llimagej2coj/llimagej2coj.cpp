@@ -107,6 +107,16 @@ public:
 
 #define WANT_VERBOSE_OPJ_SPAM LL_DEBUG
 
+// <FS> Zero-copy cache reads
+// Size of the read buffer OpenJPEG keeps inside a decode stream. The
+// codestream is already in memory, so the stream buffer only has to be
+// large enough for the small marker reads; anything larger is read
+// directly from our buffer into the decoder's own. Sizing it to the whole
+// codestream would allocate and copy the complete image again for every
+// header parse and decode.
+constexpr OPJ_SIZE_T J2C_DECODE_STREAM_BUFFER_SIZE = 64 * 1024;
+// </FS>
+
 static void opj_info(const char* msg, void* user_data)
 {
     llassert(user_data);
@@ -344,7 +354,7 @@ public:
             opj_stream_destroy(stream);
         }
 
-        stream = opj_stream_create(dataSize, true);
+        stream = opj_stream_create(llmin((OPJ_SIZE_T)dataSize, J2C_DECODE_STREAM_BUFFER_SIZE), true); // <FS/> Zero-copy cache reads
         if (!stream)
         {
             return false;
@@ -397,13 +407,23 @@ public:
         return true;
     }
 
-    bool decode(U8* data, U32 dataSize, U32* channels, U8 discard_level)
+    bool decode(U8* data, U32 dataSize, U32* channels, U8 discard_level, S32 threads = 1, const S32* region = nullptr) // <FS/> Threaded J2C decode
     {
         parameters.flags &= ~OPJ_DPARAMETERS_DUMP_FLAG;
 
         decoder = opj_create_decompress(OPJ_CODEC_J2K);
         opj_setup_decoder(decoder, &parameters);
 
+        // <FS> Threaded J2C decode
+#if OPJ_VERSION_MAJOR > 2 || (OPJ_VERSION_MAJOR == 2 && OPJ_VERSION_MINOR >= 3)
+        // Spreads the code-blocks of each tile over a pool of its own
+        if (threads > 1 && opj_has_thread_support())
+        {
+            opj_codec_set_threads(decoder, threads);
+        }
+#endif
+        // </FS>
+
         opj_set_info_handler(decoder, opj_info, this);
         opj_set_warning_handler(decoder, opj_warn, this);
         opj_set_error_handler(decoder, opj_error, this);
@@ -413,7 +433,7 @@ public:
             opj_stream_destroy(stream);
         }
 
-        stream = opj_stream_create(dataSize, true);
+        stream = opj_stream_create(llmin((OPJ_SIZE_T)dataSize, J2C_DECODE_STREAM_BUFFER_SIZE), true); // <FS/> Zero-copy cache reads
         if (!stream)
         {
             return false;
@@ -447,6 +467,14 @@ public:
             return false;
         }
 
+        // <FS> Threaded J2C decode
+        // Only decode the code-blocks that touch the region, in full resolution coordinates
+        if (region && !opj_set_decode_area(decoder, image, region[0], region[1], region[2], region[3]))
+        {
+            return false;
+        }
+        // </FS>
+
         // needs to happen before decode which may fail
         if (channels)
         {
@@ -805,6 +833,26 @@ private:
 };
 
 
+// <FS> Threaded J2C decode
+// OpenJPEG splits the work by code-blocks, and opj_codec_set_threads()
+// starts and joins a thread pool of its own for every decode. That only
+// pays off on the largest images, everything smaller stays on one thread
+// and leaves the cores to the other ImageDecode workers.
+static const S32 MIN_THREADED_DECODE_PIXELS = 1024 * 1024;
+
+static S32 decode_threads_for(S32 width, S32 height, S32 discard_level)
+{
+    const S32 max_threads = LLImageJ2C::getMaxThreadsPerDecode();
+    discard_level = llclamp(discard_level, 0, (S32)MAX_DISCARD_LEVEL);
+    const S32 pixels = (width >> discard_level) * (height >> discard_level);
+    if (max_threads <= 1 || pixels < MIN_THREADED_DECODE_PIXELS)
+    {
+        return 1;
+    }
+    return max_threads;
+}
+// </FS>
+
 LLImageJ2COJ::LLImageJ2COJ()
     : LLImageJ2CImpl()
 {
@@ -818,6 +866,13 @@ LLImageJ2COJ::~LLImageJ2COJ()
 bool LLImageJ2COJ::initDecode(LLImageJ2C &base, LLImageRaw &raw_image, int discard_level, int* region)
 {
     base.mDiscardLevel = discard_level;
+    // <FS> Threaded J2C decode
+    mUseRegion = (region != nullptr);
+    if (mUseRegion)
+    {
+        memcpy(mRegion, region, sizeof(mRegion));
+    }
+    // </FS>
     return false;
 }
 
@@ -879,7 +934,10 @@ bool LLImageJ2COJ::decodeImpl(LLImageJ2C &base, LLImageRaw &raw_image, F32 decod
     U32 image_channels = 0;
     S32 data_size = base.getDataSize();
     S32 max_bytes = (base.getMaxBytes() ? base.getMaxBytes() : data_size);
-    bool decoded = decoder.decode(base.getData(), max_bytes, &image_channels, base.mDiscardLevel);
+    // <FS> Threaded J2C decode
+    S32 threads = decode_threads_for(base.getWidth(), base.getHeight(), base.mDiscardLevel);
+    bool decoded = decoder.decode(base.getData(), max_bytes, &image_channels, base.mDiscardLevel, threads, mUseRegion ? mRegion : nullptr);
+    // </FS>
 
     // set correct channel count early so failed decodes don't miss it...
     S32 channels = (S32)image_channels - first_channel;
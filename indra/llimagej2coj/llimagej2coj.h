@@ -44,6 +44,12 @@ protected:
     virtual bool initDecode(LLImageJ2C &base, LLImageRaw &raw_image, int discard_level = -1, int* region = NULL);
     virtual bool initEncode(LLImageJ2C &base, LLImageRaw &raw_image, int blocks_size = -1, int precincts_size = -1, int levels = 0);
     virtual std::string getEngineInfo() const;
+
+    // <FS> Threaded J2C decode
+    // Region of interest set by initDecode(): x0, y0, x1, y1 at full resolution
+    bool mUseRegion { false };
+    S32  mRegion[4] { 0, 0, 0, 0 };
+    // </FS>
 };
 
 #endif
@@ -2730,6 +2730,269 @@ bool LLVolume::unpackVolumeFacesInternal(const LLSD& mdl)
     return true;
 }
 
+// <FS> Decoded mesh cache
+const U32 LLVolume::DECODED_FACES_VERSION = 1;
+
+namespace
+{
+    constexpr U32 DECODED_FACES_MAGIC = 0x5346444D; // "MDFS"
+
+    enum : U32
+    {
+        DECODED_FACE_TANGENTS = 1 << 0,
+        DECODED_FACE_WEIGHTS = 1 << 1,
+        DECODED_FACE_WEIGHTS_SCRUBBED = 1 << 2
+    };
+
+    struct DecodedFacesHeader
+    {
+        U32 mMagic;
+        U32 mVersion;
+        U32 mNumFaces;
+        U32 mSize;      // of the whole blob, header included
+    };
+    static_assert(sizeof(DecodedFacesHeader) == 16, "DecodedFacesHeader must stay 16 bytes");
+
+    // Followed by the vertex and index arrays, each padded to 16 bytes so
+    // an aligned blob keeps every array aligned:
+    // positions, normals, texture coordinates, [tangents], [weights], indices
+    struct DecodedFaceHeader
+    {
+        F32 mExtents[3][4];         // min, max, center
+        F32 mTexCoordExtents[4];
+        F32 mNormalizedScale[3];
+        U32 mFlags;
+        S32 mID;
+        U32 mTypeMask;
+        S32 mNumVertices;
+        S32 mNumIndices;
+    };
+    static_assert(sizeof(DecodedFaceHeader) == 96, "DecodedFaceHeader must stay 96 bytes");
+
+    inline size_t pad16(size_t size)
+    {
+        return (size + 0xF) & ~(size_t)0xF;
+    }
+
+    size_t decoded_face_data_size(U32 flags, S32 num_vertices, S32 num_indices)
+    {
+        const size_t vert_size = sizeof(LLVector4a) * num_vertices;
+        size_t size = vert_size * 2 + pad16(sizeof(LLVector2) * num_vertices);
+        if (flags & DECODED_FACE_TANGENTS)
+        {
+            size += vert_size;
+        }
+        if (flags & DECODED_FACE_WEIGHTS)
+        {
+            size += vert_size;
+        }
+        return size + pad16(sizeof(U16) * num_indices);
+    }
+}
+
+// static
+U8 LLVolume::getDecodedFacesVariant(const LLVolumeParams& params)
+{
+    return params.getSculptType() & LL_SCULPT_FLAG_MASK;
+}
+
+bool LLVolume::packDecodedFaces(std::vector<U8>& out) const
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_VOLUME;
+    if (mVolumeFaces.empty())
+    {
+        return false;
+    }
+
+    size_t total = sizeof(DecodedFacesHeader);
+    for (const LLVolumeFace& face : mVolumeFaces)
+    {
+        const U32 flags = (face.mTangents ? DECODED_FACE_TANGENTS : 0) | (face.mWeights ? DECODED_FACE_WEIGHTS : 0);
+        total += sizeof(DecodedFaceHeader) + decoded_face_data_size(flags, face.mNumVertices, face.mNumIndices);
+    }
+    if (total > (size_t)S32_MAX)
+    {
+        return false;
+    }
+
+    out.assign(total, 0);
+    U8* dst = out.data();
+
+    DecodedFacesHeader header = { DECODED_FACES_MAGIC, DECODED_FACES_VERSION, (U32)mVolumeFaces.size(), (U32)total };
+    memcpy(dst, &header, sizeof(header));
+    dst += sizeof(header);
+
+    for (const LLVolumeFace& face : mVolumeFaces)
+    {
+        DecodedFaceHeader face_header;
+        for (S32 i = 0; i < 3; ++i)
+        {
+            memcpy(face_header.mExtents[i], face.mExtents[i].getF32ptr(), sizeof(F32) * 4);
+        }
+        face_header.mTexCoordExtents[0] = face.mTexCoordExtents[0].mV[VX];
+        face_header.mTexCoordExtents[1] = face.mTexCoordExtents[0].mV[VY];
+        face_header.mTexCoordExtents[2] = face.mTexCoordExtents[1].mV[VX];
+        face_header.mTexCoordExtents[3] = face.mTexCoordExtents[1].mV[VY];
+        memcpy(face_header.mNormalizedScale, face.mNormalizedScale.mV, sizeof(F32) * 3);
+        face_header.mFlags = (face.mTangents ? DECODED_FACE_TANGENTS : 0) |
+                             (face.mWeights ? DECODED_FACE_WEIGHTS : 0) |
+                             (face.mWeightsScrubbed ? DECODED_FACE_WEIGHTS_SCRUBBED : 0);
+        face_header.mID = face.mID;
+        face_header.mTypeMask = face.mTypeMask;
+        face_header.mNumVertices = face.mNumVertices;
+        face_header.mNumIndices = face.mNumIndices;
+        memcpy(dst, &face_header, sizeof(face_header));
+        dst += sizeof(face_header);
+
+        const size_t vert_size = sizeof(LLVector4a) * face.mNumVertices;
+        if (vert_size)
+        {
+            memcpy(dst, face.mPositions, vert_size);
+            dst += vert_size;
+            memcpy(dst, face.mNormals, vert_size);
+            dst += vert_size;
+            memcpy(dst, face.mTexCoords, sizeof(LLVector2) * face.mNumVertices);
+            dst += pad16(sizeof(LLVector2) * face.mNumVertices);
+            if (face.mTangents)
+            {
+                memcpy(dst, face.mTangents, vert_size);
+                dst += vert_size;
+            }
+            if (face.mWeights)
+            {
+                memcpy(dst, face.mWeights, vert_size);
+                dst += vert_size;
+            }
+        }
+        if (face.mNumIndices)
+        {
+            memcpy(dst, face.mIndices, sizeof(U16) * face.mNumIndices);
+            dst += pad16(sizeof(U16) * face.mNumIndices);
+        }
+    }
+
+    llassert(dst == out.data() + out.size());
+    return true;
+}
+
+bool LLVolume::unpackDecodedFaces(const U8* data, S32 size)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_VOLUME;
+    DecodedFacesHeader header;
+    if (!data || size < (S32)sizeof(header))
+    {
+        return false;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (header.mMagic != DECODED_FACES_MAGIC || header.mVersion != DECODED_FACES_VERSION ||
+        header.mSize != (U32)size || header.mNumFaces == 0)
+    {
+        return false;
+    }
+
+    const U8* src = data + sizeof(header);
+    const U8* end = data + size;
+
+    mVolumeFaces.clear();
+    mVolumeFaces.resize(header.mNumFaces);
+    for (LLVolumeFace& face : mVolumeFaces)
+    {
+        DecodedFaceHeader face_header;
+        if ((size_t)(end - src) < sizeof(face_header))
+        {
+            mVolumeFaces.clear();
+            return false;
+        }
+        memcpy(&face_header, src, sizeof(face_header));
+        src += sizeof(face_header);
+
+        const S32 num_vertices = face_header.mNumVertices;
+        const S32 num_indices = face_header.mNumIndices;
+        if (num_vertices < 0 || num_vertices > 65536 || num_indices < 0 || num_indices % 3 != 0 ||
+            (size_t)(end - src) < decoded_face_data_size(face_header.mFlags, num_vertices, num_indices))
+        {
+            LL_WARNS() << "Corrupted decoded mesh data" << LL_ENDL;
+            mVolumeFaces.clear();
+            return false;
+        }
+
+        face.mID = face_header.mID;
+        face.mTypeMask = face_header.mTypeMask;
+        for (S32 i = 0; i < 3; ++i)
+        {
+            face.mExtents[i].loadua(face_header.mExtents[i]);
+        }
+        face.mTexCoordExtents[0].set(face_header.mTexCoordExtents[0], face_header.mTexCoordExtents[1]);
+        face.mTexCoordExtents[1].set(face_header.mTexCoordExtents[2], face_header.mTexCoordExtents[3]);
+        face.mNormalizedScale.set(face_header.mNormalizedScale);
+
+        face.resizeVertices(num_vertices);
+        face.resizeIndices(num_indices);
+        if (face.mNumVertices != num_vertices || face.mNumIndices != num_indices)
+        {
+            // Out of memory
+            mVolumeFaces.clear();
+            return false;
+        }
+
+        const size_t vert_size = sizeof(LLVector4a) * num_vertices;
+        if (vert_size)
+        {
+            memcpy(face.mPositions, src, vert_size);
+            src += vert_size;
+            memcpy(face.mNormals, src, vert_size);
+            src += vert_size;
+            memcpy(face.mTexCoords, src, sizeof(LLVector2) * num_vertices);
+            src += pad16(sizeof(LLVector2) * num_vertices);
+            if (face_header.mFlags & DECODED_FACE_TANGENTS)
+            {
+                face.allocateTangents(num_vertices);
+                if (!face.mTangents)
+                {
+                    mVolumeFaces.clear();
+                    return false;
+                }
+                memcpy(face.mTangents, src, vert_size);
+                src += vert_size;
+            }
+            if (face_header.mFlags & DECODED_FACE_WEIGHTS)
+            {
+                face.allocateWeights(num_vertices);
+                if (!face.mWeights)
+                {
+                    mVolumeFaces.clear();
+                    return false;
+                }
+                memcpy(face.mWeights, src, vert_size);
+                src += vert_size;
+                face.mWeightsScrubbed = (face_header.mFlags & DECODED_FACE_WEIGHTS_SCRUBBED) != 0;
+            }
+        }
+        if (num_indices)
+        {
+            memcpy(face.mIndices, src, sizeof(U16) * num_indices);
+            src += pad16(sizeof(U16) * num_indices);
+
+            // A bad index would read past the vertex arrays when rendering
+            for (S32 i = 0; i < num_indices; ++i)
+            {
+                if (face.mIndices[i] >= num_vertices)
+                {
+                    LL_WARNS() << "Corrupted decoded mesh data" << LL_ENDL;
+                    mVolumeFaces.clear();
+                    return false;
+                }
+            }
+        }
+
+        face.mOptimized = true;
+    }
+
+    mSculptLevel = 0;
+    return true;
+}
+// </FS>
+
 
 bool LLVolume::isMeshAssetLoaded() const
 {
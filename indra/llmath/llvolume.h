@@ -1126,6 +1126,20 @@ protected:
 public:
     bool unpackVolumeFaces(std::istream& is, S32 size);
     bool unpackVolumeFaces(U8* in_data, S32 size);
+
+    // <FS> Decoded mesh cache
+    // Flat binary copy of the decoded, cache optimized faces of a mesh LOD.
+    // Loading it back is a bounds check and a few copies per face, no LLSD
+    // or zlib involved. Bump DECODED_FACES_VERSION whenever the layout or
+    // the output of unpackVolumeFaces() changes.
+    static const U32 DECODED_FACES_VERSION;
+    // unpackVolumeFaces() bakes the mirror and invert sculpt flags into
+    // the faces, so decoded faces can only be shared between volumes of
+    // the same variant.
+    static U8 getDecodedFacesVariant(const LLVolumeParams& params);
+    bool packDecodedFaces(std::vector<U8>& out) const;
+    bool unpackDecodedFaces(const U8* data, S32 size);
+    // </FS>
 private:
     bool unpackVolumeFacesInternal(const LLSD& mdl);
 
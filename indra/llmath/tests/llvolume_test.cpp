@@ -0,0 +1,189 @@
+/**
+ * @file llvolume_test.cpp
+ * @brief Tests for the decoded mesh face cache of LLVolume
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llvolume.h"
+
+#include "llsd.h"
+#include "llsdserialize.h"
+#include "lluuid.h"
+
+#include "../test/lltut.h"
+
+#include <vector>
+
+namespace
+{
+    const LLUUID MESH_ID("0c1b9f8e-3a57-4d0e-8f40-7d6c2b1a9e55");
+
+    LLSD vec2(F32 x, F32 y)
+    {
+        LLSD sd;
+        sd.append(x);
+        sd.append(y);
+        return sd;
+    }
+
+    LLSD::Binary u16_binary(const std::vector<U16>& values)
+    {
+        const U8* bytes = reinterpret_cast<const U8*>(values.data());
+        return LLSD::Binary(bytes, bytes + values.size() * sizeof(U16));
+    }
+
+    // One triangle over the unit square corner, facing +Z, as a mesh LOD
+    // asset block: zipped LLSD with positions quantized over [0..1].
+    std::vector<U8> triangle_lod()
+    {
+        LLSD face;
+        face["Position"] = u16_binary({ 0, 0, 0,  65535, 0, 0,  0, 65535, 0 });
+        face["Normal"] = u16_binary({ 32768, 32768, 65535,  32768, 32768, 65535,  32768, 32768, 65535 });
+        face["TexCoord0"] = u16_binary({ 0, 0,  65535, 0,  0, 65535 });
+        face["TriangleList"] = u16_binary({ 0, 1, 2 });
+        face["PositionDomain"]["Min"] = LLVector3(0.f, 0.f, 0.f).getValue();
+        face["PositionDomain"]["Max"] = LLVector3(1.f, 1.f, 1.f).getValue();
+        face["TexCoord0Domain"]["Min"] = vec2(0.f, 0.f);
+        face["TexCoord0Domain"]["Max"] = vec2(1.f, 1.f);
+
+        LLSD mdl;
+        mdl.append(face);
+        const std::string zipped = zip_llsd(mdl);
+        return std::vector<U8>(zipped.begin(), zipped.end());
+    }
+
+    LLVolumeParams mesh_params(U8 flags)
+    {
+        LLVolumeParams params;
+        params.setType(LL_PCODE_PROFILE_SQUARE, LL_PCODE_PATH_LINE);
+        params.setSculptID(MESH_ID, LL_SCULPT_TYPE_MESH | flags);
+        return params;
+    }
+
+    LLPointer<LLVolume> decode_lod(const LLVolumeParams& params)
+    {
+        LLPointer<LLVolume> volume = new LLVolume(params, 1.f);
+        std::vector<U8> data = triangle_lod();
+        if (!volume->unpackVolumeFaces(data.data(), (S32)data.size()))
+        {
+            return LLPointer<LLVolume>();
+        }
+        return volume;
+    }
+
+    // Geometric normal of the first triangle, from its winding
+    LLVector4a winding_normal(const LLVolumeFace& face)
+    {
+        const LLVector4a& a = face.mPositions[face.mIndices[0]];
+        LLVector4a ab, ac, n;
+        ab.setSub(face.mPositions[face.mIndices[1]], a);
+        ac.setSub(face.mPositions[face.mIndices[2]], a);
+        n.setCross3(ab, ac);
+        return n;
+    }
+}
+
+namespace tut
+{
+    struct volume_data
+    {
+    };
+    typedef test_group<volume_data> volume_group;
+    typedef volume_group::object volume_object;
+    tut::volume_group volume_testgroup("LLVolume");
+
+    template<> template<>
+    void volume_object::test<1>()
+    {
+        set_test_name("decoded faces round trip");
+
+        LLPointer<LLVolume> plain = decode_lod(mesh_params(0));
+        ensure("plain LOD decodes", plain.notNull());
+
+        std::vector<U8> blob;
+        ensure("plain faces pack", plain->packDecodedFaces(blob));
+
+        LLPointer<LLVolume> loaded = new LLVolume(mesh_params(0), 1.f);
+        ensure("plain faces unpack", loaded->unpackDecodedFaces(blob.data(), (S32)blob.size()));
+        ensure_equals("face count", loaded->getNumVolumeFaces(), plain->getNumVolumeFaces());
+
+        const LLVolumeFace& src = plain->getVolumeFace(0);
+        const LLVolumeFace& dst = loaded->getVolumeFace(0);
+        ensure_equals("vertex count", dst.mNumVertices, src.mNumVertices);
+        ensure_equals("index count", dst.mNumIndices, src.mNumIndices);
+        ensure("positions", !memcmp(dst.mPositions, src.mPositions, sizeof(LLVector4a) * src.mNumVertices));
+        ensure("normals", !memcmp(dst.mNormals, src.mNormals, sizeof(LLVector4a) * src.mNumVertices));
+        ensure("indices", !memcmp(dst.mIndices, src.mIndices, sizeof(U16) * src.mNumIndices));
+    }
+
+    template<> template<>
+    void volume_object::test<2>()
+    {
+        set_test_name("mirrored decoded faces");
+
+        const LLVolumeParams plain_params = mesh_params(0);
+        const LLVolumeParams mirror_params = mesh_params(LL_SCULPT_FLAG_MIRROR);
+        ensure("mirror is its own variant",
+               LLVolume::getDecodedFacesVariant(plain_params) != LLVolume::getDecodedFacesVariant(mirror_params));
+        ensure("invert is its own variant",
+               LLVolume::getDecodedFacesVariant(mirror_params) !=
+               LLVolume::getDecodedFacesVariant(mesh_params(LL_SCULPT_FLAG_MIRROR | LL_SCULPT_FLAG_INVERT)));
+
+        LLPointer<LLVolume> plain = decode_lod(plain_params);
+        LLPointer<LLVolume> mirrored = decode_lod(mirror_params);
+        ensure("both LODs decode", plain.notNull() && mirrored.notNull());
+
+        std::vector<U8> plain_blob, mirror_blob;
+        ensure("both pack", plain->packDecodedFaces(plain_blob) && mirrored->packDecodedFaces(mirror_blob));
+        ensure("mirrored faces differ from plain ones", plain_blob != mirror_blob);
+
+        LLPointer<LLVolume> loaded = new LLVolume(mirror_params, 1.f);
+        ensure("mirrored faces unpack", loaded->unpackDecodedFaces(mirror_blob.data(), (S32)mirror_blob.size()));
+
+        const LLVolumeFace& ref = plain->getVolumeFace(0);
+        const LLVolumeFace& face = loaded->getVolumeFace(0);
+
+        // Reflected through the origin
+        LLVector4a expected_min(ref.mExtents[1]);
+        LLVector4a expected_max(ref.mExtents[0]);
+        expected_min.mul(-1.f);
+        expected_max.mul(-1.f);
+        ensure("mirrored min extent", face.mExtents[0].equals3(expected_min));
+        ensure("mirrored max extent", face.mExtents[1].equals3(expected_max));
+
+        // Winding reversed along with the reflection, so the triangle still
+        // faces the way its vertex normals point, which are flipped as well
+        LLVector4a ref_facing = winding_normal(ref);
+        LLVector4a facing = winding_normal(face);
+        LLVector4a expected_facing(ref_facing);
+        expected_facing.mul(-1.f);
+        ensure("mirrored winding", facing.equals3(expected_facing));
+        ensure("mirrored normals point the same way as the winding",
+               facing.dot3(face.mNormals[face.mIndices[0]]).getF32() > 0.f);
+        ensure("plain normals point the same way as the winding",
+               ref_facing.dot3(ref.mNormals[ref.mIndices[0]]).getF32() > 0.f);
+    }
+}
@@ -161,6 +161,16 @@ public:
 
     void update();
     void updateMatrix(bool update_bounds = true);
+
+    // <FS> Flattened joint hierarchy: store what update() and updateMatrix()
+    // would have computed, for callers that compute it in bulk
+    void setWorldTransform(const LLVector3& pos, const LLQuaternion& rot, const LLMatrix4& mat)
+    {
+        mWorldPosition = pos;
+        mWorldRotation = rot;
+        mWorldMatrix = mat;
+    }
+    // </FS>
     void getMinMax(LLVector3& min,LLVector3& max) const;
 
 protected:
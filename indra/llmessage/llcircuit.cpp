@@ -1288,6 +1288,14 @@ void LLCircuitData::pingTimerStop(const U8 ping_id)
 {
     nd::etw::tickTask( L"receivedPing" );  // <FS:ND/> Write an event for each ping we receice in response. Happens every ~5 seconds. This event should trigger shortly after we send our ping.
     F64Seconds mt_secs = LLMessageSystem::getMessageTimeSeconds();
+    // <FS> Threaded UDP receive
+    // Measure up to when the reply arrived rather than to when this frame got around to it
+    U64 receive_time = gMessageSystem->getLastPacketReceiveTime();
+    if (receive_time)
+    {
+        mt_secs = F64Seconds(U64Microseconds(receive_time));
+    }
+    // </FS>
 
     // Nota Bene: no averaging of ping times until we get a feel for how this works
     F64Seconds time = mt_secs - mPingTime;
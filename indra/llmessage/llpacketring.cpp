@@ -42,10 +42,166 @@
 #include "llrand.h"
 #include "message.h"
 #include "u64.h"
+#include "net.h"
+
+#include <atomic>
+#include <thread>
 
 constexpr S16 MAX_BUFFER_RING_SIZE = 1024;
 constexpr S16 DEFAULT_BUFFER_RING_SIZE = 256;
 
+// <FS> Threaded UDP receive
+// Single producer (the thread), single consumer (the main thread) ring of
+// preallocated packets. The indices only ever grow and wrap on their own, the
+// slot is the index modulo RING_SIZE.
+class LLPacketRing::ReceiveThread
+{
+public:
+    struct Packet
+    {
+        char    mData[NET_BUFFER_SIZE];
+        S32     mSize { 0 };
+        LLHost  mHost;
+        LLHost  mReceivingIF;
+        U64     mReceiveTime { 0 };
+    };
+
+    // Must be a power of two for the indices to wrap cleanly
+    static constexpr U32 RING_SIZE = 1024;
+    static constexpr S32 BATCH_SIZE = 64;
+    // How long the thread blocks before checking whether it should quit
+    static constexpr S32 WAIT_MS = 100;
+
+    ReceiveThread(S32 socket);
+    ~ReceiveThread();
+
+    // Main thread side. front() is null when the ring is empty.
+    Packet* front();
+    void pop();
+    S32 getNumPackets() const { return (S32)(mHead.load(std::memory_order_acquire) - mTail.load(std::memory_order_relaxed)); }
+    S32 getNumBytes() const { return mNumBytes.load(std::memory_order_relaxed); }
+    S32 getNumDroppedPackets() const { return mNumDroppedPackets.load(std::memory_order_relaxed); }
+
+private:
+    void run();
+
+    S32                 mSocket;
+    std::vector<Packet> mPackets;
+    std::atomic<U32>    mHead { 0 }; // next slot to fill, written by the thread only
+    std::atomic<U32>    mTail { 0 }; // next slot to consume, written by the main thread only
+    std::atomic<S32>    mNumBytes { 0 };
+    std::atomic<S32>    mNumDroppedPackets { 0 };
+    std::atomic<bool>   mRunning { true };
+    std::thread         mThread;
+};
+
+LLPacketRing::ReceiveThread::ReceiveThread(S32 socket)
+    : mSocket(socket)
+    , mPackets(RING_SIZE)
+{
+    // Last, everything it touches has to exist by now
+    mThread = std::thread(&ReceiveThread::run, this);
+}
+
+LLPacketRing::ReceiveThread::~ReceiveThread()
+{
+    mRunning = false;
+    if (mThread.joinable())
+    {
+        mThread.join();
+    }
+}
+
+LLPacketRing::ReceiveThread::Packet* LLPacketRing::ReceiveThread::front()
+{
+    const U32 tail = mTail.load(std::memory_order_relaxed);
+    if (tail == mHead.load(std::memory_order_acquire))
+    {
+        return nullptr;
+    }
+    return &mPackets[tail % RING_SIZE];
+}
+
+void LLPacketRing::ReceiveThread::pop()
+{
+    const U32 tail = mTail.load(std::memory_order_relaxed);
+    mNumBytes -= mPackets[tail % RING_SIZE].mSize;
+    mTail.store(tail + 1, std::memory_order_release);
+}
+
+void LLPacketRing::ReceiveThread::run()
+{
+    LL_PROFILER_SET_THREAD_NAME("UDP Receive");
+
+    LLNetPacket batch[BATCH_SIZE];
+    // Only used when the main thread fell so far behind that the ring is full
+    std::unique_ptr<char[]> overflow;
+
+    while (mRunning)
+    {
+        if (!wait_for_packet(mSocket, WAIT_MS))
+        {
+            continue;
+        }
+
+        const U32 head = mHead.load(std::memory_order_relaxed);
+        const U32 free_slots = RING_SIZE - (head - mTail.load(std::memory_order_acquire));
+        if (free_slots == 0)
+        {
+            // Read and count them anyway, otherwise the socket drops them
+            // without anybody knowing and wait_for_packet() never blocks.
+            if (!overflow)
+            {
+                overflow.reset(new char[BATCH_SIZE * NET_BUFFER_SIZE]);
+            }
+            for (S32 i = 0; i < BATCH_SIZE; ++i)
+            {
+                batch[i].mData = overflow.get() + i * NET_BUFFER_SIZE;
+            }
+            mNumDroppedPackets += receive_packets(mSocket, batch, BATCH_SIZE);
+            continue;
+        }
+
+        // Straight into the ring, up to where it wraps around
+        const S32 count = (S32)llmin((U32)BATCH_SIZE, free_slots, RING_SIZE - head % RING_SIZE);
+        for (S32 i = 0; i < count; ++i)
+        {
+            batch[i].mData = mPackets[(head + i) % RING_SIZE].mData;
+        }
+        const S32 received = receive_packets(mSocket, batch, count);
+        const U64 receive_time = totalTime();
+
+        U32 filled = 0;
+        S32 bytes = 0;
+        for (S32 i = 0; i < received; ++i)
+        {
+            const LLNetPacket& received_packet = batch[i];
+            if (received_packet.mSize <= 0)
+            {
+                continue;
+            }
+            Packet& packet = mPackets[(head + filled) % RING_SIZE];
+            if (packet.mData != received_packet.mData)
+            {
+                // Close the gap an empty datagram left
+                memcpy(packet.mData, received_packet.mData, received_packet.mSize);
+            }
+            packet.mSize = received_packet.mSize;
+            packet.mHost = LLHost(received_packet.mSenderIP, received_packet.mSenderPort);
+            packet.mReceivingIF = LLHost(received_packet.mReceivingIP, INVALID_PORT);
+            packet.mReceiveTime = receive_time;
+            bytes += received_packet.mSize;
+            ++filled;
+        }
+        if (filled)
+        {
+            mNumBytes += bytes;
+            mHead.store(head + filled, std::memory_order_release);
+        }
+    }
+}
+// </FS>
+
 LLPacketRing::LLPacketRing ()
     : mPacketRing(DEFAULT_BUFFER_RING_SIZE, nullptr)
 {
@@ -58,6 +214,7 @@ LLPacketRing::LLPacketRing ()
 
 LLPacketRing::~LLPacketRing ()
 {
+    stopReceiveThread(); // <FS/> Threaded UDP receive
     for (auto packet : mPacketRing)
     {
         delete packet;
@@ -71,6 +228,13 @@ LLPacketRing::~LLPacketRing ()
 S32 LLPacketRing::receivePacket (S32 socket, char *datap)
 {
     bool drop = computeDrop();
+    // <FS> Threaded UDP receive
+    mLastReceiveTime = 0;
+    if (mReceiveThread && mNumBufferedPackets == 0)
+    {
+        return receiveOrDropThreadPacket(datap, drop);
+    }
+    // </FS>
     return (mNumBufferedPackets > 0) ?
         receiveOrDropBufferedPacket(datap, drop) :
         receiveOrDropPacket(socket, datap, drop);
@@ -298,6 +462,14 @@ S32 LLPacketRing::bufferInboundPacket(S32 socket)
 
 S32 LLPacketRing::drainSocket(S32 socket)
 {
+    // <FS> Threaded UDP receive
+    if (mReceiveThread)
+    {
+        // The receive thread already keeps the socket empty
+        return getNumBufferedPackets();
+    }
+    // </FS>
+
     // drain into buffer
     S32 packet_size = 1;
     S32 num_loops = 0;
@@ -353,15 +525,117 @@ bool LLPacketRing::expandRing()
 F32 LLPacketRing::getBufferLoadRate() const
 {
     // goes up to MAX_BUFFER_RING_SIZE
-    return (F32)mNumBufferedPackets / (F32)DEFAULT_BUFFER_RING_SIZE;
+    return (F32)getNumBufferedPackets() / (F32)DEFAULT_BUFFER_RING_SIZE; // <FS/> Threaded UDP receive
+}
+
+// <FS> Threaded UDP receive
+S32 LLPacketRing::getNumBufferedPackets() const
+{
+    S32 packets = (S32)(mNumBufferedPackets);
+    if (mReceiveThread)
+    {
+        packets += mReceiveThread->getNumPackets();
+    }
+    return packets;
+}
+
+S32 LLPacketRing::getNumBufferedBytes() const
+{
+    S32 bytes = mNumBufferedBytes;
+    if (mReceiveThread)
+    {
+        bytes += mReceiveThread->getNumBytes();
+    }
+    return bytes;
+}
+
+S32 LLPacketRing::getNumDroppedPackets() const
+{
+    S32 dropped = mNumDroppedPacketsTotal + mNumDroppedPackets;
+    if (mReceiveThread)
+    {
+        dropped += mReceiveThread->getNumDroppedPackets();
+    }
+    return dropped;
+}
+
+bool LLPacketRing::startReceiveThread(S32 socket)
+{
+    if (mReceiveThread)
+    {
+        return true;
+    }
+
+    try
+    {
+        mReceiveThread = std::make_unique<ReceiveThread>(socket);
+    }
+    catch (const std::system_error& e)
+    {
+        LL_WARNS("Messaging") << "Could not start the UDP receive thread: " << e.what() << LL_ENDL;
+        return false;
+    }
+    LL_INFOS("Messaging") << "Receiving UDP on a dedicated thread" << LL_ENDL;
+    return true;
+}
+
+void LLPacketRing::stopReceiveThread()
+{
+    // Joins the thread, whatever it still holds is dropped
+    mReceiveThread.reset();
+}
+
+S32 LLPacketRing::receiveOrDropThreadPacket(char *datap, bool drop)
+{
+    ReceiveThread::Packet* packet = mReceiveThread->front();
+    if (!packet)
+    {
+        return 0;
+    }
+
+    S32 packet_size = packet->mSize;
+    mActualBytesIn += packet_size;
+    if (LLProxy::isSOCKSProxyEnabled())
+    {
+        if (packet_size > SOCKS_HEADER_SIZE && !drop)
+        {
+            // *FIX We are assuming ATYP is 0x01 (IPv4), not 0x03 (hostname) or 0x04 (IPv6)
+            packet_size -= SOCKS_HEADER_SIZE; // The unwrapped packet size
+            memcpy(datap, packet->mData + SOCKS_HEADER_SIZE, packet_size);
+            proxywrap_t * header = static_cast<proxywrap_t*>(static_cast<void*>(packet->mData));
+            mLastSender.setAddress(header->addr);
+            mLastSender.setPort(ntohs(header->port));
+            mLastReceivingIF = packet->mReceivingIF;
+            mLastReceiveTime = packet->mReceiveTime;
+        }
+        else
+        {
+            packet_size = 0;
+        }
+    }
+    else if (drop)
+    {
+        packet_size = 0;
+    }
+    else
+    {
+        memcpy(datap, packet->mData, packet_size);
+        mLastSender = packet->mHost;
+        mLastReceivingIF = packet->mReceivingIF;
+        mLastReceiveTime = packet->mReceiveTime;
+    }
+
+    mReceiveThread->pop();
+    return packet_size;
 }
+// </FS>
 
 void LLPacketRing::dumpPacketRingStats()
 {
     mNumDroppedPacketsTotal += mNumDroppedPackets;
     LL_INFOS("Messaging") << "Packet ring stats: " << std::endl
-                          << "Buffered packets: " << mNumBufferedPackets << std::endl
-                          << "Buffered bytes: " << mNumBufferedBytes << std::endl
+                          << "Buffered packets: " << getNumBufferedPackets() << std::endl // <FS/> Threaded UDP receive
+                          << "Buffered bytes: " << getNumBufferedBytes() << std::endl // <FS/> Threaded UDP receive
                           << "Dropped packets current: " << mNumDroppedPackets << std::endl
                           << "Dropped packets total: " << mNumDroppedPacketsTotal << std::endl
                           << "Dropped packets percentage: " << mDropPercentage << "%" << std::endl
@@ -27,6 +27,7 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include "llhost.h"
@@ -60,9 +61,24 @@ public:
     S32 getAndResetActualInBits()   { S32 bits = mActualBytesIn * 8; mActualBytesIn = 0; return bits;}
     S32 getAndResetActualOutBits()  { S32 bits = mActualBytesOut * 8; mActualBytesOut = 0; return bits;}
 
-    S32 getNumBufferedPackets() const { return (S32)(mNumBufferedPackets); }
-    S32 getNumBufferedBytes() const { return mNumBufferedBytes; }
-    S32 getNumDroppedPackets() const { return mNumDroppedPacketsTotal + mNumDroppedPackets; }
+    // <FS> Threaded UDP receive
+    // These include what the receive thread holds, when it runs
+    S32 getNumBufferedPackets() const;
+    S32 getNumBufferedBytes() const;
+    S32 getNumDroppedPackets() const;
+
+    // Hands the socket to a thread of its own, which reads it in batches into
+    // a preallocated ring as soon as packets arrive instead of leaving them to
+    // the socket buffer until the next frame. receivePacket() then consumes
+    // that ring and drainSocket() has nothing left to do.
+    bool startReceiveThread(S32 socket);
+    void stopReceiveThread();
+    bool isReceiveThreadRunning() const { return mReceiveThread != nullptr; }
+
+    // totalTime() at which the last packet delivered by receivePacket() came
+    // off the wire, 0 if it was not read by the receive thread
+    U64 getLastReceiveTime() const { return mLastReceiveTime; }
+    // </FS>
 
     F32 getBufferLoadRate() const; // from 0 to 4 (0 - empty, 1 - default size is full)
     void dumpPacketRingStats();
@@ -80,6 +96,11 @@ protected:
     // returns 'true' if ring was expanded
     bool expandRing();
 
+    // <FS> Threaded UDP receive
+    class ReceiveThread;
+    S32 receiveOrDropThreadPacket(char *datap, bool drop);
+    // </FS>
+
 protected:
     std::vector<LLPacketBuffer*> mPacketRing;
     S16 mHeadIndex { 0 };
@@ -96,6 +117,11 @@ protected:
     // These are the sender and receiving_interface for the last packet delivered by receivePacket()
     LLHost mLastSender;
     LLHost mLastReceivingIF;
+
+    // <FS> Threaded UDP receive
+    std::unique_ptr<ReceiveThread> mReceiveThread;
+    U64 mLastReceiveTime { 0 };
+    // </FS>
 };
 
 
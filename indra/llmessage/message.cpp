@@ -331,6 +331,7 @@ LLMessageSystem::~LLMessageSystem()
 
     if (!mbError)
     {
+        mPacketRing.stopReceiveThread(); // <FS/> Threaded UDP receive, before the socket goes away
         end_net(mSocket);
     }
     mSocket = 0;
@@ -524,6 +525,7 @@ bool LLMessageSystem::checkMessages(LockMessageChecker&, S64 frame_count )
         receive_size = mTrueReceiveSize;
         mLastSender = mPacketRing.getLastSender();
         mLastReceivingIF = mPacketRing.getLastReceivingInterface();
+        mLastPacketReceiveTime = mPacketRing.getLastReceiveTime(); // <FS/> Threaded UDP receive
 
         if (receive_size < (S32) LL_MINIMUM_VALID_PACKET_SIZE)
         {
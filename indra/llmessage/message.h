@@ -436,6 +436,12 @@ public:
 
     const LLHost& getReceivingInterface() const;
 
+    // <FS> Threaded UDP receive
+    // totalTime() at which the current packet came off the wire, 0 if it was
+    // only read from the socket by checkMessages() itself
+    U64     getLastPacketReceiveTime() const { return mLastPacketReceiveTime; }
+    // </FS>
+
     // This method returns the uuid associated with the sender. The
     // UUID will be null if it is not yet known or is a server
     // circuit.
@@ -898,6 +904,7 @@ private:
 
     LLHost mLastSender;
     LLHost mLastReceivingIF;
+    U64 mLastPacketReceiveTime { 0 }; // <FS/> Threaded UDP receive
     S32 mIncomingCompressedSize;        // original size of compressed msg (0 if uncomp.)
     TPACKETID mCurrentRecvPacketID;       // packet ID of current receive packet (for reporting)
 
@@ -40,6 +40,7 @@
     #include <arpa/inet.h>
     #include <fcntl.h>
     #include <errno.h>
+    #include <poll.h>
 #endif
 
 // linden library includes
@@ -332,6 +333,46 @@ S32 receive_packet(int hSocket, char * receiveBuffer)
     return nRet;
 }
 
+// <FS> Threaded UDP receive
+S32 receive_packets(int hSocket, LLNetPacket* packets, S32 count)
+{
+    S32 received = 0;
+    while (received < count)
+    {
+        sockaddr_in from;
+        int from_size = sizeof(from);
+        LLNetPacket& packet = packets[received];
+        int size = recvfrom(hSocket, packet.mData, NET_BUFFER_SIZE, 0, (struct sockaddr*)&from, &from_size);
+        if (size == SOCKET_ERROR)
+        {
+            if (WSAECONNRESET == WSAGetLastError())
+            {
+                // Only reports an earlier send bouncing
+                continue;
+            }
+            break;
+        }
+        packet.mSize = size;
+        packet.mSenderIP = from.sin_addr.s_addr;
+        packet.mSenderPort = ntohs(from.sin_port);
+        packet.mReceivingIP = INVALID_HOST_IP_ADDRESS;
+        ++received;
+    }
+    return received;
+}
+
+bool wait_for_packet(int hSocket, S32 timeout_ms)
+{
+    fd_set read_set;
+    FD_ZERO(&read_set);
+    FD_SET((SOCKET)hSocket, &read_set);
+    timeval timeout;
+    timeout.tv_sec = timeout_ms / 1000;
+    timeout.tv_usec = (timeout_ms % 1000) * 1000;
+    return select(0, &read_set, NULL, NULL, &timeout) > 0;
+}
+// </FS>
+
 // Returns true on success.
 bool send_packet(int hSocket, const char *sendBuffer, int size, U32 recipient, int nPort)
 {
@@ -592,6 +633,85 @@ int receive_packet(int hSocket, char * receiveBuffer)
     return nRet;
 }
 
+// <FS> Threaded UDP receive
+S32 receive_packets(int hSocket, LLNetPacket* packets, S32 count)
+{
+#if LL_LINUX
+    // One system call for the whole batch
+    constexpr S32 MAX_BATCH = 64;
+    count = llmin(count, MAX_BATCH);
+    struct mmsghdr msgs[MAX_BATCH];
+    struct iovec iovs[MAX_BATCH];
+    struct sockaddr_in from[MAX_BATCH];
+    char cmsgs[MAX_BATCH][CMSG_SPACE(sizeof(struct in_pktinfo))];
+    memset(msgs, 0, sizeof(msgs[0]) * count);
+    for (S32 i = 0; i < count; ++i)
+    {
+        iovs[i].iov_base = packets[i].mData;
+        iovs[i].iov_len = NET_BUFFER_SIZE;
+        msgs[i].msg_hdr.msg_name = &from[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(from[i]);
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_control = cmsgs[i];
+        msgs[i].msg_hdr.msg_controllen = sizeof(cmsgs[i]);
+    }
+
+    int received = recvmmsg(hSocket, msgs, count, MSG_DONTWAIT, NULL);
+    if (received <= 0)
+    {
+        return 0;
+    }
+
+    for (int i = 0; i < received; ++i)
+    {
+        LLNetPacket& packet = packets[i];
+        packet.mSize = (S32)msgs[i].msg_len;
+        packet.mSenderIP = from[i].sin_addr.s_addr;
+        packet.mSenderPort = ntohs(from[i].sin_port);
+        packet.mReceivingIP = INVALID_HOST_IP_ADDRESS;
+        for (struct cmsghdr* cmsgptr = CMSG_FIRSTHDR(&msgs[i].msg_hdr); cmsgptr != NULL; cmsgptr = CMSG_NXTHDR(&msgs[i].msg_hdr, cmsgptr))
+        {
+            if (cmsgptr->cmsg_level == SOL_IP && cmsgptr->cmsg_type == IP_PKTINFO)
+            {
+                packet.mReceivingIP = ((struct in_pktinfo*)CMSG_DATA(cmsgptr))->ipi_spec_dst.s_addr;
+            }
+        }
+    }
+    return received;
+#else
+    S32 received = 0;
+    while (received < count)
+    {
+        struct sockaddr_in from;
+        socklen_t from_size = sizeof(from);
+        LLNetPacket& packet = packets[received];
+        int size = (int)recvfrom(hSocket, packet.mData, NET_BUFFER_SIZE, 0, (struct sockaddr*)&from, &from_size);
+        if (size < 0)
+        {
+            break;
+        }
+        packet.mSize = size;
+        packet.mSenderIP = from.sin_addr.s_addr;
+        packet.mSenderPort = ntohs(from.sin_port);
+        packet.mReceivingIP = INVALID_HOST_IP_ADDRESS;
+        ++received;
+    }
+    return received;
+#endif
+}
+
+bool wait_for_packet(int hSocket, S32 timeout_ms)
+{
+    // Errors wake us up as well, receive_packets() clears them
+    struct pollfd poll_fd;
+    poll_fd.fd = hSocket;
+    poll_fd.events = POLLIN;
+    poll_fd.revents = 0;
+    return ::poll(&poll_fd, 1, timeout_ms) > 0;
+}
+// </FS>
+
 bool send_packet(int hSocket, const char * sendBuffer, int size, U32 recipient, int nPort)
 {
     int     ret;
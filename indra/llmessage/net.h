@@ -43,6 +43,27 @@ void    end_net(S32& socket_out);
 // returns size of packet or -1 in case of error
 S32     receive_packet(int hSocket, char * receiveBuffer);
 
+// <FS> Threaded UDP receive
+// One datagram for receive_packets(), mData must hold NET_BUFFER_SIZE bytes
+struct LLNetPacket
+{
+    char*   mData;
+    S32     mSize;
+    U32     mSenderIP;
+    U32     mSenderPort;
+    U32     mReceivingIP;
+};
+
+// Receives up to count datagrams without blocking, with a single recvmmsg()
+// where the platform has it. Unlike receive_packet() this does not go through
+// the globals behind get_sender() and get_receiving_interface(), so it can
+// run on a thread of its own. Returns the number of datagrams received.
+S32     receive_packets(int hSocket, LLNetPacket* packets, S32 count);
+
+// Waits up to timeout_ms for a datagram to arrive, returns true if one did
+bool    wait_for_packet(int hSocket, S32 timeout_ms);
+// </FS>
+
 bool    send_packet(int hSocket, const char *sendBuffer, int size, U32 recipient, int nPort);   // Returns true on success.
 
 //void  get_sender(char * tmp);
@@ -795,7 +795,13 @@ bool LLImageGL::setImage(const U8* data_in, bool data_hasmips /* = false */, S32
                 if (is_compressed)
                 {
                     GLsizei tex_size = (GLsizei)dataFormatBytes(mFormatPrimary, w, h);
+                    // <FS> Compressed texture cache
+                    free_cur_tex_image();
+                    // </FS>
                     glCompressedTexImage2D(mTarget, gl_level, mFormatPrimary, w, h, 0, tex_size, (GLvoid *)data_in);
+                    // <FS> Compressed texture cache
+                    alloc_tex_image(w, h, mFormatPrimary, 1);
+                    // </FS>
                     stop_glerror();
                 }
                 else
@@ -1622,6 +1628,60 @@ bool LLImageGL::createGLTexture(S32 discard_level, const LLImageRaw* imageraw, S
     return createGLTexture(discard_level, rawdata, false, usename, defer_copy, tex_name);
 }
 
+// <FS> Compressed texture cache
+bool LLImageGL::createGLTextureCompressed(S32 discard_level, LLImageDXT* imagedxt, S32 usename, S32 category)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
+    checkActiveThread();
+
+    if (gGLManager.mIsDisabled)
+    {
+        LL_WARNS() << "Trying to create a texture while GL is disabled!" << LL_ENDL;
+        return false;
+    }
+
+    if (!imagedxt || !imagedxt->getData() || imagedxt->getFileFormat() != LLImageDXT::FORMAT_DXR1)
+    {
+        LL_WARNS() << "Trying to create a compressed texture from invalid image data" << LL_ENDL;
+        return false;
+    }
+
+    // The mips come from the image, and a caller asking for a specific
+    // format wants it kept.
+    if (!mUseMipMaps || mHasExplicitFormat)
+    {
+        return false;
+    }
+
+    discard_level = llmax(discard_level, 0);
+    S32 w = imagedxt->getWidth();
+    S32 h = imagedxt->getHeight();
+    if (!setSize(w << discard_level, h << discard_level, 3, discard_level))
+    {
+        LL_WARNS() << "Trying to create a texture with incorrect dimensions!" << LL_ENDL;
+        mGLTextureCreated = false;
+        return false;
+    }
+
+    // setImage() walks from the largest mip down to mMaxDiscardLevel
+    if (mMaxDiscardLevel - discard_level >= LLImageDXT::calcNumMips(w, h))
+    {
+        return false;
+    }
+
+    // Not explicit: the next raw image upload picks the format from its components again
+    mFormatInternal = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+    mFormatPrimary = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+    mFormatType = GL_UNSIGNED_BYTE;
+    mIsMask = false;
+
+    setCategory(category);
+    LLImageDataSharedLock lock(imagedxt);
+    const U8* largest_mip = imagedxt->getData() + imagedxt->getMipOffset(0);
+    return createGLTexture(discard_level, largest_mip, true, usename);
+}
+// </FS>
+
 bool LLImageGL::createGLTexture(S32 discard_level, const U8* data_in, bool data_hasmips, S32 usename, bool defer_copy, LLGLuint* tex_name)
 // Call with void data, vmem is allocated but unitialized
 {
@@ -2481,7 +2541,13 @@ bool LLImageGL::scaleDown(S32 desired_discard)
     S32 desired_width = getWidth(desired_discard);
     S32 desired_height = getHeight(desired_discard);
 
-    if (gGLManager.mDownScaleMethod == 0)
+    // <FS> Compressed texture cache
+    // Compressed data can't be read back or copied into, so BC1 textures
+    // always take the FBO path and come out of it uncompressed
+    const bool is_compressed = isCompressed();
+    //if (gGLManager.mDownScaleMethod == 0)
+    if (gGLManager.mDownScaleMethod == 0 || is_compressed)
+    // </FS>
     { // use an FBO to downscale the texture
         glViewport(0, 0, desired_width, desired_height);
 
@@ -2490,6 +2556,15 @@ bool LLImageGL::scaleDown(S32 desired_discard)
         {
             glDrawArrays(GL_TRIANGLES, 0, 3);
 
+            // <FS> Compressed texture cache
+            if (is_compressed)
+            {
+                mFormatInternal = GL_RGB8;
+                mFormatPrimary = GL_RGB;
+                mFormatType = GL_UNSIGNED_BYTE;
+            }
+            // </FS>
+
             free_tex_image(mTexName);
             glTexImage2D(mTarget, 0, mFormatInternal, desired_width, desired_height, 0, mFormatPrimary, mFormatType, nullptr);
             glCopyTexSubImage2D(mTarget, 0, 0, 0, 0, 0, desired_width, desired_height);
@@ -29,6 +29,7 @@
 #define LL_LLIMAGEGL_H
 
 #include "llimage.h"
+#include "llimagedxt.h" // <FS/> Compressed texture cache
 
 #include "llgltypes.h"
 #include "llpointer.h"
@@ -127,6 +128,11 @@ public:
     bool createGLTexture(S32 discard_level, const LLImageRaw* imageraw, S32 usename = 0, bool to_create = true,
         S32 category = sMaxCategories-1, bool defer_copy = false, LLGLuint* tex_name = nullptr);
     bool createGLTexture(S32 discard_level, const U8* data, bool data_hasmips = false, S32 usename = 0, bool defer_copy = false, LLGLuint* tex_name = nullptr);
+    // <FS> Compressed texture cache
+    // Uploads the BC1 mip chain of a DXR1 image whose largest mip is discard_level.
+    // Returns false, leaving the texture untouched, if it can't take compressed data.
+    bool createGLTextureCompressed(S32 discard_level, LLImageDXT* imagedxt, S32 usename = 0, S32 category = sMaxCategories-1);
+    // </FS>
     void setImage(const LLImageRaw* imageraw);
     bool setImage(const U8* data_in, bool data_hasmips = false, S32 usename = 0);
     // *TODO: This function may not work if the textures is compressed (i.e.
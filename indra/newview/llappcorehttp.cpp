@@ -133,7 +133,8 @@ static void ssl_verification_changed();
 LLAppCoreHttp::HttpClass::HttpClass()
     : mPolicy(LLCore::HttpRequest::DEFAULT_POLICY_ID),
       mConnLimit(0U),
-      mPipelined(false)
+      mPipelined(false),
+      mMultiplexed(false) // <FS/> HTTP/2 multiplexing
 {}
 
 
@@ -460,6 +461,37 @@ void LLAppCoreHttp::refreshSettings(bool initial)
                     mHttpClasses[app_policy].mPipelined = to_pipeline;
                 }
             }
+
+            // <FS> HTTP/2 multiplexing
+            // The classes that may pipeline are the ones served by the
+            // CDN, which also negotiates HTTP/2.
+            const long http2_streams(gSavedSettings.getU32("FSHttp2Streams"));
+            const bool to_multiplex(init_data[i].mPipelined && http2_streams > 0);
+            if (to_multiplex != mHttpClasses[app_policy].mMultiplexed)
+            {
+                LLCore::HttpHandle handle;
+                const long new_streams(to_multiplex ? http2_streams : 0);
+
+                handle = mRequest->setPolicyOption(LLCore::HttpRequest::PO_HTTP2_STREAMS,
+                                                   mHttpClasses[app_policy].mPolicy,
+                                                   new_streams,
+                                                   LLCore::HttpHandler::ptr_t());
+                if (LLCORE_HTTP_HANDLE_INVALID == handle)
+                {
+                    status = mRequest->getStatus();
+                    LL_WARNS("Init") << "Unable to set " << init_data[i].mUsage
+                                     << " HTTP/2 streams.  Reason:  " << status.toString()
+                                     << LL_ENDL;
+                }
+                else
+                {
+                    LL_DEBUGS("Init") << "Changed " << init_data[i].mUsage
+                                      << " HTTP/2 streams.  New value:  " << new_streams
+                                      << LL_ENDL;
+                    mHttpClasses[app_policy].mMultiplexed = to_multiplex;
+                }
+            }
+            // </FS>
         }
 
         // Get target connection concurrency value
@@ -244,6 +244,14 @@ public:
             return mHttpClasses[policy].mPipelined;
         }
 
+    // <FS> HTTP/2 multiplexing
+    // Return whether a policy asks for HTTP/2 streams.
+    bool isMultiplexed(EAppPolicy policy) const
+        {
+            return mHttpClasses[policy].mMultiplexed;
+        }
+    // </FS>
+
     // Apply initial or new settings from the environment.
     void refreshSettings(bool initial);
 
@@ -262,6 +270,7 @@ private:
         policy_t                    mPolicy;            // Policy class id for the class
         U32                         mConnLimit;
         bool                        mPipelined;
+        bool                        mMultiplexed;       // <FS/> HTTP/2 multiplexing
         boost::signals2::connection mSettingsSignal;    // Signal to global setting that affect this class (if any)
     };
 
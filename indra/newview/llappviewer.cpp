@@ -175,6 +175,7 @@
 
 #include "llviewerinput.h"
 #include "lllfsthread.h"
+#include "llasyncfileio.h" // <FS/> Async cache I/O
 #include "llworkerthread.h"
 #include "lltexturecache.h"
 #include "lltexturefetch.h"
@@ -2400,6 +2401,12 @@ bool LLAppViewer::cleanup()
         gDirUtilp->deleteDirAndContents(user_path);
     }
 
+    // <FS> Async cache I/O
+    // Drain before the cache threads drop requests whose buffers are in flight;
+    // anything submitted later is done synchronously
+    LLAsyncFileIO::cleanupClass();
+    // </FS>
+
     // Delete workers first
     // shotdown all worker threads before deleting them in case of co-dependencies
     mAppCoreHttp.requestStop();
@@ -2581,6 +2588,7 @@ bool LLAppViewer::initThreads()
     LLImage::initClass(gSavedSettings.getBOOL("TextureNewByteRange"),gSavedSettings.getS32("TextureReverseByteRange"));
 
     LLLFSThread::initClass(enable_threads && true); // TODO: fix crashes associated with this shutdo
+    LLAsyncFileIO::initClass(gSavedSettings.getBOOL("FSCacheIOUring")); // <FS/> Async cache I/O
 
     //auto configure thread count
     LLSD threadCounts = gSavedSettings.getLLSD("ThreadPoolSizes");
@@ -2611,6 +2619,16 @@ bool LLAppViewer::initThreads()
     }
     // <FS:Ansariel>
     threadCounts["ImageDecode"] = image_decode_count;
+    // <FS> Threaded J2C decode
+    // Auto (0) gives a large image each ImageDecode worker's share of the
+    // cores. The setting defaults to 1 until that has been measured.
+    S32 threads_per_decode = llclamp(cores / image_decode_count, 1, 4);
+    if (auto per_decode = gSavedSettings.getU32("FSImageDecodeThreadsPerImage"); per_decode > 0)
+    {
+        threads_per_decode = llclamp((S32)per_decode, 1, 16);
+    }
+    LLImageJ2C::setMaxThreadsPerDecode(threads_per_decode);
+    // </FS>
     gSavedSettings.setLLSD("ThreadPoolSizes", threadCounts);
 
     // Image decoding
@@ -5212,7 +5230,8 @@ bool LLAppViewer::initCache()
     const std::string cache_dir = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, cache_dir_name);
     // <FS:Beq> Improve cache purge triggering
     // LLDiskCache::initParamSingleton(cache_dir, disk_cache_size, enable_cache_debug_info);
-    LLDiskCache::initParamSingleton(cache_dir, disk_cache_size, enable_cache_debug_info, gSavedSettings.getF32("FSDiskCacheHighWaterPercent"), gSavedSettings.getF32("FSDiskCacheLowWaterPercent"));
+    LLDiskCache::initParamSingleton(cache_dir, disk_cache_size, enable_cache_debug_info, gSavedSettings.getF32("FSDiskCacheHighWaterPercent"), gSavedSettings.getF32("FSDiskCacheLowWaterPercent"),
+                                    gSavedSettings.getBOOL("FSDiskCachePackSmallAssets")); // <FS/> Small asset pack files
     // </FS:Beq>
 
     if (!read_only)
@@ -42,6 +42,7 @@
 #include "llviewerregion.h"
 #include "llworld.h"
 #include "llvoavatar.h"
+#include "workqueue.h" // <FS/> Parallel flexi update
 
 static const F32 SEC_PER_FLEXI_FRAME = 1.f / 60.f; // 60 flexi updates per second
 /*static*/ F32 LLVolumeImplFlexible::sUpdateFactor = 1.0f;
@@ -56,7 +57,8 @@ LLVolumeImplFlexible::LLVolumeImplFlexible(LLViewerObject* vo, LLFlexibleObjectD
         mVO(vo),
         mAttributes(attributes),
         mLastFrameNum(0),
-        mLastUpdatePeriod(0)
+        mLastUpdatePeriod(0),
+        mPendingIdleUpdate(IDLE_UPDATE_NONE) // <FS/> Parallel flexi update
 {
     static U32 seed = 0;
     mID = seed++;
@@ -95,6 +97,11 @@ void LLVolumeImplFlexible::updateClass()
     LL_PROFILE_ZONE_SCOPED;
 
     U64 virtual_frame_num = (U64)(LLTimer::getElapsedSeconds() / SEC_PER_FLEXI_FRAME);
+
+    // <FS> Parallel flexi update
+    F32 screen_pixel_area = LLViewerCamera::getInstance()->getScreenPixelArea();
+    static std::vector<LLVolumeImplFlexible*> update_list;
+    update_list.clear();
     for (std::vector<LLVolumeImplFlexible*>::iterator iter = sInstanceList.begin();
             iter != sInstanceList.end();
             ++iter)
@@ -104,9 +111,46 @@ void LLVolumeImplFlexible::updateClass()
             || (*iter)->mLastFrameNum + (*iter)->mLastUpdatePeriod <= virtual_frame_num
             || (*iter)->mLastFrameNum > virtual_frame_num) //time issues, overflow
         {
-            (*iter)->doIdleUpdate();
+            if ((*iter)->mVO->mDrawable)
+            {
+                //ensure drawable is active, the sections are set up from its world matrix
+                (*iter)->mVO->mDrawable->makeActive();
+                update_list.push_back(*iter);
+            }
         }
     }
+
+    {
+        LL_PROFILE_ZONE_NAMED("flexi compute");
+        constexpr U32 INSTANCES_PER_JOB = 32;
+        const U32 count = (U32)update_list.size();
+        auto compute = [&](U32 job)
+        {
+            const U32 end = llmin(count, (job + 1) * INSTANCES_PER_JOB);
+            for (U32 i = job * INSTANCES_PER_JOB; i < end; ++i)
+            {
+                update_list[i]->computeIdleUpdate(virtual_frame_num, screen_pixel_area);
+            }
+        };
+        const U32 jobs = (count + INSTANCES_PER_JOB - 1) / INSTANCES_PER_JOB;
+        if (jobs > 1)
+        {
+            LL::run_parallel("General", jobs, compute);
+        }
+        else if (jobs)
+        {
+            compute(0);
+        }
+    }
+
+    {
+        LL_PROFILE_ZONE_NAMED("flexi commit");
+        for (LLVolumeImplFlexible* flexi : update_list)
+        {
+            flexi->commitIdleUpdate();
+        }
+    }
+    // </FS>
 }
 
 LLVector3 LLVolumeImplFlexible::getFramePosition() const
@@ -341,79 +385,108 @@ void LLVolumeImplFlexible::doIdleUpdate()
         //ensure drawable is active
         drawablep->makeActive();
 
-        if (gPipeline.hasRenderDebugFeatureMask(LLPipeline::RENDER_DEBUG_FEATURE_FLEXIBLE))
+        // <FS> Parallel flexi update
+        computeIdleUpdate((U64)(LLTimer::getElapsedSeconds() / SEC_PER_FLEXI_FRAME),
+                          LLViewerCamera::getInstance()->getScreenPixelArea());
+        commitIdleUpdate();
+        // </FS>
+    }
+}
+
+// <FS> Parallel flexi update
+// Everything doIdleUpdate() does that only touches this instance, so that
+// updateClass() can run it for many flexies at once. What needs the
+// pipeline is left in mPendingIdleUpdate for commitIdleUpdate().
+void LLVolumeImplFlexible::computeIdleUpdate(U64 virtual_frame_num, F32 screen_pixel_area)
+{
+    LLDrawable* drawablep = mVO->mDrawable;
+    mPendingIdleUpdate = IDLE_UPDATE_NONE;
+
+    if (drawablep && gPipeline.hasRenderDebugFeatureMask(LLPipeline::RENDER_DEBUG_FEATURE_FLEXIBLE))
+    {
+        bool visible = drawablep->isVisible();
+
+        if (mRenderRes == -1)
+        {
+            updateRenderRes();
+            mPendingIdleUpdate = IDLE_UPDATE_REBUILD;
+        }
+        else
         {
-            bool visible = drawablep->isVisible();
+            F32 pixel_area = mVO->getPixelArea();
 
-            if (mRenderRes == -1)
-            {
-                updateRenderRes();
-                gPipeline.markRebuild(drawablep, LLDrawable::REBUILD_POSITION);
-            }
-            else
+            // Note: Flexies afar will be rarely updated, closer ones will be updated more frequently.
+            // But frequency differences are extremely noticeable, so consider modifying update factor,
+            // or at least clamping value a bit more from both sides.
+            U32 update_period = (U32) (llmax((S32) (screen_pixel_area*0.01f/(pixel_area*(sUpdateFactor+1.f))),0)+1);
+            // MAINT-1890 Clamp the update period to ensure that the update_period is no greater than 32 frames
+            update_period = llclamp(update_period, 1U, 32U);
+
+            if  (visible)
             {
-                F32 pixel_area = mVO->getPixelArea();
+                if (!drawablep->isState(LLDrawable::IN_REBUILD_Q) &&
+                    pixel_area > 256.f)
+                {
+                    U32 id;
+                    if (mVO->isRootEdit())
+                    {
+                        id = mID;
+                    }
+                    else
+                    {
+                        LLVOVolume* parent = (LLVOVolume*)mVO->getParent();
+                        id = parent->getVolumeInterfaceID();
+                    }
 
-                // Note: Flexies afar will be rarely updated, closer ones will be updated more frequently.
-                // But frequency differences are extremely noticeable, so consider modifying update factor,
-                // or at least clamping value a bit more from both sides.
-                U32 update_period = (U32) (llmax((S32) (LLViewerCamera::getInstance()->getScreenPixelArea()*0.01f/(pixel_area*(sUpdateFactor+1.f))),0)+1);
-                // MAINT-1890 Clamp the update period to ensure that the update_period is no greater than 32 frames
-                update_period = llclamp(update_period, 1U, 32U);
 
-                // We control how fast flexies update, buy splitting updates among frames
-                U64 virtual_frame_num = (U64)(LLTimer::getElapsedSeconds() / SEC_PER_FLEXI_FRAME);
+                    // Throttle flexies and spread load by preventing flexies from updating in same frame
+                    // Shows how many frames we need to wait before next update
+                    U64 throttling_delay = (virtual_frame_num + id) % update_period;
 
-                if  (visible)
-                {
-                    if (!drawablep->isState(LLDrawable::IN_REBUILD_Q) &&
-                        pixel_area > 256.f)
+                    if ((throttling_delay == 0 && mLastFrameNum < virtual_frame_num) //one or more virtual frames per frame
+                        || (mLastFrameNum + update_period < virtual_frame_num) // missed virtual frame
+                        || mLastFrameNum > virtual_frame_num) // overflow
                     {
-                        U32 id;
-                        if (mVO->isRootEdit())
-                        {
-                            id = mID;
-                        }
-                        else
-                        {
-                            LLVOVolume* parent = (LLVOVolume*)mVO->getParent();
-                            id = parent->getVolumeInterfaceID();
-                        }
-
-
-                        // Throttle flexies and spread load by preventing flexies from updating in same frame
-                        // Shows how many frames we need to wait before next update
-                        U64 throttling_delay = (virtual_frame_num + id) % update_period;
-
-                        if ((throttling_delay == 0 && mLastFrameNum < virtual_frame_num) //one or more virtual frames per frame
-                            || (mLastFrameNum + update_period < virtual_frame_num) // missed virtual frame
-                            || mLastFrameNum > virtual_frame_num) // overflow
-                        {
-                            // We need mLastFrameNum to compensate for 'unreliable time' and to filter 'duplicate' frames
-                            // If happened too late, subtract throttling_delay (it is zero otherwise)
-                            mLastFrameNum = virtual_frame_num - throttling_delay;
-
-                            // Store update period for updateClass()
-                            // Note: Consider substituting update_period with mLastUpdatePeriod everywhere.
-                            mLastUpdatePeriod = update_period;
-
-                            updateRenderRes();
-
-                            mVO->shrinkWrap();
-                            gPipeline.markRebuild(drawablep, LLDrawable::REBUILD_POSITION);
-                        }
+                        // We need mLastFrameNum to compensate for 'unreliable time' and to filter 'duplicate' frames
+                        // If happened too late, subtract throttling_delay (it is zero otherwise)
+                        mLastFrameNum = virtual_frame_num - throttling_delay;
+
+                        // Store update period for updateClass()
+                        // Note: Consider substituting update_period with mLastUpdatePeriod everywhere.
+                        mLastUpdatePeriod = update_period;
+
+                        updateRenderRes();
+
+                        mPendingIdleUpdate = IDLE_UPDATE_SHRINKWRAP;
                     }
                 }
-                else
-                {
-                    mLastFrameNum = virtual_frame_num;
-                    mLastUpdatePeriod = update_period;
-                }
             }
+            else
+            {
+                mLastFrameNum = virtual_frame_num;
+                mLastUpdatePeriod = update_period;
+            }
+        }
+    }
+}
 
+void LLVolumeImplFlexible::commitIdleUpdate()
+{
+    LLDrawable* drawablep = mVO->mDrawable;
+    if (drawablep)
+    {
+        if (mPendingIdleUpdate == IDLE_UPDATE_SHRINKWRAP)
+        {
+            mVO->shrinkWrap();
+        }
+        if (mPendingIdleUpdate != IDLE_UPDATE_NONE)
+        {
+            gPipeline.markRebuild(drawablep, LLDrawable::REBUILD_POSITION);
         }
     }
+    mPendingIdleUpdate = IDLE_UPDATE_NONE;
 }
+// </FS>
 
 inline S32 log2(S32 x)
 {
@@ -87,6 +87,12 @@ private:
         LLVolumeInterfaceType getInterfaceType() const      { return INTERFACE_FLEXIBLE; }
         void updateRenderRes();
         void doIdleUpdate();
+        // <FS> Parallel flexi update
+        // doIdleUpdate() in two steps: the first is thread safe, the second
+        // hands the result to the pipeline on the main thread
+        void computeIdleUpdate(U64 virtual_frame_num, F32 screen_pixel_area);
+        void commitIdleUpdate();
+        // </FS>
         bool doUpdateGeometry(LLDrawable *drawable);
         LLVector3 getPivotPosition() const;
         void onSetVolume(const LLVolumeParams &volume_params, const S32 detail);
@@ -134,6 +140,15 @@ private:
         S32                         mRenderRes;
         U64                         mLastFrameNum;
         U32                         mLastUpdatePeriod;
+        // <FS> Parallel flexi update
+        enum EIdleUpdate : U8
+        {
+            IDLE_UPDATE_NONE,
+            IDLE_UPDATE_REBUILD,
+            IDLE_UPDATE_SHRINKWRAP
+        };
+        EIdleUpdate                 mPendingIdleUpdate;
+        // </FS>
         LLVector3                   mCollisionSpherePosition;
         F32                         mCollisionSphereRadius;
         U32                         mID;
@@ -67,6 +67,15 @@
 #include "llcorehttputil.h"
 #include "hbxxh.h"
 #include "llstartup.h"
+#include "llcrc.h"
+#include "llfileview.h"
+#include "llmemorystream.h"
+#include "workqueue.h"
+#ifdef LL_USESYSTEMLIBS
+#include <zlib.h>
+#else
+#include "zlib-ng/zlib.h"
+#endif
 // [RLVa:KB] - Checked: 2011-05-22 (RLVa-1.3.1a)
 #include "rlvhandler.h"
 #include "rlvlocks.h"
@@ -468,6 +477,8 @@ LLInventoryModel::LLInventoryModel()
     mHttpOptions(),
     mHttpHeaders(),
     mHttpPolicyClass(LLCore::HttpRequest::DEFAULT_POLICY_ID),
+    mCacheDeltaLogging(false), // <FS/> Incremental inventory cache
+    mCacheDeltaLogSize(0),     // <FS/> Incremental inventory cache
     mCategoryLock(),
     mItemLock(),
     mValidationInfo(new LLInventoryValidationInfo)
@@ -489,6 +500,7 @@ LLInventoryModel::~LLInventoryModel()
 
 void LLInventoryModel::cleanupInventory()
 {
+    stopCacheDeltaLog(); // <FS/> Incremental inventory cache
     empty();
     // Deleting one observer might erase others from the list, so always pop off the front
     while (!mObservers.empty())
@@ -2426,6 +2438,13 @@ void LLInventoryModel::addChangedMask(U32 mask, const LLUUID& referent)
         }
     }
 
+    // <FS> Incremental inventory cache
+    if (mCacheDeltaLogging && referent.notNull())
+    {
+        mCacheDirtyIDs.insert(referent);
+    }
+    // </FS>
+
     if (mIsNotifyObservers)
     {
         mModifyMaskBacklog |= mask;
@@ -2553,6 +2572,20 @@ void LLInventoryModel::cache(
                        << LL_ENDL;
     LLViewerInventoryCategory* root_cat = getCategory(parent_folder_id);
     if(!root_cat) return;
+    // <FS> Incremental inventory cache
+    static LLCachedControl<bool> sharded_cache(gSavedSettings, "FSShardedInventoryCache");
+    if (parent_folder_id == getRootFolderID())
+    {
+        if (mCacheDeltaLogging && sharded_cache)
+        {
+            // The cache and its log are current up to the last flush
+            flushCacheDeltaLog();
+            return;
+        }
+        // A compaction still running would put back an older snapshot
+        cancelCacheCompaction();
+    }
+    // </FS>
     cat_array_t categories;
     categories.push_back(root_cat);
     item_array_t items;
@@ -2565,12 +2598,28 @@ void LLInventoryModel::cache(
         items,
         INCLUDE_TRASH,
         can_cache);
+    // <FS> Sharded inventory cache
+    std::string inventory_filename = getInvCacheAddres(agent_id);
+    std::string sharded_filename = getShardedCacheFilename(inventory_filename);
+    std::string gzip_filename = inventory_filename + ".gz";
+    if (sharded_cache)
+    {
+        if (saveToShardedFile(sharded_filename, categories, items))
+        {
+            // Superseded, and would be stale if the sharded cache gets turned off
+            LLFile::remove(gzip_filename, ENOENT);
+            removeCacheDeltaLogs(sharded_filename); // <FS/> Incremental inventory cache
+        }
+        return;
+    }
+    LLFile::remove(sharded_filename, ENOENT);
+    removeCacheDeltaLogs(sharded_filename); // <FS/> Incremental inventory cache
+    // </FS>
+
     // Use temporary file to avoid potential conflicts with other
     // instances (even a 'read only' instance unzips into a file)
     std::string temp_file = gDirUtilp->getTempFilename();
     saveToFile(temp_file, categories, items);
-    std::string gzip_filename = getInvCacheAddres(agent_id);
-    gzip_filename.append(".gz");
     if(gzip_file(temp_file, gzip_filename))
     {
         LL_DEBUGS(LOG_INV) << "Successfully compressed " << temp_file << " to " << gzip_filename << LL_ENDL;
@@ -2895,6 +2944,16 @@ bool LLInventoryModel::loadSkeleton(
             LLFile::remove(inventory_filename);
         }
 
+        // <FS> Sharded inventory cache
+        std::string sharded_filename = getShardedCacheFilename(inventory_filename);
+        if (LLFile::isfile(sharded_filename))
+        {
+            LL_INFOS("LLInventoryModel") << "Purging inventory cache file: " << sharded_filename << LL_ENDL;
+            LLFile::remove(sharded_filename);
+        }
+        removeCacheDeltaLogs(sharded_filename);
+        // </FS>
+
         inventory_filename.append(".gz");
         if (LLFile::isfile(inventory_filename))
         {
@@ -2914,6 +2973,16 @@ bool LLInventoryModel::loadSkeleton(
             LLFile::remove(inventory_filename);
         }
 
+        // <FS> Sharded inventory cache
+        sharded_filename = getShardedCacheFilename(inventory_filename);
+        if (LLFile::isfile(sharded_filename))
+        {
+            LL_INFOS("LLInventoryModel") << "Purging library cache file: " << sharded_filename << LL_ENDL;
+            LLFile::remove(sharded_filename);
+        }
+        removeCacheDeltaLogs(sharded_filename);
+        // </FS>
+
         inventory_filename.append(".gz");
         if (LLFile::isfile(inventory_filename))
         {
@@ -2983,9 +3052,14 @@ bool LLInventoryModel::loadSkeleton(
         const S32 NO_VERSION = LLViewerInventoryCategory::VERSION_UNKNOWN;
         std::string gzip_filename(inventory_filename);
         gzip_filename.append(".gz");
-        LLFILE* fp = LLFile::fopen(gzip_filename, "rb");
+        // <FS> Sharded inventory cache
+        const std::string sharded_filename = getShardedCacheFilename(inventory_filename);
+        static LLCachedControl<bool> sharded_cache(gSavedSettings, "FSShardedInventoryCache");
+        const bool use_sharded_cache = sharded_cache && LLFile::isfile(sharded_filename);
+        // </FS>
+        LLFILE* fp = use_sharded_cache ? NULL : LLFile::fopen(gzip_filename, "rb"); // <FS/> Sharded inventory cache
         bool remove_inventory_file = false;
-        if (LLAppViewer::instance()->isSecondInstance())
+        if (LLAppViewer::instance()->isSecondInstance() && !use_sharded_cache) // <FS/> Sharded inventory cache
         {
             // Safeguard viewer against trying to unpack file twice
             // ex: user logs into two accounts simultaneously, so two
@@ -3013,7 +3087,18 @@ bool LLInventoryModel::loadSkeleton(
             }
         }
         bool is_cache_obsolete = false;
-        if (loadFromFile(inventory_filename, categories, items, categories_to_update, is_cache_obsolete))
+        // <FS> Sharded inventory cache
+        //if (loadFromFile(inventory_filename, categories, items, categories_to_update, is_cache_obsolete))
+        bool cache_loaded = use_sharded_cache
+            ? loadFromShardedFile(sharded_filename, categories, items, categories_to_update, is_cache_obsolete)
+            : loadFromFile(inventory_filename, categories, items, categories_to_update, is_cache_obsolete);
+        if (cache_loaded && use_sharded_cache)
+        {
+            // Changes logged since the snapshot was written
+            replayCacheDeltaLogs(sharded_filename, categories, items, categories_to_update); // <FS/> Incremental inventory cache
+        }
+        if (cache_loaded)
+        // </FS>
         {
             LL_PROFILE_ZONE_NAMED("loadFromFile");
             // We were able to find a cache of files. So, use what we
@@ -3181,11 +3266,13 @@ bool LLInventoryModel::loadSkeleton(
         // category which successfully cached so that we do not
         // needlessly fetch descendents for categories which we have.
         update_map_t::const_iterator no_child_counts = child_counts.end();
+        uuid_set_t complete_cat_ids; // <FS/> Incremental inventory cache
         for(cat_set_t::iterator it = temp_cats.begin(); it != temp_cats.end(); ++it)
         {
             LLViewerInventoryCategory* cat = (*it).get();
             if(cat->getVersion() != NO_VERSION)
             {
+                complete_cat_ids.insert(cat->getUUID()); // <FS/> Incremental inventory cache
                 update_map_t::const_iterator the_count = child_counts.find(cat->getUUID());
                 if(the_count != no_child_counts)
                 {
@@ -3209,8 +3296,22 @@ bool LLInventoryModel::loadSkeleton(
             // If out of date, remove the gzipped file too.
             LL_WARNS(LOG_INV) << "Inv cache out of date, removing" << LL_ENDL;
             LLFile::remove(gzip_filename);
+            LLFile::remove(sharded_filename, ENOENT); // <FS/> Sharded inventory cache
+            removeCacheDeltaLogs(sharded_filename); // <FS/> Incremental inventory cache
         }
         categories.clear(); // will unref and delete entries
+
+        // <FS> Incremental inventory cache
+        // From here on changes to the agent's inventory get logged instead
+        // of rewriting the whole cache on logout. That needs a snapshot to
+        // log against, and only one instance writing to it.
+        static LLCachedControl<bool> delta_log(gSavedSettings, "FSInventoryCacheDeltaLog");
+        if (delta_log && use_sharded_cache && cache_loaded && owner_id == gAgent.getID()
+            && !LLAppViewer::instance()->isSecondInstance())
+        {
+            startCacheDeltaLog(sharded_filename, complete_cat_ids);
+        }
+        // </FS>
     }
 
     LL_INFOS(LOG_INV) << "Successfully loaded " << cached_category_count
@@ -3842,6 +3943,1029 @@ bool LLInventoryModel::saveToFile(const std::string& filename,
     return true;
 }
 
+// <FS> Sharded inventory cache
+namespace
+{
+    // File layout, native byte order:
+    //   ShardedCacheHeader
+    //   ShardedCacheEntry[header.mShardCount]
+    //   shard data, each a zlib compressed binary LLSD map with
+    //   "categories" and "items" arrays like the legacy cache
+    // Categories are sharded by the range their id falls in, items by the
+    // range of their parent's id, so a folder and its contents always end
+    // up in the same shard.
+    constexpr U32 SHARDED_CACHE_MAGIC = 0x56494653; // "SFIV"
+    constexpr U32 SHARDED_CACHE_FORMAT = 1;
+    constexpr U32 MAX_CACHE_SHARDS = 16;
+    constexpr U32 RECORDS_PER_SHARD = 8192;
+
+    struct ShardedCacheHeader
+    {
+        U32 mMagic;
+        U32 mFormat;
+        S32 mInvCacheVersion;
+        U32 mShardCount;
+    };
+
+    struct ShardedCacheEntry
+    {
+        U32 mOffset;
+        U32 mCompressedSize;
+        U32 mSize;
+        U32 mCategoryCount;
+        U32 mItemCount;
+    };
+
+    U32 shard_for(const LLUUID& id, U32 shard_count)
+    {
+        return ((U32)id.mData[0] * shard_count) >> 8;
+    }
+
+    U32 shard_count_for(size_t record_count)
+    {
+        return llclamp((U32)(record_count / RECORDS_PER_SHARD), 1U, MAX_CACHE_SHARDS);
+    }
+
+    // Maps the whole cache and checks its header and shard table
+    LLFileView::ptr_t map_sharded_cache(const std::string& filename,
+                                        S32 cache_version,
+                                        std::vector<ShardedCacheEntry>& entries)
+    {
+        LLFileView::ptr_t view = LLFileView::open(filename, 0, S32_MAX);
+        if (!view || view->getSize() < (S32)sizeof(ShardedCacheHeader))
+        {
+            LL_INFOS(LOG_INV) << "unable to load inventory from: " << filename << LL_ENDL;
+            return nullptr;
+        }
+
+        const U8* data = view->getData();
+        const U32 size = (U32)view->getSize();
+        ShardedCacheHeader header;
+        memcpy(&header, data, sizeof(header));
+        if (header.mMagic != SHARDED_CACHE_MAGIC
+            || header.mFormat != SHARDED_CACHE_FORMAT
+            || header.mInvCacheVersion != cache_version)
+        {
+            LL_WARNS(LOG_INV) << "Inventory cache is out of date" << LL_ENDL;
+            return nullptr;
+        }
+
+        const U32 shard_count = header.mShardCount;
+        const U32 table_end = sizeof(header) + shard_count * sizeof(ShardedCacheEntry);
+        if (shard_count == 0 || shard_count > MAX_CACHE_SHARDS || table_end > size)
+        {
+            LL_WARNS(LOG_INV) << "Corrupted inventory cache shard table in " << filename << LL_ENDL;
+            return nullptr;
+        }
+
+        entries.resize(shard_count);
+        memcpy(entries.data(), data + sizeof(header), shard_count * sizeof(ShardedCacheEntry));
+        for (const ShardedCacheEntry& entry : entries)
+        {
+            if (entry.mOffset < table_end || entry.mCompressedSize > size - entry.mOffset)
+            {
+                LL_WARNS(LOG_INV) << "Corrupted inventory cache shard table in " << filename << LL_ENDL;
+                return nullptr;
+            }
+        }
+        return view;
+    }
+
+    bool decode_cache_shard(const U8* data, const ShardedCacheEntry& entry, LLSD& shard)
+    {
+        std::vector<U8> buffer(entry.mSize);
+        uLongf inflated_size = (uLongf)entry.mSize;
+        if (uncompress(buffer.data(), &inflated_size, data + entry.mOffset, (uLong)entry.mCompressedSize) != Z_OK
+            || inflated_size != entry.mSize)
+        {
+            return false;
+        }
+        LLMemoryStream istr(buffer.data(), (S32)buffer.size());
+        return LLSDSerialize::fromBinary(shard, istr, buffer.size()) != LLSDParser::PARSE_FAILURE;
+    }
+
+    bool encode_cache_shard(const LLSD& shard, std::vector<U8>& blob, ShardedCacheEntry& entry)
+    {
+        std::ostringstream ostr;
+        LLSDSerialize::toBinary(shard, ostr);
+        const std::string raw = ostr.str();
+
+        uLongf compressed_size = compressBound((uLong)raw.size());
+        blob.resize(compressed_size);
+        if (compress2(blob.data(), &compressed_size, (const Bytef*)raw.data(), (uLong)raw.size(), Z_DEFAULT_COMPRESSION) != Z_OK)
+        {
+            blob.clear();
+            return false;
+        }
+        blob.resize(compressed_size);
+
+        entry.mCompressedSize = (U32)compressed_size;
+        entry.mSize = (U32)raw.size();
+        entry.mCategoryCount = (U32)shard["categories"].size();
+        entry.mItemCount = (U32)shard["items"].size();
+        return true;
+    }
+
+    // Moves a finished temp file over the destination
+    bool replace_cache_file(const std::string& temp_filename, const std::string& filename)
+    {
+        // Windows will not rename over an existing file
+        if (LLFile::rename(temp_filename, filename, EEXIST) != 0
+            && (LLFile::remove(filename, ENOENT) != 0 || LLFile::rename(temp_filename, filename) != 0))
+        {
+            LL_WARNS(LOG_INV) << "Unable to move " << temp_filename << " to " << filename << LL_ENDL;
+            LLFile::remove(temp_filename);
+            return false;
+        }
+        return true;
+    }
+
+    // Writes the encoded shards to temp_filename, which the caller then
+    // renames into place so that neither a crash nor a second instance
+    // ever sees a partial file.
+    bool write_sharded_cache(const std::string& temp_filename,
+                             S32 cache_version,
+                             std::vector<ShardedCacheEntry>& entries,
+                             const std::vector<std::vector<U8>>& blobs)
+    {
+        const U32 shard_count = (U32)entries.size();
+        ShardedCacheHeader header;
+        header.mMagic = SHARDED_CACHE_MAGIC;
+        header.mFormat = SHARDED_CACHE_FORMAT;
+        header.mInvCacheVersion = cache_version;
+        header.mShardCount = shard_count;
+
+        U32 offset = sizeof(header) + shard_count * sizeof(ShardedCacheEntry);
+        for (U32 i = 0; i < shard_count; ++i)
+        {
+            if (blobs[i].empty())
+            {
+                LL_WARNS(LOG_INV) << "Failed to encode inventory cache shard. Unable to save inventory to: " << temp_filename << LL_ENDL;
+                return false;
+            }
+            entries[i].mOffset = offset;
+            offset += entries[i].mCompressedSize;
+        }
+
+        llofstream file(temp_filename.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+        if (!file.is_open())
+        {
+            LL_WARNS(LOG_INV) << "Failed to open file. Unable to save inventory to: " << temp_filename << LL_ENDL;
+            return false;
+        }
+        file.write((const char*)&header, sizeof(header));
+        file.write((const char*)entries.data(), shard_count * sizeof(ShardedCacheEntry));
+        for (const std::vector<U8>& blob : blobs)
+        {
+            file.write((const char*)blob.data(), blob.size());
+        }
+        file.close();
+        if (file.fail())
+        {
+            LL_WARNS(LOG_INV) << "Failed to write cache. Unable to save inventory to: " << temp_filename << LL_ENDL;
+            LLFile::remove(temp_filename);
+            return false;
+        }
+        return true;
+    }
+}
+
+//static
+std::string LLInventoryModel::getShardedCacheFilename(const std::string& inventory_filename)
+{
+    return inventory_filename + ".shards";
+}
+
+// static
+bool LLInventoryModel::loadFromShardedFile(const std::string& filename,
+                                           LLInventoryModel::cat_array_t& categories,
+                                           LLInventoryModel::item_array_t& items,
+                                           LLInventoryModel::changed_items_t& cats_to_update,
+                                           bool& is_cache_obsolete)
+{
+    LL_PROFILE_ZONE_SCOPED;
+    LL_INFOS(LOG_INV) << "loading sharded inventory cache from: (" << filename << ")" << LL_ENDL;
+
+    is_cache_obsolete = true; // Obsolete until proven current
+    std::vector<ShardedCacheEntry> entries;
+    LLFileView::ptr_t view = map_sharded_cache(filename, sCurrentInvCacheVersion, entries);
+    if (!view)
+    {
+        return false;
+    }
+    const U8* data = view->getData();
+    const U32 shard_count = (U32)entries.size();
+
+    // The type dictionaries are singletons, make sure they exist before
+    // the workers start looking types up.
+    LLAssetType::lookup(LLAssetType::AT_NONE);
+    LLFolderType::lookup(LLFolderType::FT_NONE);
+    LLInventoryType::lookup(LLInventoryType::IT_NONE);
+
+    struct ShardResult
+    {
+        bool            mSuccess { false };
+        cat_array_t     mCategories;
+        item_array_t    mItems;
+        changed_items_t mCatsToUpdate;
+    };
+    std::vector<ShardResult> results(shard_count);
+
+    LL::run_parallel("General", shard_count, [&](U32 index)
+    {
+        LL_PROFILE_ZONE_NAMED("inventory cache shard decode");
+        const ShardedCacheEntry& entry = entries[index];
+        ShardResult& result = results[index];
+        try
+        {
+            // The shard's LLSD is dropped as soon as it is converted, so
+            // build it in an arena.
+            LLSD::ArenaScope arena;
+            LLSD shard;
+            if (!decode_cache_shard(data, entry, shard))
+            {
+                return;
+            }
+
+            const LLSD& llsd_cats = shard["categories"];
+            result.mCategories.reserve(entry.mCategoryCount);
+            for (LLSD::array_const_iterator iter = llsd_cats.beginArray(), end = llsd_cats.endArray(); iter != end; ++iter)
+            {
+                LLPointer<LLViewerInventoryCategory> inv_cat = new LLViewerInventoryCategory(LLUUID::null);
+                if (inv_cat->importLLSDMap(*iter))
+                {
+                    result.mCategories.push_back(inv_cat);
+                }
+            }
+
+            const LLSD& llsd_items = shard["items"];
+            result.mItems.reserve(entry.mItemCount);
+            for (LLSD::array_const_iterator iter = llsd_items.beginArray(), end = llsd_items.endArray(); iter != end; ++iter)
+            {
+                LLPointer<LLViewerInventoryItem> inv_item = new LLViewerInventoryItem;
+                if (!inv_item->fromLLSD(*iter) || inv_item->getUUID().isNull())
+                {
+                    continue;
+                }
+                if (inv_item->getType() == LLAssetType::AT_UNKNOWN)
+                {
+                    result.mCatsToUpdate.insert(inv_item->getParentUUID());
+                }
+                else
+                {
+                    result.mItems.push_back(inv_item);
+                }
+            }
+            result.mSuccess = true;
+        }
+        catch (...)
+        {
+            // Do not let anything escape into the thread pool
+            LOG_UNHANDLED_EXCEPTION("inventory cache shard decode");
+            result.mCategories.clear();
+            result.mItems.clear();
+        }
+    });
+
+    // Merge the shards in one go
+    size_t cat_count = categories.size();
+    size_t item_count = items.size();
+    for (const ShardResult& result : results)
+    {
+        if (!result.mSuccess)
+        {
+            LL_WARNS(LOG_INV) << "Parsing inventory cache shard failed" << LL_ENDL;
+            return false;
+        }
+        cat_count += result.mCategories.size();
+        item_count += result.mItems.size();
+    }
+    categories.reserve(cat_count);
+    items.reserve(item_count);
+    for (ShardResult& result : results)
+    {
+        std::move(result.mCategories.begin(), result.mCategories.end(), std::back_inserter(categories));
+        std::move(result.mItems.begin(), result.mItems.end(), std::back_inserter(items));
+        cats_to_update.insert(result.mCatsToUpdate.begin(), result.mCatsToUpdate.end());
+    }
+
+    is_cache_obsolete = false;
+    return true;
+}
+
+// static
+bool LLInventoryModel::saveToShardedFile(const std::string& filename,
+                                         const cat_array_t& categories,
+                                         const item_array_t& items)
+{
+    LL_PROFILE_ZONE_SCOPED;
+    LL_INFOS(LOG_INV) << "saving sharded inventory cache to: (" << filename << ")" << LL_ENDL;
+
+    // Only raw pointers go to the workers, LLPointer's count is not atomic
+    std::vector<const LLViewerInventoryCategory*> cats;
+    cats.reserve(categories.size());
+    for (const auto& cat : categories)
+    {
+        if (cat->getVersion() != LLViewerInventoryCategory::VERSION_UNKNOWN)
+        {
+            cats.push_back(cat.get());
+        }
+    }
+
+    const U32 shard_count = shard_count_for(cats.size() + items.size());
+    std::vector<std::vector<const LLViewerInventoryCategory*>> shard_cats(shard_count);
+    std::vector<std::vector<const LLViewerInventoryItem*>> shard_items(shard_count);
+    for (const LLViewerInventoryCategory* cat : cats)
+    {
+        shard_cats[shard_for(cat->getUUID(), shard_count)].push_back(cat);
+    }
+    for (const auto& item : items)
+    {
+        shard_items[shard_for(item->getParentUUID(), shard_count)].push_back(item.get());
+    }
+
+    LLAssetType::lookup(LLAssetType::AT_NONE);
+    LLFolderType::lookup(LLFolderType::FT_NONE);
+    LLInventoryType::lookup(LLInventoryType::IT_NONE);
+
+    std::vector<ShardedCacheEntry> entries(shard_count);
+    std::vector<std::vector<U8>> blobs(shard_count);
+    LL::run_parallel("General", shard_count, [&](U32 index)
+    {
+        LL_PROFILE_ZONE_NAMED("inventory cache shard encode");
+        try
+        {
+            LLSD::ArenaScope arena;
+            LLSD shard;
+            LLSD& cat_array = shard["categories"] = LLSD::emptyArray();
+            for (const LLViewerInventoryCategory* cat : shard_cats[index])
+            {
+                LLSD sd;
+                cat->exportLLSD(sd);
+                cat_array.append(sd);
+            }
+            LLSD& item_array = shard["items"] = LLSD::emptyArray();
+            for (const LLViewerInventoryItem* item : shard_items[index])
+            {
+                LLSD sd;
+                item->asLLSD(sd);
+                item_array.append(sd);
+            }
+            encode_cache_shard(shard, blobs[index], entries[index]);
+        }
+        catch (...)
+        {
+            LOG_UNHANDLED_EXCEPTION("inventory cache shard encode");
+            blobs[index].clear();
+        }
+    });
+
+    const std::string temp_filename = llformat("%s.%d.tmp", filename.c_str(), LLApp::getPid());
+    if (!write_sharded_cache(temp_filename, sCurrentInvCacheVersion, entries, blobs)
+        || !replace_cache_file(temp_filename, filename))
+    {
+        return false;
+    }
+
+    LL_INFOS(LOG_INV) << "Inventory saved: " << cats.size() << " categories, " << items.size()
+                      << " items in " << shard_count << " shards." << LL_ENDL;
+    return true;
+}
+// </FS>
+
+// <FS> Incremental inventory cache
+namespace
+{
+    // The delta log is a sequence of frames, each a CacheDeltaFrame header
+    // followed by a binary LLSD array of records:
+    //   { "category": <exportLLSD> }         the category changed
+    //   { "category": <exportLLSD>,          the category and all of its
+    //     "items": [ <asLLSD>, ... ] }       items, any other item cached
+    //                                        in it is gone
+    //   { "item": <asLLSD> }                 the item changed
+    //   { "remove": <uuid> }                 no longer cached
+    // Records always describe the current state, so replaying a log twice
+    // does no harm. A frame that got cut short or fails its checksum ends
+    // the log.
+    constexpr U32 CACHE_DELTA_MAGIC = 0x4C444649; // "IFDL"
+    constexpr F32 CACHE_DELTA_FLUSH_INTERVAL = 5.f;
+    constexpr size_t CACHE_DELTA_COMPACT_SIZE = 4 * 1024 * 1024;
+
+    const std::string CACHE_DELTA_CATEGORY("category");
+    const std::string CACHE_DELTA_ITEMS("items");
+    const std::string CACHE_DELTA_ITEM("item");
+    const std::string CACHE_DELTA_REMOVE("remove");
+
+    struct CacheDeltaFrame
+    {
+        U32 mMagic;
+        S32 mInvCacheVersion;
+        U32 mSize;
+        U32 mCRC;
+    };
+
+    U32 cache_delta_crc(const U8* data, size_t size)
+    {
+        LLCRC crc;
+        crc.update(data, size);
+        return crc.getCRC();
+    }
+
+    // Appends one frame, returns the number of bytes written or 0
+    size_t append_cache_delta_frame(const std::string& filename, S32 cache_version, const LLSD& records)
+    {
+        std::ostringstream ostr;
+        LLSDSerialize::toBinary(records, ostr);
+        const std::string payload = ostr.str();
+
+        CacheDeltaFrame frame;
+        frame.mMagic = CACHE_DELTA_MAGIC;
+        frame.mInvCacheVersion = cache_version;
+        frame.mSize = (U32)payload.size();
+        frame.mCRC = cache_delta_crc((const U8*)payload.data(), payload.size());
+
+        LLFILE* fp = LLFile::fopen(filename, "ab");
+        if (!fp)
+        {
+            return 0;
+        }
+        bool success = fwrite(&frame, sizeof(frame), 1, fp) == 1
+                       && fwrite(payload.data(), payload.size(), 1, fp) == 1;
+        success = (fclose(fp) == 0) && success;
+        return success ? sizeof(frame) + payload.size() : 0;
+    }
+
+    // The latest state of everything the logs mention
+    struct CacheDelta
+    {
+        std::map<LLUUID, LLSD>  mCategories; // undefined once removed
+        std::map<LLUUID, LLSD>  mItems;      // undefined once removed
+        uuid_set_t              mResetCategories;
+
+        bool empty() const
+        {
+            return mCategories.empty() && mItems.empty();
+        }
+
+        void apply(const LLSD& record)
+        {
+            if (record.has(CACHE_DELTA_CATEGORY))
+            {
+                const LLSD& cat = record[CACHE_DELTA_CATEGORY];
+                const LLUUID cat_id = cat["cat_id"].asUUID();
+                mCategories[cat_id] = cat;
+                if (record.has(CACHE_DELTA_ITEMS))
+                {
+                    mResetCategories.insert(cat_id);
+                    const LLSD& items = record[CACHE_DELTA_ITEMS];
+                    for (LLSD::array_const_iterator iter = items.beginArray(), end = items.endArray(); iter != end; ++iter)
+                    {
+                        mItems[(*iter)["item_id"].asUUID()] = *iter;
+                    }
+                }
+            }
+            else if (record.has(CACHE_DELTA_ITEM))
+            {
+                const LLSD& item = record[CACHE_DELTA_ITEM];
+                mItems[item["item_id"].asUUID()] = item;
+            }
+            else if (record.has(CACHE_DELTA_REMOVE))
+            {
+                const LLUUID id = record[CACHE_DELTA_REMOVE].asUUID();
+                mCategories[id] = LLSD();
+                mItems[id] = LLSD();
+            }
+        }
+
+        // Applies every intact frame of the log, returns how many bytes of
+        // it were intact.
+        size_t read(const std::string& filename, S32 cache_version)
+        {
+            LLFileView::ptr_t view = LLFileView::open(filename, 0, S32_MAX);
+            if (!view)
+            {
+                return 0;
+            }
+
+            const U8* data = view->getData();
+            const size_t size = (size_t)view->getSize();
+            size_t offset = 0;
+            while (size - offset >= sizeof(CacheDeltaFrame))
+            {
+                CacheDeltaFrame frame;
+                memcpy(&frame, data + offset, sizeof(frame));
+                const U8* payload = data + offset + sizeof(frame);
+                if (frame.mMagic != CACHE_DELTA_MAGIC
+                    || frame.mInvCacheVersion != cache_version
+                    || frame.mSize > size - offset - sizeof(frame)
+                    || frame.mCRC != cache_delta_crc(payload, frame.mSize))
+                {
+                    LL_WARNS(LOG_INV) << "Inventory cache delta log " << filename
+                                      << " is damaged after " << offset << " bytes" << LL_ENDL;
+                    break;
+                }
+
+                LLSD records;
+                LLMemoryStream istr(payload, (S32)frame.mSize);
+                if (LLSDSerialize::fromBinary(records, istr, frame.mSize) == LLSDParser::PARSE_FAILURE)
+                {
+                    break;
+                }
+                for (LLSD::array_const_iterator iter = records.beginArray(), end = records.endArray(); iter != end; ++iter)
+                {
+                    apply(*iter);
+                }
+                offset += sizeof(frame) + frame.mSize;
+            }
+            return offset;
+        }
+    };
+
+    // Drops a damaged tail, so that new frames do not end up behind it
+    void truncate_cache_delta_log(const std::string& filename, size_t size)
+    {
+        std::string intact;
+        if (size > 0)
+        {
+            LLFileView::ptr_t view = LLFileView::open(filename, 0, (S32)size);
+            if (!view || (size_t)view->getSize() != size)
+            {
+                LLFile::remove(filename, ENOENT);
+                return;
+            }
+            intact.assign((const char*)view->getData(), size);
+        }
+
+        const std::string temp_filename = llformat("%s.%d.tmp", filename.c_str(), LLApp::getPid());
+        llofstream file(temp_filename.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+        file.write(intact.data(), intact.size());
+        file.close();
+        if (file.fail())
+        {
+            LLFile::remove(temp_filename, ENOENT);
+            LLFile::remove(filename, ENOENT);
+            return;
+        }
+        replace_cache_file(temp_filename, filename);
+    }
+}
+
+struct LLInventoryModel::CacheCompaction
+{
+    LLMutex mMutex;
+    bool    mRunning { false };
+    // Set when the whole cache got rewritten, the compacted snapshot would
+    // be older than that.
+    bool    mCancelled { false };
+};
+
+// static
+std::string LLInventoryModel::getCacheDeltaLogFilename(const std::string& sharded_filename)
+{
+    return sharded_filename + ".log";
+}
+
+// static
+std::string LLInventoryModel::getCacheCompactingLogFilename(const std::string& sharded_filename)
+{
+    return sharded_filename + ".log.compacting";
+}
+
+// static
+void LLInventoryModel::removeCacheDeltaLogs(const std::string& sharded_filename)
+{
+    LLFile::remove(getCacheCompactingLogFilename(sharded_filename), ENOENT);
+    LLFile::remove(getCacheDeltaLogFilename(sharded_filename), ENOENT);
+}
+
+// static
+bool LLInventoryModel::replayCacheDeltaLogs(const std::string& sharded_filename,
+                                            cat_array_t& categories,
+                                            item_array_t& items,
+                                            changed_items_t& cats_to_update)
+{
+    LL_PROFILE_ZONE_SCOPED;
+
+    // The log being compacted when the viewer last quit is older than the
+    // current one
+    CacheDelta delta;
+    delta.read(getCacheCompactingLogFilename(sharded_filename), sCurrentInvCacheVersion);
+    const std::string log_filename = getCacheDeltaLogFilename(sharded_filename);
+    const size_t intact_size = delta.read(log_filename, sCurrentInvCacheVersion);
+    llstat log_stat;
+    if (LLFile::stat(log_filename, &log_stat) == 0 && (size_t)log_stat.st_size > intact_size)
+    {
+        truncate_cache_delta_log(log_filename, intact_size);
+    }
+    if (delta.empty())
+    {
+        return false;
+    }
+
+    // Drop whatever the logs replace, then add the logged state
+    auto cat_logged = [&](const LLPointer<LLViewerInventoryCategory>& cat)
+    {
+        return delta.mCategories.find(cat->getUUID()) != delta.mCategories.end();
+    };
+    categories.erase(std::remove_if(categories.begin(), categories.end(), cat_logged), categories.end());
+    auto item_logged = [&](const LLPointer<LLViewerInventoryItem>& item)
+    {
+        return delta.mItems.find(item->getUUID()) != delta.mItems.end()
+            || delta.mResetCategories.find(item->getParentUUID()) != delta.mResetCategories.end();
+    };
+    items.erase(std::remove_if(items.begin(), items.end(), item_logged), items.end());
+
+    S32 cat_count = 0;
+    S32 item_count = 0;
+    for (const auto& [cat_id, sd] : delta.mCategories)
+    {
+        if (sd.isUndefined())
+        {
+            continue;
+        }
+        LLPointer<LLViewerInventoryCategory> inv_cat = new LLViewerInventoryCategory(LLUUID::null);
+        if (inv_cat->importLLSDMap(sd))
+        {
+            categories.push_back(inv_cat);
+            ++cat_count;
+        }
+    }
+    for (const auto& [item_id, sd] : delta.mItems)
+    {
+        if (sd.isUndefined())
+        {
+            continue;
+        }
+        LLPointer<LLViewerInventoryItem> inv_item = new LLViewerInventoryItem;
+        if (!inv_item->fromLLSD(sd) || inv_item->getUUID().isNull())
+        {
+            continue;
+        }
+        if (inv_item->getType() == LLAssetType::AT_UNKNOWN)
+        {
+            cats_to_update.insert(inv_item->getParentUUID());
+        }
+        else
+        {
+            items.push_back(inv_item);
+            ++item_count;
+        }
+    }
+
+    LL_INFOS(LOG_INV) << "Replayed " << cat_count << " categories and " << item_count
+                      << " items from the inventory cache delta log" << LL_ENDL;
+    return true;
+}
+
+// static
+bool LLInventoryModel::compactShardedFile(const std::string& sharded_filename, const std::string& temp_filename)
+{
+    LL_PROFILE_ZONE_SCOPED;
+
+    // Works on the LLSD only, this runs on a worker thread and must not
+    // touch the model.
+    std::map<LLUUID, LLSD> categories;
+    std::map<LLUUID, LLSD> items;
+    {
+        std::vector<ShardedCacheEntry> entries;
+        LLFileView::ptr_t view = map_sharded_cache(sharded_filename, sCurrentInvCacheVersion, entries);
+        if (!view)
+        {
+            return false;
+        }
+        for (const ShardedCacheEntry& entry : entries)
+        {
+            LLSD shard;
+            if (!decode_cache_shard(view->getData(), entry, shard))
+            {
+                LL_WARNS(LOG_INV) << "Parsing inventory cache shard failed" << LL_ENDL;
+                return false;
+            }
+            const LLSD& llsd_cats = shard["categories"];
+            for (LLSD::array_const_iterator iter = llsd_cats.beginArray(), end = llsd_cats.endArray(); iter != end; ++iter)
+            {
+                categories[(*iter)["cat_id"].asUUID()] = *iter;
+            }
+            const LLSD& llsd_items = shard["items"];
+            for (LLSD::array_const_iterator iter = llsd_items.beginArray(), end = llsd_items.endArray(); iter != end; ++iter)
+            {
+                items[(*iter)["item_id"].asUUID()] = *iter;
+            }
+        }
+    }
+
+    CacheDelta delta;
+    delta.read(getCacheCompactingLogFilename(sharded_filename), sCurrentInvCacheVersion);
+
+    for (const auto& [cat_id, sd] : delta.mCategories)
+    {
+        if (sd.isUndefined())
+        {
+            categories.erase(cat_id);
+        }
+        else
+        {
+            categories[cat_id] = sd;
+        }
+    }
+    for (auto iter = items.begin(); iter != items.end(); )
+    {
+        const LLUUID parent_id = iter->second["parent_id"].asUUID();
+        if (delta.mResetCategories.find(parent_id) != delta.mResetCategories.end())
+        {
+            iter = items.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+    for (const auto& [item_id, sd] : delta.mItems)
+    {
+        if (sd.isUndefined())
+        {
+            items.erase(item_id);
+        }
+        else
+        {
+            items[item_id] = sd;
+        }
+    }
+
+    // Same layout as saveToShardedFile(), leaving out items whose category
+    // is gone since they would be ignored on load anyway
+    const U32 shard_count = shard_count_for(categories.size() + items.size());
+    std::vector<LLSD> shards(shard_count);
+    for (LLSD& shard : shards)
+    {
+        shard["categories"] = LLSD::emptyArray();
+        shard["items"] = LLSD::emptyArray();
+    }
+    for (const auto& [cat_id, sd] : categories)
+    {
+        shards[shard_for(cat_id, shard_count)]["categories"].append(sd);
+    }
+    for (const auto& [item_id, sd] : items)
+    {
+        const LLUUID parent_id = sd["parent_id"].asUUID();
+        if (categories.find(parent_id) != categories.end())
+        {
+            shards[shard_for(parent_id, shard_count)]["items"].append(sd);
+        }
+    }
+
+    std::vector<ShardedCacheEntry> entries(shard_count);
+    std::vector<std::vector<U8>> blobs(shard_count);
+    for (U32 i = 0; i < shard_count; ++i)
+    {
+        encode_cache_shard(shards[i], blobs[i], entries[i]);
+    }
+    if (!write_sharded_cache(temp_filename, sCurrentInvCacheVersion, entries, blobs))
+    {
+        return false;
+    }
+
+    LL_INFOS(LOG_INV) << "Compacted inventory cache: " << categories.size() << " categories, "
+                      << items.size() << " items in " << shard_count << " shards." << LL_ENDL;
+    return true;
+}
+
+void LLInventoryModel::startCacheDeltaLog(const std::string& sharded_filename, const uuid_set_t& complete_cat_ids)
+{
+    LL_INFOS(LOG_INV) << "Logging inventory cache changes to: (" << getCacheDeltaLogFilename(sharded_filename) << ")" << LL_ENDL;
+
+    mCacheDeltaLogging = true;
+    mCacheShardedFilename = sharded_filename;
+    mCacheCompleteCatIDs = complete_cat_ids;
+    mCacheDirtyIDs.clear();
+    llstat log_stat;
+    mCacheDeltaLogSize = LLFile::stat(getCacheDeltaLogFilename(sharded_filename), &log_stat) == 0 ? (size_t)log_stat.st_size : 0;
+    mCacheCompaction = std::make_shared<CacheCompaction>();
+
+    doPeriodically([this]()
+    {
+        if (!mCacheDeltaLogging)
+        {
+            return true;
+        }
+        flushCacheDeltaLog();
+        return false;
+    }, CACHE_DELTA_FLUSH_INTERVAL);
+
+    // Finish what the last session could not
+    if (LLFile::isfile(getCacheCompactingLogFilename(sharded_filename)))
+    {
+        startCacheCompaction();
+    }
+}
+
+void LLInventoryModel::stopCacheDeltaLog()
+{
+    mCacheDeltaLogging = false;
+    mCacheDirtyIDs.clear();
+    mCacheCompleteCatIDs.clear();
+}
+
+void LLInventoryModel::flushCacheDeltaLog()
+{
+    if (!mCacheDeltaLogging || mCacheDirtyIDs.empty())
+    {
+        return;
+    }
+    LL_PROFILE_ZONE_SCOPED;
+
+    uuid_set_t dirty_ids;
+    dirty_ids.swap(mCacheDirtyIDs);
+
+    // Whether a category can be cached depends on its items, so look at
+    // the category of every changed item too.
+    uuid_set_t dirty_cat_ids;
+    for (const LLUUID& id : dirty_ids)
+    {
+        if (const LLViewerInventoryItem* item = getItem(id))
+        {
+            dirty_cat_ids.insert(item->getParentUUID());
+        }
+        else if (getCategory(id))
+        {
+            dirty_cat_ids.insert(id);
+        }
+    }
+
+    const LLUUID& root_id = getRootFolderID();
+    LLSD records = LLSD::emptyArray();
+    uuid_set_t listed_cat_ids;
+    for (const LLUUID& cat_id : dirty_cat_ids)
+    {
+        LLViewerInventoryCategory* cat = getCategory(cat_id);
+        if (!cat || !isObjectDescendentOf(cat_id, root_id))
+        {
+            continue;
+        }
+
+        LLCanCache can_cache(this);
+        if (!can_cache(cat, NULL))
+        {
+            if (mCacheCompleteCatIDs.erase(cat_id))
+            {
+                records.append(LLSD().with(CACHE_DELTA_REMOVE, cat_id));
+            }
+            continue;
+        }
+
+        LLSD record;
+        cat->exportLLSD(record[CACHE_DELTA_CATEGORY]);
+        if (mCacheCompleteCatIDs.insert(cat_id).second)
+        {
+            // Newly complete, log everything in it
+            LLSD& item_array = record[CACHE_DELTA_ITEMS] = LLSD::emptyArray();
+            cat_array_t* cat_array = NULL;
+            item_array_t* items = NULL;
+            getDirectDescendentsOf(cat_id, cat_array, items);
+            if (items)
+            {
+                for (const auto& item : *items)
+                {
+                    LLSD sd;
+                    item->asLLSD(sd);
+                    item_array.append(sd);
+                }
+            }
+            listed_cat_ids.insert(cat_id);
+        }
+        records.append(record);
+    }
+
+    for (const LLUUID& id : dirty_ids)
+    {
+        if (getCategory(id))
+        {
+            if (!isObjectDescendentOf(id, root_id) && mCacheCompleteCatIDs.erase(id))
+            {
+                records.append(LLSD().with(CACHE_DELTA_REMOVE, id));
+            }
+            continue;
+        }
+
+        const LLViewerInventoryItem* item = getItem(id);
+        if (item && !isObjectDescendentOf(id, root_id))
+        {
+            continue; // The library
+        }
+        if (item && mCacheCompleteCatIDs.find(item->getParentUUID()) != mCacheCompleteCatIDs.end())
+        {
+            if (listed_cat_ids.find(item->getParentUUID()) == listed_cat_ids.end())
+            {
+                LLSD record;
+                item->asLLSD(record[CACHE_DELTA_ITEM]);
+                records.append(record);
+            }
+        }
+        else
+        {
+            // Gone, or moved somewhere that is not cached (yet)
+            mCacheCompleteCatIDs.erase(id);
+            records.append(LLSD().with(CACHE_DELTA_REMOVE, id));
+        }
+    }
+
+    if (records.size() == 0)
+    {
+        return;
+    }
+
+    const size_t written = append_cache_delta_frame(getCacheDeltaLogFilename(mCacheShardedFilename), sCurrentInvCacheVersion, records);
+    if (!written)
+    {
+        // Nothing after a damaged frame gets replayed, fall back to saving
+        // everything on logout.
+        LL_WARNS(LOG_INV) << "Unable to append to the inventory cache delta log, disabling it for this session" << LL_ENDL;
+        stopCacheDeltaLog();
+        return;
+    }
+    mCacheDeltaLogSize += written;
+
+    if (mCacheDeltaLogSize >= CACHE_DELTA_COMPACT_SIZE)
+    {
+        startCacheCompaction();
+    }
+}
+
+void LLInventoryModel::startCacheCompaction()
+{
+    if (!mCacheCompaction)
+    {
+        return;
+    }
+    {
+        LLMutexLock lock(&mCacheCompaction->mMutex);
+        if (mCacheCompaction->mRunning || mCacheCompaction->mCancelled)
+        {
+            return;
+        }
+        mCacheCompaction->mRunning = true;
+    }
+
+    // A log that is still waiting to be compacted goes first, otherwise
+    // the current one gets frozen and logging continues in a fresh file.
+    const std::string compacting_filename = getCacheCompactingLogFilename(mCacheShardedFilename);
+    if (!LLFile::isfile(compacting_filename))
+    {
+        if (LLFile::rename(getCacheDeltaLogFilename(mCacheShardedFilename), compacting_filename) != 0)
+        {
+            LLMutexLock lock(&mCacheCompaction->mMutex);
+            mCacheCompaction->mRunning = false;
+            return;
+        }
+        mCacheDeltaLogSize = 0;
+    }
+
+    std::shared_ptr<CacheCompaction> state = mCacheCompaction;
+    const std::string sharded_filename = mCacheShardedFilename;
+    auto job = [state, sharded_filename]()
+    {
+        const std::string temp_filename = llformat("%s.%d.compact.tmp", sharded_filename.c_str(), LLApp::getPid());
+        bool success = false;
+        try
+        {
+            success = compactShardedFile(sharded_filename, temp_filename);
+        }
+        catch (...)
+        {
+            LOG_UNHANDLED_EXCEPTION("inventory cache compaction");
+        }
+
+        LLMutexLock lock(&state->mMutex);
+        if (success && !state->mCancelled && replace_cache_file(temp_filename, sharded_filename))
+        {
+            LLFile::remove(getCacheCompactingLogFilename(sharded_filename), ENOENT);
+        }
+        else
+        {
+            LLFile::remove(temp_filename, ENOENT);
+        }
+        state->mRunning = false;
+    };
+
+    LL::WorkQueue::ptr_t general_queue = LL::WorkQueue::getInstance("General");
+    if (!general_queue || !general_queue->post(job))
+    {
+        // Replayed on the next login and compacted then
+        LLMutexLock lock(&mCacheCompaction->mMutex);
+        mCacheCompaction->mRunning = false;
+    }
+}
+
+void LLInventoryModel::cancelCacheCompaction()
+{
+    if (mCacheCompaction)
+    {
+        LLMutexLock lock(&mCacheCompaction->mMutex);
+        mCacheCompaction->mCancelled = true;
+    }
+}
+// </FS>
+
 // message handling functionality
 // static
 void LLInventoryModel::registerCallbacks(LLMessageSystem* msg)
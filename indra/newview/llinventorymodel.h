@@ -28,6 +28,7 @@
 #define LL_LLINVENTORYMODEL_H
 
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
@@ -732,6 +733,54 @@ protected:
     static bool saveToFile(const std::string& filename,
                            const cat_array_t& categories,
                            const item_array_t& items);
+    // <FS> Sharded inventory cache
+    // Compressed per shard and decoded in parallel straight from memory,
+    // instead of through a gunzipped temp file.
+    static std::string getShardedCacheFilename(const std::string& inventory_filename);
+    static bool loadFromShardedFile(const std::string& filename,
+                                    cat_array_t& categories,
+                                    item_array_t& items,
+                                    changed_items_t& cats_to_update,
+                                    bool& is_cache_obsolete);
+    static bool saveToShardedFile(const std::string& filename,
+                                  const cat_array_t& categories,
+                                  const item_array_t& items);
+    // </FS>
+
+    // <FS> Incremental inventory cache
+    // Changes to the agent's inventory are appended to a delta log next to
+    // the sharded cache every few seconds, and the log is folded back into
+    // the shards in the background once it grows too big. Logout then only
+    // has to flush what changed since the last append.
+public:
+    void flushCacheDeltaLog();
+protected:
+    static std::string getCacheDeltaLogFilename(const std::string& sharded_filename);
+    static std::string getCacheCompactingLogFilename(const std::string& sharded_filename);
+    static void removeCacheDeltaLogs(const std::string& sharded_filename);
+    static bool replayCacheDeltaLogs(const std::string& sharded_filename,
+                                     cat_array_t& categories,
+                                     item_array_t& items,
+                                     changed_items_t& cats_to_update);
+    static bool compactShardedFile(const std::string& sharded_filename, const std::string& temp_filename);
+    void startCacheDeltaLog(const std::string& sharded_filename, const uuid_set_t& complete_cat_ids);
+    void stopCacheDeltaLog();
+    void startCacheCompaction();
+    void cancelCacheCompaction();
+
+    // Shared with the compaction job
+    struct CacheCompaction;
+
+    bool                                mCacheDeltaLogging;
+    std::string                         mCacheShardedFilename;
+    size_t                              mCacheDeltaLogSize;
+    // Changed since the last flush
+    uuid_set_t                          mCacheDirtyIDs;
+    // Categories whose contents in the cache match the model, item changes
+    // in other categories get logged in one go once they are complete
+    uuid_set_t                          mCacheCompleteCatIDs;
+    std::shared_ptr<CacheCompaction>    mCacheCompaction;
+    // </FS>
 
     //--------------------------------------------------------------------
     // Message handling functionality
@@ -411,6 +411,7 @@ U32 LLMeshRepository::sCacheBytesDecomps = 0;
 U32 LLMeshRepository::sCacheReads = 0;
 std::atomic<U32> LLMeshRepository::sCacheWrites = 0;
 U32 LLMeshRepository::sMaxLockHoldoffs = 0;
+bool LLMeshRepository::sDecodedCacheEnabled = false; // <FS/> Decoded mesh cache
 
 LLDeadmanTimer LLMeshRepository::sQuiescentTimer(15.0, false);  // true -> gather cpu metrics
 
@@ -950,6 +951,37 @@ void write_preamble(LLFileSystem &file, S32 header_bytes, S32 flags)
     file.write((U8*)&flags, sizeof(U32));
 }
 
+// <FS> Decoded mesh cache
+// Decoded LODs live in the asset cache next to the mesh asset, under an id
+// derived from the mesh id, the LOD, the mirror/invert variant and the
+// layout version. A layout change simply stops finding the old entries,
+// which then age out of the cache.
+static LLUUID get_decoded_lod_id(const LLVolumeParams& mesh_params, S32 lod)
+{
+    LLUUID decoded_id;
+    decoded_id.generate(llformat("%s:decoded:%d:%u:%u", mesh_params.getSculptID().asString().c_str(), lod,
+                                 (U32)LLVolume::getDecodedFacesVariant(mesh_params), LLVolume::DECODED_FACES_VERSION));
+    return decoded_id;
+}
+
+static void store_decoded_lod(const LLVolumeParams& mesh_params, S32 lod, const LLVolume& volume)
+{
+    LL_PROFILE_ZONE_SCOPED;
+    std::vector<U8> data;
+    if (!volume.packDecodedFaces(data))
+    {
+        return;
+    }
+
+    LLFileSystem file(get_decoded_lod_id(mesh_params, lod), LLAssetType::AT_MESH, LLFileSystem::WRITE);
+    if (file.write(data.data(), (S32)data.size()))
+    {
+        LLMeshRepository::sCacheBytesWritten += (U32)data.size();
+        ++LLMeshRepository::sCacheWrites;
+    }
+}
+// </FS>
+
 LLMeshRepoThread::LLMeshRepoThread()
 : LLThread("mesh repo"),
   mHttpRequest(NULL),
@@ -1614,30 +1646,18 @@ bool LLMeshRepoThread::fetchMeshSkinInfo(const LLUUID& mesh_id)
             LLFileSystem file(mesh_id, LLAssetType::AT_MESH);
             if (in_cache && file.getSize() >= disk_ofset + size)
             {
-                U8* buffer = new(std::nothrow) U8[size];
-                if (!buffer)
-                {
-                    LL_WARNS(LOG_MESH) << "Failed to allocate memory for skin info, size: " << size << LL_ENDL;
-
-                    // Not sure what size is reasonable for skin info,
-                    // but if 30MB allocation failed, we definitely have issues
-                    const S32 MAX_SIZE = 30 * 1024 * 1024; //30MB
-                    if (size < MAX_SIZE)
-                    {
-                        LLAppViewer::instance()->outOfMemorySoftQuit();
-                    } // else ignore failures for anomalously large data
-                    LLMutexLock locker(mLoadedMutex);
-                    mSkinUnavailableQ.emplace_back(mesh_id);
-                    return true;
-                }
+                // <FS> Zero-copy cache reads
                 LLMeshRepository::sCacheBytesRead += size;
                 ++LLMeshRepository::sCacheReads;
                 file.seek(disk_ofset);
-                file.read(buffer, size);
+                LLFileView::ptr_t view = file.readView(size);
+                U8* buffer = (view.notNull() && view->getSize() == size) ? view->getData() : nullptr;
+                // </FS>
 
                 //make sure buffer isn't all 0's by checking the first 1KB (reserved block but not written)
+                //a failed read is treated like an unwritten block
                 bool zero = true;
-                for (S32 i = 0; i < llmin(size, 1024) && zero; ++i)
+                for (S32 i = 0; buffer && i < llmin(size, 1024) && zero; ++i)
                 {
                     zero = buffer[i] == 0;
                 }
@@ -1646,12 +1666,11 @@ bool LLMeshRepoThread::fetchMeshSkinInfo(const LLUUID& mesh_id)
                 {
                     //attempt to parse
                     bool posted = mMeshThreadPool->getQueue().post(
-                        [mesh_id, buffer, size]
+                        [mesh_id, view, buffer, size]
                         ()
                     {
                         if (gMeshRepo.mThread->isShuttingDown())
                         {
-                            delete[] buffer;
                             return;
                         }
                         if (!gMeshRepo.mThread->skinInfoReceived(mesh_id, buffer, size))
@@ -1696,20 +1715,17 @@ bool LLMeshRepoThread::fetchMeshSkinInfo(const LLUUID& mesh_id)
                                 gMeshRepo.mThread->mSkinRequests.push_back(req);
                             }
                         }
-                        delete[] buffer;
                     });
                     if (posted)
                     {
-                        // lambda owns buffer
+                        // lambda holds the view
                         return true;
                     }
                     else if (skinInfoReceived(mesh_id, buffer, size))
                     {
-                        delete[] buffer;
                         return true;
                     }
                 }
-                delete[] buffer;
             }
 
             //reading from cache failed for whatever reason, fetch from sim
@@ -2134,36 +2150,30 @@ bool LLMeshRepoThread::fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod)
 
         if (version <= MAX_MESH_VERSION && offset >= 0 && size > 0)
         {
+            // <FS> Decoded mesh cache
+            if (LLMeshRepository::sDecodedCacheEnabled && fetchDecodedMeshLOD(mesh_params, lod))
+            {
+                return true;
+            }
+            // </FS>
+
             S32 disk_ofset = offset + CACHE_PREAMBLE_SIZE;
             //check cache for mesh asset
             LLFileSystem file(mesh_id, LLAssetType::AT_MESH);
             if (in_cache && (file.getSize() >= disk_ofset + size))
             {
-                U8* buffer = new(std::nothrow) U8[size]; // todo, make buffer thread local and read in thread?
-                if (!buffer)
-                {
-                    LL_WARNS(LOG_MESH) << "Can't allocate memory for mesh " << mesh_id << " LOD " << lod << ", size: " << size << LL_ENDL;
-
-                    // Not sure what size is reasonable for a mesh,
-                    // but if 30MB allocation failed, we definitely have issues
-                    const S32 MAX_SIZE = 30 * 1024 * 1024; //30MB
-                    if (size < MAX_SIZE)
-                    {
-                        LLAppViewer::instance()->outOfMemorySoftQuit();
-                    } // else ignore failures for anomalously large data
-
-                    LLMutexLock lock(mLoadedMutex);
-                    mUnavailableQ.push_back(LODRequest(mesh_params, lod));
-                    return true;
-                }
+                // <FS> Zero-copy cache reads
                 LLMeshRepository::sCacheBytesRead += size;
                 ++LLMeshRepository::sCacheReads;
                 file.seek(disk_ofset);
-                file.read(buffer, size);
+                LLFileView::ptr_t view = file.readView(size);
+                U8* buffer = (view.notNull() && view->getSize() == size) ? view->getData() : nullptr;
+                // </FS>
 
                 //make sure buffer isn't all 0's by checking the first 1KB (reserved block but not written)
+                //a failed read is treated like an unwritten block
                 bool zero = true;
-                for (S32 i = 0; i < llmin(size, 1024) && zero; ++i)
+                for (S32 i = 0; buffer && i < llmin(size, 1024) && zero; ++i)
                 {
                     zero = buffer[i] == 0;
                 }
@@ -2173,12 +2183,11 @@ bool LLMeshRepoThread::fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod)
                     //attempt to parse
                     const LLVolumeParams params(mesh_params);
                     bool posted = mMeshThreadPool->getQueue().post(
-                        [params, mesh_id, lod, buffer, size]
+                        [params, mesh_id, lod, view, buffer, size]
                         ()
                     {
                         if (gMeshRepo.mThread->isShuttingDown())
                         {
-                            delete[] buffer;
                             return;
                         }
                         if (gMeshRepo.mThread->lodReceived(params, lod, buffer, size) == MESH_OK)
@@ -2228,25 +2237,21 @@ bool LLMeshRepoThread::fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod)
                                 LLMeshRepository::sLODProcessing++;
                             }
                         }
-                        delete[] buffer;
                     });
 
                     if (posted)
                     {
-                        // now lambda owns buffer
+                        // lambda holds the view
                         return true;
                     }
                     else if (lodReceived(mesh_params, lod, buffer, size) == MESH_OK)
                     {
-                        delete[] buffer;
                         LL_DEBUGS(LOG_MESH) << "Mesh/Cache: Mesh body for ID " << mesh_id << " - was retrieved from the cache." << LL_ENDL;
 
                         return true;
                     }
 
                 }
-
-                delete[] buffer;
             }
 
             //reading from cache failed for whatever reason, fetch from sim
@@ -2488,52 +2493,128 @@ EMeshProcessingResult LLMeshRepoThread::lodReceived(const LLVolumeParams& mesh_p
     LLPointer<LLVolume> volume = new LLVolume(mesh_params, LLVolumeLODGroup::getVolumeScaleFromDetail(lod));
     if (volume->unpackVolumeFaces(data, data_size))
     {
-        // Use LLVolume::getNumVolumeFaces() here and not LLVolume::getNumFaces(),
-        // because setMeshAssetLoaded() has not yet been called for this volume
-        // (it is set later in LLMeshRepository::notifyMeshLoaded()), and
-        // getNumFaces() would return the number of faces in the LLProfile
-        // instead. HB
-        S32 num_faces = volume->getNumVolumeFaces();
-        if (num_faces > 0)
+        // <FS> Decoded mesh cache
+        if (LLMeshRepository::sDecodedCacheEnabled && volume->getNumVolumeFaces() > 0)
         {
-            // if we have a valid SkinInfo, cache per-joint bounding boxes for this LOD
-            LLPointer<LLMeshSkinInfo> skin_info = nullptr;
-            {
-                LLMutexLock lock(mSkinMapMutex);
-                skin_map::iterator iter = mSkinMap.find(mesh_params.getSculptID());
-                if (iter != mSkinMap.end())
-                {
-                    skin_info = iter->second;
-                }
-            }
-            if (skin_info.notNull() && isAgentAvatarValid())
-            {
-                for (S32 i = 0; i < num_faces; ++i)
-                {
-                    // NOTE: no need to lock gAgentAvatarp as the state being checked is not changed after initialization
-                    LLVolumeFace& face = volume->getVolumeFace(i);
-                    LLSkinningUtil::updateRiggingInfo(skin_info, gAgentAvatarp, face);
-                }
-            }
+            store_decoded_lod(mesh_params, lod, *volume);
+        }
+        return queueLoadedLOD(mesh_params, lod, volume);
+    }
+
+    return MESH_UNKNOWN;
+}
 
-            LoadedMesh mesh(volume, mesh_params, lod);
+// <FS> Decoded mesh cache
+bool LLMeshRepoThread::fetchDecodedMeshLOD(const LLVolumeParams& mesh_params, S32 lod)
+{
+    LL_PROFILE_ZONE_SCOPED;
+    const LLUUID& mesh_id = mesh_params.getSculptID();
+    const LLUUID decoded_id = get_decoded_lod_id(mesh_params, lod);
+
+    LLFileSystem file(decoded_id, LLAssetType::AT_MESH);
+    const S32 size = file.getSize();
+    if (size <= 0)
+    {
+        return false;
+    }
+    LLFileView::ptr_t view = file.readView(size);
+    if (view.isNull() || view->getSize() != size)
+    {
+        return false;
+    }
+    LLMeshRepository::sCacheBytesRead += size;
+    ++LLMeshRepository::sCacheReads;
+
+    const LLVolumeParams params(mesh_params);
+    auto load = [params, mesh_id, decoded_id, lod, view]()
+    {
+        if (gMeshRepo.mThread->isShuttingDown())
+        {
+            return;
+        }
+        if (gMeshRepo.mThread->decodedLodReceived(params, lod, view->getData(), view->getSize()) == MESH_OK)
+        {
+            LL_DEBUGS(LOG_MESH) << "Mesh/Cache: Mesh body for ID " << mesh_id << " - was retrieved from the decoded cache." << LL_ENDL;
+        }
+        else
+        {
+            // Stale or corrupted, the next attempt goes through the mesh asset
+            LL_DEBUGS(LOG_MESH) << "Decoded mesh LOD " << lod << " for ID " << mesh_id << " is unusable, discarding." << LL_ENDL;
+            LLFileSystem::removeFile(decoded_id, LLAssetType::AT_MESH);
+
+            LLMutexLock lock(gMeshRepo.mThread->mMutex);
+            LODRequest req(params, lod);
+            gMeshRepo.mThread->mLODReqQ.push(req);
+            LLMeshRepository::sLODProcessing++;
+        }
+    };
+
+    if (!mMeshThreadPool->getQueue().post(load))
+    {
+        load();
+    }
+    return true;
+}
+
+EMeshProcessingResult LLMeshRepoThread::decodedLodReceived(const LLVolumeParams& mesh_params, S32 lod, const U8* data, S32 data_size)
+{
+    LL_PROFILE_ZONE_SCOPED;
+    LLPointer<LLVolume> volume = new LLVolume(mesh_params, LLVolumeLODGroup::getVolumeScaleFromDetail(lod));
+    if (!volume->unpackDecodedFaces(data, data_size))
+    {
+        return MESH_UNKNOWN;
+    }
+    return queueLoadedLOD(mesh_params, lod, volume);
+}
+// </FS>
+
+EMeshProcessingResult LLMeshRepoThread::queueLoadedLOD(const LLVolumeParams& mesh_params, S32 lod, LLPointer<LLVolume>& volume)
+{
+    // Use LLVolume::getNumVolumeFaces() here and not LLVolume::getNumFaces(),
+    // because setMeshAssetLoaded() has not yet been called for this volume
+    // (it is set later in LLMeshRepository::notifyMeshLoaded()), and
+    // getNumFaces() would return the number of faces in the LLProfile
+    // instead. HB
+    S32 num_faces = volume->getNumVolumeFaces();
+    if (num_faces > 0)
+    {
+        // if we have a valid SkinInfo, cache per-joint bounding boxes for this LOD
+        LLPointer<LLMeshSkinInfo> skin_info = nullptr;
+        {
+            LLMutexLock lock(mSkinMapMutex);
+            skin_map::iterator iter = mSkinMap.find(mesh_params.getSculptID());
+            if (iter != mSkinMap.end())
             {
-                LLMutexLock lock(mLoadedMutex);
-                mLoadedQ.push_back(mesh);
-                // LLPointer is not thread safe, since we added this pointer into
-                // threaded list, make sure counter gets decreased inside mutex lock
-                // and won't affect mLoadedQ processing
-                volume = NULL;
-                // might be good idea to turn mesh into pointer to avoid making a copy
-                mesh.mVolume = NULL;
+                skin_info = iter->second;
             }
+        }
+        if (skin_info.notNull() && isAgentAvatarValid())
+        {
+            for (S32 i = 0; i < num_faces; ++i)
             {
-                // make sure skin info is not removed from list while we are decreasing reference count
-                LLMutexLock lock(mSkinMapMutex);
-                skin_info = nullptr;
+                // NOTE: no need to lock gAgentAvatarp as the state being checked is not changed after initialization
+                LLVolumeFace& face = volume->getVolumeFace(i);
+                LLSkinningUtil::updateRiggingInfo(skin_info, gAgentAvatarp, face);
             }
-            return MESH_OK;
         }
+
+        LoadedMesh mesh(volume, mesh_params, lod);
+        {
+            LLMutexLock lock(mLoadedMutex);
+            mLoadedQ.push_back(mesh);
+            // LLPointer is not thread safe, since we added this pointer into
+            // threaded list, make sure counter gets decreased inside mutex lock
+            // and won't affect mLoadedQ processing
+            volume = NULL;
+            // might be good idea to turn mesh into pointer to avoid making a copy
+            mesh.mVolume = NULL;
+        }
+        {
+            // make sure skin info is not removed from list while we are decreasing reference count
+            LLMutexLock lock(mSkinMapMutex);
+            skin_info = nullptr;
+        }
+        return MESH_OK;
     }
 
     return MESH_UNKNOWN;
@@ -4355,6 +4436,8 @@ void LLMeshRepository::init()
 
     metrics_teleport_started_signal = LLViewerMessage::getInstance()->setTeleportStartedCallback(teleport_started);
 
+    sDecodedCacheEnabled = gSavedSettings.getBOOL("FSMeshDecodedCache"); // <FS/> Decoded mesh cache
+
     mThread = new LLMeshRepoThread();
     mThread->start();
 }
@@ -4587,7 +4670,10 @@ void LLMeshRepository::notifyLoadedMeshes()
         // we'll increase this.  See llappcorehttp and llcorehttp for
         // discussion on connection strategies.
         LLAppCoreHttp & app_core_http(LLAppViewer::instance()->getAppCoreHttp());
-        S32 scale(app_core_http.isPipelined(LLAppCoreHttp::AP_MESH2)
+        // <FS> HTTP/2 multiplexing
+        //S32 scale(app_core_http.isPipelined(LLAppCoreHttp::AP_MESH2)
+        S32 scale((app_core_http.isPipelined(LLAppCoreHttp::AP_MESH2) || app_core_http.isMultiplexed(LLAppCoreHttp::AP_MESH2))
+        // </FS>
                   ? (2 * LLAppCoreHttp::PIPELINING_DEPTH)
                   : 5);
 
@@ -591,6 +591,11 @@ public:
     bool fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod);
     EMeshProcessingResult headerReceived(const LLVolumeParams& mesh_params, U8* data, S32 data_size, U32 flags = 0);
     EMeshProcessingResult lodReceived(const LLVolumeParams& mesh_params, S32 lod, U8* data, S32 data_size);
+    // <FS> Decoded mesh cache
+    bool fetchDecodedMeshLOD(const LLVolumeParams& mesh_params, S32 lod);
+    EMeshProcessingResult decodedLodReceived(const LLVolumeParams& mesh_params, S32 lod, const U8* data, S32 data_size);
+    EMeshProcessingResult queueLoadedLOD(const LLVolumeParams& mesh_params, S32 lod, LLPointer<LLVolume>& volume);
+    // </FS>
     bool skinInfoReceived(const LLUUID& mesh_id, U8* data, S32 data_size);
     bool decompositionReceived(const LLUUID& mesh_id, U8* data, S32 data_size);
     EMeshProcessingResult physicsShapeReceived(const LLUUID& mesh_id, U8* data, S32 data_size);
@@ -857,6 +862,7 @@ public:
     static U32 sCacheReads;
     static std::atomic<U32> sCacheWrites;
     static U32 sMaxLockHoldoffs;                // Maximum sequential locking failures
+    static bool sDecodedCacheEnabled;           // <FS/> Decoded mesh cache, set once at init
 
     static LLDeadmanTimer sQuiescentTimer;      // Time-to-complete-mesh-downloads after significant events
 
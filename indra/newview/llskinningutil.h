@@ -51,7 +51,10 @@ namespace LLSkinningUtil
     LL_FORCE_INLINE void getPerVertexSkinMatrixWithIndices(
         F32*        weights,
         U8*         idx,
-        LLMatrix4a* mat,
+        // <FS> Skinning palette cache: palettes are shared read-only
+        //LLMatrix4a* mat,
+        const LLMatrix4a* mat,
+        // </FS>
         LLMatrix4a& final_mat,
         LLMatrix4a* src)
     {
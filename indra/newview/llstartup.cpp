@@ -949,6 +949,13 @@ bool idle_startup()
 
             F32 dropPercent = gSavedSettings.getF32("PacketDropPercentage");
             msg->mPacketRing.setDropPercentage(dropPercent);
+
+            // <FS> Threaded UDP receive
+            if (gSavedSettings.getBOOL("FSThreadedUDPReceive"))
+            {
+                msg->mPacketRing.startReceiveThread(msg->mSocket);
+            }
+            // </FS>
         }
 
         LL_INFOS("AppInit") << "Message System Initialized." << LL_ENDL;
@@ -29,9 +29,12 @@
 #include "lltexturecache.h"
 
 #include "llapr.h"
+#include "llasyncfileio.h" // <FS/> Async cache I/O
+#include "llfileview.h" // <FS/> Lock-free header index
 #include "lldir.h"
 #include "llimage.h"
 #include "llimagej2c.h" // for version control
+#include "llimagedxt.h" // <FS/> Compressed texture cache
 #include "lllfsthread.h"
 #include "llviewercontrol.h"
 
@@ -39,6 +42,9 @@
 #include "llappviewer.h"
 #include "llmemory.h"
 
+#include <atomic> // <FS/> Compressed texture cache
+#include <thread> // <FS/> Lock-free header index
+
 // Cache organization:
 // cache/texture.entries
 //  Unordered array of Entry structs
@@ -46,6 +52,9 @@
 //  First TEXTURE_CACHE_ENTRY_SIZE bytes of each texture in texture.entries in same order
 // cache/textures/[0-F]/UUID.texture
 //  Actual texture body files
+// cache/textures/[0-F]/UUID.bcn
+//  <FS> Compressed texture cache: BC1 mip chain of an opaque texture, only
+//  valid while the texture has an entry in texture.entries
 
 //note: there is no good to define 1024 for TEXTURE_CACHE_ENTRY_SIZE while FIRST_PACKET_SIZE is 600 on sim side.
 const S32 TEXTURE_CACHE_ENTRY_SIZE = FIRST_PACKET_SIZE;//1024;
@@ -56,6 +65,10 @@ const S32 TEXTURE_FAST_CACHE_DATA_SIZE = 16 * 16 * 4;
 const S32 TEXTURE_FAST_CACHE_ENTRY_SIZE = TEXTURE_FAST_CACHE_DATA_SIZE + TEXTURE_FAST_CACHE_ENTRY_OVERHEAD;
 const F32 TEXTURE_LAZY_PURGE_TIME_LIMIT = .004f; // 4ms. Would be better to autoadjust, but there is a major cache rework in progress.
 const F32 TEXTURE_PRUNING_MAX_TIME = 15.f;
+// <FS> Compressed texture cache
+const S32 TEXTURE_COMPRESSED_CACHE_VERSION = 1;
+const S32 TEXTURE_COMPRESSED_CACHE_OVERHEAD = sizeof(S32) * 2; // version, discard level
+// </FS>
 
 class LLTextureCacheWorker : public LLWorkerClass
 {
@@ -135,6 +148,9 @@ public:
         mBytesRead = bytes;
     }
 
+protected:
+    bool submitIO(const std::string& filename, U8* buffer, S32 offset, S32 size, bool write); // <FS/> Async cache I/O
+
 private:
     virtual void startWork(S32 param); // called from addWork() (MAIN THREAD)
     virtual void finishWork(S32 param, bool completed); // called from finishRequest() (WORK THREAD)
@@ -260,7 +276,8 @@ private:
         LOCAL = 1,
         CACHE = 2,
         HEADER = 3,
-        BODY = 4
+        BODY = 4,
+        BODY_WAIT = 5 // <FS/> Async cache I/O
     };
 
     e_state mState;
@@ -274,6 +291,48 @@ void LLTextureCacheWorker::startWork(S32 param)
 {
 }
 
+// <FS> Async cache I/O
+// Called from doWork(). Hands a body file transfer to LLAsyncFileIO and
+// parks the work request; doWork() runs again once mBytesRead is set.
+// Returns false if the transfer must be done synchronously instead.
+bool LLTextureCacheWorker::submitIO(const std::string& filename, U8* buffer, S32 offset, S32 size, bool write)
+{
+    LLAsyncFileIO* io = LLAsyncFileIO::instance();
+    if (!io)
+    {
+        return false;
+    }
+
+    LLPointer<LLLFSThread::Responder> responder;
+    if (write)
+    {
+        responder = new WriteResponder(mCache, mRequestHandle);
+    }
+    else
+    {
+        responder = new ReadResponder(mCache, mRequestHandle);
+    }
+    LLTextureCache* cache = mCache;
+    handle_t handle = mRequestHandle;
+    auto completion = [responder, cache, handle](S32 bytes)
+    {
+        responder->completed(bytes);
+        cache->wakeRequest(handle);
+    };
+
+    mBytesRead = -1;
+    mBytesToRead = size;
+    cache->waitForWake(handle);
+    bool queued = write ? io->write(filename, buffer, offset, size, completion)
+                        : io->read(filename, buffer, offset, size, completion);
+    if (!queued)
+    {
+        cache->wakeRequest(handle); // disarm
+    }
+    return queued;
+}
+// </FS>
+
 // This is where a texture is read from the cache system (header and body)
 // Current assumption are:
 // - the whole data are in a raw form, will be stored at mReadData
@@ -486,6 +545,14 @@ bool LLTextureCacheRemoteWorker::doRead()
                 llassert_always(mReadData == NULL);
                 mReadData = data;
 
+                // <FS> Async cache I/O
+                if (submitIO(filename, mReadData + data_offset, file_offset, file_size, false))
+                {
+                    mState = BODY_WAIT;
+                    return false;
+                }
+                // </FS>
+
                 // Read the data at last
                 S32 bytes_read = LLAPRFile::readEx(filename,
                                                  mReadData + data_offset,
@@ -522,6 +589,23 @@ bool LLTextureCacheRemoteWorker::doRead()
         done = true;
     }
 
+    // <FS> Async cache I/O
+    // The body read submitted above has completed
+    if (!done && (mState == BODY_WAIT))
+    {
+        if (mBytesRead != mBytesToRead)
+        {
+            LL_WARNS() << "LLTextureCacheWorker: "  << mID
+                    << " incorrect number of bytes read from body: " << (S32)mBytesRead
+                    << " / " << mBytesToRead << LL_ENDL;
+            ll_aligned_free_16(mReadData);
+            mReadData = NULL;
+            mDataSize = -1; // failed
+        }
+        done = true;
+    }
+    // </FS>
+
     // Clean up and exit
     return done;
 }
@@ -682,6 +766,13 @@ bool LLTextureCacheRemoteWorker::doWrite()
             {
                 // build the cache file name from the UUID
                 std::string filename = mCache->getTextureFileName(mID);
+                // <FS> Async cache I/O
+                if (submitIO(filename, const_cast<U8*>(mWriteData) + TEXTURE_CACHE_ENTRY_SIZE, 0, file_size, true))
+                {
+                    mState = BODY_WAIT;
+                    return false;
+                }
+                // </FS>
                 //          LL_INFOS() << "Writing Body: " << filename << " Bytes: " << file_offset+file_size << LL_ENDL;
                 S32 bytes_written = LLAPRFile::writeEx(filename,
                                                        mWriteData + TEXTURE_CACHE_ENTRY_SIZE,
@@ -701,6 +792,21 @@ bool LLTextureCacheRemoteWorker::doWrite()
             done = true;
         }
     }
+
+    // <FS> Async cache I/O
+    // The body write submitted above has completed
+    if (!done && (mState == BODY_WAIT))
+    {
+        if (mBytesRead <= 0)
+        {
+            LL_WARNS() << "LLTextureCacheWorker: " << mID
+                << " incorrect number of bytes written to body: " << (S32)mBytesRead
+                << " / " << mBytesToRead << LL_ENDL;
+            mDataSize = -1; // failed
+        }
+        done = true;
+    }
+    // </FS>
     mRawImage = NULL;
 
     // Clean up and exit
@@ -795,6 +901,7 @@ LLTextureCache::LLTextureCache(bool threaded)
       mHeaderMutex(),
       mListMutex(),
       mFastCacheMutex(),
+      mCompressedWriteMutex(), // <FS/> Compressed texture cache
       mHeaderAPRFile(NULL),
       mReadOnly(true), //do not allow to change the texture cache until setReadOnly() is called.
       mTexturesSizeTotal(0),
@@ -872,13 +979,20 @@ std::string LLTextureCache::getTextureFileName(const LLUUID& id)
     return filename;
 }
 
+// <FS> Compressed texture cache
+std::string LLTextureCache::getCompressedFileName(const LLUUID& id)
+{
+    std::string idstr = id.asString();
+    std::string delem = gDirUtilp->getDirDelimiter();
+    std::string filename = mTexturesDirName + delem + idstr[0] + delem + idstr + ".bcn";
+    return filename;
+}
+// </FS>
+
 //debug
 bool LLTextureCache::isInCache(const LLUUID& id)
 {
-    LLMutexLock lock(&mHeaderMutex);
-    id_map_t::const_iterator iter = mHeaderIDMap.find(id);
-
-    return (iter != mHeaderIDMap.end()) ;
+    return mHeaderIDMap.find(id) >= 0; // <FS/> Lock-free header index
 }
 
 //debug
@@ -922,6 +1036,232 @@ bool LLTextureCache::isInLocal(const LLUUID& id)
 }
 //////////////////////////////////////////////////////////////////////////////
 
+// <FS> Lock-free header index
+static inline void split_uuid(const LLUUID& id, U64& lo, U64& hi)
+{
+    memcpy(&lo, id.mData, sizeof(U64));
+    memcpy(&hi, id.mData + sizeof(U64), sizeof(U64));
+}
+
+LLTextureCache::HeaderIndex::HeaderIndex()
+:   mMask(0),
+    mUsed(0),
+    mBatchDepth(0),
+    mSequence(0)
+{
+}
+
+void LLTextureCache::HeaderIndex::init(U32 max_entries)
+{
+    // Keep the load factor under 3/4 even with a full cache
+    U32 capacity = 1024;
+    while (capacity < max_entries + max_entries / 3 + 1)
+    {
+        capacity <<= 1;
+    }
+    if (mSlots && capacity <= mMask + 1)
+    {
+        return; // already large enough, readers may be holding on to it
+    }
+
+    mSlots.reset(new Slot[capacity]);
+    mMask = capacity - 1;
+    mUsed = 0;
+    for (U32 i = 0; i < capacity; ++i)
+    {
+        mSlots[i].mKeyLo.store(0, std::memory_order_relaxed);
+        mSlots[i].mKeyHi.store(0, std::memory_order_relaxed);
+        mSlots[i].mIndex.store(-1, std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+// Returns the slot holding the key (live or tombstone), or -1
+S32 LLTextureCache::HeaderIndex::findSlot(U64 lo, U64 hi) const
+{
+    U32 i = (U32)(lo ^ (hi >> 32)) & mMask;
+    for (U32 probes = 0; probes <= mMask; ++probes, i = (i + 1) & mMask)
+    {
+        const Slot& slot = mSlots[i];
+        U64 key_lo = slot.mKeyLo.load(std::memory_order_relaxed);
+        U64 key_hi = slot.mKeyHi.load(std::memory_order_relaxed);
+        if (key_lo == lo && key_hi == hi)
+        {
+            return (S32)i;
+        }
+        if (!key_lo && !key_hi)
+        {
+            break;
+        }
+    }
+    return -1;
+}
+
+S32 LLTextureCache::HeaderIndex::find(const LLUUID& id) const
+{
+    if (!mSlots || id.isNull())
+    {
+        return -1;
+    }
+
+    U64 lo, hi;
+    split_uuid(id, lo, hi);
+    while (true)
+    {
+        U32 seq = mSequence.load(std::memory_order_acquire);
+        if (seq & 1)
+        {
+            std::this_thread::yield(); // a writer is mid update
+            continue;
+        }
+
+        S32 slot = findSlot(lo, hi);
+        S32 idx = slot < 0 ? -1 : mSlots[slot].mIndex.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (mSequence.load(std::memory_order_relaxed) == seq)
+        {
+            return idx;
+        }
+    }
+}
+
+void LLTextureCache::HeaderIndex::beginWrite()
+{
+    if (!mBatchDepth)
+    {
+        mSequence.store(mSequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+}
+
+void LLTextureCache::HeaderIndex::endWrite()
+{
+    if (!mBatchDepth)
+    {
+        mSequence.store(mSequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+}
+
+void LLTextureCache::HeaderIndex::beginBatch()
+{
+    beginWrite();
+    ++mBatchDepth;
+}
+
+void LLTextureCache::HeaderIndex::endBatch()
+{
+    llassert(mBatchDepth > 0);
+    --mBatchDepth;
+    endWrite();
+}
+
+void LLTextureCache::HeaderIndex::insert(const LLUUID& id, S32 idx)
+{
+    if (!mSlots || id.isNull() || idx < 0)
+    {
+        return;
+    }
+
+    U64 lo, hi;
+    split_uuid(id, lo, hi);
+    beginWrite();
+    S32 slot = findSlot(lo, hi);
+    if (slot < 0)
+    {
+        if ((mUsed + 1) * 4 > (mMask + 1) * 3)
+        {
+            rehash(); // drop tombstones
+        }
+        // First free or erased slot along the probe sequence
+        U32 i = (U32)(lo ^ (hi >> 32)) & mMask;
+        while (mSlots[i].mIndex.load(std::memory_order_relaxed) >= 0)
+        {
+            i = (i + 1) & mMask;
+        }
+        Slot& free_slot = mSlots[i];
+        if (!free_slot.mKeyLo.load(std::memory_order_relaxed) && !free_slot.mKeyHi.load(std::memory_order_relaxed))
+        {
+            ++mUsed; // tombstones are already counted
+        }
+        free_slot.mKeyLo.store(lo, std::memory_order_relaxed);
+        free_slot.mKeyHi.store(hi, std::memory_order_relaxed);
+        slot = (S32)i;
+    }
+    mSlots[slot].mIndex.store(idx, std::memory_order_relaxed);
+    endWrite();
+}
+
+void LLTextureCache::HeaderIndex::erase(const LLUUID& id)
+{
+    if (!mSlots || id.isNull())
+    {
+        return;
+    }
+
+    U64 lo, hi;
+    split_uuid(id, lo, hi);
+    S32 slot = findSlot(lo, hi);
+    if (slot >= 0 && mSlots[slot].mIndex.load(std::memory_order_relaxed) >= 0)
+    {
+        // Keep the key as a tombstone so longer probe chains stay intact
+        beginWrite();
+        mSlots[slot].mIndex.store(-1, std::memory_order_relaxed);
+        endWrite();
+    }
+}
+
+void LLTextureCache::HeaderIndex::clear()
+{
+    if (!mSlots)
+    {
+        return;
+    }
+
+    beginWrite();
+    for (U32 i = 0; i <= mMask; ++i)
+    {
+        mSlots[i].mKeyLo.store(0, std::memory_order_relaxed);
+        mSlots[i].mKeyHi.store(0, std::memory_order_relaxed);
+        mSlots[i].mIndex.store(-1, std::memory_order_relaxed);
+    }
+    mUsed = 0;
+    endWrite();
+}
+
+// Called inside a write
+void LLTextureCache::HeaderIndex::rehash()
+{
+    std::vector<std::pair<std::pair<U64, U64>, S32> > live;
+    for (U32 i = 0; i <= mMask; ++i)
+    {
+        Slot& slot = mSlots[i];
+        S32 idx = slot.mIndex.load(std::memory_order_relaxed);
+        if (idx >= 0)
+        {
+            live.push_back(std::make_pair(std::make_pair(slot.mKeyLo.load(std::memory_order_relaxed),
+                                                         slot.mKeyHi.load(std::memory_order_relaxed)), idx));
+        }
+        slot.mKeyLo.store(0, std::memory_order_relaxed);
+        slot.mKeyHi.store(0, std::memory_order_relaxed);
+        slot.mIndex.store(-1, std::memory_order_relaxed);
+    }
+    mUsed = 0;
+    for (const auto& entry : live)
+    {
+        U32 i = (U32)(entry.first.first ^ (entry.first.second >> 32)) & mMask;
+        while (mSlots[i].mIndex.load(std::memory_order_relaxed) >= 0)
+        {
+            i = (i + 1) & mMask;
+        }
+        mSlots[i].mKeyLo.store(entry.first.first, std::memory_order_relaxed);
+        mSlots[i].mKeyHi.store(entry.first.second, std::memory_order_relaxed);
+        mSlots[i].mIndex.store(entry.second, std::memory_order_relaxed);
+        ++mUsed;
+    }
+}
+// </FS>
+
 //static
 F32 LLTextureCache::sHeaderCacheVersion = 1.71f;
 U32 LLTextureCache::sCacheMaxEntries = 1024 * 1024; //~1 million textures.
@@ -997,6 +1337,12 @@ S64 LLTextureCache::initCache(ELLPath location, S64 max_size, bool texture_cache
     S64 entries_size = (max_size * 36) / 100; //0.36 * max_size
     S64 max_entries = entries_size / (TEXTURE_CACHE_ENTRY_SIZE + TEXTURE_FAST_CACHE_ENTRY_SIZE);
     sCacheMaxEntries = (S32)(llmin((S64)sCacheMaxEntries, max_entries));
+    // <FS> Lock-free header index
+    {
+        LLMutexLock lock(&mHeaderMutex);
+        mHeaderIDMap.init(sCacheMaxEntries);
+    }
+    // </FS>
     entries_size = sCacheMaxEntries * (TEXTURE_CACHE_ENTRY_SIZE + TEXTURE_FAST_CACHE_ENTRY_SIZE);
     max_size -= entries_size;
     if (sCacheMaxTexturesSize > 0)
@@ -1118,13 +1464,7 @@ void LLTextureCache::writeEntriesHeader()
 //mHeaderMutex is locked before calling this.
 S32 LLTextureCache::openAndReadEntry(const LLUUID& id, Entry& entry, bool create)
 {
-    S32 idx = -1;
-
-    id_map_t::iterator iter1 = mHeaderIDMap.find(id);
-    if (iter1 != mHeaderIDMap.end())
-    {
-        idx = iter1->second;
-    }
+    S32 idx = mHeaderIDMap.find(id); // <FS/> Lock-free header index
 
     if (idx < 0)
     {
@@ -1151,10 +1491,9 @@ S32 LLTextureCache::openAndReadEntry(const LLUUID& id, Entry& entry, bool create
                     // Erase entry from LRU regardless
                     mLRU.erase(curiter2);
                     // Look up entry and use it if it is valid
-                    id_map_t::iterator iter3 = mHeaderIDMap.find(oldid);
-                    if (iter3 != mHeaderIDMap.end() && iter3->second >= 0)
+                    idx = mHeaderIDMap.find(oldid); // <FS/> Lock-free header index
+                    if (idx >= 0)
                     {
-                        idx = iter3->second;
                         removeCachedTexture(oldid) ;//remove the existing cached texture to release the entry index.
                         break;
                     }
@@ -1290,7 +1629,7 @@ bool LLTextureCache::updateEntry(S32& idx, Entry& entry, S32 new_image_size, S32
         bool update_header = false ;
         if(entry.mImageSize < 0) //is a brand-new entry
         {
-            mHeaderIDMap[entry.mID] = idx;
+            mHeaderIDMap.insert(entry.mID, idx); // <FS/> Lock-free header index
             mTexturesSizeMap[entry.mID] = new_body_size ;
             mTexturesSizeTotal += new_body_size ;
 
@@ -1330,50 +1669,61 @@ U32 LLTextureCache::openAndReadEntries(std::vector<Entry>& entries)
 {
     U32 num_entries = mHeaderEntriesInfo.mEntries;
 
-    mHeaderIDMap.clear();
+    // <FS> Lock-free header index
+    // Lookups wait while the index is rebuilt rather than missing entries.
+    // They spin meanwhile, so the index is cleared and refilled in one batch
+    // once the entries file has been read, not around the file reads.
+    struct IndexBatch
+    {
+        HeaderIndex& mIndex;
+        IndexBatch(HeaderIndex& index) : mIndex(index) { mIndex.beginBatch(); }
+        ~IndexBatch() { mIndex.endBatch(); }
+    };
+    //mHeaderIDMap.clear();
+    // </FS>
     mTexturesSizeMap.clear();
     mFreeList.clear();
     mTexturesSizeTotal = 0;
 
-    LLAPRFile* aprfile = NULL;
-    if(mUpdatedEntryMap.empty())
-    {
-        aprfile = openHeaderEntriesFile(true, (S32)sizeof(EntriesInfo));
-    }
-    else //update the header file first.
-    {
-        aprfile = openHeaderEntriesFile(false, 0);
+    // <FS> Lock-free header index
+    // The entries are mapped in one go below instead of being read one at a
+    // time, which is up to a million LLAPRFile reads.
+    //LLAPRFile* aprfile = NULL;
+    //if(mUpdatedEntryMap.empty())
+    //{
+    //    aprfile = openHeaderEntriesFile(true, (S32)sizeof(EntriesInfo));
+    //}
+    //else //update the header file first.
+    if (!mUpdatedEntryMap.empty()) //update the header file first.
+    // </FS>
+    {
+        LLAPRFile* aprfile = openHeaderEntriesFile(false, 0);
         updatedHeaderEntriesFile() ;
+        closeHeaderEntriesFile(); // <FS/> Lock-free header index, flush before mapping
         if(!aprfile)
         {
+            mHeaderIDMap.clear(); // <FS/> Lock-free header index
             return 0;
         }
-        aprfile->seek(APR_SET, (S32)sizeof(EntriesInfo));
+        //aprfile->seek(APR_SET, (S32)sizeof(EntriesInfo)); // <FS/> Lock-free header index
     }
-    for (U32 idx=0; idx<num_entries; idx++)
+
+    // <FS> Lock-free header index
+    const size_t first_entry = entries.size();
+    const S32 entries_size = (S32)(num_entries * sizeof(Entry));
+    if (num_entries > 0)
     {
+        LLFileView::ptr_t view = LLFileView::open(mHeaderEntriesFileName, (S32)sizeof(EntriesInfo), entries_size);
+        if (!view || view->getSize() < entries_size)
+        {
+            LL_WARNS() << "Corrupted header entries, failed at " << (view ? view->getSize() / (S32)sizeof(Entry) : 0) << " / " << num_entries << LL_ENDL;
+            mHeaderIDMap.clear();
+            return 0;
+        }
+
         try
         {
-            Entry entry;
-            S32 bytes_read = aprfile->read((void*)(&entry), (S32)sizeof(Entry));
-            if (bytes_read < sizeof(Entry))
-            {
-                LL_WARNS() << "Corrupted header entries, failed at " << idx << " / " << num_entries << LL_ENDL;
-                closeHeaderEntriesFile();
-                return 0;
-            }
-            entries.push_back(entry);
-            //      LL_INFOS() << "ENTRY: " << entry.mTime << " TEX: " << entry.mID << " IDX: " << idx << " Size: " << entry.mImageSize << LL_ENDL;
-            if (entry.mImageSize > entry.mBodySize)
-            {
-                mHeaderIDMap[entry.mID] = idx;
-                mTexturesSizeMap[entry.mID] = entry.mBodySize;
-                mTexturesSizeTotal += entry.mBodySize;
-            }
-            else
-            {
-                mFreeList.insert(idx);
-            }
+            entries.resize(first_entry + num_entries);
         }
         catch (std::bad_alloc&)
         {
@@ -1381,13 +1731,35 @@ U32 LLTextureCache::openAndReadEntries(std::vector<Entry>& entries)
             // Should this actually crash viewer?
             entries.clear();
             LL_WARNS() << "Bad alloc trying to read texture entries from cache, mFreeList: " << (S32)mFreeList.size()
-                << ", added entries: " << idx << ", total entries: " << num_entries << LL_ENDL;
-            closeHeaderEntriesFile();
+                << ", added entries: 0, total entries: " << num_entries << LL_ENDL;
             purgeAllTextures(false);
             return 0;
         }
+        // The view need not be aligned for Entry
+        memcpy((void*)&entries[first_entry], view->getData(), entries_size);
     }
-    closeHeaderEntriesFile();
+    // </FS>
+
+    // <FS> Lock-free header index
+    {
+        IndexBatch batch(mHeaderIDMap);
+        mHeaderIDMap.clear();
+        for (U32 idx = 0; idx < num_entries; idx++)
+        {
+            const Entry& entry = entries[first_entry + idx];
+            if (entry.mImageSize > entry.mBodySize)
+            {
+                mHeaderIDMap.insert(entry.mID, idx);
+                mTexturesSizeMap[entry.mID] = entry.mBodySize;
+                mTexturesSizeTotal += entry.mBodySize;
+            }
+            else
+            {
+                mFreeList.insert(idx);
+            }
+        }
+    }
+    // </FS>
     return num_entries;
 }
 
@@ -1697,10 +2069,9 @@ void LLTextureCache::purgeTexturesLazy(F32 time_limit_sec)
         {
             if (iter1->second > 0)
             {
-                id_map_t::iterator iter2 = mHeaderIDMap.find(iter1->first);
-                if (iter2 != mHeaderIDMap.end())
+                S32 idx = mHeaderIDMap.find(iter1->first); // <FS/> Lock-free header index
+                if (idx >= 0)
                 {
-                    S32 idx = iter2->second;
                     time_idx_set.insert(std::make_pair(entries[idx].mTime, idx));
                 }
                 else
@@ -1738,8 +2109,7 @@ void LLTextureCache::purgeTexturesLazy(F32 time_limit_sec)
             Entry entry = mPurgeEntryList.back().second;
             mPurgeEntryList.pop_back();
             // make sure record is still valid
-            id_map_t::iterator iter_header = mHeaderIDMap.find(entry.mID);
-            if (iter_header != mHeaderIDMap.end() && iter_header->second == idx)
+            if (mHeaderIDMap.find(entry.mID) == idx) // <FS/> Lock-free header index
             {
                 std::string tex_filename = getTextureFileName(entry.mID);
                 removeEntry(idx, entry, tex_filename);
@@ -1782,10 +2152,9 @@ void LLTextureCache::purgeTextures(bool validate)
     {
         if (iter1->second > 0)
         {
-            id_map_t::iterator iter2 = mHeaderIDMap.find(iter1->first);
-            if (iter2 != mHeaderIDMap.end())
+            S32 idx = mHeaderIDMap.find(iter1->first); // <FS/> Lock-free header index
+            if (idx >= 0)
             {
-                S32 idx = iter2->second;
                 time_idx_set.insert(std::make_pair(entries[idx].mTime, idx));
 //              LL_INFOS() << "TIME: " << entries[idx].mTime << " TEX: " << entries[idx].mID << " IDX: " << idx << " Size: " << entries[idx].mImageSize << LL_ENDL;
             }
@@ -2044,18 +2413,14 @@ LLTextureCache::handle_t LLTextureCache::writeToCache(const LLUUID& id,
 //called in the main thread
 LLPointer<LLImageRaw> LLTextureCache::readFromFastCache(const LLUUID& id, S32& discardlevel)
 {
-    U32 offset;
+    // <FS> Lock-free header index
+    S32 idx = mHeaderIDMap.find(id);
+    if (idx < 0)
     {
-        LLMutexLock lock(&mHeaderMutex);
-        id_map_t::const_iterator iter = mHeaderIDMap.find(id);
-        if(iter == mHeaderIDMap.end())
-        {
-            return NULL; //not in the cache
-        }
-
-        offset = iter->second;
+        return NULL; //not in the cache
     }
-    offset *= TEXTURE_FAST_CACHE_ENTRY_SIZE;
+    U32 offset = (U32)idx * TEXTURE_FAST_CACHE_ENTRY_SIZE;
+    // </FS>
 
     U8* data;
     S32 head[4];
@@ -2287,6 +2652,122 @@ void LLTextureCache::addCompleted(Responder* responder, bool success)
 
 //////////////////////////////////////////////////////////////////////////////
 
+// <FS> Compressed texture cache
+// Threads: any, does blocking file I/O
+LLPointer<LLImageDXT> LLTextureCache::readFromCompressedCache(const LLUUID& id, S32& discardlevel)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
+    if (mHeaderIDMap.find(id) < 0)
+    {
+        return NULL; // an orphan file is never used
+    }
+
+    std::string filename = getCompressedFileName(id);
+    S32 file_size = LLAPRFile::size(filename);
+    if (file_size <= TEXTURE_COMPRESSED_CACHE_OVERHEAD + (S32)sizeof(LLImageDXT::dxtfile_header_t))
+    {
+        return NULL;
+    }
+
+    S32 head[2];
+    if (LLAPRFile::readEx(filename, head, 0, TEXTURE_COMPRESSED_CACHE_OVERHEAD) != TEXTURE_COMPRESSED_CACHE_OVERHEAD
+        || head[0] != TEXTURE_COMPRESSED_CACHE_VERSION
+        || head[1] < 0 || head[1] > MAX_DISCARD_LEVEL)
+    {
+        return NULL;
+    }
+
+    S32 data_size = file_size - TEXTURE_COMPRESSED_CACHE_OVERHEAD;
+    LLPointer<LLImageDXT> image = new LLImageDXT();
+    U8* data = image->allocateData(data_size);
+    if (!data
+        || LLAPRFile::readEx(filename, data, TEXTURE_COMPRESSED_CACHE_OVERHEAD, data_size) != data_size
+        || !image->updateData()
+        || image->getFileFormat() != LLImageDXT::FORMAT_DXR1
+        || image->getDiscardLevel() != 0) // truncated
+    {
+        return NULL;
+    }
+
+    discardlevel = head[1];
+    return image;
+}
+
+// Discard level of the compressed cache entry in filename, -1 if there is none
+static S32 get_compressed_discard_level(const std::string& filename)
+{
+    S32 head[2];
+    if (!LLFile::isfile(filename)
+        || LLAPRFile::readEx(filename, head, 0, TEXTURE_COMPRESSED_CACHE_OVERHEAD) != TEXTURE_COMPRESSED_CACHE_OVERHEAD
+        || head[0] != TEXTURE_COMPRESSED_CACHE_VERSION
+        || head[1] < 0 || head[1] > MAX_DISCARD_LEVEL)
+    {
+        return -1;
+    }
+    return head[1];
+}
+
+// Threads: any, encodes and does blocking file I/O
+bool LLTextureCache::writeToCompressedCache(const LLUUID& id, LLPointer<LLImageRaw> raw, S32 discardlevel)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
+    if (mReadOnly || raw.isNull() || discardlevel < 0 || discardlevel > MAX_DISCARD_LEVEL)
+    {
+        return false;
+    }
+
+    if (mHeaderIDMap.find(id) < 0)
+    {
+        return false; // evicted meanwhile
+    }
+
+    // Never replace an entry that is at least as good
+    std::string filename = getCompressedFileName(id);
+    S32 cached_discard = get_compressed_discard_level(filename);
+    if (cached_discard >= 0 && cached_discard <= discardlevel)
+    {
+        return false;
+    }
+
+    LLPointer<LLImageDXT> image = new LLImageDXT();
+    if (!image->encodeBC1(raw))
+    {
+        return false;
+    }
+
+    // Write aside and move into place so a reader never sees half a file.
+    // Encodes of the same texture at different discard levels may run at
+    // the same time, each needs a temp file of its own.
+    static std::atomic<U32> sTempCounter{ 0 };
+    std::string temp_filename = filename + llformat(".%u.tmp", sTempCounter++);
+    S32 head[2] = { TEXTURE_COMPRESSED_CACHE_VERSION, discardlevel };
+    S32 data_size = image->getDataSize();
+    if (LLAPRFile::writeEx(temp_filename, head, 0, TEXTURE_COMPRESSED_CACHE_OVERHEAD) != TEXTURE_COMPRESSED_CACHE_OVERHEAD
+        || LLAPRFile::writeEx(temp_filename, image->getData(), TEXTURE_COMPRESSED_CACHE_OVERHEAD, data_size) != data_size)
+    {
+        LLFile::remove(temp_filename, ENOENT);
+        return false;
+    }
+
+    // A better encode may have landed while this one ran, check again
+    // where no other write can get in between
+    LLMutexLock lock(&mCompressedWriteMutex);
+    cached_discard = get_compressed_discard_level(filename);
+    if (cached_discard >= 0 && cached_discard <= discardlevel)
+    {
+        LLFile::remove(temp_filename, ENOENT);
+        return false;
+    }
+    LLFile::remove(filename, ENOENT);
+    if (LLFile::rename(temp_filename, filename) != 0)
+    {
+        LLFile::remove(temp_filename, ENOENT);
+        return false;
+    }
+    return true;
+}
+// </FS>
+
 //called after mHeaderMutex is locked.
 void LLTextureCache::removeCachedTexture(const LLUUID& id)
 {
@@ -2299,6 +2780,7 @@ void LLTextureCache::removeCachedTexture(const LLUUID& id)
     // We are inside header's mutex so mHeaderAPRFilePoolp is safe to use,
     // but getLocalAPRFilePool() is not safe, it might be in use by worker
     LLAPRFile::remove(getTextureFileName(id), mHeaderAPRFilePoolp);
+    LLFile::remove(getCompressedFileName(id), ENOENT); // <FS/> Compressed texture cache
 }
 
 //called after mHeaderMutex is locked.
@@ -2323,6 +2805,7 @@ void LLTextureCache::removeEntry(S32 idx, Entry& entry, std::string& filename)
           }
         }
         mTexturesSizeTotal -= entry.mBodySize;
+        LLFile::remove(getCompressedFileName(entry.mID), ENOENT); // <FS/> Compressed texture cache
 
         entry.mImageSize = -1;
         entry.mBodySize = 0;
@@ -2354,6 +2837,10 @@ bool LLTextureCache::removeFromCache(const LLUUID& id)
             writeEntryToHeaderImmediately(idx, entry);
             ret = true;
         }
+        else
+        {
+            LLFile::remove(getCompressedFileName(id), ENOENT); // <FS/> Compressed texture cache
+        }
 
         unlockHeaders() ;
     }
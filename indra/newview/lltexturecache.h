@@ -34,6 +34,12 @@
 
 #include "llworkerthread.h"
 
+// <FS> Lock-free header index
+#include <atomic>
+#include <memory>
+// </FS>
+
+class LLImageDXT; // <FS/> Compressed texture cache
 class LLImageFormatted;
 class LLTextureCacheWorker;
 class LLImageRaw;
@@ -128,6 +134,13 @@ public:
     handle_t writeToCache(const LLUUID& id, const U8* data, S32 datasize, S32 imagesize, LLPointer<LLImageRaw> rawimage, S32 discardlevel,
                           WriteResponder* responder);
     LLPointer<LLImageRaw> readFromFastCache(const LLUUID& id, S32& discardlevel);
+    // <FS> Compressed texture cache
+    // BC1 copies of opaque textures at their best cached discard level, for
+    // upload without a J2C decode. Both do blocking file I/O and are meant
+    // for a worker thread; the write also encodes.
+    LLPointer<LLImageDXT> readFromCompressedCache(const LLUUID& id, S32& discardlevel);
+    bool writeToCompressedCache(const LLUUID& id, LLPointer<LLImageRaw> raw, S32 discardlevel);
+    // </FS>
     bool writeComplete(handle_t handle, bool abort = false);
     void prioritizeWrite(handle_t handle);
 
@@ -153,6 +166,7 @@ protected:
     // Accessed by LLTextureCacheWorker
     std::string getLocalFileName(const LLUUID& id);
     std::string getTextureFileName(const LLUUID& id);
+    std::string getCompressedFileName(const LLUUID& id); // <FS/> Compressed texture cache
     void addCompleted(Responder* responder, bool success);
 
 protected:
@@ -190,12 +204,58 @@ private:
     void closeFastCache(bool forced = false);
     bool writeToFastCache(LLUUID image_id, S32 cache_id, LLPointer<LLImageRaw> raw, S32 discardlevel);
 
+private:
+    // <FS> Lock-free header index
+    // Open-addressing UUID -> header entry index table. Writers are
+    // serialized by mHeaderMutex; readers never lock, they validate their
+    // probe against a sequence counter and retry if a write overlapped.
+    class HeaderIndex
+    {
+    public:
+        HeaderIndex();
+
+        // Sizes the table once for the given entry count; not thread safe.
+        void init(U32 max_entries);
+
+        // Returns -1 if the id is not indexed. Safe from any thread.
+        S32 find(const LLUUID& id) const;
+
+        // Writers, mHeaderMutex must be held.
+        void insert(const LLUUID& id, S32 idx);
+        void erase(const LLUUID& id);
+        void clear();
+        // Readers wait out a batch instead of observing a half built table
+        void beginBatch();
+        void endBatch();
+
+    private:
+        struct Slot
+        {
+            std::atomic<U64> mKeyLo;  // both halves zero: never used
+            std::atomic<U64> mKeyHi;
+            std::atomic<S32> mIndex;  // -1: erased (tombstone)
+        };
+
+        S32 findSlot(U64 lo, U64 hi) const;
+        void beginWrite();
+        void endWrite();
+        void rehash();
+
+        std::unique_ptr<Slot[]> mSlots;
+        U32 mMask;
+        U32 mUsed;       // live + tombstones, writer side only
+        U32 mBatchDepth; // writer side only
+        std::atomic<U32> mSequence; // odd while a write is in progress
+    };
+    // </FS>
+
 private:
     // Internal
     LLMutex mWorkersMutex;
     LLMutex mHeaderMutex;
     LLMutex mListMutex;
     LLMutex mFastCacheMutex;
+    LLMutex mCompressedWriteMutex; // <FS/> Compressed texture cache
     LLAPRFile* mHeaderAPRFile;
     LLVolatileAPRPool* mFastCachePoolp;
 
@@ -225,8 +285,7 @@ private:
     EntriesInfo mHeaderEntriesInfo;
     std::set<S32> mFreeList; // deleted entries
     std::set<LLUUID> mLRU;
-    typedef std::map<LLUUID, S32> id_map_t;
-    id_map_t mHeaderIDMap;
+    HeaderIndex mHeaderIDMap; // <FS/> Lock-free header index
 
     LLAPRFile*   mFastCachep;
     LLFrameTimer mFastCacheTimer;
@@ -235,6 +235,12 @@ static const S32 HTTP_PIPE_REQUESTS_LOW_WATER = 50;         // Active level at w
 static const S32 HTTP_NONPIPE_REQUESTS_HIGH_WATER = 40;
 static const S32 HTTP_NONPIPE_REQUESTS_LOW_WATER = 20;
 
+// <FS> Progressive texture fetch
+static const F32 FETCH_STEP_SECONDS = 0.5f;                 // Time a request's share of the bandwidth is sized for
+static const F32 FETCH_BANDWIDTH_MIN = 64.f;                // Floor of the bandwidth estimate (KB/s)
+static const F32 FETCH_BANDWIDTH_RATE = 0.05f;              // Weight of a new sample while the transport is busy
+// </FS>
+
 // BUG-3323/SH-4375
 // *NOTE:  This is a heuristic value.  Texture fetches have a habit of using a
 // value of 32MB to indicate 'get the rest of the image'.  Certain ISPs and
@@ -261,6 +267,15 @@ namespace
     // "delete" derives from Latin "deletus"
     void NoOpDeletor(LLCore::HttpHandler *)
     { /*NoOp*/ }
+
+    // <FS> HTTP/2 multiplexing
+    // Image priorities are screen areas in pixels, spread their
+    // logarithm over the stream weight range.
+    LLCore::HttpRequest::priority_t http_priority(F32 image_priority)
+    {
+        return (LLCore::HttpRequest::priority_t)llclamp(log2f(llmax(image_priority, 0.f) + 1.f) * 12.f, 0.f, 255.f);
+    }
+    // </FS>
 }
 
 static const char* e_state_name[] =
@@ -372,6 +387,13 @@ private:
         // lhs < rhs
         bool operator()(const LLTextureFetchWorker* lhs, const LLTextureFetchWorker* rhs) const
         {
+            // <FS> Progressive texture fetch
+            // Textures still showing grey go ahead of refinements
+            if (lhs->mNothingShown != rhs->mNothingShown)
+            {
+                return lhs->mNothingShown;
+            }
+            // </FS>
             // greater priority is "less"
             return lhs->mImagePriority > rhs->mImagePriority;
         }
@@ -559,6 +581,7 @@ private:
     std::string mUrl;
     U8 mType;
     F32 mImagePriority; // should map to max virtual size
+    bool mNothingShown; // <FS/> Progressive texture fetch: requester has no discard level loaded yet
     F32 mRequestedPriority;
     S32 mDesiredDiscard;
     S32 mSimRequestedDiscard; // <FS:Ansariel> OpenSim compatibility
@@ -631,6 +654,10 @@ private:
     LLViewerAssetStats::duration_t mMetricsStartTime;
 
     LLCore::HttpHandle      mHttpHandle;                // Handle of any active request
+    // <FS> HTTP/2 multiplexing
+    LLCore::HttpRequest::priority_t mHttpPriority;      // Stream priority from mImagePriority
+    std::atomic<bool>       mHttpPriorityDirty;         // mHttpPriority not yet sent for the active request
+    // </FS>
     LLCore::BufferArray *   mHttpBufferArray;           // Refcounted pointer to response data
     S32                     mHttpPolicyClass;
     bool                    mHttpActive;                // Active request to http library
@@ -911,6 +938,7 @@ LLTextureFetchWorker::LLTextureFetchWorker(LLTextureFetch* fetcher,
       mHost(host),
       mUrl(url),
       mImagePriority(priority),
+      mNothingShown(false), // <FS/> Progressive texture fetch
       mRequestedPriority(0.f),
       mDesiredDiscard(-1),
       mSimRequestedDiscard(-1), // <FS:Ansariel> OpenSim compatibility
@@ -950,6 +978,8 @@ LLTextureFetchWorker::LLTextureFetchWorker(LLTextureFetch* fetcher,
       mImageCodec(IMG_CODEC_INVALID),
       mMetricsStartTime(0),
       mHttpHandle(LLCORE_HTTP_HANDLE_INVALID),
+      mHttpPriority(http_priority(priority)), // <FS/> HTTP/2 multiplexing
+      mHttpPriorityDirty(false), // <FS/> HTTP/2 multiplexing
       mHttpBufferArray(NULL),
       mHttpPolicyClass(mFetcher->mHttpPolicyClass),
       mHttpActive(false),
@@ -1098,6 +1128,21 @@ void LLTextureFetchWorker::setDesiredDiscard(S32 discard, S32 size)
 void LLTextureFetchWorker::setImagePriority(F32 priority)
 {
     mImagePriority = priority; //should map to max virtual size, abort if zero
+    // <FS> Prioritized image decode
+    if (mDecodeHandle != 0 && priority >= F_ALMOST_ZERO)
+    {
+        // Moves a still queued decode; no-op once decoding has started
+        LLAppViewer::getImageDecodeThread()->setPriority(mDecodeHandle, priority);
+    }
+    // </FS>
+    // <FS> HTTP/2 multiplexing
+    const LLCore::HttpRequest::priority_t http_prio(http_priority(priority));
+    if (http_prio != mHttpPriority)
+    {
+        mHttpPriority = http_prio;
+        mHttpPriorityDirty = true;
+    }
+    // </FS>
 }
 
 // Locks:  Mw
@@ -1151,6 +1196,23 @@ bool LLTextureFetchWorker::doWork(S32 param)
         }
     }
 
+    // <FS> Prioritized image decode
+    // The texture was discarded or is no longer wanted while its decode is
+    // still waiting in the queue: drop the decode instead of spending a
+    // decode thread on it. A decode that has already started completes.
+    if (mState == DECODE_IMAGE_UPDATE && mDecodeHandle != 0 &&
+        (mFetcher->isQuitting() || getFlags(LLWorkerClass::WCF_DELETE_REQUESTED) || mImagePriority < F_ALMOST_ZERO))
+    {
+        if (LLAppViewer::getImageDecodeThread()->cancel(mDecodeHandle))
+        {
+            LL_PROFILE_ZONE_NAMED_CATEGORY_TEXTURE("tfwdw - decode cancelled");
+            LL_DEBUGS(LOG_TXT) << mID << " abort: queued decode cancelled" << LL_ENDL;
+            mDecodeHandle = 0;
+            return true; // abort
+        }
+    }
+    // </FS>
+
     if (mImagePriority < F_ALMOST_ZERO)
     {
         // <FS:Ansariel> OpenSim compatibility
@@ -1647,15 +1709,27 @@ bool LLTextureFetchWorker::doWork(S32 param)
             // texture fetches result in full fetches.  This can be used
             // by people with questionable ISPs or networking gear that
             // doesn't handle these well.
-            mHttpHandle = mFetcher->mHttpRequest->requestGet(mHttpPolicyClass,
-                                                             mUrl,
-                                                             options,
-                                                             mFetcher->mHttpHeaders,
-                                                             LLCore::HttpHandler::ptr_t(this, &NoOpDeletor));
+            // <FS> HTTP/2 multiplexing
+            // A byte range of (0, 0) is a plain GET that can carry a priority.
+            //mHttpHandle = mFetcher->mHttpRequest->requestGet(mHttpPolicyClass,
+            //                                                 mUrl,
+            //                                                 options,
+            //                                                 mFetcher->mHttpHeaders,
+            //                                                 LLCore::HttpHandler::ptr_t(this, &NoOpDeletor));
+            mHttpHandle = mFetcher->mHttpRequest->requestGetByteRange(mHttpPolicyClass,
+                                                                      mHttpPriority,
+                                                                      mUrl,
+                                                                      0,
+                                                                      0,
+                                                                      options,
+                                                                      mFetcher->mHttpHeaders,
+                                                                      LLCore::HttpHandler::ptr_t(this, &NoOpDeletor));
+            // </FS>
         }
         else
         {
             mHttpHandle = mFetcher->mHttpRequest->requestGetByteRange(mHttpPolicyClass,
+                                                                      mHttpPriority, // <FS/> HTTP/2 multiplexing
                                                                       mUrl,
                                                                       mRequestedOffset,
                                                                       (mRequestedOffset + mRequestedSize) > HTTP_REQUESTS_RANGE_END_MAX
@@ -1678,6 +1752,7 @@ bool LLTextureFetchWorker::doWork(S32 param)
         }
 
         mHttpActive = true;
+        mHttpPriorityDirty = false; // <FS/> HTTP/2 multiplexing, sent with the request
         mFetcher->addToHTTPQueue(mID);
         recordTextureStart(true);
         setState(WAIT_HTTP_REQ);
@@ -1982,7 +2057,8 @@ bool LLTextureFetchWorker::doWork(S32 param)
         mDecodeHandle = LLAppViewer::getImageDecodeThread()->decodeImage(mFormattedImage,
                                                                        discard,
                                                                        mNeedsAux,
-                                                                       new DecodeResponder(mFetcher, mID, this));
+                                                                       new DecodeResponder(mFetcher, mID, this),
+                                                                       mImagePriority); // <FS/> Prioritized image decode
         if (mDecodeHandle == 0)
         {
             // Abort, failed to put into queue.
@@ -2240,7 +2316,11 @@ void LLTextureFetchWorker::endWork(S32 param, bool aborted)
     LL_PROFILE_ZONE_SCOPED;
     if (mDecodeHandle != 0)
     {
+        // <FS> Prioritized image decode
         // LL::ThreadPool has no operation to cancel a particular work item
+        // but a decode still waiting in LLImageDecodeThread's queue can be dropped
+        LLAppViewer::getImageDecodeThread()->cancel(mDecodeHandle);
+        // </FS>
         mDecodeHandle = 0;
     }
     mFormattedImage = NULL;
@@ -2688,6 +2768,7 @@ LLTextureFetch::LLTextureFetch(LLTextureCache* cache, bool threaded, bool qa_mod
       mNetworkQueueMutex(),
       mTextureCache(cache),
       mTextureBandwidth(0),
+      mFetchStepBytes(MAX_IMAGE_DATA_SIZE), // <FS/> Progressive texture fetch
       mHTTPTextureBits(0),
       mTotalHTTPRequests(0),
       mQAMode(qa_mode),
@@ -2706,6 +2787,7 @@ LLTextureFetch::LLTextureFetch(LLTextureCache* cache, bool threaded, bool qa_mod
       mTextureInfoMainThread(false)
 {
     mMaxBandwidth = gSavedSettings.getF32("ThrottleBandwidthKBPS");
+    mBandwidthEstimate = llmax(mMaxBandwidth / 8.f, FETCH_BANDWIDTH_MIN); // <FS/> Progressive texture fetch
     mTextureInfo.setLogging(true);
 
     LLAppCoreHttp & app_core_http(LLAppViewer::instance()->getAppCoreHttp());
@@ -2755,7 +2837,7 @@ LLTextureFetch::~LLTextureFetch()
 }
 
 S32 LLTextureFetch::createRequest(FTType f_type, const std::string& url, const LLUUID& id, const LLHost& host, F32 priority,
-    S32 w, S32 h, S32 c, S32 desired_discard, bool needs_aux, bool can_use_http)
+    S32 w, S32 h, S32 c, S32 desired_discard, bool needs_aux, bool can_use_http, S32 current_discard)
 {
     LL_PROFILE_ZONE_SCOPED;
     if (mDebugPause)
@@ -2780,6 +2862,14 @@ S32 LLTextureFetch::createRequest(FTType f_type, const std::string& url, const L
         }
     }
 
+    // <FS> Progressive texture fetch
+    S32 step_discard = desired_discard;
+    if (w * h * c > 0)
+    {
+        step_discard = getProgressiveDiscard(w, h, c, current_discard, desired_discard);
+    }
+    // </FS>
+
     S32 desired_size;
     std::string exten = gDirUtilp->getExtension(url);
     //if (f_type == FTT_SERVER_BAKE)
@@ -2801,6 +2891,16 @@ S32 LLTextureFetch::createRequest(FTType f_type, const std::string& url, const L
         desired_size = MAX_IMAGE_DATA_SIZE;
         desired_discard = 0;
     }
+    // <FS> Progressive texture fetch
+    else if (step_discard > desired_discard)
+    {
+        // The rest of the image doesn't fit this request's share of the
+        // bandwidth. Fetch a coarser level now; the texture asks again once
+        // it has arrived and the worker resumes from the bytes it holds.
+        desired_discard = step_discard;
+        desired_size = LLImageJ2C::calcDataSizeJ2C(w, h, c, desired_discard);
+    }
+    // </FS>
     else if (desired_discard == 0)
     {
         // if we want the entire image, and we know its size, then get it all
@@ -2839,6 +2939,7 @@ S32 LLTextureFetch::createRequest(FTType f_type, const std::string& url, const L
         }
         worker->mActiveCount++;
         worker->mNeedsAux = needs_aux;
+        worker->mNothingShown = (current_discard < 0); // <FS/> Progressive texture fetch
         worker->setImagePriority(priority);
         worker->setDesiredDiscard(desired_discard, desired_size);
         worker->setCanUseHTTP(can_use_http);
@@ -2867,6 +2968,7 @@ S32 LLTextureFetch::createRequest(FTType f_type, const std::string& url, const L
         worker->lockWorkMutex();                                        // +Mw
         worker->mActiveCount++;
         worker->mNeedsAux = needs_aux;
+        worker->mNothingShown = (current_discard < 0); // <FS/> Progressive texture fetch
         worker->setCanUseHTTP(can_use_http);
         worker->unlockWorkMutex();                                      // -Mw
     }
@@ -3231,7 +3333,12 @@ void LLTextureFetch::commonUpdate()
     // Update low/high water levels based on pipelining.  We pick
     // up setting eventually, so the semaphore/request level can
     // fall outside the [0..HIGH_WATER] range.  Expect that.
-    if (LLAppViewer::instance()->getAppCoreHttp().isPipelined(LLAppCoreHttp::AP_TEXTURE))
+    // <FS> HTTP/2 multiplexing
+    //if (LLAppViewer::instance()->getAppCoreHttp().isPipelined(LLAppCoreHttp::AP_TEXTURE))
+    LLAppCoreHttp & app_core_http(LLAppViewer::instance()->getAppCoreHttp());
+    const bool multiplexed(app_core_http.isMultiplexed(LLAppCoreHttp::AP_TEXTURE));
+    if (app_core_http.isPipelined(LLAppCoreHttp::AP_TEXTURE) || multiplexed)
+    // </FS>
     {
         mHttpHighWater = HTTP_PIPE_REQUESTS_HIGH_WATER;
         mHttpLowWater = HTTP_PIPE_REQUESTS_LOW_WATER;
@@ -3245,6 +3352,13 @@ void LLTextureFetch::commonUpdate()
     // Release waiters
     releaseHttpWaiters();
 
+    // <FS> HTTP/2 multiplexing
+    if (multiplexed)
+    {
+        updateHttpPriorities();
+    }
+    // </FS>
+
     // Run a cross-thread command, if any.
     cmdDoWork();
 
@@ -3274,6 +3388,8 @@ size_t LLTextureFetch::update(F32 max_time_ms)
         add(LLStatViewer::TEXTURE_NETWORK_DATA_RECEIVED, mHTTPTextureBits);
         mHTTPTextureBits = (U32Bits)0;
 
+        updateFetchStepBytes(); // <FS/> Progressive texture fetch
+
         mNetworkQueueMutex.unlock();                                    // -Mfnq
     }
 
@@ -3300,6 +3416,53 @@ size_t LLTextureFetch::update(F32 max_time_ms)
     return res;
 }
 
+// <FS> Progressive texture fetch
+// Threads:  Tmain
+// Locks:  Mfnq
+void LLTextureFetch::updateFetchStepBytes()
+{
+    // The received rate only measures the link while the transport is kept
+    // busy. Below the low water mark it measures demand, so it may raise
+    // the estimate but not lower it.
+    const F32 measured = mTextureBandwidth;
+    if (mHttpSemaphore >= mHttpLowWater)
+    {
+        mBandwidthEstimate = lerp(mBandwidthEstimate, measured, FETCH_BANDWIDTH_RATE);
+    }
+    else
+    {
+        mBandwidthEstimate = llmax(mBandwidthEstimate, measured);
+    }
+    // The throttle is in kilobits
+    mBandwidthEstimate = llclamp(mBandwidthEstimate, FETCH_BANDWIDTH_MIN, llmax(mMaxBandwidth / 8.f, FETCH_BANDWIDTH_MIN));
+
+    // Everything in flight or waiting for a slot shares the link
+    const S32 sharing = llmax(1, (S32)mHttpSemaphore + (S32)mHttpWaitResource.size());
+    mFetchStepBytes = llmax(TEXTURE_CACHE_ENTRY_SIZE, (S32)(mBandwidthEstimate * 1024.f * FETCH_STEP_SECONDS) / sharing);
+}
+
+// Threads:  T* (but Tmain mostly)
+S32 LLTextureFetch::getProgressiveDiscard(S32 w, S32 h, S32 c, S32 current_discard, S32 desired_discard) const
+{
+    static LLCachedControl<bool> progressive_fetch(gSavedSettings, "FSTextureProgressiveFetch", true);
+    if (!progressive_fetch || mQAMode || desired_discard < 0)
+    {
+        return desired_discard;
+    }
+
+    // Always move at least one level past what the texture shows, then
+    // refine further as long as the extra bytes fit into one step.
+    const S32 have = (current_discard >= 0) ? LLImageJ2C::calcDataSizeJ2C(w, h, c, current_discard) : 0;
+    const S32 budget = mFetchStepBytes;
+    S32 discard = llmax(desired_discard, (current_discard >= 0) ? current_discard - 1 : (S32)MAX_DISCARD_LEVEL);
+    while (discard > desired_discard && LLImageJ2C::calcDataSizeJ2C(w, h, c, discard - 1) - have <= budget)
+    {
+        --discard;
+    }
+    return discard;
+}
+// </FS>
+
 // called in the MAIN thread after the TextureCacheThread shuts down.
 //
 // Threads:  Tmain
@@ -3950,6 +4113,39 @@ bool LLTextureFetch::isHttpWaiter(const LLUUID & tid)
     return ret;
 }
 
+// <FS> HTTP/2 multiplexing
+// Threads:  Ttf
+// Locks:  -Mw (must not hold any worker when called)
+void LLTextureFetch::updateHttpPriorities()
+{
+    LL_PROFILE_ZONE_SCOPED;
+    std::vector<LLUUID> tids;
+    {
+        LLMutexLock lock(&mNetworkQueueMutex);                          // +Mfnq
+        if (mHTTPTextureQueue.empty())
+        {
+            return;
+        }
+        tids.assign(mHTTPTextureQueue.begin(), mHTTPTextureQueue.end());
+    }                                                                   // -Mfnq
+
+    for (const LLUUID& tid : tids)
+    {
+        LLTextureFetchWorker* worker(getWorker(tid));
+        if (worker && worker->mHttpPriorityDirty.exchange(false))
+        {
+            worker->lockWorkMutex();                                    // +Mw
+            if (worker->mHttpActive && LLCORE_HTTP_HANDLE_INVALID != worker->mHttpHandle)
+            {
+                // Fire and forget, the request may have completed meanwhile
+                mHttpRequest->requestSetPriority(worker->mHttpHandle, worker->mHttpPriority, LLCore::HttpHandler::ptr_t());
+            }
+            worker->unlockWorkMutex();                                  // -Mw
+        }
+    }
+}
+// </FS>
+
 // Release as many requests as permitted from the WAIT_HTTP_RESOURCE2
 // state to the SEND_HTTP_REQ state based on their current priority.
 //
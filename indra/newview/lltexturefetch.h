@@ -86,8 +86,14 @@ public:
 
     // Threads:  T* (but Tmain mostly)
     // returns discard on success, fail code otherwise
+    // <FS> Progressive texture fetch
+    // current_discard is the level the texture already shows, -1 for none.
+    // The returned discard may be coarser than asked for when the rest
+    // doesn't fit the request's share of the bandwidth; ask again once
+    // it has arrived.
     S32 createRequest(FTType f_type, const std::string& url, const LLUUID& id, const LLHost& host, F32 priority,
-                       S32 w, S32 h, S32 c, S32 discard, bool needs_aux, bool can_use_http);
+                       S32 w, S32 h, S32 c, S32 discard, bool needs_aux, bool can_use_http, S32 current_discard = -1);
+    // </FS>
 
     // Requests that a fetch operation be deleted from the queue.
     // If @cancel is true, also stops any I/O operations pending.
@@ -229,6 +235,15 @@ public:
     // Locks:  -Mw (must not hold any worker when called)
     void releaseHttpWaiters();
 
+    // <FS> HTTP/2 multiplexing
+    // Pass changed image priorities of requests in flight on to
+    // their HTTP/2 streams.
+    //
+    // Threads:  Ttf
+    // Locks:  -Mw (must not hold any worker when called)
+    void updateHttpPriorities();
+    // </FS>
+
     // Threads:  T*
     void cancelHttpWaiters();
 
@@ -291,6 +306,15 @@ private:
     // Threads:  Ttf
     void commonUpdate();
 
+    // <FS> Progressive texture fetch
+    // Threads:  Tmain
+    // Locks:  Mfnq
+    void updateFetchStepBytes();
+
+    // Threads:  T* (but Tmain mostly)
+    S32 getProgressiveDiscard(S32 w, S32 h, S32 c, S32 current_discard, S32 desired_discard) const;
+    // </FS>
+
     // Metrics command helpers
     /**
      * Enqueues a command request at the end of the command queue
@@ -362,6 +386,10 @@ private:
     cancel_queue_t mCancelQueue;                                        // Mfnq // <FS:Ansariel> OpenSim compatibility
     F32 mTextureBandwidth;                                              // <none>
     F32 mMaxBandwidth;                                                  // Mfnq
+    // <FS> Progressive texture fetch
+    F32 mBandwidthEstimate;                                             // Mfnq (KB/s)
+    S32 mFetchStepBytes;                                                // <none>
+    // </FS>
     LLTextureInfo mTextureInfo;
     LLTextureInfo mTextureInfoMainThread;
 
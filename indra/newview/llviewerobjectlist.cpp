@@ -1069,6 +1069,11 @@ void LLViewerObjectList::update(LLAgent &agent)
 
     std::vector<LLViewerObject*>::iterator idle_end = idle_list.begin()+idle_count;
 
+    // <FS> Parallel avatar animation
+    // Avatars evaluate their motions together once every object is idled
+    LLVOAvatar::beginMotionBatch();
+    // </FS>
+
     // <FS:Ansariel> Speed up debug settings
     //if (gSavedSettings.getBOOL("FreezeTime"))
     if (freezeTime)
@@ -1084,6 +1089,7 @@ void LLViewerObjectList::update(LLAgent &agent)
                 objectp->idleUpdate(agent, frame_time);
             }
         }
+        LLVOAvatar::endMotionBatch(); // <FS/> Parallel avatar animation
     }
     else
     {
@@ -1094,6 +1100,7 @@ void LLViewerObjectList::update(LLAgent &agent)
             llassert(objectp->isActive());
                 objectp->idleUpdate(agent, frame_time);
         }
+        LLVOAvatar::endMotionBatch(); // <FS/> Parallel avatar animation
 
         //update flexible objects
         LLVolumeImplFlexible::updateClass();
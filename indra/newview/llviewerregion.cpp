@@ -105,6 +105,7 @@
 // Even though we gave up on login, keep trying for caps after we are logged in:
 const S32 MAX_CAP_REQUEST_ATTEMPTS = 30;
 const U32 DEFAULT_MAX_REGION_WIDE_PRIM_COUNT = 15000;
+const F32 MAX_CACHE_INSTALL_TIME = 0.002f; // <FS/> Asynchronous object cache loading, seconds
 
 bool LLViewerRegion::sVOCacheCullingEnabled = false;
 S32  LLViewerRegion::sLastCameraUpdated = 0;
@@ -251,6 +252,14 @@ public:
     LLVector3   mLastCameraOrigin;
     U32         mLastCameraUpdate;
 
+    // <FS> Asynchronous object cache loading
+    LLVOCache::region_cache_load_ptr_t mPendingCacheLoad;   // read, not yet installed
+    size_t      mPendingExtrasIndex { 0 };
+    LLTimer     mCacheLoadTimer;
+    U32         mCacheLoadToken { 0 };  // tells a late load apart from the current one
+    F32         mCacheLoadTime { 0.f };
+    // </FS>
+
     static void        requestBaseCapabilitiesCoro(U64 regionHandle);
     static void        requestBaseCapabilitiesCompleteCoro(U64 regionHandle);
     static void        requestSimulatorFeatureCoro(std::string url, U64 regionHandle);
@@ -650,6 +659,8 @@ LLViewerRegion::LLViewerRegion(const U64 &handle,
     mViewerAssetUrl(""),
     mCacheLoaded(false),
     mCacheDirty(false),
+    mCacheLoadPending(false), // <FS/> Asynchronous object cache loading
+    mHandshakeReplyPending(false), // <FS/> Asynchronous object cache loading
     mReleaseNotesRequested(false),
     mCapabilitiesState(CAPABILITIES_STATE_INIT),
     mSimulatorFeaturesReceived(false),
@@ -842,18 +853,106 @@ void LLViewerRegion::loadObjectCache()
 
     if(LLVOCache::instanceExists())
     {
-        LLVOCache & vocache = LLVOCache::instance();
-        // Without this a "corrupted" vocache persists until a cache clear or other rewrite. Mark as dirty hereif read fails to force a rewrite.
-        mCacheDirty = !vocache.readFromCache(mHandle, mImpl->mCacheID, mImpl->mCacheMap);
-        vocache.readGenericExtrasFromCache(mHandle, mImpl->mCacheID, mImpl->mGLTFOverridesLLSD, mImpl->mCacheMap);
+        // <FS> Asynchronous object cache loading
+        // Reading and decoding happen on the General pool, the result is
+        // moved into mCacheMap from idleUpdate().
+        static U32 sNextCacheLoadToken = 0;
+        const U32 token = ++sNextCacheLoadToken;
+        const U64 handle = mHandle;
+
+        mCacheLoadPending = true;
+        mImpl->mCacheLoadToken = token;
+        mImpl->mCacheLoadTimer.reset();
 
-        if (mImpl->mCacheMap.empty())
+        LLVOCache::instance().readFromCacheAsync(mHandle, mImpl->mCacheID,
+            [handle, token](const LLVOCache::region_cache_load_ptr_t& load)
+            {
+                LLViewerRegion* regionp = LLWorld::instanceExists() ? LLWorld::getInstance()->getRegionFromHandle(handle) : nullptr;
+                if (!regionp || regionp->mDead || !regionp->mCacheLoadPending || regionp->mImpl->mCacheLoadToken != token)
+                {
+                    // The region went away while its cache was being read
+                    return;
+                }
+                regionp->mImpl->mPendingCacheLoad = load;
+                regionp->mImpl->mPendingExtrasIndex = 0;
+                regionp->installObjectCache(MAX_CACHE_INSTALL_TIME);
+            });
+        // </FS>
+    }
+}
+
+// <FS> Asynchronous object cache loading
+void LLViewerRegion::installObjectCache(F32 max_time)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
+    LLVOCache::region_cache_load_ptr_t load = mImpl->mPendingCacheLoad;
+    if (!load)
+    {
+        return;
+    }
+
+    LLTimer update_timer;
+    // Always make some progress, however small the budget
+    U32 installed = 0;
+    auto has_time = [&]() { return installed++ == 0 || max_time - update_timer.getElapsedTimeF32() > 0; };
+
+    LLVOCacheEntry::vocache_entry_map_t& cache_map = mImpl->mCacheMap;
+    if (cache_map.empty())
+    {
+        // Nothing arrived from the network yet, the usual case
+        cache_map.swap(load->mEntries);
+    }
+    else
+    {
+        // Anything already in memory is newer than what is on disk
+        while (!load->mEntries.empty() && has_time())
         {
-            mCacheDirty = true;
+            cache_map.insert(load->mEntries.extract(load->mEntries.begin()));
         }
     }
+
+    const LLHost& host = getHost();
+    LLVOCache::extras_entry_list_t& extras = load->mExtras;
+    size_t& index = mImpl->mPendingExtrasIndex;
+    while (index < extras.size() && has_time())
+    {
+        LLGLTFOverrideCacheEntry& entry = extras[index++];
+        // attempt to backfill a null objectId, though these shouldn't be in the persisted cache really
+        if (entry.mObjectId.isNull())
+        {
+            gObjectList.getUUIDFromLocal(entry.mObjectId, entry.mLocalId, host.getAddress(), host.getPort());
+        }
+        const U32 local_id = entry.mLocalId;
+        mImpl->mGLTFOverridesLLSD.emplace(local_id, std::move(entry));
+    }
+
+    if (!load->mEntries.empty() || index < extras.size())
+    {
+        return;
+    }
+
+    mImpl->mPendingCacheLoad.reset();
+    mCacheLoadPending = false;
+    // Without this a "corrupted" vocache persists until a cache clear or other rewrite. Mark as dirty hereif read fails to force a rewrite.
+    mCacheDirty = !load->mSuccess || mImpl->mCacheMap.empty();
+
+    mImpl->mCacheLoadTime = mImpl->mCacheLoadTimer.getElapsedTimeF32();
+    record(LLStatViewer::REGION_CACHE_LOAD_TIME, F64Seconds(mImpl->mCacheLoadTime));
+    LL_DEBUGS("VOCache") << "Loaded object cache for region " << getName() << ": " << mImpl->mCacheMap.size() << " objects, "
+                         << mImpl->mGLTFOverridesLLSD.size() << " overrides in " << mImpl->mCacheLoadTime * 1000.f << " ms" << LL_ENDL;
+
+    if (mHandshakeReplyPending)
+    {
+        sendRegionHandshakeReply();
+    }
 }
 
+F32 LLViewerRegion::getObjectCacheLoadTime() const
+{
+    return mCacheLoadPending ? 0.f : mImpl->mCacheLoadTime;
+}
+// </FS>
+
 
 void LLViewerRegion::saveObjectCache()
 {
@@ -862,6 +961,19 @@ void LLViewerRegion::saveObjectCache()
         return;
     }
 
+    // <FS> Asynchronous object cache loading
+    if (mCacheLoadPending)
+    {
+        if (!mImpl->mPendingCacheLoad)
+        {
+            // Still being read, what is on disk is as good as it gets
+            return;
+        }
+        // Read but only partly installed: finish so nothing is lost
+        installObjectCache(F32_MAX);
+    }
+    // </FS>
+
     if (mImpl->mCacheMap.empty())
     {
         return;
@@ -1730,6 +1842,13 @@ void LLViewerRegion::idleUpdate(F32 max_update_time)
         mParcelOverlay->idleUpdate();
     }
 
+    // <FS> Asynchronous object cache loading
+    if (mImpl->mPendingCacheLoad)
+    {
+        installObjectCache(max_update_time - update_timer.getElapsedTimeF32());
+    }
+    // </FS>
+
     if(!sVOCacheCullingEnabled)
     {
         return;
@@ -3422,8 +3541,26 @@ void LLViewerRegion::unpackRegionHandshake()
 
     // After loading cache, signal that simulator can start
     // sending data.
+    // <FS> Asynchronous object cache loading
+    // The flags depend on the cache contents, so the reply waits until the
+    // cache is in memory. Cache probes would all miss otherwise.
+    if (mCacheLoadPending)
+    {
+        mHandshakeReplyPending = true;
+    }
+    else
+    {
+        sendRegionHandshakeReply();
+    }
+}
+
+void LLViewerRegion::sendRegionHandshakeReply()
+{
+    mHandshakeReplyPending = false;
+    LLMessageSystem* msg = gMessageSystem;
+    const LLHost& host = getHost();
+    // </FS>
     // TODO: Send all upstream viewer->sim handshake info here.
-    LLHost host = msg->getSender();
     msg->newMessage("RegionHandshakeReply");
     msg->nextBlock("AgentData");
     msg->addUUID("AgentID", gAgent.getID());
@@ -118,6 +118,10 @@ public:
     // Call this after you have the region name and handle.
     void loadObjectCache();
     void saveObjectCache();
+    // <FS> Asynchronous object cache loading
+    bool isObjectCacheLoadPending() const { return mCacheLoadPending; }
+    F32 getObjectCacheLoadTime() const; // seconds, 0 until loaded
+    // </FS>
 
     void sendMessage(); // Send the current message to this region's simulator
     void sendReliableMessage(); // Send the current message to this region's simulator
@@ -475,6 +479,10 @@ private:
     void addCacheMiss(U32 id, LLViewerRegion::eCacheMissType miss_type);
     void decodeBoundingInfo(LLVOCacheEntry* entry);
     bool isNonCacheableObjectCreated(U32 local_id);
+    // <FS> Asynchronous object cache loading
+    void installObjectCache(F32 max_time); // moves a finished load into mCacheMap
+    void sendRegionHandshakeReply();
+    // </FS>
 
 public:
     void applyCacheMiscExtras(LLViewerObject* obj);
@@ -604,6 +612,10 @@ public:
     // a structure of size 2^14 = 16,000
     bool                                    mCacheLoaded;
     bool                                    mCacheDirty;
+    // <FS> Asynchronous object cache loading
+    bool                                    mCacheLoadPending;      // read or install still in progress
+    bool                                    mHandshakeReplyPending; // waiting for the cache before replying
+    // </FS>
     bool    mAlive;                 // can become false if circuit disconnects
     bool    mSimulatorFeaturesReceived;
     bool    mReleaseNotesRequested;
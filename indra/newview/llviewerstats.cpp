@@ -139,7 +139,11 @@ LLTrace::CountStatHandle<>  FPS("FPS", "Frames rendered"),
                             KILLED("killed", "Number of times killed"),
                             TEX_BAKES("texbakes", "Number of times avatar textures have been baked"),
                             TEX_REBAKES("texrebakes", "Number of times avatar textures have been forced to rebake"),
-                            NUM_NEW_OBJECTS("numnewobjectsstat", "Number of objects in scene that were not previously in cache");
+                            NUM_NEW_OBJECTS("numnewobjectsstat", "Number of objects in scene that were not previously in cache"),
+                            // <FS> Skinning palette cache
+                            SKIN_PALETTE_HITS("skinpalettehits", "Rigged meshes that reused a skinning matrix palette already built this frame"),
+                            SKIN_PALETTE_MATRICES_SAVED("skinpalettematricessaved", "Skinning matrices not rebuilt thanks to the palette cache");
+                            // </FS>
 
 LLTrace::CountStatHandle<LLUnit<F64, LLUnits::Kilotriangles> >
                             TRIANGLES_DRAWN("trianglesdrawnstat");
@@ -253,7 +257,8 @@ LLTrace::EventStatHandle<F64Milliseconds >  REGION_CROSSING_TIME("regioncrossing
                                                                 NETWORK_STACKTIME("networkstacktime", "NETWORK_SECS"),
                                                                 IMAGE_STACKTIME("imagestacktime", "IMAGE_SECS"),
                                                                 REBUILD_STACKTIME("rebuildstacktime", "REBUILD_SECS"),
-                                                                RENDER_STACKTIME("renderstacktime", "RENDER_SECS");
+                                                                RENDER_STACKTIME("renderstacktime", "RENDER_SECS"),
+                                                                REGION_CACHE_LOAD_TIME("regioncacheloadtime", "Time to load a region's object cache"); // <FS/> Asynchronous object cache loading
 
 LLTrace::EventStatHandle<F64Seconds >   AVATAR_EDIT_TIME("avataredittime", "Seconds in Edit Appearance"),
                                                             TOOLBOX_TIME("toolboxtime", "Seconds using Toolbox"),
@@ -137,7 +137,11 @@ extern LLTrace::CountStatHandle<>           FPS,
                                             KILLED,
                                             TEX_BAKES,
                                             TEX_REBAKES,
-                                            NUM_NEW_OBJECTS;
+                                            NUM_NEW_OBJECTS,
+                                            // <FS> Skinning palette cache
+                                            SKIN_PALETTE_HITS,
+                                            SKIN_PALETTE_MATRICES_SAVED;
+                                            // </FS>
 
 extern LLTrace::CountStatHandle<LLUnit<F64, LLUnits::Kilotriangles> > TRIANGLES_DRAWN;
 
@@ -226,7 +230,8 @@ extern LLTrace::EventStatHandle<F64Milliseconds >   REGION_CROSSING_TIME,
                                                         NETWORK_STACKTIME,
                                                         IMAGE_STACKTIME,
                                                         REBUILD_STACKTIME,
-                                                        RENDER_STACKTIME;
+                                                        RENDER_STACKTIME,
+                                                        REGION_CACHE_LOAD_TIME; // <FS/> Asynchronous object cache loading
 
 extern LLTrace::EventStatHandle<F64Seconds >    AVATAR_EDIT_TIME,
                                                                 TOOLBOX_TIME,
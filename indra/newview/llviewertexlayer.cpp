@@ -171,6 +171,11 @@ void LLViewerTexLayerSetBuffer::preRenderTexLayerSet()
 {
     LLTexLayerSetBuffer::preRenderTexLayerSet();
 
+    // <FS> Async morph masks
+    static LLCachedControl<bool> async_morph_masks(gSavedSettings, "FSAsyncMorphMasks", true);
+    LLTexLayer::sAsyncMorphMasks = async_morph_masks;
+    // </FS>
+
     // keep depth buffer, we don't need to clear it
     LLViewerDynamicTexture::preRender(false);
 }
@@ -1260,6 +1260,7 @@ void LLViewerFetchedTexture::cleanup()
     destroyRawImage();
     mSavedRawImage = NULL;
     mSavedRawDiscardLevel = -1;
+    mCompressedImage = NULL; // <FS/> Compressed texture cache
 }
 
 //access the fast cache
@@ -1332,6 +1333,174 @@ void LLViewerFetchedTexture::loadFromFastCache()
     }
 }
 
+// <FS> Compressed texture cache
+bool LLViewerFetchedTexture::canUseCompressedCache() const
+{
+    static LLCachedControl<bool> compressed_cache(gSavedSettings, "FSTextureCompressedCache", true);
+
+    // Only plain server textures that nobody needs raw pixels of
+    return compressed_cache && LLImageGL::sCompressTextures
+        && mFTType == FTT_DEFAULT
+        && mBoostLevel < LLGLTexture::BOOST_HIGH && mBoostLevel != LLGLTexture::BOOST_TERRAIN
+        && !mForSculpt && !mNeedsAux && !mForceToSaveRawImage && !mSaveRawImage
+        && mLoadedCallbackList.empty()
+        && mGLTexturep.notNull() && mGLTexturep->getUseMipMaps() && !mGLTexturep->getHasExplicitFormat();
+}
+
+// Returns true while the compressed cache is being read for this texture
+bool LLViewerFetchedTexture::loadFromCompressedCache()
+{
+    if (mCompressedCacheState == COMPRESSED_CACHE_READING)
+    {
+        return true;
+    }
+    if (mCompressedCacheState == COMPRESSED_CACHE_CHECKED || !canUseCompressedCache())
+    {
+        return false;
+    }
+    mCompressedCacheState = COMPRESSED_CACHE_CHECKED;
+
+    LL::WorkQueue::ptr_t main_queue = mMainQueue.lock();
+    LL::WorkQueue::ptr_t general_queue = LL::WorkQueue::getInstance("General");
+    if (!main_queue || !general_queue)
+    {
+        return false;
+    }
+
+    LLUUID id = getID();
+    ref();
+    bool posted = main_queue->postTo(
+        general_queue,
+        [id]() // work done on general queue
+        {
+            S32 discard_level = -1;
+            LLPointer<LLImageDXT> image;
+            LLTextureCache* cache = LLAppViewer::getTextureCache();
+            if (cache)
+            {
+                image = cache->readFromCompressedCache(id, discard_level);
+            }
+            return std::make_pair(image, discard_level);
+        },
+        [this](std::pair<LLPointer<LLImageDXT>, S32> result) // callback to main thread
+        {
+            finishCompressedCacheRead(result.first, result.second);
+            unref();
+        });
+    if (!posted)
+    {
+        unref();
+        return false;
+    }
+
+    mCompressedCacheState = COMPRESSED_CACHE_READING;
+    return true;
+}
+
+// Lets the next fetch look at the compressed cache again, after the GL
+// texture was evicted or the texture is being reloaded
+void LLViewerFetchedTexture::resetCompressedCacheState()
+{
+    // A read in flight finishes on its own
+    if (mCompressedCacheState == COMPRESSED_CACHE_CHECKED)
+    {
+        mCompressedCacheState = COMPRESSED_CACHE_UNCHECKED;
+    }
+}
+
+void LLViewerFetchedTexture::finishCompressedCacheRead(LLPointer<LLImageDXT> image, S32 discard_level)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
+    mCompressedCacheState = COMPRESSED_CACHE_CHECKED;
+    if (image.isNull())
+    {
+        return; // not cached, fetch as usual
+    }
+    mCompressedDiscardLevel = discard_level;
+
+    // Something else may have loaded or claimed the texture meanwhile
+    if (mIsFetching || mNeedsCreateTexture || mIsMissingAsset || !canUseCompressedCache()
+        || (getDiscardLevel() >= 0 && getDiscardLevel() <= discard_level))
+    {
+        return;
+    }
+
+    S32 full_width = image->getWidth() << discard_level;
+    S32 full_height = image->getHeight() << discard_level;
+    if (full_width > MAX_IMAGE_SIZE || full_height > MAX_IMAGE_SIZE)
+    {
+        return;
+    }
+    mFullWidth = full_width;
+    mFullHeight = full_height;
+    setTexelsPerImage();
+
+    if (getComponents() != 3)
+    {
+        // Same as addToCreateTexture(): faces may need a different pool
+        mComponents = 3;
+        mGLTexturep->setComponents(mComponents);
+        for (U32 j = 0; j < LLRender::NUM_TEXTURE_CHANNELS; ++j)
+        {
+            for (U32 i = 0; i < mNumFaces[j]; i++)
+            {
+                mFaceList[j][i]->dirtyTexture();
+            }
+        }
+    }
+
+    mCompressedImage = image;
+    scheduleCreateTexture();
+}
+
+// Hands the freshly decoded raw image to a worker to be encoded, unless the
+// compressed cache already has this texture at the same or a better discard level
+void LLViewerFetchedTexture::saveToCompressedCache()
+{
+    // Smaller images decode fast enough that they aren't worth the disk space
+    constexpr S32 MIN_COMPRESSED_CACHE_DIMENSION = 64;
+
+    if (mRawImage.isNull() || mRawDiscardLevel < 0 || mRawDiscardLevel > MAX_DISCARD_LEVEL
+        || (mCompressedDiscardLevel >= 0 && mCompressedDiscardLevel <= mRawDiscardLevel)
+        || mRawImage->getWidth() < MIN_COMPRESSED_CACHE_DIMENSION
+        || mRawImage->getHeight() < MIN_COMPRESSED_CACHE_DIMENSION
+        || (mRawImage->getComponents() != 3 && mRawImage->getComponents() != 4)
+        || !canUseCompressedCache())
+    {
+        return;
+    }
+
+    LL::WorkQueue::ptr_t general_queue = LL::WorkQueue::getInstance("General");
+    if (!general_queue)
+    {
+        return;
+    }
+
+    LLUUID id = getID();
+    LLPointer<LLImageRaw> raw = mRawImage;
+    S32 discard_level = mRawDiscardLevel;
+    if (general_queue->post(
+        [id, raw, discard_level]() mutable
+        {
+            {
+                LLImageDataSharedLock lock(raw);
+                if (raw->checkHasTransparentPixels())
+                {
+                    return; // BC1 is only used for opaque textures
+                }
+            }
+            LLTextureCache* cache = LLAppViewer::getTextureCache();
+            if (cache)
+            {
+                cache->writeToCompressedCache(id, raw, discard_level);
+            }
+        }))
+    {
+        mCompressedDiscardLevel = discard_level;
+    }
+}
+// </FS>
+
 void LLViewerFetchedTexture::setForSculpt()
 {
     static const S32 MAX_INTERVAL = 8; //frames
@@ -1409,6 +1578,7 @@ void LLViewerFetchedTexture::destroyTexture()
     //LL_DEBUGS("Avatar") << mID << LL_ENDL;
     destroyGLTexture();
     mFullyLoaded = false;
+    resetCompressedCacheState(); // <FS/> Compressed texture cache
 }
 
 void LLViewerFetchedTexture::addToCreateTexture()
@@ -1471,6 +1641,14 @@ bool LLViewerFetchedTexture::preCreateTexture(S32 usename/*= 0*/)
     }
     mNeedsCreateTexture = false;
 
+    // <FS> Compressed texture cache
+    if (mCompressedImage.notNull())
+    {
+        // Sized and validated when it was read
+        return true;
+    }
+    // </FS>
+
     if (mRawImage.isNull())
     {
         LL_ERRS() << "LLViewerTexture trying to create texture with no Raw Image" << LL_ENDL;
@@ -1613,6 +1791,13 @@ bool LLViewerFetchedTexture::createTexture(S32 usename/*= 0*/)
         return false;
     }
 
+    // <FS> Compressed texture cache
+    if (mCompressedImage.notNull())
+    {
+        return mGLTexturep->createGLTextureCompressed(mCompressedDiscardLevel, mCompressedImage, usename, mBoostLevel);
+    }
+    // </FS>
+
     bool res = mGLTexturep->createGLTexture(mRawDiscardLevel, mRawImage, usename, true, mBoostLevel);
 
     return res;
@@ -1646,6 +1831,16 @@ void LLViewerFetchedTexture::postCreateTexture()
     {
         mNeedsAux = false;
     }
+    // <FS> Compressed texture cache
+    if (mCompressedImage.notNull())
+    {
+        mCompressedImage = NULL;
+    }
+    else
+    {
+        saveToCompressedCache();
+    }
+    // </FS>
     destroyRawImage(); // will save raw image if needed
 
     mNeedsCreateTexture = false;
@@ -2191,6 +2386,13 @@ bool LLViewerFetchedTexture::updateFetch()
     if (make_request)
     {
         LL_PROFILE_ZONE_NAMED_CATEGORY_TEXTURE("vftuf - make request");
+        // <FS> Compressed texture cache
+        // An encoded copy from an earlier visit skips the fetch and the decode
+        if (!mIsFetching && loadFromCompressedCache())
+        {
+            return false;
+        }
+        // </FS>
         S32 w=0, h=0, c=0;
         if (getDiscardLevel() >= 0)
         {
@@ -2212,8 +2414,12 @@ bool LLViewerFetchedTexture::updateFetch()
         // bypass texturefetch directly by pulling from LLTextureCache
         S32 fetch_request_response = -1;
         S32 worker_discard = -1;
+        // <FS> Progressive texture fetch
+        //fetch_request_response = LLAppViewer::getTextureFetch()->createRequest(mFTType, mUrl, getID(), getTargetHost(), decode_priority,
+        //                                                                      w, h, c, desired_discard, needsAux(), mCanUseHTTP);
         fetch_request_response = LLAppViewer::getTextureFetch()->createRequest(mFTType, mUrl, getID(), getTargetHost(), decode_priority,
-                                                                              w, h, c, desired_discard, needsAux(), mCanUseHTTP);
+                                                                              w, h, c, desired_discard, needsAux(), mCanUseHTTP, current_discard);
+        // </FS>
 
         if (fetch_request_response >= 0) // positive values and 0 are discard values
         {
@@ -2290,6 +2496,11 @@ void LLViewerFetchedTexture::clearFetchedResults()
 
     cleanup();
     destroyGLTexture();
+    // <FS> Compressed texture cache
+    // A refresh may have removed the cached copies as well
+    resetCompressedCacheState();
+    mCompressedDiscardLevel = -1;
+    // </FS>
 
     if(getDiscardLevel() >= 0) //sculpty texture, force to invalidate
     {
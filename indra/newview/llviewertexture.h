@@ -29,6 +29,7 @@
 
 #include "llatomic.h"
 #include "llgltexture.h"
+#include "llimagedxt.h" // <FS/> Compressed texture cache
 #include "lltimer.h"
 #include "llframetimer.h"
 #include "llhost.h"
@@ -436,6 +437,9 @@ public:
     void        loadFromFastCache();
     void        setInFastCacheList(bool in_list) { mInFastCacheList = in_list; }
     bool        isInFastCacheList() { return mInFastCacheList; }
+    // <FS> Compressed texture cache
+    bool        canUseCompressedCache() const;
+    // </FS>
 
     // <FS:minerjr> [FIRE-35081] Blurry prims not changing with graphics settings
     F32         getCloseToCamera() const {return mCloseToCamera ;} // Get close to camera value
@@ -466,6 +470,13 @@ private:
 
     void saveRawImage() ;
 
+    // <FS> Compressed texture cache
+    bool loadFromCompressedCache();
+    void finishCompressedCacheRead(LLPointer<LLImageDXT> image, S32 discard_level);
+    void resetCompressedCacheState();
+    void saveToCompressedCache();
+    // </FS>
+
 private:
     bool  mFullyLoaded;
     bool  mInFastCacheList;
@@ -516,6 +527,20 @@ protected:
     LLPointer<LLImageRaw> mRawImage;
     S32 mRawDiscardLevel = -1;
 
+    // <FS> Compressed texture cache
+    enum ECompressedCacheState : U8
+    {
+        COMPRESSED_CACHE_UNCHECKED,
+        COMPRESSED_CACHE_READING,
+        COMPRESSED_CACHE_CHECKED
+    };
+    ECompressedCacheState mCompressedCacheState = COMPRESSED_CACHE_UNCHECKED;
+    // Uploaded instead of mRawImage when set
+    LLPointer<LLImageDXT> mCompressedImage;
+    // Best discard level known to be in the compressed cache, -1 if none
+    S32 mCompressedDiscardLevel = -1;
+    // </FS>
+
     // Used ONLY for cloth meshes right now.  Make SURE you know what you're
     // doing if you use it for anything else! - djs
     LLPointer<LLImageRaw> mAuxRawImage;
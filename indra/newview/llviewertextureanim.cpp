@@ -31,6 +31,7 @@
 
 #include "llmath.h"
 #include "llerror.h"
+#include "workqueue.h" // <FS/> Parallel texture animation
 
 std::vector<LLViewerTextureAnim*> LLViewerTextureAnim::sInstanceList;
 
@@ -42,6 +43,7 @@ LLViewerTextureAnim::LLViewerTextureAnim(LLVOVolume* vobj) : LLTextureAnim()
     mOffS = mOffT = 0;
     mScaleS = mScaleT = 1;
     mRot = 0;
+    mPendingResult = 0; // <FS/> Parallel texture animation
 
     mInstanceIndex = static_cast<S32>(sInstanceList.size());
     sInstanceList.push_back(this);
@@ -69,10 +71,40 @@ void LLViewerTextureAnim::reset()
 //static
 void LLViewerTextureAnim::updateClass()
 {
-    for (std::vector<LLViewerTextureAnim*>::iterator iter = sInstanceList.begin(); iter != sInstanceList.end(); ++iter)
+    LL_PROFILE_ZONE_SCOPED;
+
+    // <FS> Parallel texture animation
     {
-        (*iter)->mVObj->animateTextures();
+        LL_PROFILE_ZONE_NAMED("texture anim compute");
+        constexpr U32 INSTANCES_PER_JOB = 64;
+        const U32 count = (U32)sInstanceList.size();
+        auto compute = [count](U32 job)
+        {
+            const U32 end = llmin(count, (job + 1) * INSTANCES_PER_JOB);
+            for (U32 i = job * INSTANCES_PER_JOB; i < end; ++i)
+            {
+                sInstanceList[i]->mVObj->computeTextureAnimation();
+            }
+        };
+        const U32 jobs = (count + INSTANCES_PER_JOB - 1) / INSTANCES_PER_JOB;
+        if (jobs > 1)
+        {
+            LL::run_parallel("General", jobs, compute);
+        }
+        else if (jobs)
+        {
+            compute(0);
+        }
+    }
+
+    {
+        LL_PROFILE_ZONE_NAMED("texture anim commit");
+        for (std::vector<LLViewerTextureAnim*>::iterator iter = sInstanceList.begin(); iter != sInstanceList.end(); ++iter)
+        {
+            (*iter)->mVObj->applyTextureAnimation();
+        }
     }
+    // </FS>
 }
 
 S32 LLViewerTextureAnim::animateTextures(F32 &off_s, F32 &off_t,
@@ -29,6 +29,7 @@
 
 #include "lltextureanim.h"
 #include "llframetimer.h"
+#include "m4math.h"
 
 class LLVOVolume;
 
@@ -58,6 +59,13 @@ public:
     F32 mScaleT;
     F32 mRot;
 
+    // <FS> Parallel texture animation
+    // What LLVOVolume::computeTextureAnimation() left for applyTextureAnimation():
+    // the animateTextures() result and the texture matrix for each face
+    S32 mPendingResult;
+    std::vector<std::pair<S32, LLMatrix4> > mPendingMatrices;
+    // </FS>
+
 protected:
     LLVOVolume* mVObj;
     LLFrameTimer mTimer;
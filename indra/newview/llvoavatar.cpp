@@ -119,6 +119,7 @@
 #include "llskinningutil.h"
 
 #include "llperfstats.h"
+#include "threadpool.h" // <FS/> Parallel avatar animation
 
 #include <boost/lexical_cast.hpp>
 
@@ -656,6 +657,11 @@ F32 LLVOAvatar::sGreyUpdateTime = 0.f;
 LLPointer<LLViewerTexture> LLVOAvatar::sCloudTexture = NULL;
 std::vector<LLUUID> LLVOAvatar::sAVsIgnoringARTLimit;
 S32 LLVOAvatar::sAvatarsNearby = 0;
+// <FS> Parallel avatar animation
+LL::ThreadPool* LLVOAvatar::sMotionThreadPool = nullptr;
+std::vector<LLPointer<LLVOAvatar> > LLVOAvatar::sMotionBatch;
+bool LLVOAvatar::sMotionBatchOpen = false;
+// </FS>
 
 //-----------------------------------------------------------------------------
 // Helper functions
@@ -1287,11 +1293,29 @@ void LLVOAvatar::initClass()
     sCloudTexture = LLViewerTextureManager::getFetchedTextureFromFile("cloud-particle.j2c");
 
     initCloud();
+
+    // <FS> Parallel avatar animation
+    if (!sMotionThreadPool)
+    {
+        // The main thread takes a share of each batch as well
+        S32 cores = (S32)std::thread::hardware_concurrency();
+        sMotionThreadPool = new LL::ThreadPool("AvatarMotion", llclamp(cores - 2, 1, 8));
+        sMotionThreadPool->start();
+    }
+    // </FS>
 }
 
 
 void LLVOAvatar::cleanupClass()
 {
+    // <FS> Parallel avatar animation
+    if (sMotionThreadPool)
+    {
+        sMotionThreadPool->close();
+        delete sMotionThreadPool;
+        sMotionThreadPool = nullptr;
+    }
+    // </FS>
 }
 
 LLPartSysData LLVOAvatar::sCloud;
@@ -2481,6 +2505,14 @@ void LLVOAvatar::buildCharacter()
 {
     LLAvatarAppearance::buildCharacter();
 
+    // <FS> Flattened joint hierarchy
+    static LLCachedControl<bool> flat_skeleton(gSavedSettings, "FSFlatSkeletonUpdate", true);
+    if (mRoot)
+    {
+        mRoot->setFlatHierarchy(flat_skeleton);
+    }
+    // </FS>
+
     // Not done building yet; more to do.
     mIsBuilt = false;
 
@@ -3216,6 +3248,22 @@ void LLVOAvatar::idleUpdate(LLAgent &agent, const F64 &time)
     mLastRootPos = mRoot->getWorldPosition();
     bool detailed_update = updateCharacter(agent);
 
+    // <FS> Parallel avatar animation
+    if (mMotionUpdateQueued)
+    {
+        // Finished in endMotionBatch()
+        return;
+    }
+    idleUpdateFinish(detailed_update);
+}
+
+//------------------------------------------------------------------------
+// idleUpdateFinish()
+// The part of idleUpdate() that needs the animated skeleton.
+//------------------------------------------------------------------------
+void LLVOAvatar::idleUpdateFinish(bool detailed_update)
+{
+    // </FS>
     static LLUICachedControl<bool> visualizers_in_calls("ShowVoiceVisualizersInCalls", false);
     bool voice_enabled = (visualizers_in_calls || LLVoiceClient::getInstance()->inProximalChannel()) &&
                          LLVoiceClient::getInstance()->getVoiceEnabled(mID);
@@ -5765,20 +5813,56 @@ bool LLVOAvatar::updateCharacter(LLAgent &agent)
     mSpeed = speed;
 
     // update animations
+    // <FS> Parallel avatar animation
+    //if (!visible && !isSelf()) // NOTE: never do a "hidden update" for self avatar as it interrupts controller processing
+    //{
+    //    updateMotions(LLCharacter::HIDDEN_UPDATE);
+    //}
+    //else if (mSpecialRenderMode == 1) // Animation Preview
+    //{
+    //    updateMotions(LLCharacter::FORCE_UPDATE);
+    //}
+    //else
+    //{
+    //    // Might be better to do HIDDEN_UPDATE if cloud
+    //    updateMotions(LLCharacter::NORMAL_UPDATE);
+    //}
+    LLCharacter::e_update_t update_type = LLCharacter::NORMAL_UPDATE; // Might be better to do HIDDEN_UPDATE if cloud
     if (!visible && !isSelf()) // NOTE: never do a "hidden update" for self avatar as it interrupts controller processing
     {
-        updateMotions(LLCharacter::HIDDEN_UPDATE);
+        update_type = LLCharacter::HIDDEN_UPDATE;
     }
     else if (mSpecialRenderMode == 1) // Animation Preview
     {
-        updateMotions(LLCharacter::FORCE_UPDATE);
+        update_type = LLCharacter::FORCE_UPDATE;
     }
-    else
+
+    // Hidden updates are cheap, keep them out of the batch
+    if (sMotionBatchOpen && update_type != LLCharacter::HIDDEN_UPDATE && canBatchMotions())
     {
-        // Might be better to do HIDDEN_UPDATE if cloud
-        updateMotions(LLCharacter::NORMAL_UPDATE);
+        mBatchedUpdateType = update_type;
+        mBatchedSitGroundConstrained = was_sit_ground_constrained;
+        mBatchedVisible = visible;
+        mMotionUpdateQueued = true;
+        sMotionBatch.push_back(this);
+        return visible;
     }
 
+    updateMotions(update_type);
+    updateCharacterSkeleton(was_sit_ground_constrained);
+    finishCharacterUpdate(visible);
+
+    return visible;
+}
+
+//------------------------------------------------------------------------
+// updateCharacterSkeleton()
+// The part of updateCharacter() after the motion update that only touches
+// this avatar. Runs on an AvatarMotion worker for batched avatars.
+//------------------------------------------------------------------------
+void LLVOAvatar::updateCharacterSkeleton(bool was_sit_ground_constrained)
+{
+    // </FS>
     // Special handling for sitting on ground.
     if (!getParent() && (isSitting() || was_sit_ground_constrained))
     {
@@ -5794,23 +5878,138 @@ bool LLVOAvatar::updateCharacter(LLAgent &agent)
         }
     }
 
+    // <FS> Parallel avatar animation
+    // Moved to finishCharacterUpdate(), the joint positions they read are
+    // updated lazily so the order does not matter.
+    //// update head position
+    //updateHeadOffset();
+    //
+    //// Generate footstep sounds when feet hit the ground
+    //updateFootstepSounds();
+    // </FS>
+
+    // Update child joints as needed.
+    mRoot->updateWorldMatrixChildren();
+    ++mSkeletonUpdateCount; // <FS/> Skinning palette cache
+    // <FS> Parallel avatar animation
+    //if (visible)
+    //{
+    //    // System avatar mesh vertices need to be reskinned.
+    //    mNeedsSkin = true;
+    //}
+    //
+    //return visible;
+}
+
+//------------------------------------------------------------------------
+// finishCharacterUpdate()
+// The end of updateCharacter(), on the main thread.
+//------------------------------------------------------------------------
+void LLVOAvatar::finishCharacterUpdate(bool visible)
+{
     // update head position
     updateHeadOffset();
 
     // Generate footstep sounds when feet hit the ground
     updateFootstepSounds();
 
-    // Update child joints as needed.
-    mRoot->updateWorldMatrixChildren();
-
     if (visible)
     {
         // System avatar mesh vertices need to be reskinned.
         mNeedsSkin = true;
     }
+}
+
+//------------------------------------------------------------------------
+// canBatchMotions()
+// Whether the motions can be evaluated alongside other avatars. The own
+// avatar talks to the simulator and the agent from its motions and animesh
+// attachments follow the skeleton of the avatar wearing them, so both keep
+// the serial update.
+//------------------------------------------------------------------------
+bool LLVOAvatar::canBatchMotions()
+{
+    return !isSelf() && !isUIAvatar() && !getAttachedAvatar();
+}
+
+//------------------------------------------------------------------------
+// beginMotionBatch()
+//------------------------------------------------------------------------
+// static
+void LLVOAvatar::beginMotionBatch()
+{
+    static LLCachedControl<bool> parallel_motion(gSavedSettings, "FSParallelAvatarMotion");
+    sMotionBatchOpen = parallel_motion && sMotionThreadPool;
+}
+
+//------------------------------------------------------------------------
+// endMotionBatch()
+// Evaluates the motions of all queued avatars, spread over the AvatarMotion
+// pool and the main thread, then finishes their idle updates in the order
+// they were queued.
+//------------------------------------------------------------------------
+// static
+void LLVOAvatar::endMotionBatch()
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
+    sMotionBatchOpen = false;
+    if (sMotionBatch.empty())
+    {
+        return;
+    }
 
-    return visible;
+    std::vector<std::pair<LLVOAvatar*, bool> > avatars; // avatar, motions prepared
+    avatars.reserve(sMotionBatch.size());
+
+    // Serial phase: advance the clocks and activate motions that finished
+    // loading. Activation may fetch assets and start emotes.
+    for (LLVOAvatar* avatarp : sMotionBatch)
+    {
+        if (avatarp->isDead())
+        {
+            avatarp->mMotionUpdateQueued = false;
+            continue;
+        }
+        avatars.emplace_back(avatarp, avatarp->prepareMotions());
+    }
+
+    // Parallel phase: keyframe sampling, blending and the joint matrices.
+    // Anything a motion does that reaches beyond its own avatar is queued
+    // for the serial phase below.
+    LL::run_parallel("AvatarMotion", (U32)avatars.size(), [&avatars](U32 index)
+    {
+        LL_PROFILE_ZONE_NAMED_CATEGORY_AVATAR("evaluate batched motions");
+        auto& [avatarp, prepared] = avatars[index];
+        avatarp->mDeferVisualParams = true;
+        if (prepared)
+        {
+            avatarp->evaluateMotions(avatarp->mBatchedUpdateType);
+        }
+        avatarp->updateCharacterSkeleton(avatarp->mBatchedSitGroundConstrained);
+        avatarp->mDeferVisualParams = false;
+    });
+
+    // Serial phase: stop requests, deactivations and visual parameter
+    // updates queued by the motions, then the rest of the idle update.
+    for (auto& [avatarp, prepared] : avatars)
+    {
+        avatarp->mMotionUpdateQueued = false;
+        if (avatarp->isDead())
+        {
+            continue;
+        }
+        avatarp->flushDeferredMotions();
+        if (avatarp->mVisualParamsDeferred)
+        {
+            avatarp->mVisualParamsDeferred = false;
+            avatarp->updateVisualParams();
+        }
+        avatarp->finishCharacterUpdate(avatarp->mBatchedVisible);
+        avatarp->idleUpdateFinish(avatarp->mBatchedVisible);
+    }
+    sMotionBatch.clear();
 }
+// </FS>
 
 //-----------------------------------------------------------------------------
 // updateHeadOffset()
@@ -8207,6 +8406,15 @@ void LLVOAvatar::initAttachmentPoints(bool ignore_hud_joints)
 //-----------------------------------------------------------------------------
 void LLVOAvatar::updateVisualParams()
 {
+    // <FS> Parallel avatar animation
+    if (mDeferVisualParams)
+    {
+        // Called by a motion on an AvatarMotion worker
+        mVisualParamsDeferred = true;
+        return;
+    }
+    // </FS>
+
     ESex avatar_sex = (getVisualParamWeight("male") > 0.5f) ? SEX_MALE : SEX_FEMALE;
     if (getSex() != avatar_sex)
     {
@@ -11265,11 +11473,15 @@ const LLVOAvatar::MatrixPaletteCache& LLVOAvatar::updateSkinInfoMatrixPalette(co
     U64 hash = skin->mHash;
     MatrixPaletteCache& entry = mMatrixPaletteCache[hash];
 
-    if (entry.mFrame != gFrameCount)
+    // <FS> Skinning palette cache
+    //if (entry.mFrame != gFrameCount)
+    if (entry.mFrame != gFrameCount || entry.mSkeletonUpdate != mSkeletonUpdateCount)
+    // </FS>
     {
         LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
 
         entry.mFrame = gFrameCount;
+        entry.mSkeletonUpdate = mSkeletonUpdateCount; // <FS/> Skinning palette cache
 
         //build matrix palette
         U32 count = LLSkinningUtil::getMeshJointCount(skin);
@@ -11304,6 +11516,15 @@ const LLVOAvatar::MatrixPaletteCache& LLVOAvatar::updateSkinInfoMatrixPalette(co
             mp[idx + 11] = m[14];
         }
     }
+    // <FS> Skinning palette cache
+    else
+    {
+        // another rigged mesh with the same joints and inverse bind matrices
+        // already built this palette for this skeleton pose
+        LLTrace::add(LLStatViewer::SKIN_PALETTE_HITS, 1);
+        LLTrace::add(LLStatViewer::SKIN_PALETTE_MATRICES_SAVED, (F64)entry.mMatrixPalette.size());
+    }
+    // </FS>
 
     return entry;
 }
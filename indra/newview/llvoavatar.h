@@ -54,6 +54,7 @@
 #include "llvovolume.h"
 #include "llavatarrendernotifier.h"
 #include "llmodel.h"
+#include "threadpool_fwd.h" // <FS/> Parallel avatar animation
 
 extern const LLUUID ANIM_AGENT_BODY_NOISE;
 extern const LLUUID ANIM_AGENT_BREATHE_ROT;
@@ -283,6 +284,31 @@ public:
     void            updateTimeStep();
     void            updateRootPositionAndRotation(LLAgent &agent, F32 speed, bool was_sit_ground_constrained);
 
+    // <FS> Parallel avatar animation
+    // LLViewerObjectList::update() opens a batch around the idle updates.
+    // Visible avatars queue themselves from updateCharacter(), their motions
+    // are evaluated on the AvatarMotion pool when the batch is closed and the
+    // rest of their idle update follows on the main thread.
+    static void     beginMotionBatch();
+    static void     endMotionBatch();
+protected:
+    bool            canBatchMotions();
+    void            updateCharacterSkeleton(bool was_sit_ground_constrained);
+    void            finishCharacterUpdate(bool visible);
+    void            idleUpdateFinish(bool detailed_update);
+private:
+    LLCharacter::e_update_t mBatchedUpdateType = LLCharacter::NORMAL_UPDATE;
+    bool            mBatchedSitGroundConstrained = false;
+    bool            mBatchedVisible = false;
+    bool            mMotionUpdateQueued = false;
+    bool            mDeferVisualParams = false; // set while a worker evaluates the motions
+    bool            mVisualParamsDeferred = false;
+    static LL::ThreadPool* sMotionThreadPool;
+    static std::vector<LLPointer<LLVOAvatar> > sMotionBatch;
+    static bool     sMotionBatchOpen;
+public:
+    // </FS>
+
     void            idleUpdateVoiceVisualizer(bool voice_enabled, const LLVector3 &position);
     void            idleUpdateMisc(bool detailed_update);
     virtual void    idleUpdateAppearanceAnimation();
@@ -862,6 +888,11 @@ public:
         // Last frame this entry was updated
         U32 mFrame;
 
+        // <FS> Skinning palette cache
+        // Skeleton update the entry was built from, see mSkeletonUpdateCount
+        U32 mSkeletonUpdate = 0;
+        // </FS>
+
         // List of Matrix4a's for this entry
         LLMeshSkinInfo::matrix_list_t mMatrixPalette;
 
@@ -883,6 +914,13 @@ public:
     typedef std::unordered_map<U64, MatrixPaletteCache> matrix_palette_cache_t;
     matrix_palette_cache_t mMatrixPaletteCache;
 
+    // <FS> Skinning palette cache
+    // Bumped each time the skeleton's world matrices are updated, so palettes
+    // built earlier in the frame (a pick before the animation update, say)
+    // are rebuilt rather than served stale
+    U32 mSkeletonUpdateCount = 0;
+    // </FS>
+
 protected:
     void            releaseMeshData();
     virtual void restoreMeshData();
@@ -33,6 +33,8 @@
 #include "llviewerregion.h"
 #include "llagentcamera.h"
 #include "llsdserialize.h"
+#include "llmemorystream.h" // <FS/> Binary extras cache
+#include "workqueue.h" // <FS/> Asynchronous object cache loading
 #include "llagent.h" // <FS:Beq/> For gAgent
 #include "llworld.h" // For LLWorld::getInstance()
 
@@ -59,7 +61,49 @@ bool check_write(LLAPRFile* apr_file, void* src, S32 n_bytes)
 
 // Material Override Cache needs a version label, so we can upgrade this later.
 const std::string LLGLTFOverrideCacheEntry::VERSION_LABEL = {"GLTFCacheVer"};
-const int LLGLTFOverrideCacheEntry::VERSION = 1;
+// <FS> Binary extras cache
+//const int LLGLTFOverrideCacheEntry::VERSION = 1;
+const int LLGLTFOverrideCacheEntry::VERSION = 2;
+// Text files starting with VERSION_LABEL and holding one LLSD XML document
+// per entry. Still read so existing caches are migrated on the next write.
+const int LLGLTFOverrideCacheEntry::LEGACY_XML_VERSION = 1;
+
+namespace
+{
+    // Binary extras cache layout:
+    //   ExtrasCacheHeader
+    //   per entry: ExtrasCacheRecord, then per side an ExtrasCacheSide
+    //              followed by mSize bytes of binary LLSD override
+    // mChecksum is the CRC of everything following the header.
+    constexpr U32 EXTRAS_CACHE_MAGIC = 0x43454C53; // "SLEC"
+
+    struct ExtrasCacheHeader
+    {
+        U32 mMagic;
+        U32 mVersion;
+        U8  mRegionID[UUID_BYTES];
+        U32 mNumEntries;
+        U32 mPayloadSize;
+        U32 mChecksum;
+    };
+    static_assert(sizeof(ExtrasCacheHeader) == 36, "Extras cache header layout changed, bump LLGLTFOverrideCacheEntry::VERSION");
+
+    struct ExtrasCacheRecord
+    {
+        U32 mLocalId;
+        U8  mObjectId[UUID_BYTES];
+        U32 mNumSides;
+    };
+    static_assert(sizeof(ExtrasCacheRecord) == 24, "Extras cache record layout changed, bump LLGLTFOverrideCacheEntry::VERSION");
+
+    struct ExtrasCacheSide
+    {
+        S32 mSide;
+        U32 mSize;
+    };
+    static_assert(sizeof(ExtrasCacheSide) == 8, "Extras cache side layout changed, bump LLGLTFOverrideCacheEntry::VERSION");
+}
+// </FS>
 
 bool LLGLTFOverrideCacheEntry::fromLLSD(const LLSD& data)
 {
@@ -104,11 +148,7 @@ bool LLGLTFOverrideCacheEntry::fromLLSD(const LLSD& data)
         {
             for (int i = 0; i < sides.size(); ++i)
             {
-                S32 side_idx = sides[i].asInteger();
-                mSides[side_idx] = gltf_llsd[i];
-                LLGLTFMaterial* override_mat = new LLGLTFMaterial();
-                override_mat->applyOverrideLLSD(gltf_llsd[i]);
-                mGLTFMaterial[side_idx] = override_mat;
+                addSide(sides[i].asInteger(), gltf_llsd[i]); // <FS/> Binary extras cache
             }
         }
         else
@@ -153,6 +193,16 @@ LLSD LLGLTFOverrideCacheEntry::toLLSD() const
     return data;
 }
 
+// <FS> Binary extras cache
+void LLGLTFOverrideCacheEntry::addSide(S32 side_idx, const LLSD& override_llsd)
+{
+    mSides[side_idx] = override_llsd;
+    LLGLTFMaterial* override_mat = new LLGLTFMaterial();
+    override_mat->applyOverrideLLSD(override_llsd);
+    mGLTFMaterial[side_idx] = override_mat;
+}
+// </FS>
+
 //---------------------------------------------------------------------------
 // LLVOCacheEntry
 //---------------------------------------------------------------------------
@@ -206,7 +256,7 @@ LLVOCacheEntry::LLVOCacheEntry(LLAPRFile* apr_file)
 {
     S32 size = -1;
     bool success;
-    static U8 data_buffer[ENTRY_HEADER_SIZE];
+    U8 data_buffer[ENTRY_HEADER_SIZE]; // <FS/> Asynchronous object cache loading, entries are read on worker threads
 
     mDP.assignBuffer(mBuffer, 0);
 
@@ -1568,14 +1618,33 @@ bool LLVOCache::readFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::voca
         return false; // arguably no a problem, but we'll mark this as dirty anyway.
     }
 
+    // <FS> Asynchronous object cache loading
+    std::string filename;
+    getObjectCacheFilename(handle, filename);
+    bool success = readObjectCacheFile(filename, id, cache_entry_map, mLocalAPRFilePoolp);
+    // </FS>
+
+    if(!success)
+    {
+        if(cache_entry_map.empty())
+        {
+            removeEntry(iter->second) ;
+        }
+    }
+
+    return success;
+}
+
+// <FS> Asynchronous object cache loading
+// static
+bool LLVOCache::readObjectCacheFile(const std::string& filename, const LLUUID& id, LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, LLVolatileAPRPool* pool)
+{
+	LL_PROFILE_ZONE_NAMED_CATEGORY_NETWORK("VOCache:loadRegionObjectCache");
     bool success = true ;
-    S32 num_entries = 0 ; // lifted out of inner loop.
-    std::string filename; // lifted out of loop
+    S32 num_entries = 0 ;
     {
-		LL_PROFILE_ZONE_NAMED_CATEGORY_NETWORK("VOCache:loadRegionObjectCache");        
         LLUUID cache_id;
-        getObjectCacheFilename(handle, filename);
-        LLAPRFile apr_file(filename, APR_READ|APR_BINARY, mLocalAPRFilePoolp);
+        LLAPRFile apr_file(filename, APR_READ|APR_BINARY, pool);
 
         success = check_read(&apr_file, cache_id.mData, UUID_BYTES);
 
@@ -1610,24 +1679,88 @@ bool LLVOCache::readFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::voca
         }
     }
 
-    if(!success)
+    LL_DEBUGS("GLTF", "VOCache") << "Read " << cache_entry_map.size() << " entries from object cache " << filename << ", expected " << num_entries << ", success=" << (success?"True":"False") << LL_ENDL;
+    return success;
+}
+
+void LLVOCache::readFromCacheAsync(U64 handle, const LLUUID& id, region_cache_load_callback_t callback)
+{
+	LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
+    region_cache_load_ptr_t load = std::make_shared<RegionCacheLoad>();
+    if(!mEnabled)
     {
-        if(cache_entry_map.empty())
+        LL_WARNS() << "Not reading cache for handle " << handle << "): Cache is currently disabled." << LL_ENDL;
+        callback(load); // no problem we're just read only
+        return;
+    }
+    llassert_always(mInitialized);
+
+    if(mHandleEntryMap.find(handle) == mHandleEntryMap.end()) //no cache
+    {
+        LL_WARNS() << "No handle map entry for " << handle << LL_ENDL;
+        load->mSuccess = false; // arguably no a problem, but we'll mark this as dirty anyway.
+        callback(load);
+        return;
+    }
+
+    std::string filename;
+    getObjectCacheFilename(handle, filename);
+    const std::string extras_filename = getObjectCacheExtrasFilename(handle);
+
+    // Everything in here only touches the files and the load itself, never
+    // the cache header, which is main thread only.
+    auto read = [handle, id, filename, extras_filename, load]()
+    {
+        LL_PROFILE_ZONE_NAMED_CATEGORY_NETWORK("VOCache:readRegionAsync");
+        // A null pool picks the thread-safe global one
+        load->mSuccess = readObjectCacheFile(filename, id, load->mEntries, nullptr);
+        load->mExtrasSuccess = readExtrasFile(extras_filename, handle, id, load->mEntries, load->mExtras);
+    };
+
+    auto done = [handle, load, callback]()
+    {
+        if (LLVOCache::instanceExists())
         {
-            removeEntry(iter->second) ;
+            LLVOCache::instance().finishAsyncRead(handle, *load);
         }
+        callback(load);
+    };
+
+    LL::WorkQueue::ptr_t main_queue = LL::WorkQueue::getInstance("mainloop");
+    LL::WorkQueue::ptr_t general_queue = LL::WorkQueue::getInstance("General");
+    if (!main_queue || !general_queue ||
+        !main_queue->postTo(general_queue, read, done))
+    {
+        // No worker available (shutting down), do it inline
+        read();
+        done();
     }
+}
 
-    LL_DEBUGS("GLTF", "VOCache") << "Read " << cache_entry_map.size() << " entries from object cache " << filename << ", expected " << num_entries << ", success=" << (success?"True":"False") << LL_ENDL;
-    return success;
+void LLVOCache::finishAsyncRead(U64 handle, const RegionCacheLoad& load)
+{
+    if (!mEnabled || mHandleEntryMap.find(handle) == mHandleEntryMap.end())
+    {
+        // Purged while the files were being read
+        return;
+    }
+
+    if (!load.mExtrasSuccess)
+    {
+        // Takes the object cache along, same as the synchronous path
+        removeGenericExtrasForHandle(handle);
+    }
+    else if (!load.mSuccess && load.mEntries.empty())
+    {
+        removeEntry(handle);
+    }
 }
+// </FS>
 
 // We now pass in the cache entry map, so that we can remove entries from extras that are no longer in the primary cache.
 void LLVOCache::readGenericExtrasFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::vocache_gltf_overrides_map_t& cache_extras_entry_map, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map)
 {
 	LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
-    int loaded= 0;
-    int discarded = 0;
     // get ViewerRegion pointer from handle
     LLViewerRegion* pRegion = LLWorld::getInstance()->getRegionFromHandle(handle);
     if(!mEnabled)
@@ -1652,16 +1785,204 @@ void LLVOCache::readGenericExtrasFromCache(U64 handle, const LLUUID& id, LLVOCac
 	LL_PROFILE_ZONE_TEXT(extra_filename,256);
 	#endif
     // </FS:Beq>
-    llifstream in(filename, std::ios::in | std::ios::binary);
+
+    // <FS> Asynchronous object cache loading
+    LLTimer load_timer;
+    extras_entry_list_t entries;
+    if (!readExtrasFile(filename, handle, id, cache_entry_map, entries))
+    {
+        // Entries read before the failure are still good, only the file goes
+        removeGenericExtrasForHandle(handle);
+    }
+
+    for (LLGLTFOverrideCacheEntry& entry : entries)
+    {
+        const U32 local_id = entry.mLocalId;
+        // attempt to backfill a null objectId, though these shouldn't be in the persisted cache really
+        if(entry.mObjectId.isNull() && pRegion)
+        {
+            gObjectList.getUUIDFromLocal( entry.mObjectId, local_id, pRegion->getHost().getAddress(), pRegion->getHost().getPort() );
+        }
+        cache_extras_entry_map[local_id] = std::move(entry);
+    }
+    LL_DEBUGS("GLTF") << "Completed reading extras cache for handle " << handle << ", " << entries.size() << " loaded in "
+                      << load_timer.getElapsedTimeF32() * 1000.f << " ms" << LL_ENDL;
+    // </FS>
+}
+
+// <FS> Asynchronous object cache loading
+// static
+bool LLVOCache::readExtrasFile(const std::string& filename, U64 handle, const LLUUID& id,
+                               const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, extras_entry_list_t& entries)
+{
+	LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
+    // Binary extras cache: read the whole file in one go, both formats are
+    // parsed from memory.
+    std::vector<U8> data;
+    {
+        llifstream in(filename, std::ios::in | std::ios::binary | std::ios::ate);
+        const std::streamoff file_size = in.good() ? (std::streamoff)in.tellg() : 0;
+        if (file_size > 0)
+        {
+            data.resize((size_t)file_size);
+            in.seekg(0);
+            in.read(reinterpret_cast<char*>(data.data()), file_size);
+            if (!in)
+            {
+                data.clear();
+            }
+        }
+    }
+
+    if (data.empty())
+    {
+        LL_WARNS() << "Failed reading extras cache for handle " << handle << LL_ENDL;
+        return false;
+    }
+
+    U32 magic = 0;
+    if (data.size() >= sizeof(magic))
+    {
+        memcpy(&magic, data.data(), sizeof(magic));
+    }
+    const bool binary = (magic == EXTRAS_CACHE_MAGIC);
+
+    extras_entry_list_t read_entries;
+    const bool success = binary ? readBinaryExtras(data, handle, id, read_entries) : readLegacyExtras(data, handle, id, read_entries);
+
+    // only keep entries that exist in the primary cache
+    // this is a self-healing test that avoids us polluting the cache with entries that are no longer valid based on the main cache.
+    U32 discarded = 0;
+    entries.reserve(entries.size() + read_entries.size());
+    for (LLGLTFOverrideCacheEntry& entry : read_entries)
+    {
+        if (cache_entry_map.find(entry.mLocalId) != cache_entry_map.end())
+        {
+            entries.push_back(std::move(entry));
+        }
+        else
+        {
+            discarded++;
+        }
+    }
+
+    LL_DEBUGS("GLTF") << "Read " << (binary ? "binary" : "legacy") << " extras cache for handle " << handle << ", "
+                      << entries.size() << " kept, " << discarded << " discarded, " << data.size() << " bytes" << LL_ENDL;
+    return success;
+}
+// </FS>
+
+// <FS> Binary extras cache
+// static
+bool LLVOCache::readBinaryExtras(const std::vector<U8>& data, U64 handle, const LLUUID& id, extras_entry_list_t& entries)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
+    auto corrupt = [handle](const char* reason)
+    {
+        LL_WARNS() << "Failed reading extras cache for handle " << handle << ": " << reason << LL_ENDL;
+        return false;
+    };
+
+    ExtrasCacheHeader header;
+    if (data.size() < sizeof(header))
+    {
+        return corrupt("truncated header");
+    }
+    memcpy(&header, data.data(), sizeof(header));
+
+    if (header.mVersion != (U32)LLGLTFOverrideCacheEntry::VERSION)
+    {
+        LL_WARNS() << "Unexpected version number " << header.mVersion << " for extras cache for handle " << handle << LL_ENDL;
+        return false;
+    }
+
+    LLUUID cache_id;
+    memcpy(cache_id.mData, header.mRegionID, UUID_BYTES);
+    if (cache_id != id)
+    {
+        // if the cache id doesn't match the expected region we should just kill the file.
+        LL_WARNS() << "Cache ID doesn't match for this region, deleting it" << LL_ENDL;
+        return false;
+    }
+
+    const size_t size = data.size() - sizeof(header);
+    if (header.mPayloadSize != size)
+    {
+        return corrupt("unexpected size");
+    }
+
+    const U8* payload = data.data() + sizeof(header);
+    LLCRC crc;
+    crc.update(payload, size);
+    if (crc.getCRC() != header.mChecksum)
+    {
+        return corrupt("checksum mismatch");
+    }
+
+    LL_DEBUGS("VOCache") << "Reading binary extras cache for handle " << handle << ", version " << header.mVersion << LL_ENDL;
+	LL_PROFILE_ZONE_NUM(header.mNumEntries);
+
+    // The checksum already vouches for the contents, the bounds checks below
+    // only guard against a writer bug.
+    size_t offset = 0;
+    entries.reserve(header.mNumEntries);
+    for (U32 i = 0; i < header.mNumEntries; ++i)
+    {
+        ExtrasCacheRecord record;
+        if (size - offset < sizeof(record))
+        {
+            return corrupt("truncated entry");
+        }
+        memcpy(&record, payload + offset, sizeof(record));
+        offset += sizeof(record);
+
+        LLGLTFOverrideCacheEntry entry;
+        entry.mLocalId = record.mLocalId;
+        memcpy(entry.mObjectId.mData, record.mObjectId, UUID_BYTES);
+        entry.mRegionHandle = handle;
+
+        for (U32 j = 0; j < record.mNumSides; ++j)
+        {
+            ExtrasCacheSide side;
+            if (size - offset < sizeof(side))
+            {
+                return corrupt("truncated side");
+            }
+            memcpy(&side, payload + offset, sizeof(side));
+            offset += sizeof(side);
+
+            if (size - offset < side.mSize)
+            {
+                return corrupt("truncated override");
+            }
+
+            LLSD override_llsd;
+            LLMemoryStream in(payload + offset, (S32)side.mSize);
+            if (LLSDSerialize::fromBinary(override_llsd, in, side.mSize) == LLSDParser::PARSE_FAILURE)
+            {
+                return corrupt("unreadable override");
+            }
+            offset += side.mSize;
+
+            entry.addSide(side.mSide, override_llsd);
+        }
+        entries.push_back(std::move(entry));
+    }
+    return true;
+}
+
+// static
+bool LLVOCache::readLegacyExtras(const std::vector<U8>& data, U64 handle, const LLUUID& id, extras_entry_list_t& entries)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
+    LLMemoryStream in(data.data(), (S32)data.size());
 
     std::string line;
     std::getline(in, line);
     if(!in.good())
     {
         LL_WARNS() << "Failed reading extras cache for handle " << handle << LL_ENDL;
-        in.close();
-        removeGenericExtrasForHandle(handle);
-        return;
+        return false;
     }
     // file formats need versions, let's add one. legacy cache files will be considered version 0
     // This will make it easier to upgrade/revise later.
@@ -1671,24 +1992,20 @@ void LLVOCache::readGenericExtrasFromCache(U64 handle, const LLUUID& id, LLVOCac
         std::string versionStr = line.substr(LLGLTFOverrideCacheEntry::VERSION_LABEL.length()+1); // skip the version label and ':'
         versionNumber = std::stol(versionStr);
     }
-    // For future versions we may call a legacy handler here, but realistically we'll just consider this cache out of date.
+    // Version 0 files predate the label and are simply considered out of date.
     // The important thing is to make sure it gets removed.
-    if(versionNumber != LLGLTFOverrideCacheEntry::VERSION)
+    if(versionNumber != LLGLTFOverrideCacheEntry::LEGACY_XML_VERSION)
     {
         LL_WARNS() << "Unexpected version number " << versionNumber << " for extras cache for handle " << handle << LL_ENDL;
-        in.close();
-        removeGenericExtrasForHandle(handle);
-        return;
+        return false;
     }
 
-    LL_DEBUGS("VOCache") << "Reading extras cache for handle " << handle << ", version " << versionNumber << LL_ENDL;
+    LL_DEBUGS("VOCache") << "Reading legacy extras cache for handle " << handle << ", version " << versionNumber << LL_ENDL;
     std::getline(in, line);
     if(!LLUUID::validate(line))
     {
         LL_WARNS() << "Failed reading extras cache for handle" << handle << ". invalid uuid line: '" << line << "'" << LL_ENDL;
-        in.close();
-        removeGenericExtrasForHandle(handle);
-        return;
+        return false;
     }
 
     LLUUID cache_id(line);
@@ -1696,9 +2013,7 @@ void LLVOCache::readGenericExtrasFromCache(U64 handle, const LLUUID& id, LLVOCac
     {
         // if the cache id doesn't match the expected region we should just kill the file.
         LL_WARNS() << "Cache ID doesn't match for this region, deleting it" << LL_ENDL;
-        in.close();
-        removeGenericExtrasForHandle(handle);
-        return;
+        return false;
     }
 
     U32 num_entries;  // if removal was enabled during write num_entries might be wrong
@@ -1706,9 +2021,7 @@ void LLVOCache::readGenericExtrasFromCache(U64 handle, const LLUUID& id, LLVOCac
     if(!in.good())
     {
         LL_WARNS() << "Failed reading extras cache for handle " << handle << LL_ENDL;
-        in.close();
-        removeGenericExtrasForHandle(handle);
-        return;
+        return false;
     }
     try
     {
@@ -1717,13 +2030,9 @@ void LLVOCache::readGenericExtrasFromCache(U64 handle, const LLUUID& id, LLVOCac
     catch(std::logic_error&)  // either invalid_argument or out_of_range
     {
         LL_WARNS() << "Failed reading extras cache for handle " << handle << ". unreadable num_entries" << LL_ENDL;
-        in.close();
-        removeGenericExtrasForHandle(handle);
-        return;
+        return false;
     }
 
-    LL_DEBUGS("GLTF") << "Beginning reading extras cache for handle " << handle << " from " << getObjectCacheExtrasFilename(handle) << LL_ENDL;
-
     LLSD entry_llsd;
 	LL_PROFILE_ZONE_NUM(num_entries);
     for (U32 i = 0; i < num_entries && !in.eof(); i++)
@@ -1735,33 +2044,16 @@ void LLVOCache::readGenericExtrasFromCache(U64 handle, const LLUUID& id, LLVOCac
         if(!success || !in)
         {
             LL_WARNS() << "Failed reading extras cache for handle " << handle << ", entry number " << i << " cache patrtial load only." << LL_ENDL;
-            in.close();
-            removeGenericExtrasForHandle(handle);
-            break;
+            return false;
         }
 
         LLGLTFOverrideCacheEntry entry;
         entry.fromLLSD(entry_llsd);
-        U32 local_id = entry_llsd["local_id"].asInteger();
-        // only add entries that exist in the primary cache
-        // this is a self-healing test that avoids us polluting the cache with entries that are no longer valid based on the main cache.
-        if(cache_entry_map.find(local_id)!= cache_entry_map.end())
-        {
-            // attempt to backfill a null objectId, though these shouldn't be in the persisted cache really
-            if(entry.mObjectId.isNull() && pRegion)
-            {
-                gObjectList.getUUIDFromLocal( entry.mObjectId, local_id, pRegion->getHost().getAddress(), pRegion->getHost().getPort() );
-            }
-            cache_extras_entry_map[local_id] = entry;
-            loaded++;
-        }
-        else
-        {
-            discarded++;
-        }
+        entries.push_back(std::move(entry));
     }
-    LL_DEBUGS("GLTF") << "Completed reading extras cache for handle " << handle << ", " << loaded << " loaded, " << discarded << " discarded" << LL_ENDL;
+    return true;
 }
+// </FS>
 
 void LLVOCache::purgeEntries(U32 size)
 {
@@ -1951,37 +2243,14 @@ void LLVOCache::writeGenericExtrasToCache(U64 handle, const LLUUID& id, const LL
     }
 
     std::string filename = getObjectCacheExtrasFilename(handle);
-    llofstream out(filename, std::ios::out | std::ios::binary);
-    if(!out.good())
-    {
-        LL_WARNS() << "Failed writing extras cache for handle " << handle << LL_ENDL;
-        removeGenericExtrasForHandle(handle);
-        return;
-    }
-    // It is good practice to version file formats so let's add one.
-    // legacy versions will be treated as version 0.
-    out << LLGLTFOverrideCacheEntry::VERSION_LABEL << ":" << LLGLTFOverrideCacheEntry::VERSION << '\n';
-
-    out << id << '\n';
-    if(!out.good())
-    {
-        LL_WARNS() << "Failed writing extras cache for handle " << handle << LL_ENDL;
-        removeGenericExtrasForHandle(handle);
-        return;
-    }
-    // Because we don't write out all the entries we need to record a placeholder and rewrite this later
-    auto num_entries_placeholder = out.tellp();
-    out << std::setw(10) << std::setfill('0') << 0 << '\n';
-    if(!out.good())
-    {
-        LL_WARNS() << "Failed writing extras cache for handle " << handle << LL_ENDL;
-        removeGenericExtrasForHandle(handle);
-        return;
-    }
 
     // get ViewerRegion pointer from handle
     LLViewerRegion* pRegion = LLWorld::getInstance()->getRegionFromHandle(handle);
 
+    // <FS> Binary extras cache
+    // Assemble the payload in memory first, the header needs its size and checksum.
+    std::string payload;
+    std::ostringstream override_stream;
     U32 num_entries = 0;
     U32 skipped = 0;
     size_t inmem_entries = cache_extras_entry_map.size();
@@ -2001,16 +2270,23 @@ void LLVOCache::writeGenericExtrasToCache(U64 handle, const LLUUID& id, const LL
             entry.mSides.size() == entry.mGLTFMaterial.size()
           )
         {
-            LLSD entry_llsd = entry.toLLSD();
-            entry_llsd["local_id"] = (S32)local_id;
-            LLSDSerialize::serialize(entry_llsd, out, LLSDSerialize::LLSD_XML);
-            out << '\n';
-            if(!out.good())
+            ExtrasCacheRecord record;
+            record.mLocalId = local_id;
+            memcpy(record.mObjectId, entry.mObjectId.mData, UUID_BYTES);
+            record.mNumSides = (U32)entry.mSides.size();
+            payload.append(reinterpret_cast<const char*>(&record), sizeof(record));
+
+            for (const auto& side : entry.mSides)
             {
-                // We're not in a good place when this happens so we might as well nuke the file.
-                LL_WARNS() << "Failed writing extras cache for handle " << handle << ". Corrupted cache file " << filename << " removed." << LL_ENDL;
-                removeGenericExtrasForHandle(handle);
-                return;
+                override_stream.str(std::string());
+                LLSDSerialize::toBinary(side.second, override_stream);
+                const std::string override_data = override_stream.str();
+
+                ExtrasCacheSide side_header;
+                side_header.mSide = side.first;
+                side_header.mSize = (U32)override_data.size();
+                payload.append(reinterpret_cast<const char*>(&side_header), sizeof(side_header));
+                payload.append(override_data);
             }
             num_entries++;
         }
@@ -2019,14 +2295,31 @@ void LLVOCache::writeGenericExtrasToCache(U64 handle, const LLUUID& id, const LL
             skipped++;
         }
     }
-    // Rewrite the placeholder
-    out.seekp(num_entries_placeholder);
-    out << std::setw(10) << std::setfill('0') << num_entries << '\n';
+
+    ExtrasCacheHeader header;
+    header.mMagic = EXTRAS_CACHE_MAGIC;
+    header.mVersion = LLGLTFOverrideCacheEntry::VERSION;
+    memcpy(header.mRegionID, id.mData, UUID_BYTES);
+    header.mNumEntries = num_entries;
+    header.mPayloadSize = (U32)payload.size();
+    LLCRC crc;
+    crc.update(reinterpret_cast<const U8*>(payload.data()), payload.size());
+    header.mChecksum = crc.getCRC();
+
+    llofstream out(filename, std::ios::out | std::ios::binary);
+    if(out.good())
+    {
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(payload.data(), payload.size());
+    }
     if(!out.good())
     {
-        LL_WARNS() << "Failed writing extras cache for handle " << handle << LL_ENDL;
+        // We're not in a good place when this happens so we might as well nuke the file.
+        LL_WARNS() << "Failed writing extras cache for handle " << handle << ". Corrupted cache file " << filename << " removed." << LL_ENDL;
+        out.close();
         removeGenericExtrasForHandle(handle);
         return;
     }
-    LL_DEBUGS("GLTF") << "Completed writing extras cache for handle " << handle << ", " << num_entries << " entries. Total in RAM: " << inmem_entries << " skipped (no persist): " << skipped << LL_ENDL;
+    // </FS>
+    LL_DEBUGS("GLTF") << "Completed writing extras cache for handle " << handle << ", " << num_entries << " entries, " << payload.size() << " bytes. Total in RAM: " << inmem_entries << " skipped (no persist): " << skipped << LL_ENDL;
 }
@@ -34,6 +34,8 @@
 #include "llapr.h"
 #include "llgltfmaterial.h"
 
+#include <functional>
+#include <memory>
 #include <unordered_map>
 
 //---------------------------------------------------------------------------
@@ -45,8 +47,10 @@ class LLGLTFOverrideCacheEntry
 public:
     static const std::string VERSION_LABEL;
     static const int VERSION;
+    static const int LEGACY_XML_VERSION; // <FS/> Binary extras cache
     bool fromLLSD(const LLSD& data);
     LLSD toLLSD() const;
+    void addSide(S32 side_idx, const LLSD& override_llsd); // <FS/> Binary extras cache
 
     LLUUID mObjectId;
     U32    mLocalId = 0;
@@ -288,6 +292,21 @@ private:
     typedef std::map<U64, HeaderEntryInfo*> handle_entry_map_t;
 
 public:
+    // <FS> Asynchronous object cache loading
+    typedef std::vector<LLGLTFOverrideCacheEntry> extras_entry_list_t;
+
+    // Everything read from disk for one region
+    struct RegionCacheLoad
+    {
+        LLVOCacheEntry::vocache_entry_map_t mEntries;
+        extras_entry_list_t                 mExtras;    // only those matching an entry
+        bool                                mSuccess { true };
+        bool                                mExtrasSuccess { true };
+    };
+    typedef std::shared_ptr<RegionCacheLoad> region_cache_load_ptr_t;
+    typedef std::function<void(const region_cache_load_ptr_t&)> region_cache_load_callback_t;
+    // </FS>
+
     // We need this init to be separate from constructor, since we might construct cache, purge it, then init.
     void initCache(ELLPath location, U32 size, U32 cache_version);
     void removeCache(ELLPath location, bool started = false) ;
@@ -295,6 +314,13 @@ public:
     bool readFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::vocache_entry_map_t& cache_entry_map) ;
     void readGenericExtrasFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::vocache_gltf_overrides_map_t& cache_extras_entry_map, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map);
 
+    // <FS> Asynchronous object cache loading
+    // Reads the object cache and the extras of a region on the "General"
+    // thread pool. callback runs on the main thread once both are in memory;
+    // the null object ids of the overrides are not backfilled yet.
+    void readFromCacheAsync(U64 handle, const LLUUID& id, region_cache_load_callback_t callback);
+    // </FS>
+
     void writeToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, bool dirty_cache, bool removal_enabled);
     void writeGenericExtrasToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry::vocache_gltf_overrides_map_t& cache_extras_entry_map, bool dirty_cache, bool removal_enabled);
     void removeEntry(U64 handle) ;
@@ -316,6 +342,20 @@ private:
     void removeEntry(HeaderEntryInfo* entry) ;
     void purgeEntries(U32 size);
     bool updateEntry(const HeaderEntryInfo* entry);
+    void finishAsyncRead(U64 handle, const RegionCacheLoad& load); // <FS/> Asynchronous object cache loading
+
+    // <FS> Binary extras cache
+    static bool readBinaryExtras(const std::vector<U8>& data, U64 handle, const LLUUID& id, extras_entry_list_t& entries);
+    static bool readLegacyExtras(const std::vector<U8>& data, U64 handle, const LLUUID& id, extras_entry_list_t& entries);
+    // </FS>
+
+    // <FS> Asynchronous object cache loading
+    // These only touch the files and their arguments, so they are safe to
+    // run on a worker thread.
+    static bool readObjectCacheFile(const std::string& filename, const LLUUID& id, LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, LLVolatileAPRPool* pool);
+    static bool readExtrasFile(const std::string& filename, U64 handle, const LLUUID& id,
+                               const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, extras_entry_list_t& entries);
+    // </FS>
 
 private:
     bool                 mEnabled;
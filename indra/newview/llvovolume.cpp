@@ -720,21 +720,29 @@ void LLVOVolume::onDrawableUpdateFromServer()
 
 void LLVOVolume::animateTextures()
 {
+    // <FS> Parallel texture animation
+    computeTextureAnimation();
+    applyTextureAnimation();
+    // </FS>
+}
+
+// <FS> Parallel texture animation
+// Steps the animation and works out the texture matrices without touching
+// the faces or the pipeline, so LLViewerTextureAnim::updateClass() can run
+// it for many objects at once.
+void LLVOVolume::computeTextureAnimation()
+{
+    mTextureAnimp->mPendingResult = 0;
+    mTextureAnimp->mPendingMatrices.clear();
+
     if (!mDead && mDrawable) // <FS:Beq/> FIRE-34601 - bugsplat accessing null drawable.
     {
-        shrinkWrap();
         F32 off_s = 0.f, off_t = 0.f, scale_s = 1.f, scale_t = 1.f, rot = 0.f;
         S32 result = mTextureAnimp->animateTextures(off_s, off_t, scale_s, scale_t, rot);
+        mTextureAnimp->mPendingResult = result;
 
         if (result)
         {
-            if (!mTexAnimMode)
-            {
-                mFaceMappingChanged = true;
-                gPipeline.markTextured(mDrawable);
-            }
-            mTexAnimMode = result | mTextureAnimp->mMode;
-
             S32 start=0, end=mDrawable->getNumFaces()-1;
             if (mTextureAnimp->mFace >= 0 && mTextureAnimp->mFace <= end)
             {
@@ -770,13 +778,59 @@ void LLVOVolume::animateTextures()
                     te->getScale(&scale_s, &scale_t);
                 }
 
+                LLMatrix4 tex_mat;
+                tex_mat.setIdentity();
+                LLVector3 trans ;
+
+                    trans.set(LLVector3(off_s+0.5f, off_t+0.5f, 0.f));
+                    tex_mat.translate(LLVector3(-0.5f, -0.5f, 0.f));
+
+                LLVector3 scale(scale_s, scale_t, 1.f);
+                LLQuaternion quat;
+                quat.setQuat(rot, 0, 0, -1.f);
+
+                tex_mat.rotate(quat);
+
+                LLMatrix4 mat;
+                mat.initAll(scale, LLQuaternion(), LLVector3());
+                tex_mat *= mat;
+
+                tex_mat.translate(trans);
+
+                mTextureAnimp->mPendingMatrices.emplace_back(i, tex_mat);
+            }
+        }
+    }
+}
+
+void LLVOVolume::applyTextureAnimation()
+{
+    if (!mDead && mDrawable) // <FS:Beq/> FIRE-34601 - bugsplat accessing null drawable.
+    {
+        shrinkWrap();
+        S32 result = mTextureAnimp->mPendingResult;
+
+        if (result)
+        {
+            if (!mTexAnimMode)
+            {
+                mFaceMappingChanged = true;
+                gPipeline.markTextured(mDrawable);
+            }
+            mTexAnimMode = result | mTextureAnimp->mMode;
+
+            for (const auto& face_matrix : mTextureAnimp->mPendingMatrices)
+            {
+                LLFace* facep = mDrawable->getFace(face_matrix.first);
+                if (!facep) continue;
+
                 if (!facep->mTextureMatrix)
                 {
                     facep->mTextureMatrix = new LLMatrix4();
                     // <FS:minerjr> [FIRE-35081] Blurry prims not changing with graphics settings
                     // Removed check for turning off animations
                     //if (facep->getVirtualSize() > MIN_TEX_ANIM_SIZE)
-                    // </FS:minerjr> [FIRE-35081]                    
+                    // </FS:minerjr> [FIRE-35081]
                     {
                         // Fix the one edge case missed in
                         // LLVOVolume::updateTextureVirtualSize when the
@@ -791,24 +845,7 @@ void LLVOVolume::animateTextures()
                     }
                 }
 
-                LLMatrix4& tex_mat = *facep->mTextureMatrix;
-                tex_mat.setIdentity();
-                LLVector3 trans ;
-
-                    trans.set(LLVector3(off_s+0.5f, off_t+0.5f, 0.f));
-                    tex_mat.translate(LLVector3(-0.5f, -0.5f, 0.f));
-
-                LLVector3 scale(scale_s, scale_t, 1.f);
-                LLQuaternion quat;
-                quat.setQuat(rot, 0, 0, -1.f);
-
-                tex_mat.rotate(quat);
-
-                LLMatrix4 mat;
-                mat.initAll(scale, LLQuaternion(), LLVector3());
-                tex_mat *= mat;
-
-                tex_mat.translate(trans);
+                *facep->mTextureMatrix = face_matrix.second;
             }
         }
         else
@@ -849,8 +886,10 @@ void LLVOVolume::animateTextures()
                 mTexAnimMode = 0;
             }
         }
+        mTextureAnimp->mPendingMatrices.clear();
     }
 }
+// </FS>
 
 void LLVOVolume::updateTextures()
 {
@@ -5262,11 +5301,16 @@ void LLRiggedVolume::update(
 
 
     //build matrix palette
-    static const size_t kMaxJoints = LL_MAX_JOINTS_PER_MESH_OBJECT;
-
-    LLMatrix4a mat[kMaxJoints];
-    U32 maxJoints = LLSkinningUtil::getMeshJointCount(skin);
-    LLSkinningUtil::initSkinningMatrixPalette(mat, maxJoints, skin, avatar);
+    // <FS> Skinning palette cache: share the avatar's palette for this skin
+    // with every other rigged mesh and with the draw pools
+    //static const size_t kMaxJoints = LL_MAX_JOINTS_PER_MESH_OBJECT;
+    //
+    //LLMatrix4a mat[kMaxJoints];
+    //U32 maxJoints = LLSkinningUtil::getMeshJointCount(skin);
+    //LLSkinningUtil::initSkinningMatrixPalette(mat, maxJoints, skin, avatar);
+    const LLVOAvatar::MatrixPaletteCache& palette = avatar->updateSkinInfoMatrixPalette(skin);
+    const LLMatrix4a* mat = palette.mMatrixPalette.data();
+    // </FS>
     const LLMatrix4a bind_shape_matrix = skin->mBindShapeMatrix;
 
     S32 rigged_vert_count = 0;
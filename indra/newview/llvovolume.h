@@ -132,6 +132,12 @@ public:
                 void    deleteFaces();
 
                 void    animateTextures();
+                // <FS> Parallel texture animation
+                // animateTextures() in two steps: the first is thread safe,
+                // the second applies the result to the faces on the main thread
+                void    computeTextureAnimation();
+                void    applyTextureAnimation();
+                // </FS>
 
                 bool    isVisible() const ;
     bool isActive() const override;